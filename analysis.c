@@ -93,6 +93,7 @@ LuckFirst(const TanBoard anBoard, const int n0, const int n1, cubeinfo * pci, co
     float aar[6][6], ar[NUM_ROLLOUT_OUTPUTS], rMean = 0.0f;
     cubeinfo ciOpp;
     movelist ml;
+    size_t iMark = MT_ScratchMark();
 
     /* first with player pci->fMove on roll */
 
@@ -104,9 +105,9 @@ LuckFirst(const TanBoard anBoard, const int n0, const int n1, cubeinfo * pci, co
             memcpy(&anBoardTemp[0][0], &anBoard[0][0], 2 * 25 * sizeof(int));
 
             /* Find the best move for each roll at ply 0 only. */
-            if (FindnSaveBestMoves(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
-                                   pci, pec, defaultFilters) < 0) {
-                free(ml.amMoves);
+            if (FindnSaveBestMovesScratch(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
+                                          pci, pec, defaultFilters) < 0) {
+                MT_ScratchRelease(iMark);
                 return ERR_VAL;
             }
 
@@ -127,7 +128,8 @@ LuckFirst(const TanBoard anBoard, const int n0, const int n1, cubeinfo * pci, co
 
             } else {
                 aar[i][j] = ml.amMoves[0].rScore;
-                free(ml.amMoves);
+                /* the next roll reuses the memory */
+                MT_ScratchRelease(iMark);
             }
 
             rMean += aar[i][j];
@@ -142,9 +144,9 @@ LuckFirst(const TanBoard anBoard, const int n0, const int n1, cubeinfo * pci, co
             SwapSides(anBoardTemp);
 
             /* Find the best move for each roll at ply 0 only. */
-            if (FindnSaveBestMoves(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
-                                   &ciOpp, pec, defaultFilters) < 0) {
-                free(ml.amMoves);
+            if (FindnSaveBestMovesScratch(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
+                                          &ciOpp, pec, defaultFilters) < 0) {
+                MT_ScratchRelease(iMark);
                 return ERR_VAL;
             }
 
@@ -165,7 +167,8 @@ LuckFirst(const TanBoard anBoard, const int n0, const int n1, cubeinfo * pci, co
 
             } else {
                 aar[i][j] = -ml.amMoves[0].rScore;
-                free(ml.amMoves);
+                /* the next roll reuses the memory */
+                MT_ScratchRelease(iMark);
             }
 
             rMean += aar[i][j];
@@ -188,6 +191,7 @@ LuckNormal(const TanBoard anBoard, const int n0, const int n1, const cubeinfo *
     float aar[6][6], ar[NUM_ROLLOUT_OUTPUTS], rMean = 0.0f;
     cubeinfo ciOpp;
     movelist ml;
+    size_t iMark = MT_ScratchMark();
 
     memcpy(&ciOpp, pci, sizeof(cubeinfo));
     ciOpp.fMove = !pci->fMove;
@@ -197,9 +201,9 @@ LuckNormal(const TanBoard anBoard, const int n0, const int n1, const cubeinfo *
             memcpy(&anBoardTemp[0][0], &anBoard[0][0], 2 * 25 * sizeof(int));
 
             /* Find the best move for each roll at ply 0 only. */
-            if (FindnSaveBestMoves(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
-                                   pci, pec, defaultFilters) < 0) {
-                free(ml.amMoves);
+            if (FindnSaveBestMovesScratch(&ml, i + 1, j + 1, (ConstTanBoard) anBoardTemp, NULL, 0.0f,
+                                          pci, pec, defaultFilters) < 0) {
+                MT_ScratchRelease(iMark);
                 return ERR_VAL;
             }
 
@@ -220,7 +224,8 @@ LuckNormal(const TanBoard anBoard, const int n0, const int n1, const cubeinfo *
 
             } else {
                 aar[i][j] = ml.amMoves[0].rScore;
-                free(ml.amMoves);
+                /* the next roll reuses the memory */
+                MT_ScratchRelease(iMark);
             }
 
             rMean += (i == j) ? aar[i][j] : aar[i][j] * 2.0f;
@@ -918,6 +923,137 @@ UpdateProgressBar(gpointer UNUSED(unused))
     return TRUE;
 }
 
+/* Incremental analysis.  Every analysed move record keeps a stamp of
+ * what its analysis depended on: the analysis settings, the match state
+ * before the record, the record itself and the kind of evaluations
+ * stored in it.  Records whose stamp still matches are not analysed
+ * again, so re-analysing a match that has grown or been edited only
+ * costs the new and changed records (and those following an edit, as
+ * their match state differs).  Use "analyse clear" to force a full
+ * analysis. */
+
+static unsigned int
+HashBytes(unsigned int n, const void *p, size_t cb)
+{
+    const unsigned char *puch = p;
+
+    /* FNV-1a */
+    while (cb--)
+        n = (n ^ *puch++) * 16777619u;
+
+    return n;
+}
+
+static unsigned int
+AnalysisInputs(const moverecord * pmr, const matchstate * pms)
+{
+    unsigned int n = 2166136261u;
+
+    n = HashBytes(n, &esAnalysisChequer, sizeof esAnalysisChequer);
+    n = HashBytes(n, &esAnalysisCube, sizeof esAnalysisCube);
+    n = HashBytes(n, aamfAnalysis, sizeof aamfAnalysis);
+    n = HashBytes(n, afAnalysePlayers, sizeof afAnalysePlayers);
+    n = HashBytes(n, &fAnalyseCube, sizeof fAnalyseCube);
+    n = HashBytes(n, &fAnalyseDice, sizeof fAnalyseDice);
+    n = HashBytes(n, &fAnalyseMove, sizeof fAnalyseMove);
+    n = HashBytes(n, pms, sizeof *pms);
+
+    n = HashBytes(n, &pmr->mt, sizeof pmr->mt);
+    n = HashBytes(n, &pmr->fPlayer, sizeof pmr->fPlayer);
+    n = HashBytes(n, pmr->anDice, sizeof pmr->anDice);
+    n = HashBytes(n, &pmr->nAnimals, sizeof pmr->nAnimals);
+
+    switch (pmr->mt) {
+    case MOVE_GAMEINFO:
+        n = HashBytes(n, &pmr->g.fWinner, sizeof pmr->g.fWinner);
+        n = HashBytes(n, &pmr->g.nPoints, sizeof pmr->g.nPoints);
+        n = HashBytes(n, &pmr->g.fResigned, sizeof pmr->g.fResigned);
+        break;
+    case MOVE_NORMAL:
+        n = HashBytes(n, pmr->n.anMove, sizeof pmr->n.anMove);
+        break;
+    case MOVE_RESIGN:
+        n = HashBytes(n, &pmr->r.nResigned, sizeof pmr->r.nResigned);
+        break;
+    case MOVE_SETBOARD:
+        n = HashBytes(n, &pmr->sb.key, sizeof pmr->sb.key);
+        break;
+    case MOVE_SETCUBEVAL:
+        n = HashBytes(n, &pmr->scv.nCube, sizeof pmr->scv.nCube);
+        break;
+    case MOVE_SETCUBEPOS:
+        n = HashBytes(n, &pmr->scp.fCubeOwner, sizeof pmr->scp.fCubeOwner);
+        break;
+    default:
+        break;
+    }
+
+    return n;
+}
+
+/* The stamp adds the kind of the stored evaluations, so a record that
+ * has been rolled out or cleared since is analysed again. */
+
+static unsigned int
+AnalysisStamp(const moverecord * pmr, unsigned int nInputs)
+{
+    unsigned int n = nInputs;
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
+        n = HashBytes(n, &pmr->esChequer.et, sizeof pmr->esChequer.et);
+        n = HashBytes(n, &pmr->CubeDecPtr->esDouble.et, sizeof pmr->CubeDecPtr->esDouble.et);
+        break;
+    case MOVE_DOUBLE:
+    case MOVE_TAKE:
+    case MOVE_DROP:
+        n = HashBytes(n, &pmr->CubeDecPtr->esDouble.et, sizeof pmr->CubeDecPtr->esDouble.et);
+        break;
+    case MOVE_RESIGN:
+        n = HashBytes(n, &pmr->r.esResign.et, sizeof pmr->r.esResign.et);
+        break;
+    default:
+        break;
+    }
+
+    return n ? n : 1;
+}
+
+static void
+NextAnalyseState(matchstate * pms, const listOLD * plGame, const moverecord * pmr)
+{
+    FixMatchState(pms, pmr);
+    if ((pmr->fPlayer != pms->fMove)
+        && (pmr->mt == MOVE_NORMAL || pmr->mt == MOVE_RESIGN || pmr->mt == MOVE_SETDICE)) {
+        SwapSides(pms->anBoard);
+        pms->fMove = pmr->fPlayer;
+    }
+    ApplyMoveRecord(pms, plGame, pmr);
+}
+
+/* Number of records of the game whose analysis is out of date */
+
+static unsigned int
+StaleMovesGame(const listOLD * plGame)
+{
+    unsigned int cStale = 0;
+    const listOLD *pl;
+    matchstate msAnalyse;
+
+    memset(&msAnalyse, 0, sizeof msAnalyse);
+
+    for (pl = plGame->plNext; pl != plGame; pl = pl->plNext) {
+        moverecord *pmr = pl->p;
+
+        if (pmr->nAnalysisStamp != AnalysisStamp(pmr, AnalysisInputs(pmr, &msAnalyse)))
+            cStale++;
+
+        NextAnalyseState(&msAnalyse, plGame, pmr);
+    }
+
+    return cStale;
+}
+
 static void
 AnalyseMoveMT(Task * task)
 {
@@ -929,6 +1065,8 @@ AnalyseMoveMT(Task * task)
     if (AnalyzeMove(amt->pmr, &amt->ms, amt->plGame, amt->psc,
                     &esAnalysisChequer, &esAnalysisCube, aamfAnalysis, afAnalysePlayers, &doubleError) < 0)
         MT_AbortTasks();
+    else
+        amt->pmr->nAnalysisStamp = AnalysisStamp(amt->pmr, amt->nInputs);
 
     if (task->pLinkedTask) {    /* Need to analyze take/drop decision in sequence */
         task = task->pLinkedTask;
@@ -936,6 +1074,12 @@ AnalyseMoveMT(Task * task)
     }
 }
 
+/* Queue the analysis of the out of date records of the game.  When
+ * every record is out of date the game statistics are collected as the
+ * moves are analysed; otherwise they have to be recomputed with
+ * updateStatisticsGame() once the analysis is done, which is signalled
+ * by returning 1 when wait is FALSE. */
+
 static int
 AnalyzeGame(listOLD * plGame, int wait)
 {
@@ -943,16 +1087,27 @@ AnalyzeGame(listOLD * plGame, int wait)
     unsigned int i;
     listOLD *pl = plGame->plNext;
     moverecord *pmr = pl->p;
-    statcontext *psc = &pmr->g.sc;
+    statcontext *psc;
     matchstate msAnalyse;
     unsigned int numMoves = NumberMovesGame(plGame);
+    unsigned int cStale = StaleMovesGame(plGame);
+    unsigned int nInputs;
+    int fPartial = cStale < numMoves;
+    int fStale, fParentStale = FALSE;
     AnalyseMoveTask *pt = NULL, *pParentTask = NULL;
 
+    if (!cStale)
+        return 0;
+
     /* Analyse first move record (gameinfo) */
     g_assert(pmr->mt == MOVE_GAMEINFO);
-    if (AnalyzeMove(pmr, &msAnalyse, plGame, psc,
+    memset(&msAnalyse, 0, sizeof msAnalyse);
+    nInputs = AnalysisInputs(pmr, &msAnalyse);
+    if (AnalyzeMove(pmr, &msAnalyse, plGame, fPartial ? NULL : &pmr->g.sc,
                     &esAnalysisChequer, &esAnalysisCube, aamfAnalysis, afAnalysePlayers, NULL) < 0)
         return -1;              /* Interrupted */
+    pmr->nAnalysisStamp = AnalysisStamp(pmr, nInputs);
+    psc = fPartial ? NULL : &pmr->g.sc;
 
     numMoves--;                 /* Done one - the gameinfo */
 
@@ -970,12 +1125,16 @@ AnalyzeGame(listOLD * plGame, int wait)
         if (!pParentTask)
             pt = (AnalyseMoveTask *) malloc(sizeof(AnalyseMoveTask));
 
+        nInputs = AnalysisInputs(pmr, &msAnalyse);
+        fStale = pmr->nAnalysisStamp != AnalysisStamp(pmr, nInputs);
+
         pt->task.fun = (AsyncFun) AnalyseMoveMT;
         pt->task.data = pt;
         pt->task.pLinkedTask = NULL;
         pt->pmr = pmr;
         pt->plGame = plGame;
         pt->psc = psc;
+        pt->nInputs = nInputs;
         memcpy(&pt->ms, &msAnalyse, sizeof(msAnalyse));
 
         if (pmr->mt == MOVE_DOUBLE) {
@@ -983,25 +1142,27 @@ AnalyzeGame(listOLD * plGame, int wait)
             moverecord *pNextmr = (moverecord *) pl->plNext->p;
             if (pNextmr && dt == DT_NORMAL) {   /* Need to link the two tasks so executed together */
                 pParentTask = pt;
+                fParentStale = fStale;
                 pt = (AnalyseMoveTask *) malloc(sizeof(AnalyseMoveTask));
                 pParentTask->task.pLinkedTask = (Task *) pt;
             }
         } else {
             if (pParentTask) {
+                /* the double and its take or drop go together */
+                fStale = fStale || fParentStale;
                 pt = pParentTask;
                 pParentTask = NULL;
             }
-            multi_debug("add task: analysis");
-            MT_AddTask((Task *) pt, TRUE);
+            if (fStale) {
+                multi_debug("add task: analysis");
+                MT_AddTask((Task *) pt, TRUE);
+            } else {
+                free(pt->task.pLinkedTask);
+                free(pt);
+            }
         }
 
-        FixMatchState(&msAnalyse, pmr);
-        if ((pmr->fPlayer != msAnalyse.fMove)
-            && (pmr->mt == MOVE_NORMAL || pmr->mt == MOVE_RESIGN || pmr->mt == MOVE_SETDICE)) {
-            SwapSides(msAnalyse.anBoard);
-            msAnalyse.fMove = pmr->fPlayer;
-        }
-        ApplyMoveRecord(&msAnalyse, plGame, pmr);
+        NextAnalyseState(&msAnalyse, plGame, pmr);
     }
     g_assert(pl->plNext == plGame);
 
@@ -1010,11 +1171,13 @@ AnalyzeGame(listOLD * plGame, int wait)
         result = MT_WaitForTasks(UpdateProgressBar, 250, fAutoSaveAnalysis);
 
         if (result == -1)
-            IniStatcontext(psc);
+            IniStatcontext(&((moverecord *) plGame->plNext->p)->g.sc);
+        else if (fPartial)
+            updateStatisticsGame(plGame);
 
         return result;
     } else
-        return 0;
+        return fPartial;
 }
 
 
@@ -1157,7 +1320,7 @@ CommandAnalyseGame(char *UNUSED(sz))
         return;
 
     fStore_crawford = ms.fCrawford;
-    nMoves = NumberMovesGame(plGame);
+    nMoves = StaleMovesGame(plGame);
 
     ProgressStartValue(_("Analysing game; move:"), nMoves);
 
@@ -1181,8 +1344,10 @@ CommandAnalyseMatch(char *UNUSED(sz))
 {
     listOLD *pl;
     moverecord *pmr;
-    int nMoves;
+    int nMoves = 0;
     int fStore_crawford;
+    int result;
+    GSList *plStale = NULL, *plStats;
 
     if (!CheckGameExists())
         return;
@@ -1191,30 +1356,41 @@ CommandAnalyseMatch(char *UNUSED(sz))
         return;
 
     fStore_crawford = ms.fCrawford;
-    nMoves = NumberMovesMatch(&lMatch);
+    for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
+        nMoves += StaleMovesGame(pl->p);
 
     ProgressStartValue(_("Analysing match; move:"), nMoves);
 
-    IniStatcontext(&scMatch);
-
     for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext) {
 
-        if (AnalyzeGame(pl->p, FALSE) < 0) {
-            /* analysis incomplete; erase partial summary */
-
-            IniStatcontext(&scMatch);
+        result = AnalyzeGame(pl->p, FALSE);
+        if (result < 0)
             break;
-        }
-        pmr = (moverecord *) ((listOLD *) pl->p)->plNext->p;
-        g_assert(pmr->mt == MOVE_GAMEINFO);
-        AddStatcontext(&pmr->g.sc, &scMatch);
+        else if (result > 0)
+            plStale = g_slist_prepend(plStale, pl->p);
     }
 
     multi_debug("wait for all task: analysis");
-    MT_WaitForTasks(UpdateProgressBar, 250, fAutoSaveAnalysis);
+    result = MT_WaitForTasks(UpdateProgressBar, 250, fAutoSaveAnalysis);
 
     ProgressEnd();
 
+    /* only the games that were partly analysed need their statistics
+     * recomputed; the match summary is the sum of the games */
+
+    for (plStats = plStale; plStats; plStats = plStats->next)
+        updateStatisticsGame(plStats->data);
+    g_slist_free(plStale);
+
+    IniStatcontext(&scMatch);
+
+    if (result != -1 && !fInterrupt)
+        for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext) {
+            pmr = (moverecord *) ((listOLD *) pl->p)->plNext->p;
+            g_assert(pmr->mt == MOVE_GAMEINFO);
+            AddStatcontext(&pmr->g.sc, &scMatch);
+        }
+
 #if defined(USE_GTK)
     if (fX)
         ChangeGame(NULL);
@@ -1698,6 +1874,8 @@ AnalyseClearMove(moverecord * pmr)
     if (!pmr)
         return;
 
+    pmr->nAnalysisStamp = 0;
+
     switch (pmr->mt) {
     case MOVE_GAMEINFO:
         IniStatcontext(&pmr->g.sc);
@@ -196,6 +196,8 @@ typedef struct _moverecord {
     cubedecisiondata CubeDec;
     /* skill for the cube decision */
     skilltype stCube;
+    /* stamp of the inputs of the last analysis, 0 if not analysed */
+    unsigned int nAnalysisStamp;
     /* "private" data */
     xmovegameinfo g;            /* game information */
     xmovenormal n;              /* chequerplay move */
@@ -302,6 +304,10 @@ extern listOLD *plLastMove;
  */
 extern listOLD lMatch;
 
+/* Raised whenever games or move records are taken out of lMatch, so
+ * pointers kept into it can be known to be stale */
+extern unsigned int nMatchGeneration;
+
 extern int automaticTask;
 
 extern char *aszCopying[];
@@ -577,6 +583,7 @@ extern void CommandExportGamePDF(char *);
 extern void CommandExportGamePS(char *);
 extern void CommandExportGameText(char *);
 extern void CommandExportHTMLImages(char *);
+extern void CommandExportMatchGBF(char *);
 extern void CommandExportMatchHtml(char *);
 extern void CommandExportMatchLaTeX(char *);
 extern void CommandExportMatchMat(char *);
@@ -604,8 +611,10 @@ extern void CommandHelp(char *);
 extern void CommandHint(char *);
 extern void CommandHistory(char *);
 extern void CommandImportAuto(char *);
+extern void CommandImportBatch(char *);
 extern void CommandImportBGRoom(char *);
 extern void CommandImportEmpire(char *);
+extern void CommandImportGBF(char *);
 extern void CommandImportJF(char *);
 extern void CommandImportMat(char *);
 extern void CommandImportOldmoves(char *);
@@ -802,6 +811,7 @@ extern void CommandSetMatchRating(char *);
 extern void CommandSetMatchRound(char *);
 extern void CommandSetMessage(char *);
 extern void CommandSetMET(char *);
+extern void CommandSetOSRTrials(char *);
 extern void CommandSetOutputDigits(char *);
 extern void CommandSetOutputErrorRateFactor(char *);
 extern void CommandSetOutputMatchPC(char *);
@@ -837,6 +847,7 @@ extern void CommandSetRNGIsaac(char *);
 extern void CommandSetRNGManual(char *);
 extern void CommandSetRNGMD5(char *);
 extern void CommandSetRNGMersenne(char *);
+extern void CommandSetRNGPhilox(char *);
 extern void CommandSetRNGRandomDotOrg(char *);
 extern void CommandSetRolloutBearoffTruncationExact(char *);
 extern void CommandSetRolloutBearoffTruncationOS(char *);
@@ -883,6 +894,7 @@ extern void CommandSetRolloutTruncationEnable(char *);
 extern void CommandSetRolloutTruncationEqualPlayer0(char *);
 extern void CommandSetRolloutTruncationPlies(char *);
 extern void CommandSetRolloutVarRedn(char *);
+extern void CommandSetRolloutWorkers(char *);
 extern void CommandSetScore(char *);
 extern void CommandSetSeed(char *);
 extern void CommandSetSGFFolder(char *);
@@ -909,6 +921,9 @@ extern void CommandSetSoundSystemCommand(char *);
 extern void CommandSetStyledGameList(char *);
 extern void CommandSetTheoryWindow(char *);
 extern void CommandSetThreads(char *);
+extern void CommandSetNUMAOff(char *);
+extern void CommandSetNUMAOn(char *);
+extern void CommandSetNUMASharded(char *);
 extern void CommandSetToolbar(char *);
 extern void CommandSetTurn(char *);
 extern void CommandSetTutorChequer(char *);
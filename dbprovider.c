@@ -33,6 +33,7 @@
 
 DBProviderType dbProviderType = (DBProviderType)INVALID_PROVIDER ;
 int storeGameStats = TRUE;
+int storePositions = FALSE;
 
 #if defined(USE_PYTHON)
 #include "pylocdefs.h"
@@ -61,6 +62,10 @@ static void SQLiteDisconnect(void);
 static RowSet *SQLiteSelect(const char *str);
 static int SQLiteUpdateCommand(const char *str);
 static void SQLiteCommit(void);
+static int SQLiteBegin(void);
+static void *SQLitePrepare(const char *str);
+static int SQLiteExecute(void *stmt, const DBValue * av, int c);
+static void SQLiteFinalize(void *stmt);
 #endif
 
 #if NUM_PROVIDERS
@@ -69,27 +74,29 @@ static GList *SQLiteGetDatabaseList(const char *user, const char *password, cons
 static DBProvider providers[NUM_PROVIDERS] = {
 #if defined(USE_SQLITE)
     {SQLiteConnect, SQLiteDisconnect, SQLiteSelect, SQLiteUpdateCommand, SQLiteCommit, SQLiteGetDatabaseList,
-     SQLiteDeleteDatabase,
+     SQLiteDeleteDatabase, SQLiteBegin, SQLitePrepare, SQLiteExecute, SQLiteFinalize,
      "SQLite", "SQLite", "Direct SQLite3 connection", FALSE, TRUE, "gnubg", "", "", ""},
 #endif
 #if defined(USE_PYTHON)
 #if !defined(USE_SQLITE)
     {PySQLiteConnect, PyDisconnect, PySelect, PyUpdateCommand, PyCommit, SQLiteGetDatabaseList, SQLiteDeleteDatabase,
+     NULL, NULL, NULL, NULL,
      "SQLite (Python)", "PythonSQLite", "SQLite3 connection included in latest Python version", FALSE, TRUE, "gnubg",
      "", "", ""},
 #endif
     {PyMySQLConnect, PyDisconnect, PySelect, PyUpdateCommand, PyCommit, PyMySQLGetDatabaseList, PyMySQLDeleteDatabase,
+     NULL, NULL, NULL, NULL,
      "MySQL (Python)", "PythonMySQL", "MySQL connection via MySQLdb Python module", TRUE, TRUE, "gnubg", "", "",
      "localhost:3306"},
     {PyPostgreConnect, PyDisconnect, PySelect, PyUpdateCommand, PyCommit, PyPostgreGetDatabaseList,
-     PyPostgreDeleteDatabase,
+     PyPostgreDeleteDatabase, NULL, NULL, NULL, NULL,
      "PostgreSQL (Python)", "PythonPostgre", "PostgreSQL connection via PyGreSQL Python module", TRUE, TRUE, "gnubg", "",
      "", "localhost:5432"},
 #endif
 };
 
 #else
-DBProvider providers[1] = { {0, 0, 0, 0, 0, 0, 0, "No Providers", "No Providers", "No Providers", 0, 0, 0, 0, 0, 0} };
+DBProvider providers[1] = { {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "No Providers", "No Providers", "No Providers", 0, 0, 0, 0, 0, 0} };
 #endif
 
 #if defined(USE_PYTHON) || defined(USE_SQLITE)
@@ -169,6 +176,91 @@ RunQueryValue(const DBProvider * pdb, const char *query)
     }
 }
 
+struct _DBStatement {
+    DBProvider *pdb;
+    void *stmt;                 /* the provider's statement, if it prepares them */
+    gchar **asz;                /* or the text around the placeholders */
+};
+
+extern int
+DBBegin(const DBProvider * pdb)
+{
+    return pdb->Begin ? pdb->Begin() : TRUE;
+}
+
+extern DBStatement *
+DBPrepare(DBProvider * pdb, const char *sz)
+{
+    DBStatement *pst = g_new0(DBStatement, 1);
+
+    pst->pdb = pdb;
+    if (!pdb->Prepare)
+        pst->asz = g_strsplit(sz, "?", -1);
+    else if ((pst->stmt = pdb->Prepare(sz)) == NULL) {
+        g_free(pst);
+        return NULL;
+    }
+    return pst;
+}
+
+static void
+AppendValue(GString * str, const DBValue * pv)
+{
+    char tmpf[G_ASCII_DTOSTR_BUF_SIZE];
+    const char *pch;
+
+    switch (pv->type) {
+    case DB_INT:
+        g_string_append_printf(str, "%d", pv->v.n);
+        break;
+    case DB_FLOAT:
+        g_string_append(str, g_ascii_dtostr(tmpf, G_ASCII_DTOSTR_BUF_SIZE, pv->v.r));
+        break;
+    case DB_TEXT:
+        g_string_append_c(str, '\'');
+        for (pch = pv->v.sz; *pch; pch++) {
+            if (*pch == '\'')
+                g_string_append_c(str, '\'');
+            g_string_append_c(str, *pch);
+        }
+        g_string_append_c(str, '\'');
+        break;
+    default:
+        g_string_append(str, "NULL");
+        break;
+    }
+}
+
+extern int
+DBExecute(DBStatement * pst, const DBValue * av, int c)
+{
+    GString *str;
+    int i, ret;
+
+    if (pst->stmt)
+        return pst->pdb->Execute(pst->stmt, av, c);
+
+    /* no prepared statements; substitute the values in the text */
+    str = g_string_new(pst->asz[0]);
+    for (i = 1; pst->asz[i]; i++) {
+        g_assert(i <= c);
+        AppendValue(str, av + i - 1);
+        g_string_append(str, pst->asz[i]);
+    }
+    ret = pst->pdb->UpdateCommand(str->str);
+    g_string_free(str, TRUE);
+    return ret;
+}
+
+extern void
+DBFinalize(DBStatement * pst)
+{
+    if (pst->stmt)
+        pst->pdb->Finalize(pst->stmt);
+    g_strfreev(pst->asz);
+    g_free(pst);
+}
+
 extern RowSet *
 RunQuery(const char *sz)
 {
@@ -239,6 +331,7 @@ RelationalSaveSettings(FILE * pf)
 {
     int i;
     fprintf(pf, "relational setup storegamestats=%s\n", storeGameStats ? "yes" : "no");
+    fprintf(pf, "relational setup storepositions=%s\n", storePositions ? "yes" : "no");
 
     if (dbProviderType != INVALID_PROVIDER)
         fprintf(pf, "relational setup dbtype=%s\n", providers[dbProviderType].shortname);
@@ -658,6 +751,65 @@ SQLiteUpdateCommand(const char *str)
 static void
 SQLiteCommit(void)
 {                               /* No transaction in sqlite by default */
+    if (!sqlite3_get_autocommit(connection))
+        SQLiteUpdateCommand("COMMIT TRANSACTION");
+}
+
+static int
+SQLiteBegin(void)
+{
+    return SQLiteUpdateCommand("BEGIN TRANSACTION");
+}
+
+static void *
+SQLitePrepare(const char *str)
+{
+    sqlite3_stmt *pStmt;
+
+    if (sqlite3_prepare_v2(connection, str, -1, &pStmt, NULL) != SQLITE_OK) {
+        outputerrf("SQL error: %s\nfrom '%s'", sqlite3_errmsg(connection), str);
+        return NULL;
+    }
+    return pStmt;
+}
+
+static int
+SQLiteExecute(void *stmt, const DBValue * av, int c)
+{
+    sqlite3_stmt *pStmt = stmt;
+    int i, ret = SQLITE_OK;
+
+    /* the values are only needed until the statement has been stepped */
+    for (i = 0; i < c && ret == SQLITE_OK; i++) {
+        switch (av[i].type) {
+        case DB_INT:
+            ret = sqlite3_bind_int(pStmt, i + 1, av[i].v.n);
+            break;
+        case DB_FLOAT:
+            ret = sqlite3_bind_double(pStmt, i + 1, av[i].v.r);
+            break;
+        case DB_TEXT:
+            ret = sqlite3_bind_text(pStmt, i + 1, av[i].v.sz, -1, SQLITE_STATIC);
+            break;
+        default:
+            ret = sqlite3_bind_null(pStmt, i + 1);
+            break;
+        }
+    }
+
+    if (ret == SQLITE_OK && (ret = sqlite3_step(pStmt)) == SQLITE_DONE)
+        ret = SQLITE_OK;
+    if (ret != SQLITE_OK)
+        outputerrf("SQL error: %s\nfrom '%s'", sqlite3_errmsg(connection), sqlite3_sql(pStmt));
+
+    sqlite3_reset(pStmt);
+    return (ret == SQLITE_OK);
+}
+
+static void
+SQLiteFinalize(void *stmt)
+{
+    sqlite3_finalize(stmt);
 }
 #endif
 
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <glib.h>
 extern int storeGameStats;
+extern int storePositions;
 
 typedef struct _RowSet {
     size_t cols, rows;
@@ -28,6 +29,22 @@ typedef struct _RowSet {
     size_t *widths;
 } RowSet;
 
+/* A value for a placeholder ('?') of a prepared statement */
+typedef enum _DBValueType {
+    DB_NULL, DB_INT, DB_FLOAT, DB_TEXT
+} DBValueType;
+
+typedef struct _DBValue {
+    DBValueType type;
+    union {
+        int n;
+        double r;
+        const char *sz;
+    } v;
+} DBValue;
+
+typedef struct _DBStatement DBStatement;
+
 typedef struct _DBProvider {
     int (*Connect) (const char *database, const char *user, const char *password, const char *hostname);
     void (*Disconnect) (void);
@@ -36,6 +53,12 @@ typedef struct _DBProvider {
     void (*Commit) (void);
     GList *(*GetDatabaseList) (const char *user, const char *password, const char *hostname);
     int (*DeleteDatabase) (const char *database, const char *user, const char *password, const char *hostname);
+    /* optional; without them DBPrepare() and friends format the
+     * statements as text and DBBegin() does nothing */
+    int (*Begin) (void);
+    void *(*Prepare) (const char *str);
+    int (*Execute) (void *stmt, const DBValue * av, int c);
+    void (*Finalize) (void *stmt);
 
     const char *name;
     const char *shortname;
@@ -84,4 +107,12 @@ const char *GetProviderName(int i);
 extern RowSet *RunQuery(const char *sz);
 extern int RunQueryValue(const DBProvider * pdb, const char *query);
 extern void FreeRowset(RowSet * pRow);
+
+/* Start a transaction, ended by pdb->Commit() */
+extern int DBBegin(const DBProvider * pdb);
+/* Prepare a statement with '?' placeholders (and no other '?') to be
+ * executed any number of times with different values */
+extern DBStatement *DBPrepare(DBProvider * pdb, const char *sz);
+extern int DBExecute(DBStatement * pst, const DBValue * av, int c);
+extern void DBFinalize(DBStatement * pst);
 #endif
@@ -58,6 +58,7 @@ const char *aszRNG[NUM_RNGS] = {
     "ISAAC",
     "MD5",
     N_("Mersenne Twister"),
+    "Philox",
     N_("manual dice"),
     "www.random.org",
     N_("read from file")
@@ -68,11 +69,17 @@ const char *aszRNGTip[NUM_RNGS] = {
     N_("Bob Jenkins' Indirection, Shift, Accumulate, Add and Count " "cryptographic generator"),
     N_("A generator based on the Message Digest 5 algorithm"),
     N_("Makoto Matsumoto and Takuji Nishimura's generator"),
+    N_("Salmon, Moraes, Dror and Shaw's counter based generator " "(Philox4x32-10)"),
     N_("Enter each dice roll by hand"),
     N_("The online non-deterministic generator from random.org"),
     N_("Dice loaded from a file"),
 };
 
+/* number of Philox rolls generated at a time */
+#if !defined(PHILOX_LANES)
+#define PHILOX_LANES 8
+#endif
+
 rng rngCurrent = RNG_MERSENNE;
 rngcontext *rngctxCurrent = NULL;
 
@@ -92,6 +99,11 @@ struct _rngcontext {
     int mti;
     unsigned long mt[MT_ARRAY_N];
 
+    /* RNG_PHILOX */
+    guint32 anPhiloxKey[2];
+    guint64 iPhiloxBlock;       /* first roll in aanPhilox, or G_MAXUINT64 */
+    unsigned int aanPhilox[PHILOX_LANES][2];
+
     /* RNG_BBS */
 
 #if defined(HAVE_LIBGMP)
@@ -113,6 +125,104 @@ struct _rngcontext {
 static unsigned int
  ReadDiceFile(rngcontext * rngctx);
 
+/*
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+ * 1, 2, 3", SC11).  Roll number i of a stream is a function of the key
+ * and i only, so seeding is free and any roll can be reached directly.
+ * PhiloxBlock() computes PHILOX_LANES consecutive rolls with the lanes
+ * in separate array elements, which the compiler can vectorise.
+ */
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+static void
+Philox4x32(guint32 ax[4], const guint32 anKey[2])
+{
+    guint32 k0 = anKey[0], k1 = anKey[1];
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        guint64 p0 = (guint64) PHILOX_M0 * ax[0];
+        guint64 p1 = (guint64) PHILOX_M1 * ax[2];
+        guint32 x1 = ax[1], x3 = ax[3];
+
+        ax[0] = (guint32) (p1 >> 32) ^ x1 ^ k0;
+        ax[1] = (guint32) p1;
+        ax[2] = (guint32) (p0 >> 32) ^ x3 ^ k1;
+        ax[3] = (guint32) p0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+static void
+PhiloxBlock(unsigned int aanDice[PHILOX_LANES][2], const guint32 anKey[2], guint64 iFirst)
+{
+    const guint32 exp232_q = 715827882;
+    const guint32 exp232_l = 4294967292U;
+    guint32 aax[4][PHILOX_LANES];
+    guint32 k0 = anKey[0], k1 = anKey[1];
+    int i, l;
+
+    for (l = 0; l < PHILOX_LANES; l++) {
+        aax[0][l] = (guint32) (iFirst + l);
+        aax[1][l] = (guint32) ((iFirst + l) >> 32);
+        aax[2][l] = aax[3][l] = 0;
+    }
+
+    for (i = 0; i < 10; i++) {
+        for (l = 0; l < PHILOX_LANES; l++) {
+            guint64 p0 = (guint64) PHILOX_M0 * aax[0][l];
+            guint64 p1 = (guint64) PHILOX_M1 * aax[2][l];
+            guint32 x1 = aax[1][l], x3 = aax[3][l];
+
+            aax[0][l] = (guint32) (p1 >> 32) ^ x1 ^ k0;
+            aax[1][l] = (guint32) p1;
+            aax[2][l] = (guint32) (p0 >> 32) ^ x3 ^ k1;
+            aax[3][l] = (guint32) p0;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (l = 0; l < PHILOX_LANES; l++) {
+        /* words 0 and 1 are the dice, 2 and 3 replace rejected ones */
+        guint32 n0 = aax[0][l], n1 = aax[1][l];
+
+        if (n0 >= exp232_l) {
+            n0 = aax[2][l];
+            aax[2][l] = aax[3][l];
+        }
+        if (n1 >= exp232_l)
+            n1 = aax[2][l];
+
+        if (n0 >= exp232_l || n1 >= exp232_l) {
+            /* about one roll in 2^60; draw again with the fourth
+             * counter word set */
+            guint32 ay[4], nAttempt = 0;
+
+            while (n0 >= exp232_l || n1 >= exp232_l) {
+                ay[0] = (guint32) (iFirst + l);
+                ay[1] = (guint32) ((iFirst + l) >> 32);
+                ay[2] = 0;
+                ay[3] = ++nAttempt;
+                Philox4x32(ay, anKey);
+                if (n0 >= exp232_l)
+                    n0 = ay[0];
+                if (n1 >= exp232_l)
+                    n1 = ay[1];
+            }
+        }
+
+        aanDice[l][0] = 1 + n0 / exp232_q;
+        aanDice[l][1] = 1 + n1 / exp232_q;
+    }
+}
+
 
 #if defined(HAVE_LIBGMP)
 
@@ -350,6 +460,7 @@ PrintRNGCounter(const rng rngx, rngcontext * rngctx)
     case RNG_BBS:
     case RNG_ISAAC:
     case RNG_MD5:
+    case RNG_PHILOX:
         g_print(_("Number of calls since last seed: %lu."), rngctx->c);
         g_print("\n");
 
@@ -438,6 +549,7 @@ PrintRNGSeed(const rng rngx, rngcontext * rngctx)
 
     case RNG_ISAAC:
     case RNG_MERSENNE:
+    case RNG_PHILOX:
 #if defined(HAVE_LIBGMP)
         PrintRNGSeedMP(rngctx->nz);
 #else
@@ -490,6 +602,12 @@ InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx)
         init_genrand((unsigned long) n, &rngctx->mti, rngctx->mt);
         break;
 
+    case RNG_PHILOX:
+        rngctx->anPhiloxKey[0] = n;
+        rngctx->anPhiloxKey[1] = 0;
+        rngctx->iPhiloxBlock = G_MAXUINT64;
+        break;
+
     case RNG_MANUAL:
     case RNG_RANDOM_DOT_ORG:
     case RNG_FILE:
@@ -502,6 +620,22 @@ InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx)
     }
 }
 
+/*
+ * Seed the generator for stream nStream (e.g., a rollout trial) of
+ * seed n.  Philox takes (n, nStream) as its key, which costs nothing
+ * and gives every stream its own sequence; the other generators are
+ * seeded with n + (nStream << 8) as before.
+ */
+extern void
+InitRNGSeedStream(unsigned int n, unsigned int nStream, const rng rngx, rngcontext * rngctx)
+{
+    if (rngx == RNG_PHILOX) {
+        InitRNGSeed(n, rngx, rngctx);
+        rngctx->anPhiloxKey[1] = nStream;
+    } else
+        InitRNGSeed(n + (nStream << 8), rngx, rngctx);
+}
+
 #if defined(HAVE_LIBGMP)
 static void
 InitRNGSeedMP(mpz_t n, rng rng, rngcontext * rngctx)
@@ -539,6 +673,19 @@ InitRNGSeedMP(mpz_t n, rng rng, rngcontext * rngctx)
         InitRNGSeed((unsigned int) (mpz_get_ui(n) % UINT_MAX), rng, rngctx);
         break;
 
+    case RNG_PHILOX:{
+            guint32 *achState;
+            size_t cb;
+
+            /* the key is the low 64 bits of the seed */
+            achState = mpz_export(NULL, &cb, -1, sizeof(guint32), 0, 0, n);
+            InitRNGSeed(cb > 0 ? achState[0] : 0, rng, rngctx);
+            rngctx->anPhiloxKey[1] = cb > 1 ? achState[1] : 0;
+
+            free(achState);
+            break;
+        }
+
     case RNG_BBS:
         g_assert(rngctx->fZInit);
         mpz_set(rngctx->zSeed, n);
@@ -724,6 +871,9 @@ InitRNG(unsigned long *pnSeed, int *pfInitFrom, const int fSet, const rng rngx)
     /* Mersenne-Twister */
     rngctx->mti = MT_ARRAY_N + 1;
 
+    /* Philox */
+    rngctx->iPhiloxBlock = G_MAXUINT64;
+
 #if defined(HAVE_LIBGMP)
     /* BBS */
     rngctx->fZInit = FALSE;
@@ -809,6 +959,19 @@ RollDice(unsigned int anDice[2], rng * prng, rngcontext * rngctx)
         rngctx->c += 2;
         break;
 
+    case RNG_PHILOX:{
+            guint64 iRoll = rngctx->c / 2;
+
+            if (iRoll - rngctx->iPhiloxBlock >= PHILOX_LANES) {
+                rngctx->iPhiloxBlock = iRoll - iRoll % PHILOX_LANES;
+                PhiloxBlock(rngctx->aanPhilox, rngctx->anPhiloxKey, rngctx->iPhiloxBlock);
+            }
+            anDice[0] = rngctx->aanPhilox[iRoll - rngctx->iPhiloxBlock][0];
+            anDice[1] = rngctx->aanPhilox[iRoll - rngctx->iPhiloxBlock][1];
+            rngctx->c += 2;
+            break;
+        }
+
     case RNG_RANDOM_DOT_ORG:
 #if defined(LIBCURL_PROTOCOL_HTTPS)
         anDice[0] = getDiceRandomDotOrg();
@@ -25,7 +25,7 @@
 #include <stdio.h>
 
 typedef enum _rng {
-    RNG_BBS, RNG_ISAAC, RNG_MD5, RNG_MERSENNE,
+    RNG_BBS, RNG_ISAAC, RNG_MD5, RNG_MERSENNE, RNG_PHILOX,
     RNG_MANUAL, RNG_RANDOM_DOT_ORG, RNG_FILE,
     NUM_RNGS
 } rng;
@@ -47,6 +47,7 @@ extern void DestroyRNG(const rng rngx, rngcontext ** rngctx);
 extern void PrintRNGSeed(const rng rngx, rngcontext * rngctx);
 extern void PrintRNGCounter(const rng rngx, rngcontext * rngctx);
 extern void InitRNGSeed(unsigned int n, const rng rngx, rngcontext * rngctx);
+extern void InitRNGSeedStream(unsigned int n, unsigned int nStream, const rng rngx, rngcontext * rngctx);
 extern int RNGSystemSeed(const rng rngx, void *p, unsigned long *pnSeed);
 
 extern int RollDice(unsigned int anDice[2], rng * prng, rngcontext * rngctx);
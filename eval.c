@@ -198,22 +198,47 @@ enum {
 #define NUM_PRUNING_INPUTS (25 * MINPPERPOINT * 2)
 
 
+/* The copies of the nets and the cache of the calling thread's NUMA
+ * node, if it has been placed on one (see MT_SetNUMA()) */
+static inline evalnode *
+ThreadNode(void)
+{
+#if defined(USE_MULTITHREAD)
+    size_t *p;
+
+    if (!td.tlsItem || !(p = (size_t *) g_private_get(td.tlsItem)))
+        return NULL;
+
+    return ((ThreadLocalData *) * p)->pen;
+#else
+    return td.tld ? td.tld->pen : NULL;
+#endif
+}
+
+#define NODE_NET(pen, nn) ((pen) ? &(pen)->nn : &nn)
+#define NODE_CACHE(pen) ((pen) && (pen)->fCache ? &(pen)->cEval : &cEval)
+
 #if !defined(LOCKING_VERSION)
 
 f_FindnSaveBestMoves FindnSaveBestMoves = FindnSaveBestMovesNoLocking;
+f_FindnSaveBestMovesScratch FindnSaveBestMovesScratch = FindnSaveBestMovesScratchNoLocking;
 f_FindBestMove FindBestMove = FindBestMoveNoLocking;
 f_EvaluatePosition EvaluatePosition = EvaluatePositionNoLocking;
 f_ScoreMove ScoreMove = ScoreMoveNoLocking;
 f_GeneralCubeDecisionE GeneralCubeDecisionE = GeneralCubeDecisionENoLocking;
 f_GeneralEvaluationE GeneralEvaluationE = GeneralEvaluationENoLocking;
+f_EvaluateRollsVarRedn EvaluateRollsVarRedn = EvaluateRollsVarRednNoLocking;
 
 #define FindnSaveBestMoves FindnSaveBestMovesNoLocking
+#define FindnSaveBestMovesScratch FindnSaveBestMovesScratchNoLocking
 #define FindBestMove FindBestMoveNoLocking
 #define EvaluatePosition EvaluatePositionNoLocking
 #define ScoreMove ScoreMoveNoLocking
 #define GeneralCubeDecisionE GeneralCubeDecisionENoLocking
 #define GeneralEvaluationE GeneralEvaluationENoLocking
+#define EvaluateRollsVarRedn EvaluateRollsVarRednNoLocking
 #define EvaluatePositionCache EvaluatePositionCacheNoLocking
+#define EvaluatePositionsLeaf EvaluatePositionsLeafNoLocking
 #define FindBestMovePlied FindBestMovePliedNoLocking
 #define GeneralEvaluationEPlied GeneralEvaluationEPliedNoLocking
 #define EvaluatePositionCubeful3 EvaluatePositionCubeful3NoLocking
@@ -2115,13 +2140,16 @@ static int
 EvalRace(const TanBoard anBoard, float arOutput[], const bgvariation bgv, NNState * nnStates)
 {
     SSE_ALIGN(float arInput[NUM_RACE_INPUTS]);
+    evalnode *pen = ThreadNode();
 
     CalculateRaceInputs(anBoard, arInput);
 
 #if defined(USE_SIMD_INSTRUCTIONS)
-    if (NeuralNetEvaluateSSE(&nnRace, arInput, arOutput, nnStates ? nnStates + (CLASS_RACE - CLASS_RACE) : NULL))
+    if (NeuralNetEvaluateSSE(NODE_NET(pen, nnRace), arInput, arOutput,
+                             nnStates ? nnStates + (CLASS_RACE - CLASS_RACE) : NULL))
 #else
-    if (NeuralNetEvaluate(&nnRace, arInput, arOutput, nnStates ? nnStates + (CLASS_RACE - CLASS_RACE) : NULL))
+    if (NeuralNetEvaluate(NODE_NET(pen, nnRace), arInput, arOutput,
+                          nnStates ? nnStates + (CLASS_RACE - CLASS_RACE) : NULL))
 #endif
         return -1;
 
@@ -2139,13 +2167,16 @@ EvalContact(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(b
 {
     SSE_ALIGN(float arInput[NUM_INPUTS]);
 
+    evalnode *pen = ThreadNode();
+
     CalculateContactInputs(anBoard, arInput);
 
 #if defined(USE_SIMD_INSTRUCTIONS)
-    return NeuralNetEvaluateSSE(&nnContact, arInput, arOutput,
+    return NeuralNetEvaluateSSE(NODE_NET(pen, nnContact), arInput, arOutput,
                                 nnStates ? nnStates + (CLASS_CONTACT - CLASS_RACE) : NULL);
 #else
-    return NeuralNetEvaluate(&nnContact, arInput, arOutput, nnStates ? nnStates + (CLASS_CONTACT - CLASS_RACE) : NULL);
+    return NeuralNetEvaluate(NODE_NET(pen, nnContact), arInput, arOutput,
+                             nnStates ? nnStates + (CLASS_CONTACT - CLASS_RACE) : NULL);
 #endif
 }
 
@@ -2154,13 +2185,16 @@ EvalCrashed(const TanBoard anBoard, float arOutput[], const bgvariation UNUSED(b
 {
     SSE_ALIGN(float arInput[NUM_INPUTS]);
 
+    evalnode *pen = ThreadNode();
+
     CalculateCrashedInputs(anBoard, arInput);
 
 #if defined(USE_SIMD_INSTRUCTIONS)
-    return NeuralNetEvaluateSSE(&nnCrashed, arInput, arOutput,
+    return NeuralNetEvaluateSSE(NODE_NET(pen, nnCrashed), arInput, arOutput,
                                 nnStates ? nnStates + (CLASS_CRASHED - CLASS_RACE) : NULL);
 #else
-    return NeuralNetEvaluate(&nnCrashed, arInput, arOutput, nnStates ? nnStates + (CLASS_CRASHED - CLASS_RACE) : NULL);
+    return NeuralNetEvaluate(NODE_NET(pen, nnCrashed), arInput, arOutput,
+                             nnStates ? nnStates + (CLASS_CRASHED - CLASS_RACE) : NULL);
 #endif
 }
 
@@ -2825,6 +2859,50 @@ CompareMoves(const move * pm0, const move * pm1)
     return (pm1->rScore > pm0->rScore || (pm1->rScore == pm0->rScore && pm1->rScore2 > pm0->rScore2)) ? 1 : -1;
 }
 
+/*
+ * Rearrange am[0..c) so that the k best moves, in the CompareMoves()
+ * order, come first and sorted; the others follow in no particular
+ * order.  This is nth_element() followed by a sort of the front part,
+ * so the moves a move filter is about to drop are not sorted with the
+ * ones it keeps.
+ */
+static void
+SelectBestMoves(move * am, unsigned int c, unsigned int k)
+{
+    unsigned int lo = 0, hi = c;
+    move m;
+
+    while (k < hi && hi - lo > 1) {
+        unsigned int i, j = lo;
+
+        /* partition around the middle element, moved to the end */
+        m = am[lo + (hi - lo) / 2];
+        am[lo + (hi - lo) / 2] = am[hi - 1];
+        am[hi - 1] = m;
+
+        for (i = lo; i < hi - 1; i++)
+            if (CompareMoves(&am[hi - 1], &am[i]) > 0) {
+                m = am[i];
+                am[i] = am[j];
+                am[j++] = m;
+            }
+
+        m = am[j];
+        am[j] = am[hi - 1];
+        am[hi - 1] = m;
+
+        /* am[lo..j) are better than am[j], am(j..hi) are not */
+        if (k <= j)
+            hi = j;
+        else if (k > j + 1)
+            lo = j + 1;
+        else
+            break;
+    }
+
+    qsort(am, MIN(k, c), sizeof(move), (cfunc) CompareMoves);
+}
+
 static int
 CompareMovesGeneral(const move * pm0, const move * pm1)
 {
@@ -3179,10 +3257,58 @@ GetCubeRecommendation(const cubedecision cd)
 }
 
 
+static GSList *plNodes;         /* the evalnodes in use */
+
+extern evalnode *
+EvalNodeNew(unsigned int cShards)
+{
+    evalnode *pen = g_new0(evalnode, 1);
+
+    if (NeuralNetCopy(&pen->nnContact, &nnContact) || NeuralNetCopy(&pen->nnRace, &nnRace) ||
+        NeuralNetCopy(&pen->nnCrashed, &nnCrashed) || NeuralNetCopy(&pen->nnpContact, &nnpContact) ||
+        NeuralNetCopy(&pen->nnpRace, &nnpRace) || NeuralNetCopy(&pen->nnpCrashed, &nnpCrashed)) {
+        EvalNodeFree(pen);
+        return NULL;
+    }
+
+    /* the global cache is split between the nodes */
+    pen->cShards = cShards;
+    if (cShards && cCache)
+        pen->fCache = !CacheCreate(&pen->cEval, MAX(cCache / cShards, 2));
+
+    plNodes = g_slist_prepend(plNodes, pen);
+
+    return pen;
+}
+
+extern void
+EvalNodeFree(evalnode * pen)
+{
+    plNodes = g_slist_remove(plNodes, pen);
+
+    NeuralNetDestroy(&pen->nnContact);
+    NeuralNetDestroy(&pen->nnRace);
+    NeuralNetDestroy(&pen->nnCrashed);
+    NeuralNetDestroy(&pen->nnpContact);
+    NeuralNetDestroy(&pen->nnpRace);
+    NeuralNetDestroy(&pen->nnpCrashed);
+
+    if (pen->fCache)
+        CacheDestroy(&pen->cEval);
+
+    g_free(pen);
+}
+
 extern void
 EvalCacheFlush(void)
 {
+    GSList *pl;
+
     CacheFlush(&cEval);
+
+    for (pl = plNodes; pl; pl = pl->next)
+        if (((evalnode *) pl->data)->fCache)
+            CacheFlush(&((evalnode *) pl->data)->cEval);
 }
 
 void
@@ -3233,7 +3359,18 @@ GetCacheMB(int size)
 extern int
 EvalCacheResize(unsigned int cNew)
 {
+    GSList *pl;
+
     cCache = CacheResize(&cEval, cNew);
+
+    for (pl = plNodes; pl; pl = pl->next) {
+        evalnode *pen = pl->data;
+
+        /* a cache of 0 turns caching off altogether */
+        if (pen->cShards && cCache)
+            pen->fCache = CacheResize(&pen->cEval, MAX(cCache / pen->cShards, 2)) > 0;
+    }
+
     return cCache;
 }
 
@@ -3289,26 +3426,13 @@ SetCubeInfoMatch(cubeinfo * pci, const int nCube, const int fCubeOwner,
     pci->fCrawford = fCrawford;
     pci->bgv = bgv;
 
-    /*
-     * FIXME: calculate gammon price when initializing program
-     * instead of recalculating it again and again, or cache it.
-     */
-
     {
 
         int nAway0 = pci->nMatchTo - pci->anScore[0] - 1;
         int nAway1 = pci->nMatchTo - pci->anScore[1] - 1;
 
-        if ((!nAway0 || !nAway1) && !fCrawford) {
-            if (!nAway0)
-                memcpy(pci->arGammonPrice, aaaafGammonPricesPostCrawford[LogCube(pci->nCube)]
-                       [nAway1][0], 4 * sizeof(float));
-            else
-                memcpy(pci->arGammonPrice, aaaafGammonPricesPostCrawford[LogCube(pci->nCube)]
-                       [nAway0][1], 4 * sizeof(float));
-        } else
-            memcpy(pci->arGammonPrice, aaaafGammonPrices[LogCube(pci->nCube)]
-                   [nAway0][nAway1], 4 * sizeof(float));
+        getGammonPrices(pci->arGammonPrice, pci->nMatchTo, nAway0, nAway1, LogCube(pci->nCube),
+                        (!nAway0 || !nAway1) && !fCrawford);
 
     }
 
@@ -3708,7 +3832,9 @@ Cl2CfMatchCentered(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     float rMWCDead, rMWCLive, rMWCWin, rMWCLose;
     float rMWCOppCash, rMWCCash, rOppTG, rTG;
-    float aarMETResult[2][DTLBP1 + 1];
+    float arG[2], arBG[2];
+    const cubefulcoefs *pcc = getCubefulCoefs(pci);
+    const float *arMET = pcc->aarMET[pci->fMove];
 
     /* Centered cube */
 
@@ -3732,18 +3858,20 @@ Cl2CfMatchCentered(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     /* MWC(dead cube) = cubeless equity */
 
-    rMWCDead = eq2mwc(Utility(arOutput, pci), pci);
+    rMWCDead = 0.5f * (Utility(arOutput, pci) * (arMET[NDW] - arMET[NDL]) + (arMET[NDW] + arMET[NDL]));
 
     /* Get live cube cash points */
 
-    GetPoints(arOutput, pci, arCP);
+    arG[pci->fMove] = rG0;
+    arBG[pci->fMove] = rBG0;
+    arG[!pci->fMove] = rG1;
+    arBG[!pci->fMove] = rBG1;
 
-    getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo,
-                  pci->nCube, -1, -1, pci->fCrawford, aafMET, aafMETPostCrawford, aarMETResult[0], aarMETResult[1]);
+    GetPointsFromCoefs(pcc, arG, arBG, arCP);
 
-    rMWCCash = aarMETResult[pci->fMove][NDW];
+    rMWCCash = arMET[NDW];
 
-    rMWCOppCash = aarMETResult[pci->fMove][NDL];
+    rMWCOppCash = arMET[NDL];
 
     rOppTG = 1.0f - arCP[!pci->fMove];
     rTG = arCP[pci->fMove];
@@ -3752,9 +3880,9 @@ Cl2CfMatchCentered(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
         /* Opp too good to double */
 
-        rMWCLose = (1.0f - rG1 - rBG1) * aarMETResult[pci->fMove][NDL]
-            + rG1 * aarMETResult[pci->fMove][NDLG]
-            + rBG1 * aarMETResult[pci->fMove][NDLB];
+        rMWCLose = (1.0f - rG1 - rBG1) * arMET[NDL]
+            + rG1 * arMET[NDLG]
+            + rBG1 * arMET[NDLB];
 
         if (rOppTG > 0.0f)
             /* avoid division by zero */
@@ -3785,9 +3913,9 @@ Cl2CfMatchCentered(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
          * 
          */
 
-        rMWCWin = (1.0f - rG0 - rBG0) * aarMETResult[pci->fMove][NDW]
-            + rG0 * aarMETResult[pci->fMove][NDWG]
-            + rBG0 * aarMETResult[pci->fMove][NDWB];
+        rMWCWin = (1.0f - rG0 - rBG0) * arMET[NDW]
+            + rG0 * arMET[NDWG]
+            + rBG0 * arMET[NDWB];
 
         if (rTG < 1.0f)
             rMWCLive = rMWCCash + (rMWCWin - rMWCCash) * (arOutput[OUTPUT_WIN] - rTG) / (1.0f - rTG);
@@ -3813,7 +3941,9 @@ Cl2CfMatchOwned(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     float rMWCDead, rMWCLive, rMWCWin, rMWCLose;
     float rMWCCash, rTG;
-    float aarMETResult[2][DTLBP1 + 1];
+    float arG[2], arBG[2];
+    const cubefulcoefs *pcc = getCubefulCoefs(pci);
+    const float *arMET = pcc->aarMET[pci->fMove];
 
     /* I own cube */
 
@@ -3837,16 +3967,18 @@ Cl2CfMatchOwned(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     /* MWC(dead cube) = cubeless equity */
 
-    rMWCDead = eq2mwc(Utility(arOutput, pci), pci);
+    rMWCDead = 0.5f * (Utility(arOutput, pci) * (arMET[NDW] - arMET[NDL]) + (arMET[NDW] + arMET[NDL]));
 
     /* Get live cube cash points */
 
-    GetPoints(arOutput, pci, arCP);
+    arG[pci->fMove] = rG0;
+    arBG[pci->fMove] = rBG0;
+    arG[!pci->fMove] = rG1;
+    arBG[!pci->fMove] = rBG1;
 
-    getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo,
-                  pci->nCube, -1, -1, pci->fCrawford, aafMET, aafMETPostCrawford, aarMETResult[0], aarMETResult[1]);
+    GetPointsFromCoefs(pcc, arG, arBG, arCP);
 
-    rMWCCash = aarMETResult[pci->fMove][NDW];
+    rMWCCash = arMET[NDW];
 
     rTG = arCP[pci->fMove];
 
@@ -3860,9 +3992,9 @@ Cl2CfMatchOwned(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
          * 
          */
 
-        rMWCLose = (1.0f - rG1 - rBG1) * aarMETResult[pci->fMove][NDL]
-            + rG1 * aarMETResult[pci->fMove][NDLG]
-            + rBG1 * aarMETResult[pci->fMove][NDLB];
+        rMWCLose = (1.0f - rG1 - rBG1) * arMET[NDL]
+            + rG1 * arMET[NDLG]
+            + rBG1 * arMET[NDLB];
 
         if (rTG > 0.0f)
             rMWCLive = rMWCLose + (rMWCCash - rMWCLose) * arOutput[OUTPUT_WIN] / rTG;
@@ -3885,9 +4017,9 @@ Cl2CfMatchOwned(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
          * 
          */
 
-        rMWCWin = (1.0f - rG0 - rBG0) * aarMETResult[pci->fMove][NDW]
-            + rG0 * aarMETResult[pci->fMove][NDWG]
-            + rBG0 * aarMETResult[pci->fMove][NDWB];
+        rMWCWin = (1.0f - rG0 - rBG0) * arMET[NDW]
+            + rG0 * arMET[NDWG]
+            + rBG0 * arMET[NDWB];
 
         if (rTG < 1.0f)
             rMWCLive = rMWCCash + (rMWCWin - rMWCCash) * (arOutput[OUTPUT_WIN] - rTG) / (1.0f - rTG);
@@ -3914,7 +4046,9 @@ Cl2CfMatchUnavailable(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     float rMWCDead, rMWCLive, rMWCWin, rMWCLose;
     float rMWCOppCash, rOppTG;
-    float aarMETResult[2][DTLBP1 + 1];
+    float arG[2], arBG[2];
+    const cubefulcoefs *pcc = getCubefulCoefs(pci);
+    const float *arMET = pcc->aarMET[pci->fMove];
 
     /* I own cube */
 
@@ -3938,16 +4072,18 @@ Cl2CfMatchUnavailable(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
 
     /* MWC(dead cube) = cubeless equity */
 
-    rMWCDead = eq2mwc(Utility(arOutput, pci), pci);
+    rMWCDead = 0.5f * (Utility(arOutput, pci) * (arMET[NDW] - arMET[NDL]) + (arMET[NDW] + arMET[NDL]));
 
     /* Get live cube cash points */
 
-    GetPoints(arOutput, pci, arCP);
+    arG[pci->fMove] = rG0;
+    arBG[pci->fMove] = rBG0;
+    arG[!pci->fMove] = rG1;
+    arBG[!pci->fMove] = rBG1;
 
-    getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo,
-                  pci->nCube, -1, -1, pci->fCrawford, aafMET, aafMETPostCrawford, aarMETResult[0], aarMETResult[1]);
+    GetPointsFromCoefs(pcc, arG, arBG, arCP);
 
-    rMWCOppCash = aarMETResult[pci->fMove][NDL];
+    rMWCOppCash = arMET[NDL];
 
     rOppTG = 1.0f - arCP[!pci->fMove];
 
@@ -3963,9 +4099,9 @@ Cl2CfMatchUnavailable(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
          * 
          */
 
-        rMWCLose = (1.0f - rG1 - rBG1) * aarMETResult[pci->fMove][NDL]
-            + rG1 * aarMETResult[pci->fMove][NDLG]
-            + rBG1 * aarMETResult[pci->fMove][NDLB];
+        rMWCLose = (1.0f - rG1 - rBG1) * arMET[NDL]
+            + rG1 * arMET[NDLG]
+            + rBG1 * arMET[NDLB];
 
         if (rOppTG > 0.0f)
             /* avoid division by zero */
@@ -3987,9 +4123,9 @@ Cl2CfMatchUnavailable(float arOutput[NUM_OUTPUTS], cubeinfo * pci, float rCubeX)
          * 
          */
 
-        rMWCWin = (1.0f - rG0 - rBG0) * aarMETResult[pci->fMove][NDW]
-            + rG0 * aarMETResult[pci->fMove][NDWG]
-            + rBG0 * aarMETResult[pci->fMove][NDWB];
+        rMWCWin = (1.0f - rG0 - rBG0) * arMET[NDW]
+            + rG0 * arMET[NDWG]
+            + rBG0 * arMET[NDWB];
 
         rMWCLive = rMWCOppCash + (rMWCWin - rMWCOppCash) * (arOutput[OUTPUT_WIN] - rOppTG) / (1.0f - rOppTG);
 
@@ -5260,12 +5396,15 @@ DoubleType(const int fDoubled, const int fMove, const int fTurn)
 #else
 
 #define FindnSaveBestMoves FindnSaveBestMovesWithLocking
+#define FindnSaveBestMovesScratch FindnSaveBestMovesScratchWithLocking
 #define FindBestMove FindBestMoveWithLocking
 #define EvaluatePosition EvaluatePositionWithLocking
 #define ScoreMove ScoreMoveWithLocking
 #define GeneralCubeDecisionE GeneralCubeDecisionEWithLocking
 #define GeneralEvaluationE GeneralEvaluationEWithLocking
+#define EvaluateRollsVarRedn EvaluateRollsVarRednWithLocking
 #define EvaluatePositionCache EvaluatePositionCacheWithLocking
+#define EvaluatePositionsLeaf EvaluatePositionsLeafWithLocking
 #define FindBestMovePlied FindBestMovePliedWithLocking
 #define GeneralEvaluationEPlied GeneralEvaluationEPliedWithLocking
 #define EvaluatePositionCubeful3 EvaluatePositionCubeful3WithLocking
@@ -5367,7 +5506,8 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
         if ((l = CacheLookup(&cpEval, &ec, arOutput, NULL)) != CACHEHIT) {
             baseInputs((ConstTanBoard) anBoardOut, arInput);
             {
-                neuralnet *nets[] = { &nnpRace, &nnpCrashed, &nnpContact };
+                evalnode *pen = ThreadNode();
+                neuralnet *nets[] = { NODE_NET(pen, nnpRace), NODE_NET(pen, nnpCrashed), NODE_NET(pen, nnpContact) };
                 neuralnet *n = nets[pc - CLASS_RACE];
 #if defined(USE_SIMD_INSTRUCTIONS)
                 (void) nnStates;        /* silence compiler warning */
@@ -5418,19 +5558,111 @@ FindBestMoveInEval(NNState * nnStates, int const nDice0, int const nDice1, const
     PositionFromKey(anBoardOut, &ml.amMoves[ml.iMoveBest].key);
 }
 
+/*
+ * Evaluate the cBoards (at most 21) positions in aanBoard at 0-ply,
+ * with the same results as calling EvaluatePositionCache() on each.
+ * Positions that are not in the cache and need one of the neural nets
+ * are collected per net and evaluated with a single batched call, so
+ * the net weights are streamed through once per node instead of once
+ * per roll.
+ */
+static int
+EvaluatePositionsLeaf(NNState * nnStates, TanBoard aanBoard[], unsigned int cBoards,
+                      float aarOutput[][NUM_OUTPUTS], cubeinfo * const pci, const evalcontext * pec)
+{
+    evalnode *pen = ThreadNode();
+    neuralnet *const apnn[] = { NODE_NET(pen, nnRace), NODE_NET(pen, nnCrashed), NODE_NET(pen, nnContact) };
+    evalCache *pcEval = NODE_CACHE(pen);
+    SSE_ALIGN(float aarInput[21][NUM_INPUTS]);
+    float *aapInput[3][21], *aapOutput[3][21];
+    unsigned int aaiBoard[3][21];
+    unsigned int acBatch[3] = { 0, 0, 0 };
+    evalcache aec[21];
+    uint32_t al[21];
+    unsigned int i, k, n;
+
+    g_assert(cBoards <= 21);
+
+    for (i = 0; i < cBoards; i++) {
+        positionclass pc = ClassifyPosition((ConstTanBoard) aanBoard[i], pci->bgv);
+
+        if (pc < CLASS_RACE || pec->rNoise != 0.0f) {
+            /* bearoff databases and noisy evaluations take the usual route */
+            if (EvaluatePositionCache(nnStates, (ConstTanBoard) aanBoard[i], aarOutput[i], pci, pec, 0, pc))
+                return -1;
+            continue;
+        }
+
+        if (cCache) {
+            PositionKey((ConstTanBoard) aanBoard[i], &aec[i].key);
+            aec[i].nEvalContext = EvalKey(pec, 0, pci, FALSE);
+            if ((al[i] = CacheLookup(pcEval, &aec[i], aarOutput[i], NULL)) == CACHEHIT)
+                continue;
+        }
+
+        switch (pc) {
+        case CLASS_RACE:
+            CalculateRaceInputs((ConstTanBoard) aanBoard[i], aarInput[i]);
+            break;
+        case CLASS_CRASHED:
+            CalculateCrashedInputs((ConstTanBoard) aanBoard[i], aarInput[i]);
+            break;
+        default:
+            CalculateContactInputs((ConstTanBoard) aanBoard[i], aarInput[i]);
+            break;
+        }
+
+        n = pc - CLASS_RACE;
+        aapInput[n][acBatch[n]] = aarInput[i];
+        aapOutput[n][acBatch[n]] = aarOutput[i];
+        aaiBoard[n][acBatch[n]++] = i;
+    }
+
+    for (n = 0; n < 3; n++) {
+        if (!acBatch[n])
+            continue;
+
+#if defined(USE_SIMD_INSTRUCTIONS)
+        if (NeuralNetEvaluateBatchSSE(apnn[n], acBatch[n], aapInput[n], aapOutput[n]))
+#else
+        if (NeuralNetEvaluateBatch(apnn[n], acBatch[n], aapInput[n], aapOutput[n]))
+#endif
+            return -1;
+
+        for (k = 0; k < acBatch[n]; k++) {
+            i = aaiBoard[n][k];
+
+            if (n == CLASS_RACE - CLASS_RACE)
+                /* special evaluation of backgammons overrides net output */
+                EvalRaceBG((ConstTanBoard) aanBoard[i], aarOutput[i], pci->bgv);
+
+            SanityCheck((ConstTanBoard) aanBoard[i], aarOutput[i]);
+
+            if (cCache) {
+                memcpy(aec[i].ar, aarOutput[i], sizeof(float) * NUM_OUTPUTS);
+                aec[i].ar[5] = 0.f;
+                CacheAdd(pcEval, &aec[i], al[i]);
+            }
+        }
+    }
+
+    return 0;
+}
+
 static int
 EvaluatePositionFull(NNState * nnStates, const TanBoard anBoard, float arOutput[],
                      cubeinfo * const pci, const evalcontext * pec, unsigned int nPlies, positionclass pc)
 {
     int i, n0, n1;
-    SSE_ALIGN(float arVariationOutput[NUM_OUTPUTS]);
     float rTemp;
-    int w;
 
     if (pc > CLASS_PERFECT && nPlies > 0) {
         /* internal node; recurse */
 
-        TanBoard anBoardNew;
+        TanBoard aanBoardNew[21];
+        SSE_ALIGN(float aarVariationOutput[21][NUM_OUTPUTS]);
+        int aw[21];
+        unsigned int iRoll, cRolls = 0;
         /* int anMove[ 8 ]; */
         cubeinfo ciOpp;
         int const usePrune = pec->fUsePrune && pec->rNoise == 0.0f && pci->bgv == VARIATION_STANDARD;
@@ -5438,15 +5670,17 @@ EvaluatePositionFull(NNState * nnStates, const TanBoard anBoard, float arOutput[
         for (i = 0; i < NUM_OUTPUTS; i++)
             arOutput[i] = 0.0;
 
-        /* loop over rolls */
+        /* find the best move for each roll */
 
         for (n0 = 1; n0 <= 6; n0++) {
             for (n1 = 1; n1 <= n0; n1++) {
-                w = (n0 == n1) ? 1 : 2;
+                TanBoard *panBoardNew = &aanBoardNew[cRolls];
+
+                aw[cRolls++] = (n0 == n1) ? 1 : 2;
 
                 for (i = 0; i < 25; i++) {
-                    anBoardNew[0][i] = anBoard[0][i];
-                    anBoardNew[1][i] = anBoard[1][i];
+                    (*panBoardNew)[0][i] = anBoard[0][i];
+                    (*panBoardNew)[1][i] = anBoard[1][i];
                 }
 
                 if (fInterrupt) {
@@ -5455,28 +5689,35 @@ EvaluatePositionFull(NNState * nnStates, const TanBoard anBoard, float arOutput[
                 }
 
                 if (usePrune) {
-                    FindBestMoveInEval(nnStates, n0, n1, anBoard, anBoardNew, pci, pec);
+                    FindBestMoveInEval(nnStates, n0, n1, anBoard, *panBoardNew, pci, pec);
                 } else {
 
-                    FindBestMovePlied(NULL, n0, n1, anBoardNew, pci, pec, 0, defaultFilters);
+                    FindBestMovePlied(NULL, n0, n1, *panBoardNew, pci, pec, 0, defaultFilters);
                 }
 
-                SwapSides(anBoardNew);
+                SwapSides(*panBoardNew);
+            }
+
+        }
+
+        SetCubeInfo(&ciOpp, pci->nCube, pci->fCubeOwner, !pci->fMove,
+                    pci->nMatchTo, pci->anScore, pci->fCrawford, pci->fJacoby, pci->fBeavers, pci->bgv);
 
-                SetCubeInfo(&ciOpp, pci->nCube, pci->fCubeOwner, !pci->fMove,
-                            pci->nMatchTo, pci->anScore, pci->fCrawford, pci->fJacoby, pci->fBeavers, pci->bgv);
+        /* evaluate the resulting positions; the leaves in one batch */
 
-                /* Evaluate at 0-ply */
-                if (EvaluatePositionCache(nnStates, (ConstTanBoard) anBoardNew, arVariationOutput,
+        if (nPlies == 1) {
+            if (EvaluatePositionsLeaf(nnStates, aanBoardNew, cRolls, aarVariationOutput, &ciOpp, pec))
+                return -1;
+        } else
+            for (iRoll = 0; iRoll < cRolls; iRoll++)
+                if (EvaluatePositionCache(nnStates, (ConstTanBoard) aanBoardNew[iRoll], aarVariationOutput[iRoll],
                                           &ciOpp, pec, nPlies - 1,
-                                          ClassifyPosition((ConstTanBoard) anBoardNew, ciOpp.bgv)))
+                                          ClassifyPosition((ConstTanBoard) aanBoardNew[iRoll], ciOpp.bgv)))
                     return -1;
 
-                for (i = 0; i < NUM_OUTPUTS; i++)
-                    arOutput[i] += w * arVariationOutput[i];
-            }
-
-        }
+        for (iRoll = 0; iRoll < cRolls; iRoll++)
+            for (i = 0; i < NUM_OUTPUTS; i++)
+                arOutput[i] += aw[iRoll] * aarVariationOutput[iRoll][i];
 
         /* normalize */
         for (i = 0; i < NUM_OUTPUTS; i++)
@@ -5522,6 +5763,7 @@ EvaluatePositionCache(NNState * nnStates, const TanBoard anBoard, float arOutput
 {
     evalcache ec;
     uint32_t l;
+    evalCache *pcEval;
     /* This should be a part of the code that is called in all
      * time-consuming operations at a relatively steady rate, so is a
      * good choice for a callback function. */
@@ -5532,7 +5774,8 @@ EvaluatePositionCache(NNState * nnStates, const TanBoard anBoard, float arOutput
     PositionKey(anBoard, &ec.key);
 
     ec.nEvalContext = EvalKey(pecx, nPlies, pci, FALSE);
-    if ((l = CacheLookup(&cEval, &ec, arOutput, NULL)) == CACHEHIT) {
+    pcEval = NODE_CACHE(ThreadNode());
+    if ((l = CacheLookup(pcEval, &ec, arOutput, NULL)) == CACHEHIT) {
         return 0;
     }
 
@@ -5541,7 +5784,7 @@ EvaluatePositionCache(NNState * nnStates, const TanBoard anBoard, float arOutput
 
     memcpy(ec.ar, arOutput, sizeof(float) * NUM_OUTPUTS);
     ec.ar[5] = 0.f;
-    CacheAdd(&cEval, &ec, l);
+    CacheAdd(pcEval, &ec, l);
     return 0;
 }
 
@@ -5678,6 +5921,7 @@ FindBestMovePlied(int anMove[8], int nDice0, int nDice1,
     evalcontext ec;
     movelist ml;
     unsigned int i;
+    size_t iMark = MT_ScratchMark();
 
     memcpy(&ec, pec, sizeof(evalcontext));
     ec.nPlies = nPlies;
@@ -5686,8 +5930,8 @@ FindBestMovePlied(int anMove[8], int nDice0, int nDice1,
         for (i = 0; i < 8; ++i)
             anMove[i] = -1;
 
-    if (FindnSaveBestMoves(&ml, nDice0, nDice1, (ConstTanBoard) anBoard, NULL, 0.0f, pci, &ec, aamf) < 0) {
-        free(ml.amMoves);
+    if (FindnSaveBestMovesScratch(&ml, nDice0, nDice1, (ConstTanBoard) anBoard, NULL, 0.0f, pci, &ec, aamf) < 0) {
+        MT_ScratchRelease(iMark);
         return -1;
     }
 
@@ -5699,7 +5943,7 @@ FindBestMovePlied(int anMove[8], int nDice0, int nDice1,
     if (ml.cMoves)
         PositionFromKey(anBoard, &ml.amMoves[ml.iMoveBest].key);
 
-    free(ml.amMoves);
+    MT_ScratchRelease(iMark);
 
     return ml.cMaxMoves * 2;
 }
@@ -5715,10 +5959,13 @@ FindBestMove(int anMove[8], int nDice0, int nDice1,
     return FindBestMovePlied(anMove, nDice0, nDice1, anBoard, pci, pec ? pec : &ecBasic, pec ? pec->nPlies : 0, aamf);
 }
 
-extern int
-FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard, positionkey * keyMove, const
-                   float rThr, const cubeinfo * pci, const evalcontext * pec,
-                   movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+/* The moves are saved in memory from malloc() or, if fScratch, from
+ * the scratch memory of the thread */
+
+static int
+SaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard, positionkey * keyMove, const
+              float rThr, const cubeinfo * pci, const evalcontext * pec,
+              movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES], int fScratch)
 {
 
     /* Find best moves. 
@@ -5730,6 +5977,8 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
     movefilter *mFilters;
     unsigned int nMaxPly = 0;
     unsigned int cOldMoves;
+    unsigned int aaiDropped[MAX_FILTER_PLIES + 1][2];
+    unsigned int cDropped = 0;
 
     /* Find all moves -- note that pml contains internal pointers to static
      * data, so we can't call GenerateMoves again (or anything that calls
@@ -5744,7 +5993,10 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
     }
 
     /* Save moves */
-    pm = (move *) malloc(pml->cMoves * sizeof(move));
+    if (fScratch)
+        pm = (move *) MT_ScratchAlloc(pml->cMoves * sizeof(move));
+    else
+        pm = (move *) malloc(pml->cMoves * sizeof(move));
     memcpy(pm, pml->amMoves, pml->cMoves * sizeof(move));
     pml->amMoves = pm;
     nMoves = pml->cMoves;
@@ -5762,17 +6014,25 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
             continue;
         }
 
+        if (pml->cMoves > 1 && pml->cMoves <= (unsigned int) mFilter->Accept)
+            /* the filter keeps every candidate and the next ply
+             * rescores them all; don't score them here */
+            continue;
+
         if (ScoreMoves(pml, pci, pec, iPly) < 0) {
-            free(pm);
+            if (!fScratch)
+                free(pm);
             pml->cMoves = 0;
             pml->amMoves = NULL;
             return -1;
         }
 
-        qsort(pml->amMoves, pml->cMoves, sizeof(move), (cfunc) CompareMoves);
+        k = pml->cMoves;
+
+        /* only the moves the filter may keep need to be in order */
+        SelectBestMoves(pml->amMoves, k, (unsigned int) mFilter->Accept + mFilter->Extra);
         pml->iMoveBest = 0;
 
-        k = pml->cMoves;
         /* we check for mFilter->Accept < 0 above */
         pml->cMoves = MIN((unsigned int) mFilter->Accept, pml->cMoves);
 
@@ -5786,6 +6046,12 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
             }
         }
 
+        /* the dropped moves are sorted once we are done */
+        if (pml->cMoves < k) {
+            aaiDropped[cDropped][0] = pml->cMoves;
+            aaiDropped[cDropped++][1] = k;
+        }
+
         nMaxPly = iPly;
 
         if (pml->cMoves == 1 && mFilter->Accept != 1)
@@ -5798,7 +6064,8 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
     /* evaluate moves on top ply */
 
     if (ScoreMoves(pml, pci, pec, pec->nPlies) < 0) {
-        free(pm);
+        if (!fScratch)
+            free(pm);
         pml->cMoves = 0;
         pml->amMoves = NULL;
         return -1;
@@ -5814,6 +6081,9 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
 
   finished:
 
+    for (i = 0; i < cDropped; i++)
+        qsort(pml->amMoves + aaiDropped[i][0], aaiDropped[i][1] - aaiDropped[i][0], sizeof(move), (cfunc) CompareMoves);
+
     cOldMoves = pml->cMoves;
     pml->cMoves = nMoves;
 
@@ -5870,6 +6140,165 @@ FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoar
 
 }
 
+extern int
+FindnSaveBestMoves(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard, positionkey * keyMove, const
+                   float rThr, const cubeinfo * pci, const evalcontext * pec,
+                   movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+
+    return SaveBestMoves(pml, nDice0, nDice1, anBoard, keyMove, rThr, pci, pec, aamf, FALSE);
+}
+
+extern int
+FindnSaveBestMovesScratch(movelist * pml, int nDice0, int nDice1, const TanBoard anBoard, positionkey * keyMove, const
+                          float rThr, const cubeinfo * pci, const evalcontext * pec,
+                          movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+
+    return SaveBestMoves(pml, nDice0, nDice1, anBoard, keyMove, rThr, pci, pec, aamf, TRUE);
+}
+
+/*
+ * The variance reduction of rollouts: for each roll nDie0 = i + 1 >=
+ * nDie1 = j + 1 (but no doubles if fNoDoubles) find the best move at
+ * 0-ply with pecMove, as FindBestMove() would, and evaluate the
+ * position after it, from the opponent's side, with pecEval, as
+ * GeneralEvaluationE() would.  The move, that position and its
+ * evaluation go to aanMove[i][j], aanBoard[i][j] and aar[i][j].
+ *
+ * The moves are scored straight from the list of GenerateMoves(), and
+ * when pecEval is the 0-ply evaluation they were scored with, the
+ * evaluation of the best one is kept instead of being looked up again.
+ * The positions still to be evaluated are done afterwards, those
+ * needing a neural net at 0-ply in one batch.
+ */
+extern int
+EvaluateRollsVarRedn(const TanBoard anBoard, const cubeinfo * pci,
+                     const evalcontext * pecMove, const evalcontext * pecEval, int fNoDoubles,
+                     int aanMove[6][6][8], TanBoard aanBoard[6][6], float aar[6][6][NUM_ROLLOUT_OUTPUTS])
+{
+    NNState *nnStates = MT_Get_nnState();
+    evalcontext ec;
+    cubeinfo ciOpp;
+    movelist ml;
+    TanBoard anBoardTemp;
+    SSE_ALIGN(float arEval[NUM_ROLLOUT_OUTPUTS]);
+    SSE_ALIGN(float arBest[NUM_ROLLOUT_OUTPUTS]);
+    SSE_ALIGN(float aarNN[21][NUM_OUTPUTS]);
+    TanBoard aanBoardNN[21];
+    unsigned int cNN = 0;
+    int afDone[6][6];
+    int fReuse;
+    int i, j;
+    unsigned int k, iBest;
+    float rScore, rScore2, rBestScore, rBestScore2;
+
+    memcpy(&ec, pecMove, sizeof(evalcontext));
+    ec.nPlies = 0;
+
+    memcpy(&ciOpp, pci, sizeof(cubeinfo));
+    ciOpp.fMove = !ciOpp.fMove;
+
+    fReuse = !pecEval->nPlies && pecEval->fCubeful == ec.fCubeful && pecEval->rNoise == 0.0f && ec.rNoise == 0.0f;
+
+    /* start incremental evaluations */
+    nnStates[0].state = nnStates[1].state = nnStates[2].state = NNSTATE_INCREMENTAL;
+
+    for (i = 0; i < 6; i++)
+        for (j = 0; j <= i; j++) {
+
+            afDone[i][j] = TRUE;
+
+            if (fNoDoubles && i == j)
+                continue;
+
+            for (k = 0; k < 8; k++)
+                aanMove[i][j][k] = -1;
+
+            memcpy(aanBoard[i][j], anBoard, sizeof(TanBoard));
+
+            /* the list points to the thread's static data; nothing
+             * below generates moves until the best one is saved */
+            GenerateMoves(&ml, anBoard, i + 1, j + 1, FALSE);
+
+            iBest = 0;
+            rBestScore = rBestScore2 = -99999.9f;
+
+            for (k = 0; k < ml.cMoves; k++) {
+
+                /* as ScoreMove() */
+
+                PositionFromKeySwapped(anBoardTemp, &ml.amMoves[k].key);
+
+                if (GeneralEvaluationEPlied(nnStates, arEval, (ConstTanBoard) anBoardTemp, &ciOpp, &ec, 0)) {
+                    nnStates[0].state = nnStates[1].state = nnStates[2].state = NNSTATE_NONE;
+                    return -1;
+                }
+
+                rScore2 = -arEval[OUTPUT_EQUITY];
+                if (!ec.fCubeful)
+                    rScore = rScore2;
+                else if (ciOpp.nMatchTo)
+                    rScore = mwc2eq(1.0f - arEval[OUTPUT_CUBEFUL_EQUITY], pci);
+                else
+                    rScore = -arEval[OUTPUT_CUBEFUL_EQUITY];
+
+                if (rScore > rBestScore || (rScore == rBestScore && rScore2 > rBestScore2)) {
+                    iBest = k;
+                    rBestScore = rScore;
+                    rBestScore2 = rScore2;
+                    memcpy(arBest, arEval, sizeof(arBest));
+                }
+            }
+
+            if (ml.cMoves) {
+                for (k = 0; k < ml.cMaxMoves * 2; k++)
+                    aanMove[i][j][k] = ml.amMoves[iBest].anMove[k];
+
+                PositionFromKey(aanBoard[i][j], &ml.amMoves[iBest].key);
+            }
+
+            SwapSides(aanBoard[i][j]);
+
+            if (fReuse && ml.cMoves)
+                memcpy(aar[i][j], arBest, sizeof(arBest));
+            else
+                afDone[i][j] = FALSE;
+        }
+
+    /* reset to none */
+    nnStates[0].state = nnStates[1].state = nnStates[2].state = NNSTATE_NONE;
+
+    if (!pecEval->nPlies && cCache) {
+        /* The 0-ply evaluations below look the neural net outputs up
+         * in the cache; evaluate the missing ones in one batch.  Cubeful
+         * evaluations use the basic context for them. */
+        for (i = 0; i < 6; i++)
+            for (j = 0; j <= i; j++)
+                if (!afDone[i][j] && ClassifyPosition((ConstTanBoard) aanBoard[i][j], ciOpp.bgv) >= CLASS_RACE)
+                    memcpy(aanBoardNN[cNN++], aanBoard[i][j], sizeof(TanBoard));
+
+        if (cNN && EvaluatePositionsLeaf(nnStates, aanBoardNN, cNN, aarNN, &ciOpp,
+                                         pecEval->fCubeful ? &ecBasic : pecEval))
+            return -1;
+    }
+
+    for (i = 0; i < 6; i++)
+        for (j = 0; j <= i; j++) {
+
+            if (afDone[i][j])
+                continue;
+
+            /* as GeneralEvaluationE() */
+            if (GeneralEvaluationEPlied(NULL, arEval, (ConstTanBoard) aanBoard[i][j], &ciOpp, pecEval, pecEval->nPlies))
+                return -1;
+
+            memcpy(aar[i][j], arEval, sizeof(arEval));
+        }
+
+    return 0;
+}
+
 extern int
 GeneralCubeDecisionE(float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
                      const TanBoard anBoard,
@@ -5989,7 +6418,6 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
     float *arCfTemp = (float *) g_alloca(2 * cci * sizeof(float));
     cubeinfo *aci = (cubeinfo *) g_alloca(2 * cci * sizeof(cubeinfo));
 
-    int w;
     int n0, n1;
 
     pc = ClassifyPosition(anBoard, pciMove->bgv);
@@ -5997,7 +6425,9 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
     if (pc > CLASS_OVER && nPlies > 0 && !(pc <= CLASS_PERFECT && !pciMove->nMatchTo)) {
         /* internal node; recurse */
 
-        TanBoard anBoardNew;
+        TanBoard aanBoardNew[21];
+        int aw[21];
+        unsigned int iRoll, cRolls = 0;
 
         int const usePrune = pec->fUsePrune && pec->rNoise == 0.0f && pciMove->bgv == VARIATION_STANDARD;
 
@@ -6011,15 +6441,17 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
 
         MakeCubePos(aciCubePos, cci, fTop, aci, TRUE);
 
-        /* loop over rolls */
+        /* find the best move for each roll */
 
         for (n0 = 1; n0 <= 6; n0++) {
             for (n1 = 1; n1 <= n0; n1++) {
-                w = (n0 == n1) ? 1 : 2;
+                TanBoard *panBoardNew = &aanBoardNew[cRolls];
+
+                aw[cRolls++] = (n0 == n1) ? 1 : 2;
 
                 for (i = 0; i < 25; i++) {
-                    anBoardNew[0][i] = anBoard[0][i];
-                    anBoardNew[1][i] = anBoard[1][i];
+                    (*panBoardNew)[0][i] = anBoard[0][i];
+                    (*panBoardNew)[1][i] = anBoard[1][i];
                 }
 
                 if (fInterrupt) {
@@ -6028,32 +6460,51 @@ EvaluatePositionCubeful4(NNState * nnStates, const TanBoard anBoard,
                 }
 
                 if (usePrune) {
-                    FindBestMoveInEval(nnStates, n0, n1, anBoard, anBoardNew, pciMove, pec);
+                    FindBestMoveInEval(nnStates, n0, n1, anBoard, *panBoardNew, pciMove, pec);
                 } else {
 
-                    FindBestMovePlied(NULL, n0, n1, anBoardNew, pciMove, pec, 0, defaultFilters);
+                    FindBestMovePlied(NULL, n0, n1, *panBoardNew, pciMove, pec, 0, defaultFilters);
                 }
 
-                SwapSides(anBoardNew);
+                SwapSides(*panBoardNew);
+            }
 
-                SetCubeInfo(&ciMoveOpp,
-                            pciMove->nCube, pciMove->fCubeOwner,
-                            !pciMove->fMove, pciMove->nMatchTo,
-                            pciMove->anScore, pciMove->fCrawford, pciMove->fJacoby, pciMove->fBeavers, pciMove->bgv);
+        }
 
-                /* Evaluate at 0-ply */
-                if (EvaluatePositionCubeful3(nnStates, (ConstTanBoard) anBoardNew,
-                                             ar, arCfTemp, aci, 2 * cci, &ciMoveOpp, pec, nPlies - 1, FALSE))
-                    return -1;
+        SetCubeInfo(&ciMoveOpp,
+                    pciMove->nCube, pciMove->fCubeOwner,
+                    !pciMove->fMove, pciMove->nMatchTo,
+                    pciMove->anScore, pciMove->fCrawford, pciMove->fJacoby, pciMove->fBeavers, pciMove->bgv);
 
-                /* Sum up cubeless winning chances and cubeful equities */
+        if (nPlies == 1 && cCache) {
+            /* The leaves below are evaluated with EvaluatePosition();
+             * evaluate the ones needing a neural net in one batch and
+             * leave the results in the cache for it. */
+            TanBoard aanBoardNN[21];
+            SSE_ALIGN(float aarNN[21][NUM_OUTPUTS]);
+            unsigned int cNN = 0;
 
-                for (i = 0; i < NUM_OUTPUTS; i++)
-                    arOutput[i] += w * ar[i];
-                for (i = 0; i < 2 * cci; i++)
-                    arCf[i] += w * arCfTemp[i];
+            for (iRoll = 0; iRoll < cRolls; iRoll++)
+                if (ClassifyPosition((ConstTanBoard) aanBoardNew[iRoll], ciMoveOpp.bgv) >= CLASS_RACE)
+                    memcpy(aanBoardNN[cNN++], aanBoardNew[iRoll], sizeof(TanBoard));
 
-            }
+            if (cNN && EvaluatePositionsLeaf(nnStates, aanBoardNN, cNN, aarNN, &ciMoveOpp, &ecBasic))
+                return -1;
+        }
+
+        for (iRoll = 0; iRoll < cRolls; iRoll++) {
+
+            /* Evaluate at 0-ply */
+            if (EvaluatePositionCubeful3(nnStates, (ConstTanBoard) aanBoardNew[iRoll],
+                                         ar, arCfTemp, aci, 2 * cci, &ciMoveOpp, pec, nPlies - 1, FALSE))
+                return -1;
+
+            /* Sum up cubeless winning chances and cubeful equities */
+
+            for (i = 0; i < NUM_OUTPUTS; i++)
+                arOutput[i] += aw[iRoll] * ar[i];
+            for (i = 0; i < 2 * cci; i++)
+                arCf[i] += aw[iRoll] * arCfTemp[i];
 
         }
 
@@ -6288,6 +6739,7 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
     int ici;
     int fAll = TRUE;
     evalcache ec;
+    evalCache *pcEval;
 
     if (!cCache || pec->rNoise != 0.0f)
         /* non-deterministic evaluation; never cache */
@@ -6297,6 +6749,7 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
     }
 
     PositionKey(anBoard, &ec.key);
+    pcEval = NODE_CACHE(ThreadNode());
 
     /* check cache for existence for earlier calculation */
 
@@ -6310,7 +6763,7 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
 
         ec.nEvalContext = EvalKey(pec, nPlies, &aciCubePos[ici], TRUE);
 
-        if (CacheLookup(&cEval, &ec, arOutput, arCubeful + ici) != CACHEHIT) {
+        if (CacheLookup(pcEval, &ec, arOutput, arCubeful + ici) != CACHEHIT) {
             fAll = FALSE;
         }
     }
@@ -6336,7 +6789,7 @@ EvaluatePositionCubeful3(NNState * nnStates, const TanBoard anBoard,
                 ec.ar[5] = arCubeful[ici];      /* Cubeful equity stored in slot 5 */
                 ec.nEvalContext = EvalKey(pec, nPlies, &aciCubePos[ici], TRUE);
 
-                CacheAdd(&cEval, &ec, GetHashKey(cEval.hashMask, &ec));
+                CacheAdd(pcEval, &ec, GetHashKey(pcEval->hashMask, &ec));
 
             }
         }
@@ -372,6 +372,18 @@ EXP_LOCK_FUN(int, FindnSaveBestMoves, movelist * pml,
              positionkey * keyMove, const float rThr,
              const cubeinfo * pci, const evalcontext * pec, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
 
+/* As FindnSaveBestMoves, with the moves in the scratch memory of the
+ * thread: they are given back with MT_ScratchRelease() instead of
+ * being freed */
+EXP_LOCK_FUN(int, FindnSaveBestMovesScratch, movelist * pml,
+             int nDice0, int nDice1, const TanBoard anBoard,
+             positionkey * keyMove, const float rThr,
+             const cubeinfo * pci, const evalcontext * pec, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES]);
+
+EXP_LOCK_FUN(int, EvaluateRollsVarRedn, const TanBoard anBoard, const cubeinfo * pci,
+             const evalcontext * pecMove, const evalcontext * pecEval, int fNoDoubles,
+             int aanMove[6][6][8], TanBoard aanBoard[6][6], float aar[6][6][NUM_ROLLOUT_OUTPUTS]);
+
 extern void
  PipCount(const TanBoard anBoard, unsigned int anPips[2]);
 
@@ -550,4 +562,19 @@ extern int EvaluatePerfectCubeful(const TanBoard anBoard, float arEquity[], cons
 extern neuralnet nnContact, nnRace, nnCrashed;
 extern neuralnet nnpContact, nnpRace, nnpCrashed;
 
+/* Copies of the nets and, optionally, an evaluation cache of their own
+ * for the threads of one NUMA node.  They are made by one of those
+ * threads, so the memory is local to the node. */
+typedef struct _evalnode {
+    neuralnet nnContact, nnRace, nnCrashed;
+    neuralnet nnpContact, nnpRace, nnpCrashed;
+    unsigned int cShards;       /* nodes the global cache size is split
+                                 * between, 0 if they share the global cache */
+    int fCache;                 /* cEval is used instead of the global one */
+    evalCache cEval;
+} evalnode;
+
+extern evalnode *EvalNodeNew(unsigned int cShards);
+extern void EvalNodeFree(evalnode * pen);
+
 #endif
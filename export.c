@@ -25,6 +25,7 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <glib/gprintf.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include "glib-ext.h"
@@ -40,6 +41,7 @@
 #include "positionid.h"
 #include "renderprefs.h"
 #include "matchid.h"
+#include "multithread.h"
 #include "boardpos.h"
 #include "boarddim.h"
 
@@ -88,6 +90,191 @@ filename_from_iGame(const char *szBase, const int iGame)
     }
 }
 
+/*
+ * Split a game into one fragment per move record, with the match state
+ * each is exported from.  The board of chequer play decisions is shown
+ * with the dice of the roll.
+ *
+ * Garbage collect:
+ *   Caller must g_free returned array
+ */
+
+extern exportfragment *
+ExportGameFragments(listOLD * plGame, const int iGame, unsigned int *pn)
+{
+    listOLD *pl;
+    matchstate msExport;
+    exportfragment *aef;
+    unsigned int i = 0;
+    int iMove = 0;
+
+    for (pl = plGame->plNext; pl != plGame; pl = pl->plNext)
+        i++;
+
+    aef = g_new0(exportfragment, i);
+
+    for (pl = plGame->plNext, i = 0; pl != plGame; pl = pl->plNext, i++) {
+        moverecord *pmr = pl->p;
+
+        FixMatchState(&msExport, pmr);
+
+        aef[i].iMove = -1;
+
+        switch (pmr->mt) {
+
+        case MOVE_GAMEINFO:
+            ApplyMoveRecord(&msExport, plGame, pmr);
+            break;
+
+        case MOVE_NORMAL:
+            if (pmr->fPlayer != msExport.fMove) {
+                SwapSides(msExport.anBoard);
+                msExport.fMove = pmr->fPlayer;
+            }
+
+            msExport.fTurn = msExport.fMove = pmr->fPlayer;
+            msExport.anDice[0] = pmr->anDice[0];
+            msExport.anDice[1] = pmr->anDice[1];
+            aef[i].iMove = iMove++;
+            break;
+
+        case MOVE_DOUBLE:
+        case MOVE_TAKE:
+        case MOVE_DROP:
+            aef[i].iMove = iMove++;
+            break;
+
+        default:
+            break;
+        }
+
+        aef[i].ms = msExport;
+        aef[i].pmr = pmr;
+        aef[i].iGame = iGame;
+
+        if (pmr->mt != MOVE_GAMEINFO)
+            ApplyMoveRecord(&msExport, plGame, pmr);
+    }
+
+    *pn = i;
+    return aef;
+}
+
+/* the fragments being exported, for the progress callback */
+
+static exportfragment *aefExport;
+static unsigned int cExport, iExportNext;
+static ExportFragmentFun pfExportRender, pfExportWrite;
+static void *pExportData;
+
+static void
+FreeFragment(exportfragment * pef)
+{
+    int i;
+
+    for (i = 0; i < 2; ++i)
+        if (pef->agsz[i]) {
+            g_string_free(pef->agsz[i], TRUE);
+            pef->agsz[i] = NULL;
+        }
+}
+
+/* Write the fragments that are done and next in order */
+
+static void
+WriteFragments(void)
+{
+    while (iExportNext < cExport && MT_SafeGet(&aefExport[iExportNext].fDone)) {
+        pfExportWrite(&aefExport[iExportNext], pExportData);
+        FreeFragment(&aefExport[iExportNext++]);
+    }
+}
+
+#if defined(MT_SAFE_STATIC_BUFFERS)
+
+typedef struct _fragmenttask {
+    Task task;
+    exportfragment *pef;
+} fragmenttask;
+
+static void
+RenderFragmentMT(fragmenttask * pft)
+{
+    pfExportRender(pft->pef, pExportData);
+    MT_SafeSet(&pft->pef->fDone, TRUE);
+}
+
+static gboolean
+UpdateFragments(gpointer UNUSED(unused))
+{
+    WriteFragments();
+    ProgressValue(MT_GetDoneTasks());
+    return TRUE;
+}
+
+#endif
+
+/*
+ * Render the fragments in tasks and write them in order.  Each is
+ * written as soon as the ones before it are, while the rest are still
+ * being rendered.
+ *
+ * Returns: 0 on success, -1 if interrupted
+ */
+
+extern int
+ExportFragments(exportfragment aef[], const unsigned int n,
+                ExportFragmentFun pfRender, ExportFragmentFun pfWrite, void *pData)
+{
+    unsigned int i;
+    int result;
+
+    aefExport = aef;
+    cExport = n;
+    iExportNext = 0;
+    pfExportRender = pfRender;
+    pfExportWrite = pfWrite;
+    pExportData = pData;
+
+#if defined(MT_SAFE_STATIC_BUFFERS)
+    for (i = 0; i < n; ++i) {
+        fragmenttask *pft = (fragmenttask *) malloc(sizeof(fragmenttask));
+
+        pft->task.fun = (AsyncFun) RenderFragmentMT;
+        pft->task.data = pft;
+        pft->task.pLinkedTask = NULL;
+        pft->pef = &aef[i];
+
+        MT_AddTask((Task *) pft, TRUE);
+    }
+
+    ProgressStartValue(_("Exporting"), n);
+    result = MT_WaitForTasks(UpdateFragments, 250, FALSE);
+    ProgressEnd();
+#else
+    /* the formatting functions share their buffers between threads,
+     * so render in order */
+    for (i = 0; i < n && !fInterrupt; ++i) {
+        pfRender(&aef[i], pData);
+        aef[i].fDone = TRUE;
+        WriteFragments();
+    }
+    result = 0;
+#endif
+
+    if (result == -1 || fInterrupt)
+        result = -1;
+    else
+        WriteFragments();
+
+    for (i = iExportNext; i < n; ++i)
+        FreeFragment(&aef[i]);
+
+    aefExport = NULL;
+
+    return result;
+}
+
 #if defined(HAVE_PANGOCAIRO)
 
 /* Caller must g_free returned pointer */
@@ -138,111 +325,134 @@ export_get_moverecord(int *game_nr, int *move_nr)
 #define SIMPLE_BOARD_WIDTH 210.0/25.4*72.0
 #define SIMPLE_BOARD_HEIGHT 297.0/25.4*72.0
 
-static int
-draw_simple_board_on_cairo(matchstate * sb_pms,
-                           moverecord * sb_pmr, int move_nr, int game_nr, cairo_t * cairo, float size)
+static void
+draw_simple_board_text(matchstate * sb_pms, const GString * header, const GString * annotation, cairo_t * cairo,
+                       float size)
 {
     SimpleBoard *board;
-    GString *header = NULL;
-    GString *annotation = NULL;
-
-    g_return_val_if_fail(cairo, 0);
-    g_return_val_if_fail(sb_pms->gs != GAME_NONE, 0);
 
     board = simple_board_new(sb_pms, cairo, size);
     board->surface_x = SIMPLE_BOARD_WIDTH;
     board->surface_y = SIMPLE_BOARD_HEIGHT;
-
-    header = g_string_new(NULL);
-    TextPrologue(header, sb_pms, game_nr);
-    TextBoardHeader(header, sb_pms, game_nr, move_nr);
     board->header = header->str;
 
-    if (sb_pmr) {
-        annotation = g_string_new(NULL);
-        TextAnalysis(annotation, sb_pms, sb_pmr);
+    if (annotation)
         board->annotation = annotation->str;
-    }
 
     simple_board_draw(board);
     g_free(board);
-    g_string_free(header, TRUE);
-    if (annotation)
-        g_string_free(annotation, TRUE);
-    return 1;
 }
 
-static int
-export_boards(moverecord * pmr, matchstate * msExport, int *iMove, int iGame, cairo_t * cairo, float size)
+static void
+render_simple_board_text(GString * agsz[2], const matchstate * sb_pms, moverecord * sb_pmr, int move_nr, int game_nr)
 {
-    FixMatchState(msExport, pmr);
-    switch (pmr->mt) {
-    case MOVE_NORMAL:
-        if (pmr->fPlayer != msExport->fMove) {
-            SwapSides(msExport->anBoard);
-            msExport->fMove = pmr->fPlayer;
-        }
-        msExport->fTurn = msExport->fMove = pmr->fPlayer;
-        msExport->anDice[0] = pmr->anDice[0];
-        msExport->anDice[1] = pmr->anDice[1];
-        draw_simple_board_on_cairo(msExport, pmr, *iMove, iGame, cairo, size);
-        (*iMove)++;
-        break;
-    case MOVE_TAKE:
-    case MOVE_DROP:
-    case MOVE_DOUBLE:
-        draw_simple_board_on_cairo(msExport, pmr, *iMove, iGame, cairo, size);
-        (*iMove)++;
-        break;
-    default:
-        break;
+    agsz[0] = g_string_new(NULL);
+    TextPrologue(agsz[0], sb_pms, game_nr);
+    TextBoardHeader(agsz[0], sb_pms, game_nr, move_nr);
+
+    if (sb_pmr) {
+        agsz[1] = g_string_new(NULL);
+        TextAnalysis(agsz[1], sb_pms, sb_pmr);
     }
-    ApplyMoveRecord(msExport, plGame, pmr);
+}
+
+static int
+draw_simple_board_on_cairo(matchstate * sb_pms,
+                           moverecord * sb_pmr, int move_nr, int game_nr, cairo_t * cairo, float size)
+{
+    GString *agsz[2] = { NULL, NULL };
+
+    g_return_val_if_fail(cairo, 0);
+    g_return_val_if_fail(sb_pms->gs != GAME_NONE, 0);
+
+    render_simple_board_text(agsz, sb_pms, sb_pmr, move_nr, game_nr);
+    draw_simple_board_text(sb_pms, agsz[0], agsz[1], cairo, size);
+
+    g_string_free(agsz[0], TRUE);
+    if (agsz[1])
+        g_string_free(agsz[1], TRUE);
     return 1;
 }
 
+/* The text of the pages is rendered in tasks, the boards are drawn on
+ * the surface in order */
+
+typedef struct _cairoexport {
+    cairo_t *cairo;
+    int page;
+} cairoexport;
+
+static void
+render_page_fragment(exportfragment * pef, void *UNUSED(pData))
+{
+    if (pef->iMove < 0)
+        return;
+
+    /* the first move after the game info */
+    if (pef->ms.gs == GAME_NONE)
+        pef->ms.gs = GAME_PLAYING;
+
+    render_simple_board_text(pef->agsz, &pef->ms, pef->pmr, pef->iMove, pef->iGame);
+}
+
+static void
+draw_page_fragment(exportfragment * pef, void *pData)
+{
+    cairoexport *pce = (cairoexport *) pData;
+
+    if (pef->pmr->mt == MOVE_GAMEINFO)
+        return;
+
+    if (pef->iMove >= 0)
+        draw_simple_board_text(&pef->ms, pef->agsz[0], pef->agsz[1], pce->cairo, SIZE_2PERPAGE);
+
+    if (pce->page % 2) {
+        cairo_translate(pce->cairo, 0, SIMPLE_BOARD_HEIGHT / 2.0);
+    } else {
+        cairo_translate(pce->cairo, 0, -SIMPLE_BOARD_HEIGHT / 2.0);
+        cairo_show_page(pce->cairo);
+    }
+    pce->page++;
+}
+
+/* Returns 0 if interrupted */
+
 static int
 draw_cairo_pages(cairo_t * cairo, listOLD * game_ptr)
 {
-    matchstate msExport;
     static statcontext scTotal;
     moverecord *pmr;
     statcontext *psc = NULL;
-    listOLD *pl;
-    int iMove = 0;
     int iGame = 0;
-    int page;
     listOLD *pl_hint = NULL;
+    exportfragment *aef;
+    unsigned int n;
+    cairoexport ce;
+    int result;
 
     IniStatcontext(&scTotal);
     updateStatisticsGame(game_ptr);
-    pl = game_ptr->plNext;
-    pmr = pl->p;
-    FixMatchState(&msExport, pmr);
-    ApplyMoveRecord(&msExport, game_ptr, pmr);
+    pmr = game_ptr->plNext->p;
     g_assert(pmr->mt == MOVE_GAMEINFO);
-    msExport.gs = GAME_PLAYING;
     psc = &pmr->g.sc;
     AddStatcontext(psc, &scTotal);
     iGame = getGameNumber(game_ptr);
     if (game_is_last(plGame))
         pl_hint = game_add_pmr_hint(game_ptr);
-    for (pl = pl->plNext, page = 1; pl != game_ptr; pl = pl->plNext, page++) {
-        export_boards(pl->p, &msExport, &iMove, iGame, cairo, SIZE_2PERPAGE);
-        if (page % 2) {
-            cairo_translate(cairo, 0, SIMPLE_BOARD_HEIGHT / 2.0);
-        } else {
-            cairo_translate(cairo, 0, -SIMPLE_BOARD_HEIGHT / 2.0);
-            cairo_show_page(cairo);
-        }
-    }
-    if (!(page % 2)) {
+
+    aef = ExportGameFragments(game_ptr, iGame, &n);
+    ce.cairo = cairo;
+    ce.page = 1;
+    result = ExportFragments(aef, n, render_page_fragment, draw_page_fragment, &ce);
+    g_free(aef);
+
+    if (!(ce.page % 2)) {
         cairo_translate(cairo, 0, -SIMPLE_BOARD_HEIGHT / 2.0);
         cairo_show_page(cairo);
     }
     if (pl_hint)
         game_remove_pmr_hint(pl_hint);
-    return 1;
+    return result == 0;
 }
 
 #endif
@@ -427,7 +637,8 @@ CommandExportMatchPDF(char *sz)
 
         cairo = cairo_create(surface);
         for (pl = lMatch.plNext, i = 0; pl != &lMatch; pl = pl->plNext, i++) {
-            draw_cairo_pages(cairo, pl->p);
+            if (!draw_cairo_pages(cairo, pl->p))
+                break;
         }
         cairo_surface_destroy(surface);
         cairo_destroy(cairo);
@@ -458,7 +669,8 @@ CommandExportMatchPS(char *sz)
 
         cairo = cairo_create(surface);
         for (pl = lMatch.plNext, i = 0; pl != &lMatch; pl = pl->plNext, i++) {
-            draw_cairo_pages(cairo, pl->p);
+            if (!draw_cairo_pages(cairo, pl->p))
+                break;
         }
         cairo_surface_destroy(surface);
         cairo_destroy(cairo);
@@ -472,39 +684,47 @@ CommandExportMatchPS(char *sz)
 /* size of html images in steps of BOARD_WIDTH x BOARD_HEIGHT
  * as defined in boarddim.h */
 
-extern int
-WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
+static void
+WritePNGMemory(png_structp ppng, png_bytep pb, png_size_t cb)
+{
+    g_byte_array_append((GByteArray *) png_get_io_ptr(ppng), pb, (guint) cb);
+}
+
+static void
+FlushPNGMemory(png_structp UNUSED(ppng))
+{
+}
+
+/* Encode the image to pf, or to pba if pf is NULL */
+
+static int
+EncodePNG(FILE * pf, GByteArray * pba, const char *sz,
+          unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
 {
 
-    FILE *pf;
     png_structp ppng;
     png_infop pinfo;
     png_text atext[3];
     unsigned int i;
 
-    if (!(pf = gnubg_g_fopen(sz, "wb")))
+    if (!(ppng = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL)))
         return -1;
 
-    if (!(ppng = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL))) {
-        fclose(pf);
-        return -1;
-
-    }
-
     if (!(pinfo = png_create_info_struct(ppng))) {
-        fclose(pf);
         png_destroy_write_struct(&ppng, NULL);
         return -1;
     }
 
     if (setjmp(png_jmpbuf(ppng))) {
         outputerr(sz);
-        fclose(pf);
         png_destroy_write_struct(&ppng, &pinfo);
         return -1;
     }
 
-    png_init_io(ppng, pf);
+    if (pf)
+        png_init_io(ppng, pf);
+    else
+        png_set_write_fn(ppng, pba, WritePNGMemory, FlushPNGMemory);
 
     png_set_IHDR(ppng, pinfo, nSizeX, nSizeY, 8, PNG_COLOR_TYPE_RGB,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
@@ -540,16 +760,59 @@ WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int
 
     png_destroy_write_struct(&ppng, &pinfo);
 
+    return 0;
+
+}
+
+extern int
+WritePNG(const char *sz, unsigned char *puch, unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY)
+{
+
+    FILE *pf;
+    int n;
+
+    if (!(pf = gnubg_g_fopen(sz, "wb")))
+        return -1;
+
+    n = EncodePNG(pf, NULL, sz, puch, nStride, nSizeX, nSizeY);
+
     fclose(pf);
 
-    return 0;
+    return n;
 
 }
 
-static int
+/* The board, chequer, dice and cube images only depend on the
+ * appearance and size, so they are kept from one export to the next
+ * and each position just draws the moving parts on a copy of the
+ * board.  Only the 2d part of renderdata is compared; the rest does
+ * not affect these images. */
+
+static renderdata rdCache;
+static renderimages riCache;
+static int fCacheValid = FALSE;
+
+#define RENDERDATA_2D_SIZE (offsetof(renderdata, showMoveIndicator) + sizeof(int))
+
+static renderimages *
+GetExportImages(renderdata * prd)
+{
+    if (fCacheValid && !memcmp(prd, &rdCache, RENDERDATA_2D_SIZE))
+        return &riCache;
+
+    if (fCacheValid)
+        FreeImages(&riCache);
+
+    memcpy(&rdCache, prd, sizeof(renderdata));
+    RenderImages(&rdCache, &riCache);
+    fCacheValid = TRUE;
+
+    return &riCache;
+}
+
+static unsigned char *
 GenerateImage(renderimages * pri, renderdata * prd,
               const TanBoard anBoard,
-              const char *szName,
               const int nSize, const int nSizeX, const int nSizeY,
               const int nOffsetX, const int nOffsetY,
               const int fMove, const int fTurn, const int fCube,
@@ -576,7 +839,7 @@ GenerateImage(renderimages * pri, renderdata * prd,
 
     if (!(puch = (unsigned char *) malloc(BOARD_WIDTH * BOARD_HEIGHT * nSize * nSize * 3))) {
         outputerr("malloc");
-        return -1;
+        return NULL;
     }
 
     /* calculate cube position */
@@ -644,13 +907,44 @@ GenerateImage(renderimages * pri, renderdata * prd,
 
     }
 
-    /* write png */
+    return puch;
+}
+
+/* PNG image of anBoard with the dice and cube of the current match,
+ * nSize pixels per unit, returned as a g_malloc'ed buffer of *pcb
+ * bytes, or NULL on failure */
+
+extern unsigned char *
+PositionPNGData(const TanBoard anBoard, const unsigned int nSize, gsize * pcb)
+{
+    renderdata rd;
+    renderimages *pri;
+    unsigned char *puch;
+    GByteArray *pba;
+
+    CopyAppearance(&rd);
+    rd.nSize = nSize;
+
+    g_assert(rd.nSize >= 1);
+
+    pri = GetExportImages(&rd);
+
+    if (!(puch = GenerateImage(pri, &rd, anBoard, nSize, BOARD_WIDTH, BOARD_HEIGHT, 0, 0,
+                               ms.fMove, ms.fTurn, fCubeUse, ms.anDice, ms.nCube, ms.fDoubled, ms.fCubeOwner)))
+        return NULL;
 
-    WritePNG(szName, puch, nSizeX * nSize * 3, nSizeX * nSize, nSizeY * nSize);
+    pba = g_byte_array_new();
+
+    if (EncodePNG(NULL, pba, "png", puch, BOARD_WIDTH * nSize * 3, BOARD_WIDTH * nSize, BOARD_HEIGHT * nSize) < 0) {
+        free(puch);
+        g_byte_array_free(pba, TRUE);
+        return NULL;
+    }
 
     free(puch);
 
-    return 0;
+    *pcb = pba->len;
+    return g_byte_array_free(pba, FALSE);
 }
 
 extern void
@@ -677,21 +971,23 @@ CommandExportPositionPNG(char *sz)
     } else
 #endif
     {
-        renderimages ri;
         renderdata rd;
+        unsigned char *puch;
+        const int nSize = exsExport.nPNGSize;
 
         CopyAppearance(&rd);
-        rd.nSize = exsExport.nPNGSize;
+        rd.nSize = nSize;
 
         g_assert(rd.nSize >= 1);
 
-        RenderImages(&rd, &ri);
-
-        GenerateImage(&ri, &rd, msBoard(), sz,
-                      exsExport.nPNGSize, BOARD_WIDTH, BOARD_HEIGHT, 0, 0,
-                      ms.fMove, ms.fTurn, fCubeUse, ms.anDice, ms.nCube, ms.fDoubled, ms.fCubeOwner);
+        puch = GenerateImage(GetExportImages(&rd), &rd, msBoard(),
+                             nSize, BOARD_WIDTH, BOARD_HEIGHT, 0, 0,
+                             ms.fMove, ms.fTurn, fCubeUse, ms.anDice, ms.nCube, ms.fDoubled, ms.fCubeOwner);
 
-        FreeImages(&ri);
+        if (puch) {
+            WritePNG(sz, puch, BOARD_WIDTH * nSize * 3, BOARD_WIDTH * nSize, BOARD_HEIGHT * nSize);
+            free(puch);
+        }
     }
 }
 
@@ -93,8 +93,28 @@ typedef struct _exportsetup {
 extern exportsetup exsExport;
 
 extern char *filename_from_iGame(const char *szBase, const int iGame);
+
+/* The output for one move record of a game export.  The fragments of a
+ * game are rendered in tasks and written to the file in order. */
+
+typedef struct _exportfragment {
+    matchstate ms;              /* before the move record */
+    moverecord *pmr;
+    int iGame;
+    int iMove;                  /* -1 if the record has no board */
+    GString *agsz[2];           /* the rendered output */
+    int fDone;
+} exportfragment;
+
+typedef void (*ExportFragmentFun) (exportfragment * pef, void *pData);
+
+extern exportfragment *ExportGameFragments(listOLD * plGame, const int iGame, unsigned int *pn);
+extern int ExportFragments(exportfragment aef[], const unsigned int n,
+                           ExportFragmentFun pfRender, ExportFragmentFun pfWrite, void *pData);
+
 extern int WritePNG(const char *sz, unsigned char *puch,
                     unsigned int nStride, unsigned int nSizeX, unsigned int nSizeY);
+extern unsigned char *PositionPNGData(const TanBoard anBoard, const unsigned int nSize, gsize * pcb);
 
 #if defined(USE_BOARD3D)
 void GenerateImage3d(const char *szName, unsigned int nSize, unsigned int nSizeX, unsigned int nSizeY);
@@ -24,6 +24,7 @@
 #include "file.h"
 #include <stdlib.h>
 #include "glib-ext.h"
+#include "gbf.h"
 
 ExportFormat export_format[] = {
     {EXPORT_SGF, ".sgf", N_("GNU Backgammon File"), "sgf", {TRUE, TRUE, TRUE}
@@ -70,6 +71,9 @@ ExportFormat export_format[] = {
      }
     ,
 #endif
+    {EXPORT_GBF, ".gbf", N_("GNU Backgammon Binary File"), "gbf", {TRUE, FALSE, FALSE}
+     }
+    ,
 };
 
 ImportFormat import_format[] = {
@@ -93,6 +97,8 @@ ImportFormat import_format[] = {
     ,
     {IMPORT_BGROOM, ".bgf", N_("BGRoom Game"), "bgroom"}
     ,
+    {IMPORT_GBF, ".gbf", N_("GNU Backgammon Binary File"), "gbf"}
+    ,
     {N_IMPORT_TYPES, NULL, N_("Unknown file format"), NULL}
 };
 
@@ -283,6 +289,13 @@ IsSGFFile(FileHelper * fh)
     return TRUE;
 }
 
+static int
+IsGBFFile(FileHelper * fh)
+{
+    fhReset(fh);
+    return fhReadString(fh, GBF_MAGIC);
+}
+
 static int
 IsSGGFile(FileHelper * fh)
 {
@@ -442,7 +455,9 @@ ReadFilePreview(const char *filename)
     fpd = g_new0(FilePreviewData, 1);
     fpd->type = N_IMPORT_TYPES;
 
-    if (IsSGFFile(fh))
+    if (IsGBFFile(fh))
+        fpd->type = IMPORT_GBF;
+    else if (IsSGFFile(fh))
         fpd->type = IMPORT_SGF;
     else if (IsSGGFile(fh))
         fpd->type = IMPORT_SGG;
@@ -35,6 +35,7 @@ typedef enum {
     EXPORT_PS,
     EXPORT_SNOWIETXT,
     EXPORT_SVG,
+    EXPORT_GBF,
     N_EXPORT_TYPES
 } ExportType;
 
@@ -49,6 +50,7 @@ typedef enum {
     IMPORT_EMPIRE,
     IMPORT_PARTY,
     IMPORT_BGROOM,
+    IMPORT_GBF,
     N_IMPORT_TYPES
 } ImportType;
 
@@ -30,6 +30,7 @@
 
 #include "export.h"
 #include "positionid.h"
+#include "multithread.h"
 
 
 int fOutputMWC = FALSE;
@@ -51,7 +52,7 @@ OutputRolloutResult(const char *szIndent,
                     const cubeinfo aci[], const int alt, const int cci, const int fCubeful)
 {
 
-    static char sz[1024];
+    MT_STATIC_BUFFER(sz, 1024);
     int ici;
 
     strcpy(sz, "");
@@ -111,7 +112,7 @@ extern char *
 OutputEvalContext(const evalcontext * pec, const int fChequer)
 {
 
-    static char sz[1024];
+    MT_STATIC_BUFFER(sz, 1024);
     int i;
 
     sprintf(sz, "%u-%s %s", pec->nPlies, _("ply"), (!fChequer || pec->fCubeful) ? _("cubeful") : _("cubeless"));
@@ -213,7 +214,7 @@ static char *
 OutputMoveFilterPly(const char *szIndent, const int nPlies, const movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
 {
 
-    static char sz[1024];
+    MT_STATIC_BUFFER(sz, 1024);
     int i;
 
     strcpy(sz, "");
@@ -313,7 +314,7 @@ extern char *
 OutputRolloutContext(const char *szIndent, const rolloutcontext * prc)
 {
 
-    static char sz[1024];
+    MT_STATIC_BUFFER(sz, 1024);
 
     strcpy(sz, "");
 
@@ -413,7 +414,7 @@ extern char *
 OutputEquity(const float r, const cubeinfo * pci, const int f)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
 
     if (!pci->nMatchTo || !fOutputMWC) {
         if (f)
@@ -438,7 +439,7 @@ extern char *
 OutputMoneyEquity(const float ar[], const int f)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
     float eq = 2.0f * ar[OUTPUT_WIN] - 1.0f + ar[OUTPUT_WINGAMMON] + ar[OUTPUT_WINBACKGAMMON] -
         ar[OUTPUT_LOSEGAMMON] - ar[OUTPUT_LOSEBACKGAMMON];
 
@@ -471,7 +472,7 @@ extern char *
 OutputEquityScale(const float r, const cubeinfo * pci, const cubeinfo * pciBase, const int f)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
 
     if (!pci->nMatchTo) {
         if (f)
@@ -521,7 +522,7 @@ extern char *
 OutputEquityDiff(const float r1, const float r2, const cubeinfo * pci)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
 
     if (!pci->nMatchTo || !fOutputMWC) {
         sprintf(sz, "%+*.*f", fOutputDigits + 3, fOutputDigits, r1 - r2);
@@ -552,7 +553,7 @@ extern char *
 OutputMWC(const float r, const cubeinfo * pci, const int f)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
 
     if (!pci->nMatchTo) {
         if (f)
@@ -585,7 +586,7 @@ extern char *
 OutputPercent(const float r)
 {
 
-    static char sz[OUTPUT_SZ_LENGTH];
+    MT_STATIC_BUFFER(sz, OUTPUT_SZ_LENGTH);
 
     if (fOutputWinPC) {
         sprintf(sz, "%*.*f", fOutputDigits + 2, fOutputDigits > 2 ? fOutputDigits - 2 : 0, 100.0 * r);
@@ -601,7 +602,7 @@ extern char *
 OutputPercents(const float ar[], const int f)
 {
 
-    static char sz[80];
+    MT_STATIC_BUFFER(sz, 80);
 
     strcpy(sz, "");
 
@@ -654,7 +655,7 @@ OutputCubeAnalysisFull(float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
 
     float arDouble[4];
 
-    static char sz[4096];
+    MT_STATIC_BUFFER(sz, 4096);
 
 
     strcpy(sz, "");
@@ -769,7 +770,7 @@ OutputCubeAnalysis(float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
                    float aarStdDev[2][NUM_ROLLOUT_OUTPUTS], const evalsetup * pes, const cubeinfo * pci)
 {
 
-    static char sz[4096];
+    MT_STATIC_BUFFER(sz, 4096);
     int i;
     float arDouble[4];
     const char *aszCube[] = {
@@ -0,0 +1,1042 @@
+/*
+ * gbf.c
+ *
+ * Binary match files
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+/* Layout of version 1 (all numbers little endian; strings are a 32 bit
+ * length, 0xFFFFFFFF for none, followed by the UTF-8 bytes):
+ *
+ *   magic, version
+ *   player names[2], match info (ratings[2], event, round, place,
+ *   annotator, comment, year, month, day), number of games
+ *   per game:
+ *     game info record, statistics, number of move records
+ *     per move record:
+ *       type, player, dice[2], annotation, then the data of the type
+ *       (move, analysis, luck, skill, cube decision, ...)
+ *
+ * Evaluation setups are the evaltype followed by the evalcontext and,
+ * for rollouts, the complete rolloutcontext.  Move lists keep every
+ * output and standard deviation, so nothing is lost compared to the
+ * in-memory match.  The position keys of the moves in a move list are
+ * not stored; they are recomputed when loading, as for SGF. */
+
+#include "config.h"
+#include "common.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glib-ext.h"
+
+#include "backgammon.h"
+#include "analysis.h"
+#include "positionid.h"
+#if USE_GTK
+#include "gtkgame.h"
+#endif
+#include "gbf.h"
+
+/*
+ * Writing
+ */
+
+extern void
+GBFPutU8(GByteArray * pba, unsigned int n)
+{
+    guint8 u = (guint8) n;
+
+    g_byte_array_append(pba, &u, 1);
+}
+
+extern void
+GBFPutU16(GByteArray * pba, unsigned int n)
+{
+    guint8 auch[2];
+
+    auch[0] = (guint8) n;
+    auch[1] = (guint8) (n >> 8);
+    g_byte_array_append(pba, auch, 2);
+}
+
+extern void
+GBFPutU32(GByteArray * pba, guint32 n)
+{
+    guint8 auch[4];
+
+    auch[0] = (guint8) n;
+    auch[1] = (guint8) (n >> 8);
+    auch[2] = (guint8) (n >> 16);
+    auch[3] = (guint8) (n >> 24);
+    g_byte_array_append(pba, auch, 4);
+}
+
+extern void
+GBFPutI32(GByteArray * pba, int n)
+{
+    GBFPutU32(pba, (guint32) n);
+}
+
+extern void
+GBFPutFloats(GByteArray * pba, const float *ar, unsigned int c)
+{
+    guint32 n;
+
+    for (; c; c--) {
+        memcpy(&n, ar++, sizeof n);
+        GBFPutU32(pba, n);
+    }
+}
+
+extern void
+GBFPutFloat(GByteArray * pba, float r)
+{
+    GBFPutFloats(pba, &r, 1);
+}
+
+extern void
+GBFPutInts(GByteArray * pba, const int *an, unsigned int c)
+{
+    for (; c; c--)
+        GBFPutI32(pba, *an++);
+}
+
+extern void
+GBFPutString(GByteArray * pba, const char *sz)
+{
+    if (!sz) {
+        GBFPutU32(pba, 0xFFFFFFFFu);
+        return;
+    }
+
+    GBFPutU32(pba, (guint32) strlen(sz));
+    g_byte_array_append(pba, (const guint8 *) sz, (guint) strlen(sz));
+}
+
+static void
+PutMove(GByteArray * pba, const int anMove[8])
+{
+    int i;
+
+    for (i = 0; i < 8; ++i)
+        GBFPutU8(pba, (unsigned int) (anMove[i] + 1));
+}
+
+static void
+PutEvalContext(GByteArray * pba, const evalcontext * pec)
+{
+    GBFPutU8(pba, pec->fCubeful | (pec->fUsePrune << 1) | (pec->fDeterministic << 2));
+    GBFPutU8(pba, pec->nPlies);
+    GBFPutFloat(pba, pec->rNoise);
+}
+
+static void
+PutMoveFilters(GByteArray * pba, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+    int i, j;
+
+    for (i = 0; i < MAX_FILTER_PLIES; ++i)
+        for (j = 0; j < MAX_FILTER_PLIES; ++j) {
+            GBFPutI32(pba, aamf[i][j].Accept);
+            GBFPutI32(pba, aamf[i][j].Extra);
+            GBFPutFloat(pba, aamf[i][j].Threshold);
+        }
+}
+
+static void
+PutRolloutContext(GByteArray * pba, rolloutcontext * prc)
+{
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+        PutEvalContext(pba, &prc->aecCube[i]);
+        PutEvalContext(pba, &prc->aecChequer[i]);
+        PutEvalContext(pba, &prc->aecCubeLate[i]);
+        PutEvalContext(pba, &prc->aecChequerLate[i]);
+        PutMoveFilters(pba, prc->aaamfChequer[i]);
+        PutMoveFilters(pba, prc->aaamfLate[i]);
+    }
+    PutEvalContext(pba, &prc->aecCubeTrunc);
+    PutEvalContext(pba, &prc->aecChequerTrunc);
+
+    GBFPutU16(pba, prc->fCubeful | (prc->fVarRedn << 1) | (prc->fInitial << 2) | (prc->fRotate << 3)
+           | (prc->fTruncBearoff2 << 4) | (prc->fTruncBearoffOS << 5) | (prc->fLateEvals << 6)
+           | (prc->fDoTruncate << 7) | (prc->fStopOnSTD << 8) | (prc->fStopOnJsd << 9) | (prc->fStopMoveOnJsd << 10));
+    GBFPutU16(pba, prc->nTruncate);
+    GBFPutU32(pba, prc->nTrials);
+    GBFPutU16(pba, prc->nLate);
+    GBFPutU8(pba, prc->rngRollout);
+    GBFPutU32(pba, (guint32) prc->nSeed);
+    GBFPutU32(pba, (guint32) ((guint64) prc->nSeed >> 32));
+    GBFPutU32(pba, prc->nMinimumGames);
+    GBFPutFloat(pba, prc->rStdLimit);
+    GBFPutU32(pba, prc->nMinimumJsdGames);
+    GBFPutFloat(pba, prc->rJsdLimit);
+    GBFPutU32(pba, prc->nGamesDone);
+    GBFPutFloat(pba, prc->rStoppedOnJSD);
+    GBFPutI32(pba, prc->nSkip);
+}
+
+static void
+PutEvalSetup(GByteArray * pba, evalsetup * pes)
+{
+    GBFPutU8(pba, pes->et);
+
+    if (pes->et != EVAL_NONE)
+        PutEvalContext(pba, &pes->ec);
+    if (pes->et == EVAL_ROLLOUT)
+        PutRolloutContext(pba, &pes->rc);
+}
+
+static void
+PutCubeDecision(GByteArray * pba, cubedecisiondata * pcdd)
+{
+    PutEvalSetup(pba, &pcdd->esDouble);
+
+    if (pcdd->esDouble.et != EVAL_NONE)
+        GBFPutFloats(pba, pcdd->aarOutput[0], 2 * NUM_ROLLOUT_OUTPUTS);
+    if (pcdd->esDouble.et == EVAL_ROLLOUT)
+        GBFPutFloats(pba, pcdd->aarStdDev[0], 2 * NUM_ROLLOUT_OUTPUTS);
+
+    GBFPutU8(pba, pcdd->cmark);
+}
+
+static void
+PutMoveList(GByteArray * pba, const movelist * pml)
+{
+    unsigned int i;
+
+    GBFPutU32(pba, pml->cMoves);
+
+    for (i = 0; i < pml->cMoves; ++i) {
+        move *pm = &pml->amMoves[i];
+
+        PutMove(pba, pm->anMove);
+        PutEvalSetup(pba, &pm->esMove);
+        GBFPutFloat(pba, pm->rScore);
+        GBFPutFloat(pba, pm->rScore2);
+        GBFPutFloats(pba, pm->arEvalMove, NUM_ROLLOUT_OUTPUTS);
+        if (pm->esMove.et == EVAL_ROLLOUT)
+            GBFPutFloats(pba, pm->arEvalStdDev, NUM_ROLLOUT_OUTPUTS);
+        GBFPutU8(pba, pm->cmark);
+    }
+}
+
+static void
+PutStatcontext(GByteArray * pba, const statcontext * psc)
+{
+    GBFPutI32(pba, psc->fMoves);
+    GBFPutI32(pba, psc->fCube);
+    GBFPutI32(pba, psc->fDice);
+    GBFPutInts(pba, psc->anUnforcedMoves, 2);
+    GBFPutInts(pba, psc->anTotalMoves, 2);
+    GBFPutInts(pba, psc->anTotalCube, 2);
+    GBFPutInts(pba, psc->anCloseCube, 2);
+    GBFPutInts(pba, psc->anDouble, 2);
+    GBFPutInts(pba, psc->anTake, 2);
+    GBFPutInts(pba, psc->anPass, 2);
+    GBFPutInts(pba, psc->anMoves[0], 2 * N_SKILLS);
+    GBFPutInts(pba, psc->anLuck[0], 2 * N_LUCKS);
+    GBFPutInts(pba, psc->anCubeMissedDoubleDP, 2);
+    GBFPutInts(pba, psc->anCubeMissedDoubleTG, 2);
+    GBFPutInts(pba, psc->anCubeWrongDoubleDP, 2);
+    GBFPutInts(pba, psc->anCubeWrongDoubleTG, 2);
+    GBFPutInts(pba, psc->anCubeWrongTake, 2);
+    GBFPutInts(pba, psc->anCubeWrongPass, 2);
+
+    GBFPutFloats(pba, psc->arErrorCheckerplay[0], 4);
+    GBFPutFloats(pba, psc->arErrorMissedDoubleDP[0], 4);
+    GBFPutFloats(pba, psc->arErrorMissedDoubleTG[0], 4);
+    GBFPutFloats(pba, psc->arErrorWrongDoubleDP[0], 4);
+    GBFPutFloats(pba, psc->arErrorWrongDoubleTG[0], 4);
+    GBFPutFloats(pba, psc->arErrorWrongTake[0], 4);
+    GBFPutFloats(pba, psc->arErrorWrongPass[0], 4);
+    GBFPutFloats(pba, psc->arLuck[0], 4);
+
+    GBFPutFloats(pba, psc->arActualResult, 2);
+    GBFPutFloats(pba, psc->arLuckAdj, 2);
+    GBFPutFloats(pba, psc->arVarianceActual, 2);
+    GBFPutFloats(pba, psc->arVarianceLuckAdj, 2);
+    GBFPutI32(pba, psc->nGames);
+}
+
+static void
+PutGameInfo(GByteArray * pba, const xmovegameinfo * pmgi)
+{
+    GBFPutI32(pba, pmgi->i);
+    GBFPutI32(pba, pmgi->nMatch);
+    GBFPutI32(pba, pmgi->anScore[0]);
+    GBFPutI32(pba, pmgi->anScore[1]);
+    GBFPutU8(pba, pmgi->fCrawford);
+    GBFPutU8(pba, pmgi->fCrawfordGame);
+    GBFPutU8(pba, pmgi->fJacoby);
+    GBFPutI32(pba, pmgi->fWinner);
+    GBFPutI32(pba, pmgi->nPoints);
+    GBFPutU8(pba, pmgi->fResigned);
+    GBFPutI32(pba, pmgi->nAutoDoubles);
+    GBFPutU8(pba, pmgi->bgv);
+    GBFPutU8(pba, pmgi->fCubeUse);
+    PutStatcontext(pba, &pmgi->sc);
+}
+
+/* The records written are the ones SaveGame() writes to SGF, plus
+ * resignations, which SGF only keeps as the result of the game. */
+
+static gboolean
+SaveRecord(listOLD * pl, listOLD * plGame, int fMoveNormalSeen)
+{
+    moverecord *pmr = pl->p;
+
+    /* see SaveGame() about a trailing double */
+    return !(pmr->mt == MOVE_DOUBLE && pl->plNext == plGame
+             && !(fMoveNormalSeen == FALSE && pmr->CubeDecPtr->esDouble.et != EVAL_NONE));
+}
+
+static void
+PutRecord(GByteArray * pba, moverecord * pmr)
+{
+    unsigned int i;
+
+    GBFPutU8(pba, pmr->mt);
+    GBFPutU8(pba, pmr->fPlayer);
+    GBFPutU8(pba, pmr->anDice[0]);
+    GBFPutU8(pba, pmr->anDice[1]);
+    GBFPutString(pba, pmr->sz);
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
+        /* sanitise the move if from a hint record */
+        if (pmr->ml.cMoves && pmr->n.iMove > pmr->ml.cMoves) {
+            memcpy(pmr->n.anMove, pmr->ml.amMoves[0].anMove, sizeof(pmr->n.anMove));
+            pmr->n.iMove = 0;
+        }
+        PutMove(pba, pmr->n.anMove);
+        GBFPutU32(pba, pmr->n.iMove);
+        GBFPutU8(pba, pmr->n.stMove);
+        GBFPutU8(pba, pmr->stCube);
+        GBFPutU8(pba, pmr->lt);
+        GBFPutFloat(pba, pmr->rLuck);
+        PutCubeDecision(pba, pmr->CubeDecPtr);
+        PutEvalSetup(pba, &pmr->esChequer);
+        PutMoveList(pba, &pmr->ml);
+        break;
+
+    case MOVE_DOUBLE:
+    case MOVE_TAKE:
+    case MOVE_DROP:
+        GBFPutU8(pba, pmr->stCube);
+        PutCubeDecision(pba, pmr->CubeDecPtr);
+        break;
+
+    case MOVE_RESIGN:
+        GBFPutI32(pba, pmr->r.nResigned);
+        PutEvalSetup(pba, &pmr->r.esResign);
+        GBFPutFloats(pba, pmr->r.arResign, NUM_ROLLOUT_OUTPUTS);
+        GBFPutU8(pba, pmr->r.stResign);
+        GBFPutU8(pba, pmr->r.stAccept);
+        break;
+
+    case MOVE_SETBOARD:
+        for (i = 0; i < 7; ++i)
+            GBFPutU32(pba, pmr->sb.key.data[i]);
+        break;
+
+    case MOVE_SETDICE:
+        GBFPutU8(pba, pmr->lt);
+        GBFPutFloat(pba, pmr->rLuck);
+        break;
+
+    case MOVE_SETCUBEVAL:
+        GBFPutI32(pba, pmr->scv.nCube);
+        break;
+
+    case MOVE_SETCUBEPOS:
+        GBFPutI32(pba, pmr->scp.fCubeOwner);
+        break;
+
+    default:
+        g_assert_not_reached();
+    }
+}
+
+static void
+PutGame(GByteArray * pba, listOLD * plGame)
+{
+    listOLD *pl, *pl_hint = NULL;
+    moverecord *pmr;
+    unsigned int cRecords = 0;
+    int fMoveNormalSeen;
+
+    updateStatisticsGame(plGame);
+
+    pmr = plGame->plNext->p;
+    g_assert(pmr->mt == MOVE_GAMEINFO);
+    PutGameInfo(pba, &pmr->g);
+
+    if (game_is_last(plGame))
+        pl_hint = game_add_pmr_hint(plGame);
+
+    for (fMoveNormalSeen = FALSE, pl = plGame->plNext->plNext; pl != plGame; pl = pl->plNext) {
+        if (SaveRecord(pl, plGame, fMoveNormalSeen))
+            cRecords++;
+        fMoveNormalSeen |= ((moverecord *) pl->p)->mt == MOVE_NORMAL;
+    }
+
+    GBFPutU32(pba, cRecords);
+
+    for (fMoveNormalSeen = FALSE, pl = plGame->plNext->plNext; pl != plGame; pl = pl->plNext) {
+        if (SaveRecord(pl, plGame, fMoveNormalSeen))
+            PutRecord(pba, pl->p);
+        fMoveNormalSeen |= ((moverecord *) pl->p)->mt == MOVE_NORMAL;
+    }
+
+    if (pl_hint)
+        game_remove_pmr_hint(pl_hint);
+}
+
+extern void
+GBFPutRolloutContext(GByteArray * pba, const rolloutcontext * prc)
+{
+    rolloutcontext rc;
+
+    /* the move filters can't be passed as const */
+    memcpy(&rc, prc, sizeof(rolloutcontext));
+    PutRolloutContext(pba, &rc);
+}
+
+extern GByteArray *
+GBFSaveMatch(void)
+{
+    GByteArray *pba = g_byte_array_new();
+    listOLD *pl;
+    guint32 cGames = 0;
+    int i;
+
+    g_byte_array_append(pba, (const guint8 *) GBF_MAGIC, strlen(GBF_MAGIC));
+    GBFPutU32(pba, GBF_VERSION);
+
+    GBFPutString(pba, ap[0].szName);
+    GBFPutString(pba, ap[1].szName);
+
+    for (i = 0; i < 2; ++i)
+        GBFPutString(pba, mi.pchRating[i]);
+    GBFPutString(pba, mi.pchEvent);
+    GBFPutString(pba, mi.pchRound);
+    GBFPutString(pba, mi.pchPlace);
+    GBFPutString(pba, mi.pchAnnotator);
+    GBFPutString(pba, mi.pchComment);
+    GBFPutU32(pba, mi.nYear);
+    GBFPutU32(pba, mi.nMonth);
+    GBFPutU32(pba, mi.nDay);
+
+    for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
+        cGames++;
+    GBFPutU32(pba, cGames);
+
+    for (pl = lMatch.plNext; pl != &lMatch; pl = pl->plNext)
+        PutGame(pba, pl->p);
+
+    return pba;
+}
+
+/*
+ * Reading
+ */
+
+extern const guchar *
+GBFTake(gbfreader * pr, gsize cb)
+{
+    const guchar *puch = pr->puch;
+
+    if (pr->fError || (gsize) (pr->puchEnd - pr->puch) < cb) {
+        pr->fError = TRUE;
+        return NULL;
+    }
+
+    pr->puch += cb;
+    return puch;
+}
+
+extern unsigned int
+GBFGetU8(gbfreader * pr)
+{
+    const guchar *puch = GBFTake(pr, 1);
+
+    return puch ? puch[0] : 0;
+}
+
+extern unsigned int
+GBFGetU16(gbfreader * pr)
+{
+    const guchar *puch = GBFTake(pr, 2);
+
+    return puch ? (unsigned int) (puch[0] | (puch[1] << 8)) : 0;
+}
+
+extern guint32
+GBFGetU32(gbfreader * pr)
+{
+    const guchar *puch = GBFTake(pr, 4);
+
+    return puch ? (guint32) puch[0] | ((guint32) puch[1] << 8) | ((guint32) puch[2] << 16) | ((guint32) puch[3] << 24)
+        : 0;
+}
+
+extern int
+GBFGetI32(gbfreader * pr)
+{
+    return (int) GBFGetU32(pr);
+}
+
+extern void
+GBFGetFloats(gbfreader * pr, float *ar, unsigned int c)
+{
+    guint32 n;
+
+    for (; c; c--) {
+        n = GBFGetU32(pr);
+        memcpy(ar++, &n, sizeof n);
+    }
+}
+
+extern float
+GBFGetFloat(gbfreader * pr)
+{
+    float r;
+
+    GBFGetFloats(pr, &r, 1);
+    return r;
+}
+
+extern void
+GBFGetInts(gbfreader * pr, int *an, unsigned int c)
+{
+    for (; c; c--)
+        *an++ = GBFGetI32(pr);
+}
+
+extern char *
+GBFGetString(gbfreader * pr)
+{
+    guint32 cch = GBFGetU32(pr);
+    const guchar *puch;
+
+    if (cch == 0xFFFFFFFFu || !(puch = GBFTake(pr, cch)))
+        return NULL;
+
+    return g_strndup((const char *) puch, cch);
+}
+
+static void
+GetMove(gbfreader * pr, int anMove[8])
+{
+    int i;
+
+    for (i = 0; i < 8; ++i)
+        anMove[i] = (int) GBFGetU8(pr) - 1;
+}
+
+static void
+GetEvalContext(gbfreader * pr, evalcontext * pec)
+{
+    unsigned int n = GBFGetU8(pr);
+
+    pec->fCubeful = n & 1;
+    pec->fUsePrune = (n >> 1) & 1;
+    pec->fDeterministic = (n >> 2) & 1;
+    pec->nPlies = GBFGetU8(pr) & 0xF;
+    pec->rNoise = GBFGetFloat(pr);
+}
+
+static void
+GetMoveFilters(gbfreader * pr, movefilter aamf[MAX_FILTER_PLIES][MAX_FILTER_PLIES])
+{
+    int i, j;
+
+    for (i = 0; i < MAX_FILTER_PLIES; ++i)
+        for (j = 0; j < MAX_FILTER_PLIES; ++j) {
+            aamf[i][j].Accept = GBFGetI32(pr);
+            aamf[i][j].Extra = GBFGetI32(pr);
+            aamf[i][j].Threshold = GBFGetFloat(pr);
+        }
+}
+
+static void
+GetRolloutContext(gbfreader * pr, rolloutcontext * prc)
+{
+    unsigned int n;
+    guint64 nSeed;
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+        GetEvalContext(pr, &prc->aecCube[i]);
+        GetEvalContext(pr, &prc->aecChequer[i]);
+        GetEvalContext(pr, &prc->aecCubeLate[i]);
+        GetEvalContext(pr, &prc->aecChequerLate[i]);
+        GetMoveFilters(pr, prc->aaamfChequer[i]);
+        GetMoveFilters(pr, prc->aaamfLate[i]);
+    }
+    GetEvalContext(pr, &prc->aecCubeTrunc);
+    GetEvalContext(pr, &prc->aecChequerTrunc);
+
+    n = GBFGetU16(pr);
+    prc->fCubeful = n & 1;
+    prc->fVarRedn = (n >> 1) & 1;
+    prc->fInitial = (n >> 2) & 1;
+    prc->fRotate = (n >> 3) & 1;
+    prc->fTruncBearoff2 = (n >> 4) & 1;
+    prc->fTruncBearoffOS = (n >> 5) & 1;
+    prc->fLateEvals = (n >> 6) & 1;
+    prc->fDoTruncate = (n >> 7) & 1;
+    prc->fStopOnSTD = (n >> 8) & 1;
+    prc->fStopOnJsd = (n >> 9) & 1;
+    prc->fStopMoveOnJsd = (n >> 10) & 1;
+    prc->nTruncate = (unsigned short) GBFGetU16(pr);
+    prc->nTrials = GBFGetU32(pr);
+    prc->nLate = (unsigned short) GBFGetU16(pr);
+    prc->rngRollout = (rng) GBFGetU8(pr);
+    nSeed = GBFGetU32(pr);
+    nSeed |= (guint64) GBFGetU32(pr) << 32;
+    prc->nSeed = (unsigned long) nSeed;
+    prc->nMinimumGames = GBFGetU32(pr);
+    prc->rStdLimit = GBFGetFloat(pr);
+    prc->nMinimumJsdGames = GBFGetU32(pr);
+    prc->rJsdLimit = GBFGetFloat(pr);
+    prc->nGamesDone = GBFGetU32(pr);
+    prc->rStoppedOnJSD = GBFGetFloat(pr);
+    prc->nSkip = GBFGetI32(pr);
+}
+
+static void
+GetEvalSetup(gbfreader * pr, evalsetup * pes)
+{
+    unsigned int et = GBFGetU8(pr);
+
+    if (et > EVAL_ROLLOUT) {
+        pr->fError = TRUE;
+        return;
+    }
+
+    pes->et = (evaltype) et;
+    if (pes->et != EVAL_NONE)
+        GetEvalContext(pr, &pes->ec);
+    if (pes->et == EVAL_ROLLOUT)
+        GetRolloutContext(pr, &pes->rc);
+}
+
+static void
+GetCubeDecision(gbfreader * pr, cubedecisiondata * pcdd)
+{
+    GetEvalSetup(pr, &pcdd->esDouble);
+
+    if (pcdd->esDouble.et != EVAL_NONE)
+        GBFGetFloats(pr, pcdd->aarOutput[0], 2 * NUM_ROLLOUT_OUTPUTS);
+    if (pcdd->esDouble.et == EVAL_ROLLOUT)
+        GBFGetFloats(pr, pcdd->aarStdDev[0], 2 * NUM_ROLLOUT_OUTPUTS);
+
+    pcdd->cmark = (CMark) GBFGetU8(pr);
+}
+
+static void
+GetMoveList(gbfreader * pr, movelist * pml, const matchstate * pms)
+{
+    TanBoard anBoardMove;
+    unsigned int i, cMoves = GBFGetU32(pr);
+
+    /* each move takes at least 40 bytes */
+    if (pr->fError || cMoves > MAX_MOVES || cMoves > (gsize) (pr->puchEnd - pr->puch) / 40) {
+        pr->fError = TRUE;
+        return;
+    }
+
+    pml->cMoves = cMoves;
+    pml->cMaxMoves = pml->cMaxPips = pml->iMoveBest = 0;
+    pml->rBestScore = 0;
+    pml->amMoves = cMoves ? calloc(cMoves, sizeof(move)) : NULL;
+
+    for (i = 0; i < cMoves; ++i) {
+        move *pm = &pml->amMoves[i];
+
+        GetMove(pr, pm->anMove);
+        GetEvalSetup(pr, &pm->esMove);
+        pm->rScore = GBFGetFloat(pr);
+        pm->rScore2 = GBFGetFloat(pr);
+        GBFGetFloats(pr, pm->arEvalMove, NUM_ROLLOUT_OUTPUTS);
+        if (pm->esMove.et == EVAL_ROLLOUT)
+            GBFGetFloats(pr, pm->arEvalStdDev, NUM_ROLLOUT_OUTPUTS);
+        pm->cmark = (CMark) GBFGetU8(pr);
+
+        if (pr->fError)
+            return;
+
+        memcpy(anBoardMove, pms->anBoard, sizeof(anBoardMove));
+        ApplyMove(anBoardMove, pm->anMove, FALSE);
+        PositionKey((ConstTanBoard) anBoardMove, &pm->key);
+    }
+}
+
+static void
+GetStatcontext(gbfreader * pr, statcontext * psc)
+{
+    psc->fMoves = GBFGetI32(pr);
+    psc->fCube = GBFGetI32(pr);
+    psc->fDice = GBFGetI32(pr);
+    GBFGetInts(pr, psc->anUnforcedMoves, 2);
+    GBFGetInts(pr, psc->anTotalMoves, 2);
+    GBFGetInts(pr, psc->anTotalCube, 2);
+    GBFGetInts(pr, psc->anCloseCube, 2);
+    GBFGetInts(pr, psc->anDouble, 2);
+    GBFGetInts(pr, psc->anTake, 2);
+    GBFGetInts(pr, psc->anPass, 2);
+    GBFGetInts(pr, psc->anMoves[0], 2 * N_SKILLS);
+    GBFGetInts(pr, psc->anLuck[0], 2 * N_LUCKS);
+    GBFGetInts(pr, psc->anCubeMissedDoubleDP, 2);
+    GBFGetInts(pr, psc->anCubeMissedDoubleTG, 2);
+    GBFGetInts(pr, psc->anCubeWrongDoubleDP, 2);
+    GBFGetInts(pr, psc->anCubeWrongDoubleTG, 2);
+    GBFGetInts(pr, psc->anCubeWrongTake, 2);
+    GBFGetInts(pr, psc->anCubeWrongPass, 2);
+
+    GBFGetFloats(pr, psc->arErrorCheckerplay[0], 4);
+    GBFGetFloats(pr, psc->arErrorMissedDoubleDP[0], 4);
+    GBFGetFloats(pr, psc->arErrorMissedDoubleTG[0], 4);
+    GBFGetFloats(pr, psc->arErrorWrongDoubleDP[0], 4);
+    GBFGetFloats(pr, psc->arErrorWrongDoubleTG[0], 4);
+    GBFGetFloats(pr, psc->arErrorWrongTake[0], 4);
+    GBFGetFloats(pr, psc->arErrorWrongPass[0], 4);
+    GBFGetFloats(pr, psc->arLuck[0], 4);
+
+    GBFGetFloats(pr, psc->arActualResult, 2);
+    GBFGetFloats(pr, psc->arLuckAdj, 2);
+    GBFGetFloats(pr, psc->arVarianceActual, 2);
+    GBFGetFloats(pr, psc->arVarianceLuckAdj, 2);
+    psc->nGames = GBFGetI32(pr);
+}
+
+static void
+GetGameInfo(gbfreader * pr, xmovegameinfo * pmgi)
+{
+    pmgi->i = GBFGetI32(pr);
+    pmgi->nMatch = GBFGetI32(pr);
+    pmgi->anScore[0] = GBFGetI32(pr);
+    pmgi->anScore[1] = GBFGetI32(pr);
+    pmgi->fCrawford = GBFGetU8(pr);
+    pmgi->fCrawfordGame = GBFGetU8(pr);
+    pmgi->fJacoby = GBFGetU8(pr);
+    pmgi->fWinner = GBFGetI32(pr);
+    pmgi->nPoints = GBFGetI32(pr);
+    pmgi->fResigned = GBFGetU8(pr);
+    pmgi->nAutoDoubles = GBFGetI32(pr);
+    pmgi->bgv = (bgvariation) GBFGetU8(pr);
+    pmgi->fCubeUse = GBFGetU8(pr);
+    GetStatcontext(pr, &pmgi->sc);
+
+    if (pmgi->bgv >= NUM_VARIATIONS || pmgi->fWinner < -1 || pmgi->fWinner > 1)
+        pr->fError = TRUE;
+}
+
+/* Read one record and add it to the current game, the way RestoreNode()
+ * does for SGF */
+
+static void
+GetRecord(gbfreader * pr)
+{
+    moverecord *pmr = NewMoveRecord();
+    unsigned int i, mt = GBFGetU8(pr);
+
+    if (mt == MOVE_GAMEINFO || mt > MOVE_SETCUBEPOS) {
+        pr->fError = TRUE;
+        free(pmr);
+        return;
+    }
+
+    pmr->mt = (movetype) mt;
+    pmr->fPlayer = GBFGetU8(pr) ? 1 : 0;
+    pmr->anDice[0] = GBFGetU8(pr);
+    pmr->anDice[1] = GBFGetU8(pr);
+    pmr->sz = GBFGetString(pr);
+
+    if (pmr->mt == MOVE_DOUBLE || pmr->mt == MOVE_TAKE || pmr->mt == MOVE_DROP)
+        LinkToDouble(pmr);
+
+    FixMatchState(&ms, pmr);
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
+        GetMove(pr, pmr->n.anMove);
+        pmr->n.iMove = GBFGetU32(pr);
+        pmr->n.stMove = (skilltype) GBFGetU8(pr);
+        pmr->stCube = (skilltype) GBFGetU8(pr);
+        pmr->lt = (lucktype) GBFGetU8(pr);
+        pmr->rLuck = GBFGetFloat(pr);
+        GetCubeDecision(pr, pmr->CubeDecPtr);
+        GetEvalSetup(pr, &pmr->esChequer);
+        GetMoveList(pr, &pmr->ml, &ms);
+        break;
+
+    case MOVE_DOUBLE:
+    case MOVE_TAKE:
+    case MOVE_DROP:
+        pmr->stCube = (skilltype) GBFGetU8(pr);
+        GetCubeDecision(pr, pmr->CubeDecPtr);
+        break;
+
+    case MOVE_RESIGN:
+        pmr->r.nResigned = GBFGetI32(pr);
+        GetEvalSetup(pr, &pmr->r.esResign);
+        GBFGetFloats(pr, pmr->r.arResign, NUM_ROLLOUT_OUTPUTS);
+        pmr->r.stResign = (skilltype) GBFGetU8(pr);
+        pmr->r.stAccept = (skilltype) GBFGetU8(pr);
+        break;
+
+    case MOVE_SETBOARD:
+        for (i = 0; i < 7; ++i)
+            pmr->sb.key.data[i] = GBFGetU32(pr);
+        break;
+
+    case MOVE_SETDICE:
+        pmr->lt = (lucktype) GBFGetU8(pr);
+        pmr->rLuck = GBFGetFloat(pr);
+        break;
+
+    case MOVE_SETCUBEVAL:
+        pmr->scv.nCube = GBFGetI32(pr);
+        break;
+
+    case MOVE_SETCUBEPOS:
+        pmr->scp.fCubeOwner = GBFGetI32(pr);
+        break;
+
+    default:
+        break;
+    }
+
+    if (pmr->anDice[0] > 6 || pmr->anDice[1] > 6 || pmr->lt > LUCK_VERYGOOD || pmr->stCube > SKILL_NONE
+        || pmr->n.stMove > SKILL_NONE || (pmr->ml.cMoves && pmr->n.iMove > pmr->ml.cMoves))
+        pr->fError = TRUE;
+
+    if (pr->fError) {
+        g_free(pmr->sz);
+        free(pmr->ml.amMoves);
+        free(pmr);
+        return;
+    }
+
+    AddMoveRecord(pmr);
+}
+
+/* As RestoreGame(), except that the game info is read before the game
+ * is added to the match, so that a damaged one leaves nothing behind */
+
+static void
+GetGame(gbfreader * pr)
+{
+    moverecord *pmr = NewMoveRecord();
+    guint32 i, cRecords;
+
+    pmr->mt = MOVE_GAMEINFO;
+    GetGameInfo(pr, &pmr->g);
+    if (pr->fError) {
+        free(pmr);
+        return;
+    }
+
+    InitBoard(ms.anBoard, ms.bgv);
+
+    ClearMoveRecord();
+
+    ListInsert(&lMatch, plGame);
+
+    ms.anDice[0] = ms.anDice[1] = 0;
+    ms.fResigned = ms.fDoubled = FALSE;
+    ms.nCube = 1;
+    ms.fTurn = ms.fMove = ms.fCubeOwner = -1;
+    ms.gs = GAME_NONE;
+
+    AddMoveRecord(pmr);
+
+    cRecords = GBFGetU32(pr);
+    for (i = 0; i < cRecords && !pr->fError; ++i)
+        GetRecord(pr);
+
+    AddGame(pmr);
+}
+
+static void
+GetName(gbfreader * pr, int i)
+{
+    char *sz = GBFGetString(pr);
+
+    if (sz) {
+        g_strlcpy(ap[i].szName, sz, MAX_NAME_LEN);
+        g_free(sz);
+    }
+}
+
+extern int
+GBFLoadMatch(const guchar * puch, gsize cb)
+{
+    gbfreader r;
+    guint32 i, cGames;
+    char **appch[7];
+
+    if (cb < strlen(GBF_MAGIC) + 4 || memcmp(puch, GBF_MAGIC, strlen(GBF_MAGIC)))
+        return -1;
+
+    r.puch = puch + strlen(GBF_MAGIC);
+    r.puchEnd = puch + cb;
+    r.fError = FALSE;
+
+    if (GBFGetU32(&r) != GBF_VERSION)
+        return -1;
+
+    FreeMatch();
+    ClearMatch();
+
+    GetName(&r, 0);
+    GetName(&r, 1);
+
+    appch[0] = &mi.pchRating[0];
+    appch[1] = &mi.pchRating[1];
+    appch[2] = &mi.pchEvent;
+    appch[3] = &mi.pchRound;
+    appch[4] = &mi.pchPlace;
+    appch[5] = &mi.pchAnnotator;
+    appch[6] = &mi.pchComment;
+    for (i = 0; i < 7; ++i) {
+        char *sz = GBFGetString(&r);
+
+        SetMatchInfo(appch[i], sz, NULL);
+        g_free(sz);
+    }
+    mi.nYear = GBFGetU32(&r);
+    mi.nMonth = GBFGetU32(&r);
+    mi.nDay = GBFGetU32(&r);
+
+    cGames = GBFGetU32(&r);
+    for (i = 0; i < cGames && !r.fError; ++i)
+        GetGame(&r);
+
+    if (r.fError) {
+        /* don't leave half a match behind */
+        FreeMatch();
+        ClearMatch();
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Commands
+ */
+
+extern void
+CommandExportMatchGBF(char *sz)
+{
+    GByteArray *pba;
+    FILE *pf;
+
+    sz = NextToken(&sz);
+
+    if (!plGame) {
+        outputl(_("No game in progress (type `new game' to start one)."));
+        return;
+    }
+
+    if (!sz || !*sz) {
+        outputl(_("You must specify a file to export to (see `help export " "match gbf')."));
+        return;
+    }
+
+    if (!confirmOverwrite(sz, fConfirmSave))
+        return;
+
+    if (!(pf = gnubg_g_fopen(sz, "wb"))) {
+        outputerr(sz);
+        return;
+    }
+
+    pba = GBFSaveMatch();
+
+    if (fwrite(pba->data, 1, pba->len, pf) != pba->len)
+        outputerr(sz);
+
+    fclose(pf);
+    g_byte_array_free(pba, TRUE);
+
+    setDefaultFileName(sz);
+}
+
+extern void
+CommandImportGBF(char *sz)
+{
+    GMappedFile *pmf;
+    GError *error = NULL;
+    int rc;
+
+    sz = NextToken(&sz);
+
+    if (!sz || !*sz) {
+        outputl(_("You must specify a file to import (see `help import " "gbf')."));
+        return;
+    }
+
+    if (!(pmf = g_mapped_file_new(sz, FALSE, &error))) {
+        outputerrf("%s: %s", sz, error->message);
+        g_error_free(error);
+        return;
+    }
+
+    if (!get_input_discard()) {
+        g_mapped_file_unref(pmf);
+        return;
+    }
+#if USE_GTK
+    if (fX) {                   /* Clear record to avoid ugly updates */
+        GTKClearMoveRecord();
+        GTKFreeze();
+    }
+#endif
+
+    rc = GBFLoadMatch((const guchar *) g_mapped_file_get_contents(pmf), g_mapped_file_get_length(pmf));
+
+    g_mapped_file_unref(pmf);
+
+    if (rc)
+        outputerrf(_("`%s' is not a GNU Backgammon binary match file, or it is damaged"), sz);
+
+    UpdateSettings();
+
+#if USE_GTK
+    if (fX) {
+        GTKThaw();
+        GTKSet(ap);
+    }
+#endif
+
+    if (rc)
+        return;
+
+    setDefaultFileName(sz);
+
+    if (fGotoFirstGame)
+        CommandFirstGame(NULL);
+}
@@ -0,0 +1,86 @@
+/*
+ * gbf.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef GBF_H
+#define GBF_H
+
+#include <glib.h>
+#include "eval.h"
+
+/* GNU Backgammon binary match files.  They hold the same information
+ * as a match saved as SGF -- move records, their analysis and rollouts
+ * -- but the numbers are stored as they are in memory (little endian)
+ * instead of being formatted as text, so a file can be loaded straight
+ * from a mapping of it.
+ *
+ * The file starts with GBF_MAGIC and a 32 bit version number; the
+ * version is raised whenever the layout changes. */
+
+#define GBF_MAGIC "GNUBGBIN"
+#define GBF_VERSION 1
+
+/* Serialise the current match (lMatch, ap, mi) */
+extern GByteArray *GBFSaveMatch(void);
+
+/* Replace the current match with the one in the buffer; returns 0 on
+ * success, -1 if the buffer is not a match file this version of gnubg
+ * can read.  If the header is wrong the current match is left alone;
+ * if the file is damaged further on, the match is cleared. */
+extern int GBFLoadMatch(const guchar * puch, gsize cb);
+
+/* Append the rollout context as it is written to the files */
+extern void GBFPutRolloutContext(GByteArray * pba, const rolloutcontext * prc);
+
+/* The primitives the files are made of, for other binary formats.
+ * Numbers are little endian whatever the host; floats are written as
+ * their 32 bit pattern.  A string is its 32 bit length (0xFFFFFFFF for
+ * NULL) followed by its bytes, without the terminating zero. */
+
+extern void GBFPutU8(GByteArray * pba, unsigned int n);
+extern void GBFPutU16(GByteArray * pba, unsigned int n);
+extern void GBFPutU32(GByteArray * pba, guint32 n);
+extern void GBFPutI32(GByteArray * pba, int n);
+extern void GBFPutInts(GByteArray * pba, const int *an, unsigned int c);
+extern void GBFPutFloats(GByteArray * pba, const float *ar, unsigned int c);
+extern void GBFPutFloat(GByteArray * pba, float r);
+extern void GBFPutString(GByteArray * pba, const char *sz);
+
+/* Reading goes through a gbfreader.  Once it runs past the end of the
+ * buffer, fError is set and every further read returns zeros (or NULL),
+ * so a caller need only check fError when it is done. */
+
+typedef struct _gbfreader {
+    const guchar *puch;
+    const guchar *puchEnd;
+    int fError;
+} gbfreader;
+
+/* Return a pointer to the next cb bytes and skip them, or NULL */
+extern const guchar *GBFTake(gbfreader * pr, gsize cb);
+extern unsigned int GBFGetU8(gbfreader * pr);
+extern unsigned int GBFGetU16(gbfreader * pr);
+extern guint32 GBFGetU32(gbfreader * pr);
+extern int GBFGetI32(gbfreader * pr);
+extern void GBFGetInts(gbfreader * pr, int *an, unsigned int c);
+extern void GBFGetFloats(gbfreader * pr, float *ar, unsigned int c);
+extern float GBFGetFloat(gbfreader * pr);
+/* The string is allocated with g_malloc() */
+extern char *GBFGetString(gbfreader * pr);
+
+#endif                          /* GBF_H */
@@ -156,6 +156,14 @@ g_list_free_full(GList * list, GDestroyNotify free_func)
 }
 #endif
 
+#if ! GLIB_CHECK_VERSION(2,22,0)
+void
+g_mapped_file_unref(GMappedFile * file)
+{
+    g_mapped_file_free(file);
+}
+#endif
+
 void
 g_value_unsetfree(GValue * gv)
 {
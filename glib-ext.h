@@ -52,6 +52,10 @@ void g_once_init_leave(volatile gsize * value_location, gsize initialization_val
 extern void g_list_free_full(GList * list, GDestroyNotify free_func);
 #endif
 
+#if ! GLIB_CHECK_VERSION(2,22,0)
+extern void g_mapped_file_unref(GMappedFile * file);
+#endif
+
 extern FILE *gnubg_g_fopen(const gchar * filename, const gchar * mode);
 
 typedef GList GMap;
@@ -63,6 +63,7 @@ static char szCommandSeparators[] = " \t\n\r\v\f";
 #include "render.h"
 #include "renderprefs.h"
 #include "rollout.h"
+#include "rolloutworker.h"
 #include "sound.h"
 #include "progress.h"
 #include "osr.h"
@@ -486,6 +487,7 @@ static char szDICE[] = N_("<die> <die>"),
     szCOMMENT[] = N_("<comment>"),
     szER[] = "evaluation|rollout",
     szFILENAME[] = N_("<filename>"),
+    szIMPORTBATCH[] = N_("<directory>|<file list> [analyse]"),
     szKEYVALUE[] = N_("[<key>=<value> ...]"),
     szLENGTH[] = N_("<length>"),
     szLIMIT[] = N_("<limit>"),
@@ -513,10 +515,12 @@ static char szDICE[] = N_("<die> <die>"),
     szPLIES[] = N_("<plies>"),
     szPOSITION[] = N_("<position>"),
     szPRIORITY[] = N_("<priority>"),
+    szPROCESSES[] = N_("<processes>"),
     szPROMPT[] = N_("<prompt>"),
     szSCORE[] = N_("<score> [length]"),
     szSIZE[] = N_("<size>"),
     szSTEP[] = N_("[game|roll|rolled|marked] <count>"),
+    szTHREADS[] = N_("<threads>|auto"),
     szTRIALS[] = N_("<trials>"),
     szVALUE[] = N_("<value>"),
     szMATCHID[] = N_("<matchid>"),
@@ -1305,7 +1309,7 @@ extern char *
 GetLuckAnalysis(const matchstate * pms, float rLuck)
 {
 
-    static char sz[16];
+    MT_STATIC_BUFFER(sz, 16);
     cubeinfo ci;
 
     if (fOutputMWC && pms->nMatchTo) {
@@ -2852,6 +2856,9 @@ SaveRNGSettings(FILE * pf, const char *sz, rng rngCurrent, rngcontext * rngctx)
     case RNG_MERSENNE:
         fprintf(pf, "%s rng mersenne\n", sz);
         break;
+    case RNG_PHILOX:
+        fprintf(pf, "%s rng philox\n", sz);
+        break;
     case RNG_RANDOM_DOT_ORG:
         fprintf(pf, "%s rng random.org\n", sz);
         break;
@@ -3238,11 +3245,17 @@ SaveEvaluationSettings(FILE * pf)
     SaveEvalSetupSettings(pf, "set evaluation cubedecision", &esEvalCube);
     SaveMoveFilterSettings(pf, "set evaluation movefilter", aamfEval);
     fprintf(pf, "set cache %u\n", GetEvalCacheEntries());
+    fprintf(pf, "set osrtrials %u\n", nOSRTrials);
     fprintf(pf, "set matchequitytable \"%s\"\n", miCurrent.szFileName);
     fprintf(pf, "set invert matchequitytable %s\n", fInvertMET ? "on" : "off");
 #if defined(USE_MULTITHREAD)
-    fprintf(pf, "set threads %u\n", MT_GetNumThreads());
+    if (MT_GetAutoThreads())
+        fputs("set threads auto\n", pf);
+    else
+        fprintf(pf, "set threads %u\n", MT_GetNumThreads());
+    fprintf(pf, "set numa %s\n", aszNUMAMode[MT_GetNUMA()]);
 #endif
+    fprintf(pf, "set rollout workers %u\n", cRolloutWorkers);
 }
 
 static void
@@ -4534,6 +4547,7 @@ main(int argc, char *argv[])
 
     static char *pchCommands = NULL, *pchPythonScript = NULL, *lang = NULL;
     static int fNoBearoff = FALSE, fNoX = FALSE, fSplash = FALSE, fNoTTY = FALSE, show_version = FALSE, debug = FALSE;
+    static int fRolloutWorker = FALSE;
     GOptionEntry ao[] = {
         {"no-bearoff", 'b', 0, G_OPTION_ARG_NONE, &fNoBearoff,
          N_("Do not use bearoff database"), NULL},
@@ -4566,6 +4580,8 @@ main(int argc, char *argv[])
          N_("Specify location of program documentation"), NULL},
         {"prefsdir", 's', 0, G_OPTION_ARG_STRING, &prefsdir,
          N_("Specify location of user's preferences directory"), NULL},
+        {"rollout-worker", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &fRolloutWorker,
+         N_("Play rollout games for another gnubg on standard input and output"), NULL},
         {NULL, 0, 0, G_OPTION_ARG_NONE, NULL, NULL, NULL}
     };
     GError *error = NULL;
@@ -4614,6 +4630,8 @@ main(int argc, char *argv[])
     if (!debug)
         g_log_set_handler(NULL, G_LOG_LEVEL_DEBUG, &null_debug, NULL);
 
+    RolloutWorkerSetProgram(argv[0], fNoBearoff);
+
     if (prefsdir) {
         szHomeDirectory = prefsdir;
     }
@@ -4704,10 +4722,18 @@ main(int argc, char *argv[])
     fflush(stderr);
 
 #if defined(USE_MULTITHREAD)
-    /* Make sure threads started */
-    MT_StartThreads();
+    /* Make sure threads started; a rollout worker is one of several
+     * processes, so it plays its games on one */
+    if (fRolloutWorker)
+        MT_SetNumThreads(1);
+    else
+        MT_StartThreads();
 #endif
 
+    /* --rollout-worker option given */
+    if (fRolloutWorker)
+        exit(RolloutWorkerMain());
+
     /* start-up sound */
     playSound(SOUND_START);
 
@@ -5233,12 +5259,11 @@ EPC(const TanBoard anBoard, float *arEPC, float *arMu, float *arSigma, int *pfSo
 
         /* one-sided rollout */
 
-        int nTrials = 5760;
         float arMux[2];
         float ar[5];
         int i;
 
-        raceProbs(anBoard, nTrials, ar, arMux);
+        raceProbs(anBoard, nOSRTrials, ar, arMux);
 
         for (i = 0; i < 2; ++i) {
             if (arEPC)
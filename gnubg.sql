@@ -322,3 +322,45 @@ CREATE TABLE gamestat (
 CREATE UNIQUE INDEX isgamestat ON gamestat (
     gamestat_id
 );
+
+-- Table: position
+-- Rollouts of positions, so that they can be looked up and extended
+-- instead of being rolled out again.  A rollout is identified by the
+-- position, the cube, score and rules it is rolled out with, and the
+-- settings that decide its result.
+
+CREATE TABLE position (
+    position_id                      INTEGER NOT NULL
+   -- GNU Backgammon position id of the board
+   ,gnubg_id                         CHAR(14) NOT NULL
+   -- cube, score and rules
+   ,context                          VARCHAR(128) NOT NULL
+   -- checksum of the rollout settings
+   ,setup                            CHAR(32) NOT NULL
+   -- games rolled out, and where to continue from
+   ,trials                           INTEGER NOT NULL
+   ,dice_skip                        INTEGER NOT NULL
+   ,stopped_on_jsd                   FLOAT   NOT NULL
+   -- the results
+   ,output_win                       FLOAT   NOT NULL
+   ,output_win_gammon                FLOAT   NOT NULL
+   ,output_win_backgammon            FLOAT   NOT NULL
+   ,output_lose_gammon               FLOAT   NOT NULL
+   ,output_lose_backgammon           FLOAT   NOT NULL
+   ,output_equity                    FLOAT   NOT NULL
+   ,output_cubeful_equity            FLOAT   NOT NULL
+   ,stddev_win                       FLOAT   NOT NULL
+   ,stddev_win_gammon                FLOAT   NOT NULL
+   ,stddev_win_backgammon            FLOAT   NOT NULL
+   ,stddev_lose_gammon               FLOAT   NOT NULL
+   ,stddev_lose_backgammon           FLOAT   NOT NULL
+   ,stddev_equity                    FLOAT   NOT NULL
+   ,stddev_cubeful_equity            FLOAT   NOT NULL
+   -- Timestamp of the last update
+   ,added                            TIMESTAMP NOT NULL
+   ,PRIMARY KEY (position_id)
+);
+
+CREATE INDEX iposition ON position (
+    gnubg_id, context, setup
+);
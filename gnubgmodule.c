@@ -34,8 +34,12 @@
 #include "eval.h"
 #include "matchequity.h"
 #include "positionid.h"
+#include "export.h"
+#include "rolls.h"
+#include "tempmap.h"
 #include "matchid.h"
 #include "util.h"
+#include "multithread.h"
 #include "lib/gnubg-types.h"
 #include "lib/simd.h"
 
@@ -1362,6 +1366,482 @@ PythonFindBestMove(PyObject * UNUSED(self), PyObject * args)
     }
 }
 
+/*
+ * Batched evaluation.  The positions are read from, and the results
+ * written to, contiguous buffers (array.array, numpy arrays, ...) with
+ * no conversion to and from Python objects, and the positions are
+ * shared out between the threads with the GIL released.
+ */
+
+typedef struct _batchdata {
+    const unsigned int *pnBoards;       /* n x 2 x 25 */
+    const int *pnDice;          /* n x 2, findbestmove only */
+    float *prOutput;            /* n x NUM_ROLLOUT_OUTPUTS, evaluate only */
+    int *pnMoves;               /* n x 8, findbestmove only */
+    Py_ssize_t n;
+    int iNext;
+    const cubeinfo *pci;
+    const evalcontext *pec;
+    movefilter(*aamf)[MAX_FILTER_PLIES];
+} batchdata;
+
+/* Get a C contiguous buffer of items of type ch ('i' or 'f') holding
+ * records of cPer items, n records unless n is -1.  Returns the number
+ * of records, or -1 with an exception set (the buffer is then not
+ * held). */
+
+static Py_ssize_t
+GetBatchBuffer(PyObject * p, Py_buffer * pview, char ch, int fWritable, Py_ssize_t cPer, Py_ssize_t n,
+               const char *szName)
+{
+    const char *pchFormat;
+    Py_ssize_t c;
+
+    if (PyObject_GetBuffer(p, pview, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (fWritable ? PyBUF_WRITABLE : 0)) < 0)
+        return -1;
+
+    pchFormat = pview->format ? pview->format : "B";
+    if (*pchFormat == '@' || *pchFormat == '=')
+        pchFormat++;
+
+    if (pchFormat[0] != ch || pchFormat[1] || pview->itemsize != (ch == 'f' ? sizeof(float) : sizeof(int))
+        || (pview->len / pview->itemsize) % cPer) {
+        PyErr_Format(PyExc_ValueError, _("%s must be a contiguous buffer of type '%c' holding a multiple "
+                                         "of %d items"), szName, ch, (int) cPer);
+        PyBuffer_Release(pview);
+        return -1;
+    }
+
+    c = pview->len / pview->itemsize / cPer;
+
+    if (n >= 0 && c != n) {
+        PyErr_Format(PyExc_ValueError, _("%s must hold %d records of %d items"), szName, (int) n, (int) cPer);
+        PyBuffer_Release(pview);
+        return -1;
+    }
+
+    return c;
+}
+
+static int
+CheckBatchBoards(const unsigned int *pn, Py_ssize_t n)
+{
+    Py_ssize_t i;
+    int j;
+
+    for (i = 0; i < 2 * n; ++i, pn += 25) {
+        unsigned int c = 0;
+
+        for (j = 0; j < 25; ++j) {
+            if (pn[j] > 15)
+                break;
+            c += pn[j];
+        }
+
+        if (j < 25 || c > 15) {
+            PyErr_Format(PyExc_ValueError, _("board %d has more than 15 chequers for player %d"),
+                         (int) (i / 2), (int) (i % 2));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int
+CheckBatchDice(const int *pn, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < 2 * n; ++i)
+        if (pn[i] < 1 || pn[i] > 6) {
+            PyErr_Format(PyExc_ValueError, _("invalid dice for board %d"), (int) (i / 2));
+            return -1;
+        }
+
+    return 0;
+}
+
+static void
+EvaluateBatchMT(batchdata * pbd)
+{
+    Py_ssize_t i;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+
+    while ((i = MT_SafeIncCheck(&pbd->iNext)) < pbd->n && !fInterrupt) {
+        if (GeneralEvaluationE(ar, (ConstTanBoard) (pbd->pnBoards + 50 * i), (cubeinfo *) pbd->pci, pbd->pec) < 0) {
+            MT_SetResultFailed();
+            return;
+        }
+        memcpy(pbd->prOutput + NUM_ROLLOUT_OUTPUTS * i, ar, sizeof(ar));
+    }
+}
+
+static void
+FindBestMoveBatchMT(batchdata * pbd)
+{
+    Py_ssize_t i;
+    movelist ml;
+    int k;
+
+    while ((i = MT_SafeIncCheck(&pbd->iNext)) < pbd->n && !fInterrupt) {
+        const int *pnDice = pbd->pnDice + 2 * i;
+        int *pnMove = pbd->pnMoves + 8 * i;
+
+        if (FindnSaveBestMoves(&ml, pnDice[0], pnDice[1], (ConstTanBoard) (pbd->pnBoards + 50 * i), NULL, 0.0f,
+                               pbd->pci, pbd->pec, pbd->aamf) < 0) {
+            MT_SetResultFailed();
+            return;
+        }
+
+        /* as findbestmove(): 1 based points, unused moves zero */
+        for (k = 0; k < 8; ++k)
+            pnMove[k] = ml.cMoves ? ml.amMoves[0].anMove[k] + 1 : 0;
+
+        if (ml.cMoves)
+            free(ml.amMoves);
+    }
+}
+
+static gboolean
+BatchCallback(gpointer UNUSED(unused))
+{
+    return TRUE;
+}
+
+/* Run pfun on all the threads with the GIL released */
+
+static int
+RunBatch(AsyncFun pfun, batchdata * pbd)
+{
+    int fSaveShowProg = fShowProgress;
+    int rc;
+
+    pbd->iNext = 0;
+
+    fShowProgress = FALSE;
+    Py_BEGIN_ALLOW_THREADS
+    mt_add_tasks(MT_GetNumThreads(), pfun, pbd, NULL);
+    rc = MT_WaitForTasks(BatchCallback, 1000, FALSE);
+    Py_END_ALLOW_THREADS
+    fShowProgress = fSaveShowProg;
+
+    if (rc || fInterrupt) {
+        ResetInterrupt();
+        PyErr_SetString(PyExc_StandardError, _("interrupted/error in batch evaluation"));
+        return -1;
+    }
+
+    return 0;
+}
+
+SIMD_STACKALIGN static PyObject *
+PythonEvaluateBatch(PyObject * UNUSED(self), PyObject * args)
+{
+    PyObject *pyBoards, *pyOutput;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+    Py_buffer viewBoards, viewOutput;
+    batchdata bd;
+    cubeinfo ci;
+    evalcontext ec;
+    int rc;
+
+    memcpy(&ec, &GetEvalChequer()->ec, sizeof(evalcontext));
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "OO|OO", &pyBoards, &pyOutput, &pyCubeInfo, &pyEvalContext))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    if ((bd.n = GetBatchBuffer(pyBoards, &viewBoards, 'i', FALSE, 50, -1, "boards")) < 0)
+        return NULL;
+
+    if (GetBatchBuffer(pyOutput, &viewOutput, 'f', TRUE, NUM_ROLLOUT_OUTPUTS, bd.n, "output") < 0) {
+        PyBuffer_Release(&viewBoards);
+        return NULL;
+    }
+
+    bd.pnBoards = viewBoards.buf;
+    bd.prOutput = viewOutput.buf;
+    bd.pci = &ci;
+    bd.pec = &ec;
+
+    if ((rc = CheckBatchBoards(bd.pnBoards, bd.n)) == 0)
+        rc = RunBatch((AsyncFun) EvaluateBatchMT, &bd);
+
+    PyBuffer_Release(&viewOutput);
+    PyBuffer_Release(&viewBoards);
+
+    if (rc)
+        return NULL;
+
+    return PyInt_FromLong((long) bd.n);
+}
+
+SIMD_STACKALIGN static PyObject *
+PythonFindBestMoveBatch(PyObject * UNUSED(self), PyObject * args)
+{
+    PyObject *pyBoards, *pyDice, *pyMoves;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+    PyObject *pyMoveFilters = NULL;
+    Py_buffer viewBoards, viewDice, viewMoves;
+    batchdata bd;
+    cubeinfo ci;
+    evalcontext ec;
+    TmoveFilter aamf;
+    int rc;
+
+    memcpy(&ec, &GetEvalChequer()->ec, sizeof(evalcontext));
+    /* a copy, as movefilters changes it */
+    memcpy(aamf, *GetEvalMoveFilter(), sizeof(TmoveFilter));
+    bd.aamf = aamf;
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "OOO|OOO", &pyBoards, &pyDice, &pyMoves, &pyCubeInfo, &pyEvalContext, &pyMoveFilters))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    if (pyMoveFilters && PyToMoveFilters(pyMoveFilters, bd.aamf))
+        return NULL;
+
+    if ((bd.n = GetBatchBuffer(pyBoards, &viewBoards, 'i', FALSE, 50, -1, "boards")) < 0)
+        return NULL;
+
+    if (GetBatchBuffer(pyDice, &viewDice, 'i', FALSE, 2, bd.n, "dice") < 0) {
+        PyBuffer_Release(&viewBoards);
+        return NULL;
+    }
+
+    if (GetBatchBuffer(pyMoves, &viewMoves, 'i', TRUE, 8, bd.n, "moves") < 0) {
+        PyBuffer_Release(&viewDice);
+        PyBuffer_Release(&viewBoards);
+        return NULL;
+    }
+
+    bd.pnBoards = viewBoards.buf;
+    bd.pnDice = viewDice.buf;
+    bd.pnMoves = viewMoves.buf;
+    bd.pci = &ci;
+    bd.pec = &ec;
+
+    if ((rc = CheckBatchBoards(bd.pnBoards, bd.n)) == 0 && (rc = CheckBatchDice(bd.pnDice, bd.n)) == 0)
+        rc = RunBatch((AsyncFun) FindBestMoveBatchMT, &bd);
+
+    PyBuffer_Release(&viewMoves);
+    PyBuffer_Release(&viewDice);
+    PyBuffer_Release(&viewBoards);
+
+    if (rc)
+        return NULL;
+
+    return PyInt_FromLong((long) bd.n);
+}
+
+static PyObject *
+RollsToPy(const rollstree * prt, const rollsnode * prn, const unsigned int nLevel, const unsigned int nDepth)
+{
+    TanBoard anBoard;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    char szMove[100];
+    PyObject *pyRolls = PyList_New(21);
+    unsigned int i;
+
+    PositionFromKey(anBoard, &prn->key);
+
+    for (i = 0; i < 21; ++i) {
+        const rollsnode *prnChild = &prn->arnChild[i];
+        PyObject *pyRoll;
+
+        RollsNodeValue(prt, prnChild, nLevel + 1, nDepth, ar);
+        FormatMove(szMove, (ConstTanBoard) anBoard, (int *) prnChild->anMove);
+
+        pyRoll = Py_BuildValue("{s:(i,i),s:s,s:f}", "dice", aanRollsDice[i][0], aanRollsDice[i][1],
+                               "move", szMove, "equity", ar[OUTPUT_CUBEFUL_EQUITY]);
+
+        if (nLevel + 1 < nDepth)
+            DictSetItemSteal(pyRoll, "rolls", RollsToPy(prt, prnChild, nLevel + 1, nDepth));
+
+        PyList_SET_ITEM(pyRolls, i, pyRoll);
+    }
+
+    return pyRolls;
+}
+
+static PyObject *
+PythonRolls(PyObject * UNUSED(self), PyObject * args)
+{
+
+    PyObject *pyBoard = NULL;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+
+    static evalcontext ec0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
+    int nDepth = 1;
+    int fSaveShowProg;
+    TanBoard anBoard;
+    cubeinfo ci;
+    evalcontext ec;
+    rollstree *prt;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    PyObject *p;
+
+    memcpy(&ec, &ec0ply, sizeof(evalcontext));
+    memcpy(anBoard, msBoard(), sizeof(TanBoard));
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "|iOOO", &nDepth, &pyBoard, &pyCubeInfo, &pyEvalContext))
+        return NULL;
+
+    if (nDepth < 1) {
+        PyErr_SetString(PyExc_ValueError, _("depth must be at least 1"));
+        return NULL;
+    }
+
+    if (pyBoard && !PyToBoard(pyBoard, anBoard))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    /* a second call for the same position reuses the levels already
+     * calculated */
+
+    prt = RollsTreeGet((ConstTanBoard) anBoard, &ci, &ec);
+
+    fSaveShowProg = fShowProgress;
+    fShowProgress = FALSE;
+    if (RollsTreeExpand(prt, (unsigned int) nDepth) < 0 || fInterrupt) {
+        fShowProgress = fSaveShowProg;
+        ResetInterrupt();
+        PyErr_SetString(PyExc_StandardError, _("interrupted/errno in RollsTreeExpand"));
+        return NULL;
+    }
+    fShowProgress = fSaveShowProg;
+
+    RollsNodeValue(prt, &prt->rnRoot, 0, (unsigned int) nDepth, ar);
+
+    p = Py_BuildValue("{s:f}", "equity", ar[OUTPUT_CUBEFUL_EQUITY]);
+    DictSetItemSteal(p, "rolls", RollsToPy(prt, &prt->rnRoot, 0, (unsigned int) nDepth));
+
+    return p;
+}
+
+#if defined(HAVE_LIBPNG)
+static PyObject *
+PythonPositionPNG(PyObject * UNUSED(self), PyObject * args)
+{
+
+    PyObject *pyBoard = NULL;
+    int nSize = exsExport.nPNGSize;
+    TanBoard anBoard;
+    unsigned char *puch;
+    gsize cb;
+    PyObject *p;
+
+    memcpy(anBoard, msBoard(), sizeof(TanBoard));
+
+    if (!PyArg_ParseTuple(args, "|Oi", &pyBoard, &nSize))
+        return NULL;
+
+    if (pyBoard && !PyToBoard(pyBoard, anBoard))
+        return NULL;
+
+    if (nSize < 1 || nSize > 20) {
+        PyErr_SetString(PyExc_ValueError, _("size must be between 1 and 20"));
+        return NULL;
+    }
+
+    if (!(puch = PositionPNGData((ConstTanBoard) anBoard, (unsigned int) nSize, &cb))) {
+        PyErr_SetString(PyExc_StandardError, _("failed to render position"));
+        return NULL;
+    }
+
+    p = PyBytes_FromStringAndSize((const char *) puch, (Py_ssize_t) cb);
+    g_free(puch);
+
+    return p;
+}
+#endif
+
+static PyObject *
+PythonTemperatureMap(PyObject * UNUSED(self), PyObject * args)
+{
+
+    PyObject *pyBoard = NULL;
+    PyObject *pyCubeInfo = NULL;
+    PyObject *pyEvalContext = NULL;
+
+    static evalcontext ec0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
+    int fSaveShowProg;
+    tempmapdata tmd;
+    evalcontext ec;
+    char szMove[100];
+    float rAverage = 0.0f;
+    PyObject *pyEquity, *pyMove;
+    int i, j;
+
+    memcpy(&ec, &ec0ply, sizeof(evalcontext));
+    memcpy(tmd.anBoard, msBoard(), sizeof(TanBoard));
+    GetMatchStateCubeInfo(&tmd.ci, &ms);
+
+    if (!PyArg_ParseTuple(args, "|OOO", &pyBoard, &pyCubeInfo, &pyEvalContext))
+        return NULL;
+
+    if (pyBoard && !PyToBoard(pyBoard, tmd.anBoard))
+        return NULL;
+
+    if (pyCubeInfo && PyToCubeInfo(pyCubeInfo, &tmd.ci))
+        return NULL;
+
+    if (pyEvalContext && PyToEvalContext(pyEvalContext, &ec))
+        return NULL;
+
+    fSaveShowProg = fShowProgress;
+    fShowProgress = FALSE;
+    if (CalcTempMap(&tmd, 1, &ec) < 0 || fInterrupt) {
+        fShowProgress = fSaveShowProg;
+        ResetInterrupt();
+        PyErr_SetString(PyExc_StandardError, _("interrupted/errno in CalcTempMap"));
+        return NULL;
+    }
+    fShowProgress = fSaveShowProg;
+
+    pyEquity = PyTuple_New(6);
+    pyMove = PyTuple_New(6);
+
+    for (i = 0; i < 6; ++i) {
+        PyObject *pyEquityRow = PyTuple_New(6);
+        PyObject *pyMoveRow = PyTuple_New(6);
+
+        for (j = 0; j < 6; ++j) {
+            rAverage += tmd.aarEquity[i][j];
+            PyTuple_SET_ITEM(pyEquityRow, j, PyFloat_FromDouble(tmd.aarEquity[i][j]));
+            FormatMove(szMove, (ConstTanBoard) tmd.anBoard, tmd.aaanMove[i][j]);
+            PyTuple_SET_ITEM(pyMoveRow, j, PyUnicode_FromString(szMove));
+        }
+
+        PyTuple_SET_ITEM(pyEquity, i, pyEquityRow);
+        PyTuple_SET_ITEM(pyMove, i, pyMoveRow);
+    }
+
+    return Py_BuildValue("{s:f,s:N,s:N}", "average", rAverage / 36.0f, "equity", pyEquity, "move", pyMove);
+}
+
 static PyObject *
 METRow(float ar[MAXSCORE], const int n)
 {
@@ -2521,24 +3001,93 @@ PyGameStats(const statcontext * sc, const int fIsMatch, const int nMatchTo)
  * scMatch: if non-0, add game & match statistics.
  */
 
+/* An array of n x cPer 4 byte items (szFormat "i" or "f") as a single
+ * object supporting the buffer protocol: a memoryview of that shape
+ * where available, otherwise a bytes object */
+
 static PyObject *
-PythonGame(const listOLD * plGame,
-           int const doAnalysis, int const verbose, statcontext * scMatch, int const includeBoards, PyMatchState * ms)
+PyBufferFromArray(const void *p, Py_ssize_t n, Py_ssize_t cPer, const char *szFormat)
 {
-    const listOLD *pl = plGame->plNext;
-    const moverecord *pmr = pl->p;
-    const xmovegameinfo *g = &pmr->g;
-
-    PyObject *gameDict = PyDict_New();
-    PyObject *gameInfoDict = PyDict_New();
+    PyObject *pyBytes = PyBytes_FromStringAndSize((const char *) p, n * cPer * 4);
+#if PY_VERSION_HEX >= 0x03030000
+    PyObject *pyView, *pyCast;
 
-    g_assert(pmr->mt == MOVE_GAMEINFO);
+    if (!pyBytes)
+        return 0;
 
-    if (!(gameDict && gameInfoDict)) {
-        PyErr_SetString(PyExc_MemoryError, "");
+    pyView = PyMemoryView_FromObject(pyBytes);
+    Py_DECREF(pyBytes);
+    if (!pyView)
         return 0;
+
+    if (cPer > 1)
+        pyCast = PyObject_CallMethod(pyView, "cast", "s(nn)", szFormat, n, cPer);
+    else
+        pyCast = PyObject_CallMethod(pyView, "cast", "s", szFormat);
+    Py_DECREF(pyView);
+
+    return pyCast;
+#else
+    (void) szFormat;
+    return pyBytes;
+#endif
+}
+
+/* The move analysis of PyMoveAnalysis(), but for all the moves of the
+ * list and with each field as one buffer instead of a tuple of
+ * dictionaries */
+
+static PyObject *
+PyMoveAnalysisBuffers(const movelist * pml)
+{
+    Py_ssize_t n = pml->cMoves;
+    int *anMoves = g_new(int, 8 * n);
+    int *anTypes = g_new(int, n);
+    float *arOutputs = g_new(float, NUM_ROLLOUT_OUTPUTS * n);
+    float *arStdDevs = g_new(float, NUM_ROLLOUT_OUTPUTS * n);
+    float *arScores = g_new(float, n);
+    int fRollout = FALSE;
+    Py_ssize_t i;
+    int k;
+    PyObject *d;
+
+    for (i = 0; i < n; i++) {
+        const move *pm = &pml->amMoves[i];
+
+        for (k = 0; k < 8; ++k)
+            anMoves[8 * i + k] = pm->anMove[k] + 1;
+        anTypes[i] = pm->esMove.et;
+        memcpy(arOutputs + NUM_ROLLOUT_OUTPUTS * i, pm->arEvalMove, sizeof(pm->arEvalMove));
+        memcpy(arStdDevs + NUM_ROLLOUT_OUTPUTS * i, pm->arEvalStdDev, sizeof(pm->arEvalStdDev));
+        arScores[i] = pm->rScore;
+        fRollout |= pm->esMove.et == EVAL_ROLLOUT;
     }
 
+    d = PyDict_New();
+    DictSetItemSteal(d, "moves", PyBufferFromArray(anMoves, n, 8, "i"));
+    DictSetItemSteal(d, "types", PyBufferFromArray(anTypes, n, 1, "i"));
+    DictSetItemSteal(d, "outputs", PyBufferFromArray(arOutputs, n, NUM_ROLLOUT_OUTPUTS, "f"));
+    if (fRollout)
+        DictSetItemSteal(d, "stddevs", PyBufferFromArray(arStdDevs, n, NUM_ROLLOUT_OUTPUTS, "f"));
+    DictSetItemSteal(d, "scores", PyBufferFromArray(arScores, n, 1, "f"));
+
+    g_free(anMoves);
+    g_free(anTypes);
+    g_free(arOutputs);
+    g_free(arStdDevs);
+    g_free(arScores);
+
+    return d;
+}
+
+static PyObject *
+PyGameInfo(const xmovegameinfo * g)
+{
+    PyObject *gameInfoDict = PyDict_New();
+
+    if (!gameInfoDict)
+        return 0;
+
     DictSetItemSteal(gameInfoDict, "score-X", PyInt_FromLong(g->anScore[0]));
     DictSetItemSteal(gameInfoDict, "score-O", PyInt_FromLong(g->anScore[1]));
 
@@ -2564,245 +3113,276 @@ PythonGame(const listOLD * plGame,
         DictSetItemSteal(gameInfoDict, "initial-cube", PyInt_FromLong(1 << g->nAutoDoubles));
     }
 
-    DictSetItemSteal(gameDict, "info", gameInfoDict);
-
-    if (scMatch) {
-        updateStatisticsGame(plGame);
+    return gameInfoDict;
+}
 
-        AddStatcontext(&g->sc, scMatch);
+/* One move record as a dictionary; anBoard is the board before it,
+ * and is updated if includeBoards is set */
 
+static PyObject *
+PyMoveRecord(const moverecord * pmr, TanBoard anBoard,
+             int const doAnalysis, int const verbose, int const includeBoards, int const fBuffers, PyMatchState * ms)
+{
+    const char *action = 0;
+    int player = -1;
+    long points = -1;
+    PyObject *recordDict = PyDict_New();
+    PyObject *analysis = doAnalysis ? PyDict_New() : 0;
+
+    switch (pmr->mt) {
+    case MOVE_NORMAL:
         {
-            PyObject *s = PyGameStats(&g->sc, FALSE, g->nMatch);
+            action = "move";
+            player = pmr->fPlayer;
 
-            if (s) {
-                DictSetItemSteal(gameDict, "stats", s);
+            {
+                PyObject *dice = Py_BuildValue("(ii)",
+                                               pmr->anDice[0], pmr->anDice[1]);
+
+
+                DictSetItemSteal(recordDict, "dice", dice);
             }
-        }
-    }
 
-    {
-        int nRecords = 0;
-        TanBoard anBoard;
-        PyObject *gameTuple;
+            DictSetItemSteal(recordDict, "move", PyMove(pmr->n.anMove));
 
-        {
-            listOLD *t;
-            for (t = pl->plNext; t != plGame; t = t->plNext) {
-                ++nRecords;
+            if (includeBoards) {
+                DictSetItemSteal(recordDict, "board", PyUnicode_FromString(PositionID((ConstTanBoard) anBoard)));
+
+                ApplyMove(anBoard, pmr->n.anMove, 0);
+                SwapSides(anBoard);
             }
-        }
 
-        gameTuple = PyTuple_New(nRecords);
+            if (analysis) {
+                if (pmr->CubeDecPtr->esDouble.et != EVAL_NONE) {
+                    PyObject *d = PyDoubleAnalysis(&pmr->CubeDecPtr->esDouble,
+                                                   pmr->CubeDecPtr->aarOutput,
+                                                   pmr->CubeDecPtr->aarStdDev,
+                                                   ms, verbose);
+                    {
+                        int s = PyDict_Merge(analysis, d, 1);
+                        g_assert(s != -1);
+                        (void) s;
+                    }
+                    Py_DECREF(d);
+                }
 
-        nRecords = 0;
 
-        if (includeBoards) {
-            InitBoard(anBoard, g->bgv);
-        }
+                if (pmr->ml.cMoves) {
+                    PyObject *a = fBuffers ? PyMoveAnalysisBuffers(&pmr->ml) : PyMoveAnalysis(&pmr->ml, ms);
 
-        for (pl = pl->plNext; pl != plGame; pl = pl->plNext) {
-            const char *action = 0;
-            int player = -1;
-            long points = -1;
-            PyObject *recordDict = PyDict_New();
-            PyObject *analysis = doAnalysis ? PyDict_New() : 0;
+                    if (a) {
+                        DictSetItemSteal(analysis, "moves", a);
 
-            pmr = pl->p;
+                        DictSetItemSteal(analysis, "imove", PyInt_FromLong(pmr->n.iMove));
+                    }
+                }
 
-            switch (pmr->mt) {
-            case MOVE_NORMAL:
-                {
-                    action = "move";
-                    player = pmr->fPlayer;
+                addLuck(analysis, pmr->rLuck, pmr->lt);
+                addSkill(analysis, pmr->n.stMove, 0);
+                addSkill(analysis, pmr->stCube, "cube-skill");
+            }
 
-                    {
-                        PyObject *dice = Py_BuildValue("(ii)",
-                                                       pmr->anDice[0], pmr->anDice[1]);
+            break;
+        }
+    case MOVE_DOUBLE:
+        {
+            action = "double";
+            player = pmr->fPlayer;
 
+            if (includeBoards) {
+                DictSetItemSteal(recordDict, "board", PyUnicode_FromString(PositionID((ConstTanBoard) anBoard)));
+            }
 
-                        DictSetItemSteal(recordDict, "dice", dice);
+            if (analysis) {
+                cubedecisiondata *c = pmr->CubeDecPtr;
+                if (c->esDouble.et != EVAL_NONE) {
+                    PyObject *d = PyDoubleAnalysis(&c->esDouble, c->aarOutput,
+                                                   c->aarStdDev, ms, verbose);
+                    {
+                        int s = PyDict_Merge(analysis, d, 1);
+                        g_assert(s != -1);
+                        (void) s;
                     }
+                    Py_DECREF(d);
+                }
 
-                    DictSetItemSteal(recordDict, "move", PyMove(pmr->n.anMove));
+                addSkill(analysis, pmr->stCube, 0);
+            }
 
-                    if (includeBoards) {
-                        DictSetItemSteal(recordDict, "board", PyUnicode_FromString(PositionID((ConstTanBoard) anBoard)));
+            break;
+        }
+    case MOVE_TAKE:
+        {
+            action = "take";
+            player = pmr->fPlayer;
 
-                        ApplyMove(anBoard, pmr->n.anMove, 0);
-                        SwapSides(anBoard);
-                    }
+            /* use nAnimals to point to double analysis ? */
 
-                    if (analysis) {
-                        if (pmr->CubeDecPtr->esDouble.et != EVAL_NONE) {
-                            PyObject *d = PyDoubleAnalysis(&pmr->CubeDecPtr->esDouble,
-                                                           pmr->CubeDecPtr->aarOutput,
-                                                           pmr->CubeDecPtr->aarStdDev,
-                                                           ms, verbose);
-                            {
-                                int s = PyDict_Merge(analysis, d, 1);
-                                g_assert(s != -1);
-                                (void) s;
-                            }
-                            Py_DECREF(d);
-                        }
+            addSkill(analysis, pmr->stCube, 0);
+
+            break;
+        }
+    case MOVE_DROP:
+        {
+            action = "drop";
+            player = pmr->fPlayer;
+
+            addSkill(analysis, pmr->stCube, 0);
+
+            break;
+        }
+    case MOVE_RESIGN:
+        {
+            action = "resign";
+            player = pmr->fPlayer;
+            points = pmr->r.nResigned;
+            if (points < 1)
+                points = 1;
+            else if (points > 3)
+                points = 3;
+            break;
+        }
 
+    case MOVE_SETBOARD:
+        {
+            PyObject *id = PyUnicode_FromString(PositionIDFromKey(&pmr->sb.key));
 
-                        if (pmr->ml.cMoves) {
-                            PyObject *a = PyMoveAnalysis(&pmr->ml, ms);
+            action = "set";
 
-                            if (a) {
-                                DictSetItemSteal(analysis, "moves", a);
+            DictSetItemSteal(recordDict, "board", id);
 
-                                DictSetItemSteal(analysis, "imove", PyInt_FromLong(pmr->n.iMove));
-                            }
-                        }
+            if (includeBoards) {
+                /* (FIXME) what about side? */
+                /* JTH: the board is always stored as if player 0 was on roll */
+                PositionFromKey(anBoard, &pmr->sb.key);
+            }
 
-                        addLuck(analysis, pmr->rLuck, pmr->lt);
-                        addSkill(analysis, pmr->n.stMove, 0);
-                        addSkill(analysis, pmr->stCube, "cube-skill");
-                    }
+            break;
+        }
 
-                    break;
-                }
-            case MOVE_DOUBLE:
-                {
-                    action = "double";
-                    player = pmr->fPlayer;
+    case MOVE_SETDICE:
+        {
+            PyObject *dice;
 
-                    if (includeBoards) {
-                        DictSetItemSteal(recordDict, "board", PyUnicode_FromString(PositionID((ConstTanBoard) anBoard)));
-                    }
+            player = pmr->fPlayer;
+            action = "set";
 
-                    if (analysis) {
-                        cubedecisiondata *c = pmr->CubeDecPtr;
-                        if (c->esDouble.et != EVAL_NONE) {
-                            PyObject *d = PyDoubleAnalysis(&c->esDouble, c->aarOutput,
-                                                           c->aarStdDev, ms, verbose);
-                            {
-                                int s = PyDict_Merge(analysis, d, 1);
-                                g_assert(s != -1);
-                                (void) s;
-                            }
-                            Py_DECREF(d);
-                        }
+            dice = Py_BuildValue("(ii)", pmr->anDice[0], pmr->anDice[1]);
 
-                        addSkill(analysis, pmr->stCube, 0);
-                    }
+            DictSetItemSteal(recordDict, "dice", dice);
 
-                    break;
-                }
-            case MOVE_TAKE:
-                {
-                    action = "take";
-                    player = pmr->fPlayer;
+            addLuck(analysis, pmr->rLuck, pmr->lt);
 
-                    /* use nAnimals to point to double analysis ? */
+            break;
+        }
 
-                    addSkill(analysis, pmr->stCube, 0);
+    case MOVE_SETCUBEVAL:
+        {
+            action = "set";
+            DictSetItemSteal(recordDict, "cube", PyInt_FromLong(pmr->scv.nCube));
+            break;
+        }
 
-                    break;
-                }
-            case MOVE_DROP:
-                {
-                    action = "drop";
-                    player = pmr->fPlayer;
+    case MOVE_SETCUBEPOS:
+        {
+            const char *s[] = { "centered", "X", "O" };
+            const char *o = s[pmr->scp.fCubeOwner + 1];
 
-                    addSkill(analysis, pmr->stCube, 0);
+            action = "set";
+            DictSetItemSteal(recordDict, "cube-owner", PyUnicode_FromString(o));
+            break;
+        }
 
-                    break;
-                }
-            case MOVE_RESIGN:
-                {
-                    action = "resign";
-                    player = pmr->fPlayer;
-                    points = pmr->r.nResigned;
-                    if (points < 1)
-                        points = 1;
-                    else if (points > 3)
-                        points = 3;
-                    break;
-                }
+    default:
+        {
+            g_assert_not_reached();
+        }
+    }
 
-            case MOVE_SETBOARD:
-                {
-                    PyObject *id = PyUnicode_FromString(PositionIDFromKey(&pmr->sb.key));
+    if (action) {
+        DictSetItemSteal(recordDict, "action", PyUnicode_FromString(action));
+    }
 
-                    action = "set";
+    if (player != -1) {
+        DictSetItemSteal(recordDict, "player", PyUnicode_FromString(player ? "O" : "X"));
+    }
 
-                    DictSetItemSteal(recordDict, "board", id);
+    if (points != -1) {
+        DictSetItemSteal(recordDict, "points", PyInt_FromLong(points));
+    }
 
-                    if (includeBoards) {
-                        /* (FIXME) what about side? */
-                        /* JTH: the board is always stored as if player 0 was on roll */
-                        PositionFromKey(anBoard, &pmr->sb.key);
-                    }
+    if (analysis) {
+        if (PyDict_Size(analysis) > 0) {
+            DictSetItemSteal(recordDict, "analysis", analysis);
+        } else {
+            Py_DECREF(analysis);
+            analysis = 0;
+        }
+    }
 
-                    break;
-                }
+    if (pmr->sz) {
+        DictSetItemSteal(recordDict, "comment", PyUnicode_FromString(pmr->sz));
+    }
 
-            case MOVE_SETDICE:
-                {
-                    PyObject *dice;
+    return recordDict;
+}
 
-                    player = pmr->fPlayer;
-                    action = "set";
+static PyObject *
+PythonGame(const listOLD * plGame,
+           int const doAnalysis, int const verbose, statcontext * scMatch, int const includeBoards, PyMatchState * ms)
+{
+    const listOLD *pl = plGame->plNext;
+    const moverecord *pmr = pl->p;
+    const xmovegameinfo *g = &pmr->g;
 
-                    dice = Py_BuildValue("(ii)", pmr->anDice[0], pmr->anDice[1]);
+    PyObject *gameDict = PyDict_New();
+    PyObject *gameInfoDict = PyGameInfo(g);
 
-                    DictSetItemSteal(recordDict, "dice", dice);
+    g_assert(pmr->mt == MOVE_GAMEINFO);
 
-                    addLuck(analysis, pmr->rLuck, pmr->lt);
+    if (!(gameDict && gameInfoDict)) {
+        PyErr_SetString(PyExc_MemoryError, "");
+        return 0;
+    }
 
-                    break;
-                }
+    DictSetItemSteal(gameDict, "info", gameInfoDict);
 
-            case MOVE_SETCUBEVAL:
-                {
-                    action = "set";
-                    DictSetItemSteal(recordDict, "cube", PyInt_FromLong(pmr->scv.nCube));
-                    break;
-                }
+    if (scMatch) {
+        updateStatisticsGame(plGame);
 
-            case MOVE_SETCUBEPOS:
-                {
-                    const char *s[] = { "centered", "X", "O" };
-                    const char *o = s[pmr->scp.fCubeOwner + 1];
+        AddStatcontext(&g->sc, scMatch);
 
-                    action = "set";
-                    DictSetItemSteal(recordDict, "cube-owner", PyUnicode_FromString(o));
-                    break;
-                }
+        {
+            PyObject *s = PyGameStats(&g->sc, FALSE, g->nMatch);
 
-            default:
-                {
-                    g_assert_not_reached();
-                }
+            if (s) {
+                DictSetItemSteal(gameDict, "stats", s);
             }
+        }
+    }
 
-            if (action) {
-                DictSetItemSteal(recordDict, "action", PyUnicode_FromString(action));
-            }
+    {
+        int nRecords = 0;
+        TanBoard anBoard;
+        PyObject *gameTuple;
 
-            if (player != -1) {
-                DictSetItemSteal(recordDict, "player", PyUnicode_FromString(player ? "O" : "X"));
+        {
+            listOLD *t;
+            for (t = pl->plNext; t != plGame; t = t->plNext) {
+                ++nRecords;
             }
+        }
 
-            if (points != -1) {
-                DictSetItemSteal(recordDict, "points", PyInt_FromLong(points));
-            }
+        gameTuple = PyTuple_New(nRecords);
 
-            if (analysis) {
-                if (PyDict_Size(analysis) > 0) {
-                    DictSetItemSteal(recordDict, "analysis", analysis);
-                } else {
-                    Py_DECREF(analysis);
-                    analysis = 0;
-                }
-            }
+        nRecords = 0;
 
-            if (pmr->sz) {
-                DictSetItemSteal(recordDict, "comment", PyUnicode_FromString(pmr->sz));
-            }
+        if (includeBoards) {
+            InitBoard(anBoard, g->bgv);
+        }
+
+        for (pl = pl->plNext; pl != plGame; pl = pl->plNext) {
+            PyObject *recordDict = PyMoveRecord(pl->p, anBoard, doAnalysis, verbose, includeBoards, FALSE, ms);
 
             PyTuple_SET_ITEM(gameTuple, nRecords, recordDict);
             ++nRecords;
@@ -2824,50 +3404,15 @@ addProperty(PyObject * dict, const char *name, const char *val)
     DictSetItemSteal(dict, name, PyUnicode_FromString(val));
 }
 
+/* The match information, taken from the match and its first game */
+
 static PyObject *
-PythonMatch(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
+PyMatchInfo(const xmovegameinfo * g)
 {
-    /* take match info from first game */
-    const listOLD *firstGame = lMatch.plNext->p;
-    const moverecord *pmr;
-    const xmovegameinfo *g;
-    int includeAnalysis = 1;
-    int verboseAnalysis = 0;
-    int statistics = 0;
-    int boards = 1;
-    PyObject *matchDict;
-    PyObject *matchInfoDict;
-    PyMatchState s;
-
-    static char *kwlist[] = { "analysis", "boards", "statistics", "verbose", 0 };
-
-    if (!firstGame) {
-        Py_INCREF(Py_None);
-        return Py_None;
-    }
-
-    pmr = firstGame->plNext->p;
-    g_assert(pmr->mt == MOVE_GAMEINFO);
-    g = &pmr->g;
-
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|iiii", kwlist,
-                                     &includeAnalysis, &boards, &statistics, &verboseAnalysis))
-        return 0;
-
-
-    matchDict = PyDict_New();
-    matchInfoDict = PyDict_New();
-
-    if (!matchDict && !matchInfoDict) {
-        PyErr_SetString(PyExc_MemoryError, "");
-        return 0;
-    }
+    PyObject *matchInfoDict = PyDict_New();
 
-    if (g->i != 0) {
-        PyErr_SetString(PyExc_StandardError, "First game missing from match");
+    if (!matchInfoDict)
         return 0;
-    }
-    g_assert(g->i == 0);
 
     /* W,X,0
      * B,O,1 */
@@ -2936,6 +3481,54 @@ PythonMatch(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
         }
     }
 
+    return matchInfoDict;
+}
+
+static PyObject *
+PythonMatch(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
+{
+    /* take match info from first game */
+    const listOLD *firstGame = lMatch.plNext->p;
+    const moverecord *pmr;
+    const xmovegameinfo *g;
+    int includeAnalysis = 1;
+    int verboseAnalysis = 0;
+    int statistics = 0;
+    int boards = 1;
+    PyObject *matchDict;
+    PyObject *matchInfoDict;
+    PyMatchState s;
+
+    static char *kwlist[] = { "analysis", "boards", "statistics", "verbose", 0 };
+
+    if (!firstGame) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    pmr = firstGame->plNext->p;
+    g_assert(pmr->mt == MOVE_GAMEINFO);
+    g = &pmr->g;
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|iiii", kwlist,
+                                     &includeAnalysis, &boards, &statistics, &verboseAnalysis))
+        return 0;
+
+
+    matchDict = PyDict_New();
+    matchInfoDict = PyMatchInfo(g);
+
+    if (!matchDict && !matchInfoDict) {
+        PyErr_SetString(PyExc_MemoryError, "");
+        return 0;
+    }
+
+    if (g->i != 0) {
+        PyErr_SetString(PyExc_StandardError, "First game missing from match");
+        return 0;
+    }
+    g_assert(g->i == 0);
+
     DictSetItemSteal(matchDict, "match-info", matchInfoDict);
 
     s.ec = 0;
@@ -2999,6 +3592,177 @@ PythonMatch(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
     return matchDict;
 }
 
+/*
+ * Lazy match export.  gnubg.matchiter() returns an iterator over the
+ * current match which converts one record at a time, so the whole
+ * match never exists as Python objects at once.
+ */
+
+typedef struct {
+    PyObject_HEAD
+    const listOLD *plMatch;     /* node of lMatch of the current game */
+    const listOLD *pl;          /* last record returned */
+    int iGame;
+    int fStarted;
+    int includeAnalysis, boards, statistics, verboseAnalysis, buffers;
+    unsigned int nGeneration;   /* nMatchGeneration when started */
+    TanBoard anBoard;
+    PyMatchState s;             /* pointing to ec and rc */
+    evalcontext ec;
+    rolloutcontext rc;
+} PyMatchIter;
+
+static PyTypeObject PyMatchIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "gnubg.matchiter"
+};
+
+static PyObject *
+PyMatchIterGame(PyMatchIter * pmi)
+{
+    const listOLD *plGame = pmi->plMatch->p;
+    const moverecord *pmr = plGame->plNext->p;
+    PyObject *d = PyDict_New();
+
+    g_assert(pmr->mt == MOVE_GAMEINFO);
+
+    pmi->pl = plGame->plNext;
+
+    if (pmi->boards)
+        InitBoard(pmi->anBoard, pmr->g.bgv);
+
+    DictSetItemSteal(d, "action", PyUnicode_FromString("game"));
+    DictSetItemSteal(d, "game", PyInt_FromLong(pmi->iGame));
+    DictSetItemSteal(d, "info", PyGameInfo(&pmr->g));
+
+    if (pmi->statistics) {
+        PyObject *pyStats;
+
+        updateStatisticsGame(plGame);
+        if ((pyStats = PyGameStats(&pmr->g.sc, FALSE, pmr->g.nMatch)))
+            DictSetItemSteal(d, "stats", pyStats);
+    }
+
+    return d;
+}
+
+static PyObject *
+PyMatchIterNext(PyMatchIter * pmi)
+{
+    const listOLD *plGame;
+    const evalcontext *pec = pmi->s.ec;
+    const rolloutcontext *prc = pmi->s.rc;
+    PyObject *d;
+
+    if (!pmi->fStarted) {
+        const moverecord *pmr;
+
+        pmi->fStarted = TRUE;
+        pmi->nGeneration = nMatchGeneration;
+        if (ListEmpty(&lMatch))
+            return 0;
+
+        pmi->plMatch = lMatch.plNext;
+        pmr = ((listOLD *) pmi->plMatch->p)->plNext->p;
+
+        d = PyDict_New();
+        DictSetItemSteal(d, "action", PyUnicode_FromString("match"));
+        DictSetItemSteal(d, "info", PyMatchInfo(&pmr->g));
+        return d;
+    }
+
+    if (!pmi->plMatch)
+        return 0;
+
+    /* games or records we point to may be gone */
+    if (pmi->nGeneration != nMatchGeneration) {
+        PyErr_SetString(PyExc_RuntimeError, _("the match changed during iteration"));
+        return 0;
+    }
+
+    plGame = pmi->plMatch->p;
+
+    if (!pmi->pl)
+        return PyMatchIterGame(pmi);
+
+    if (pmi->pl->plNext == plGame) {
+        /* on to the next game */
+        pmi->plMatch = pmi->plMatch->plNext;
+        pmi->pl = NULL;
+        if (pmi->plMatch == &lMatch) {
+            pmi->plMatch = NULL;
+            return 0;
+        }
+        pmi->iGame++;
+        return PyMatchIterGame(pmi);
+    }
+
+    pmi->pl = pmi->pl->plNext;
+
+    d = PyMoveRecord(pmi->pl->p, pmi->anBoard, pmi->includeAnalysis, pmi->verboseAnalysis, pmi->boards,
+                     pmi->buffers, &pmi->s);
+
+    DictSetItemSteal(d, "game", PyInt_FromLong(pmi->iGame));
+
+    /* keep copies of the contexts the later ones are relative to, as
+     * the records may go */
+    if (pmi->s.ec && pmi->s.ec != &pmi->ec) {
+        memcpy(&pmi->ec, pmi->s.ec, sizeof(evalcontext));
+        pmi->s.ec = &pmi->ec;
+    }
+    if (pmi->s.rc && pmi->s.rc != &pmi->rc) {
+        memcpy(&pmi->rc, pmi->s.rc, sizeof(rolloutcontext));
+        pmi->s.rc = &pmi->rc;
+    }
+
+    if (!pec && pmi->s.ec)
+        DictSetItemSteal(d, "default-eval-context", EvalContextToPy(pmi->s.ec));
+    if (!prc && pmi->s.rc)
+        DictSetItemSteal(d, "default-rollout-context", RolloutContextToPy(pmi->s.rc));
+
+    return d;
+}
+
+static void
+PyMatchIterDealloc(PyObject * self)
+{
+    PyObject_Del(self);
+}
+
+static PyObject *
+PythonMatchIter(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
+{
+    PyMatchIter *pmi;
+    int includeAnalysis = 1;
+    int verboseAnalysis = 0;
+    int statistics = 0;
+    int boards = 1;
+    int buffers = 0;
+
+    static char *kwlist[] = { "analysis", "boards", "statistics", "verbose", "buffers", 0 };
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|iiiii", kwlist,
+                                     &includeAnalysis, &boards, &statistics, &verboseAnalysis, &buffers))
+        return 0;
+
+    if (!(pmi = PyObject_New(PyMatchIter, &PyMatchIterType)))
+        return 0;
+
+    pmi->plMatch = NULL;
+    pmi->pl = NULL;
+    pmi->iGame = 0;
+    pmi->fStarted = FALSE;
+    pmi->includeAnalysis = includeAnalysis;
+    pmi->boards = boards;
+    pmi->statistics = statistics;
+    pmi->verboseAnalysis = verboseAnalysis;
+    pmi->buffers = buffers;
+    pmi->s.ec = 0;
+    pmi->s.rc = 0;
+
+    return (PyObject *) pmi;
+}
+
 
 static PyObject *
 PythonNavigate(PyObject * UNUSED(self), PyObject * args, PyObject * keywds)
@@ -3146,6 +3910,17 @@ static PyMethodDef gnubgMethods[] = {
      "    returns tuple(floats P(win), P(win gammon), P(win backgammnon)\n"
      "         P(lose gammon), P(lose backgammon), cubeless equity)"}
     ,
+    {"evaluate_batch", PythonEvaluateBatch, METH_VARARGS,
+     "Evaluation of many positions at once, on all threads\n"
+     "    arguments: boards output [cube-info] [eval-context]\n"
+     "        boards = buffer of n x 2 x 25 ints (e.g. array('i')), each\n"
+     "            50 laid out as the two tuples of 'board'\n"
+     "        output = writable buffer of n x 7 floats (array('f')), filled\n"
+     "            with the outputs of 'evaluate' and the cubeful equity\n"
+     "            (0.0 if the eval-context is cubeless)\n"
+     "        cube-info and eval-context are the same for all positions\n"
+     "    returns: int n"}
+    ,
     {"evalcontext", PythonEvalContext, METH_VARARGS,
      "make an evalcontext\n"
      "    argument: [tuple ( 5 int, float )]\n"
@@ -3156,6 +3931,33 @@ static PyMethodDef gnubgMethods[] = {
      "    argument: [tuple ( 16 int, 2 float )]\n"
      "    returns:  rollout-context"}
     ,
+#if defined(HAVE_LIBPNG)
+    {"positionpng", PythonPositionPNG, METH_VARARGS,
+     "PNG image of a position, drawn with the current appearance\n"
+     "    arguments: [board] [size]\n"
+     "        board = tuple ( see \"board\" ), dice and cube are taken\n"
+     "            from the current match\n"
+     "        size = pixels per board unit, default from 'set export png size'\n"
+     "    returns: bytes"}
+    ,
+#endif
+    {"rolls", PythonRolls, METH_VARARGS,
+     "Distribution of rolls\n"
+     "    arguments: [depth] [board] [cube-info] [eval-context]\n"
+     "        depth = number of rolls to look ahead (default 1)\n"
+     "        eval-context defaults to 0-ply cubeful, others see 'cfevaluate'\n"
+     "    returns: dictionary: 'equity'=>average equity, 'rolls'=>list of 21\n"
+     "        dictionaries: 'dice'=>(int, int), 'move'=>best move,\n"
+     "        'equity'=>equity for the player on roll now,\n"
+     "        'rolls'=>the replies, except on the last level"}
+    ,
+    {"temperaturemap", PythonTemperatureMap, METH_VARARGS,
+     "Temperature map: equity after the best move for each roll\n"
+     "    arguments: [board] [cube-info] [eval-context]\n"
+     "        eval-context defaults to 0-ply cubeful, others see 'cfevaluate'\n"
+     "    returns: dictionary: 'average'=>float, 'equity'=>6x6 tuple of\n"
+     "        floats, 'move'=>6x6 tuple of strings, indexed by the dice - 1"}
+    ,
     {"eq2mwc", PythonEq2mwc, METH_VARARGS,
      "convert equity to MWC\n"
      "    argument: [float equity], [cube-info]\n"
@@ -3175,6 +3977,16 @@ static PyMethodDef gnubgMethods[] = {
      "    returns: tuple( ints point from, point to, \n"
      "        unused moves are set to zero"}
     ,
+    {"findbestmove_batch", PythonFindBestMoveBatch, METH_VARARGS,
+     "Find the best move in many positions at once, on all threads\n"
+     "    arguments: boards dice moves [cube-info] [eval-context]\n"
+     "        [move-filters]\n"
+     "        boards = buffer of n x 2 x 25 ints, see 'evaluate_batch'\n"
+     "        dice = buffer of n x 2 ints\n"
+     "        moves = writable buffer of n x 8 ints, filled as the tuples\n"
+     "            of 'findbestmove' with unused moves set to zero\n"
+     "    returns: int n"}
+    ,
     {"hint", PythonHint, METH_VARARGS,
      "    arguments: [max moves]\n"
      "    returns: hint dictionary\n"}
@@ -3279,6 +4091,22 @@ static PyMethodDef gnubgMethods[] = {
      "    arguments: [ list of 10 ints] \n"
      "    returns: board ( see 'cfevaluate' )"}
     ,
+    {"matchiter", (PyCFunction) PythonMatchIter, METH_VARARGS | METH_KEYWORDS,
+     "Iterate over the current match, converting one record at a time\n"
+     "    arguments: [ analysis = 0/1, boards = 0/1, statistics = 0/1,\n"
+     "       verbose = 0/1, buffers = 0/1 ]\n"
+     "    returns: iterator yielding dictionaries, first\n"
+     "       'action'=>'match', 'info'=>match info as from 'match'\n"
+     "     then for each game\n"
+     "       'action'=>'game', 'game'=>int, 'info'=>game info\n"
+     "         ['stats'=>game statistics]\n"
+     "     followed by its records, as in 'match' with 'game'=>int added\n"
+     "     The first record with analysis carries 'default-eval-context'\n"
+     "     and 'default-rollout-context' as needed.  With buffers=1 the\n"
+     "     move analysis holds every move of the list as buffers, one row\n"
+     "     per move: 'moves' (8 ints, see 'findbestmove'), 'types' (int\n"
+     "     evaltype), 'outputs' and 'stddevs' (7 floats), 'scores' (float)"}
+    ,
     {"match", (PyCFunction) PythonMatch, METH_VARARGS | METH_KEYWORDS,
      "Get the current match\n"
      "    arguments: [ include-analysis = 0/1, include-boards = 0/1,\n"
@@ -3430,6 +4258,16 @@ extern MOD_INIT(gnubg)
     if (module == NULL)
         return MOD_ERROR_VAL;
 
+    PyMatchIterType.tp_basicsize = sizeof(PyMatchIter);
+    PyMatchIterType.tp_flags = Py_TPFLAGS_DEFAULT;
+    PyMatchIterType.tp_doc = "iterator over the current match, see gnubg.matchiter()";
+    PyMatchIterType.tp_dealloc = PyMatchIterDealloc;
+    PyMatchIterType.tp_iter = PyObject_SelfIter;
+    PyMatchIterType.tp_iternext = (iternextfunc) PyMatchIterNext;
+
+    if (PyType_Ready(&PyMatchIterType) < 0)
+        return MOD_ERROR_VAL;
+
     return MOD_SUCCESS_VAL(module);
 }
 
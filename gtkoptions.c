@@ -1514,6 +1514,7 @@ OptionsOK(GtkWidget * pw, optionswidget * pow)
         "set rng isaac",
         "set rng md5",
         "set rng mersenne",
+        "set rng philox",
         "set rng manual",
         "set rng random.org",
         NULL,
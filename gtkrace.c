@@ -289,7 +289,7 @@ OSRPage(TanBoard UNUSED(anBoard), racewidget * prw)
 #endif
     gtk_container_add(GTK_CONTAINER(pwp), pwvbox);
 
-    prw->padjTrials = GTK_ADJUSTMENT(gtk_adjustment_new(5760, 1, 1296 * 1296, 36, 36, 0));
+    prw->padjTrials = GTK_ADJUSTMENT(gtk_adjustment_new(nOSRTrials, 1, 1296 * 1296, 36, 36, 0));
 #if GTK_CHECK_VERSION(3,0,0)
     pw = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
 #else
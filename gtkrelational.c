@@ -74,7 +74,7 @@ static GtkListStore *playerStore;
 static GtkListStore *dbStore;
 static GtkTreeIter selected_iter;
 static int optionsValid;
-static GtkWidget *playerTreeview, *adddb, *deldb, *gameStats, *dbList, *dbtype, *user, *password, *hostname, *login, *helptext;
+static GtkWidget *playerTreeview, *adddb, *deldb, *gameStats, *positions, *dbList, *dbtype, *user, *password, *hostname, *login, *helptext;
 
 static void CheckDatabase(const char *database);
 static void DBListSelected(GtkTreeView * treeview, gpointer userdata);
@@ -702,6 +702,7 @@ RelationalSaveOptions(void)
                       gtk_entry_get_text(GTK_ENTRY(password)), gtk_entry_get_text(GTK_ENTRY(hostname)));
 
         storeGameStats = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(gameStats));
+        storePositions = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(positions));
     }
 }
 
@@ -806,6 +807,10 @@ RelationalOptions(void)
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(gameStats), storeGameStats);
     gtk_box_pack_start(GTK_BOX(vb1), gameStats, FALSE, FALSE, 0);
 
+    positions = gtk_check_button_new_with_label(_("Store and reuse rollouts"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(positions), storePositions);
+    gtk_box_pack_start(GTK_BOX(vb1), positions, FALSE, FALSE, 0);
+
     gtk_box_pack_start(GTK_BOX(hb2), vb1, FALSE, FALSE, 10);
 
     help = gtk_frame_new(_("Info"));
@@ -24,13 +24,13 @@
 #include <string.h>
 #include <stdlib.h>
 
-#include "lib/simd.h"
-
 #include "gtkgame.h"
 #include "drawboard.h"
 #include "format.h"
 #include "gtkwindows.h"
 #include "gtkrolls.h"
+#include "positionid.h"
+#include "rolls.h"
 
 typedef struct _rollswidget {
 
@@ -47,89 +47,51 @@ typedef struct _rollswidget {
 
 
 static void
-add_level(GtkTreeStore * model, GtkTreeIter * iter,
-          const int n, const TanBoard anBoard,
-          evalcontext * pec, cubeinfo * pci, const gboolean fInvert, float arOutput[NUM_ROLLOUT_OUTPUTS])
+add_level(GtkTreeStore * model, GtkTreeIter * iter, const rollstree * prt,
+          const rollsnode * prn, const unsigned int nLevel, const unsigned int nDepth)
 {
 
-    int n0, n1;
     GtkTreeIter child_iter;
-    cubeinfo ci;
-    TanBoard an;
-    SSE_ALIGN(float ar[NUM_ROLLOUT_OUTPUTS]);
-    int anMove[8];
-    int i;
+    TanBoard anBoard;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    unsigned int i;
 
     char szRoll[3], szMove[100], *szEquity;
 
-    /* cubeinfo for opponent on roll */
-
-    memcpy(&ci, pci, sizeof(cubeinfo));
-    ci.fMove = !pci->fMove;
-
-    for (i = 0; i < NUM_ROLLOUT_OUTPUTS; ++i)
-        arOutput[i] = 0.0f;
-
-    for (n0 = 0; n0 < 6; ++n0) {
-        for (n1 = 0; n1 <= n0; ++n1) {
-
-            memcpy(an, anBoard, sizeof(an));
+    /* position before the move, player on roll */
 
-            if (FindBestMove(anMove, n0 + 1, n1 + 1, an, pci, pec, defaultFilters) < 0)
-                return;
+    PositionFromKey(anBoard, &prn->key);
 
-            SwapSides(an);
+    for (i = 0; i < 21; ++i) {
 
-            gtk_tree_store_append(model, &child_iter, iter);
+        const rollsnode *prnChild = &prn->arnChild[i];
 
-            if (n) {
+        gtk_tree_store_append(model, &child_iter, iter);
 
-                add_level(model, &child_iter, n - 1, (ConstTanBoard) an, pec, &ci, !fInvert, ar);
-                if (fInterrupt)
-                    return;
+        if (nLevel + 1 < nDepth)
+            add_level(model, &child_iter, prt, prnChild, nLevel + 1, nDepth);
 
-            } else {
+        RollsNodeValue(prt, prnChild, nLevel + 1, nDepth, ar);
 
-                /* evaluate resulting position */
+        sprintf(szRoll, "%d%d", aanRollsDice[i][0], aanRollsDice[i][1]);
+        FormatMove(szMove, (ConstTanBoard) anBoard, (int *) prnChild->anMove);
 
-                ProgressValueAdd(1);
+        szEquity = OutputMWC(ar[OUTPUT_CUBEFUL_EQUITY], &prt->aci[0], TRUE);
 
-                if (GeneralEvaluationE(ar, (ConstTanBoard) an, &ci, pec) < 0)
-                    return;
-
-            }
-
-            if (fInvert)
-                InvertEvaluationR(ar, &ci);
-
-            sprintf(szRoll, "%d%d", n0 + 1, n1 + 1);
-            FormatMove(szMove, anBoard, anMove);
-
-            szEquity = OutputMWC(ar[OUTPUT_CUBEFUL_EQUITY], fInvert ? pci : &ci, TRUE);
-
-            gtk_tree_store_set(model, &child_iter, 0, szRoll, 1, szMove, 2, szEquity, -1);
-
-            for (i = 0; i < NUM_ROLLOUT_OUTPUTS; ++i)
-                arOutput[i] += (n0 == n1) ? ar[i] : 2.0f * ar[i];
-
-        }
+        gtk_tree_store_set(model, &child_iter, 0, szRoll, 1, szMove, 2, szEquity, -1);
 
     }
 
-    for (i = 0; i < NUM_ROLLOUT_OUTPUTS; ++i)
-        arOutput[i] /= 36.0f;
-
     /* add average equity */
 
-    szEquity = OutputMWC(arOutput[OUTPUT_CUBEFUL_EQUITY], fInvert ? pci : &ci, TRUE);
+    RollsNodeValue(prt, prn, nLevel, nDepth, ar);
+
+    szEquity = OutputMWC(ar[OUTPUT_CUBEFUL_EQUITY], &prt->aci[0], TRUE);
 
     gtk_tree_store_append(model, &child_iter, iter);
 
     gtk_tree_store_set(model, &child_iter, 0, _("Average equity"), 1, "", 2, szEquity, -1);
 
-    if (!fInvert)
-        InvertEvaluationR(arOutput, pci);
-
 }
 
 
@@ -159,32 +121,26 @@ static GtkTreeModel *
 create_model(const int n, evalcontext * pec, const matchstate * pms)
 {
     GtkTreeStore *model;
-    TanBoard anBoard;
     cubeinfo ci;
-    float arOutput[NUM_ROLLOUT_OUTPUTS];
-    int i, j;
-
-    memcpy(anBoard, pms->anBoard, sizeof(anBoard));
-
-    /* create tree store */
-    model = gtk_tree_store_new(3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+    rollstree *prt;
 
     GetMatchStateCubeInfo(&ci, pms);
 
-    for (i = 0, j = 1; i < n; ++i, j *= 21);
+    /* the levels calculated for a smaller depth are reused */
 
-    ProgressStartValue(_("Calculating equities"), j);
+    prt = RollsTreeGet((ConstTanBoard) pms->anBoard, &ci, pec);
 
-    add_level(model, NULL, n - 1, (ConstTanBoard) anBoard, pec, &ci, TRUE, arOutput);
+    if (RollsTreeExpand(prt, (unsigned int) n) < 0 || fInterrupt)
+        return NULL;
 
-    ProgressEnd();
+    /* create tree store */
+    model = gtk_tree_store_new(3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
 
-    if (!fInterrupt) {
-        gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(model), 2, sort_func, NULL, NULL);
-        gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(model), 2, GTK_SORT_DESCENDING);
-        return GTK_TREE_MODEL(model);
-    } else
-        return NULL;
+    add_level(model, NULL, prt, &prt->rnRoot, 0, (unsigned int) n);
+
+    gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(model), 2, sort_func, NULL, NULL);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(model), 2, GTK_SORT_DESCENDING);
+    return GTK_TREE_MODEL(model);
 }
 
 
@@ -202,7 +158,7 @@ RollsTree(const int n, evalcontext * pec, const matchstate * pms)
     };
 
     pm = create_model(n, pec, pms);
-    if (fInterrupt) {
+    if (!pm) {
         return NULL;
     }
     ptv = gtk_tree_view_new_with_model(pm);
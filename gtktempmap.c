@@ -42,6 +42,7 @@
 #include "renderprefs.h"
 #include "gtkboard.h"
 #include "gtkwindows.h"
+#include "tempmap.h"
 
 #define SIZE_QUADRANT 52
 
@@ -87,93 +88,36 @@ static int fShowEquity = FALSE;
 static int fShowBestMove = FALSE;
 
 static int
-TempMapEquities(evalcontext * pec, matchstate * pms,
-                float aarEquity[6][6], int aaanMove[6][6][8], const gchar * szTitle, const float rFac)
+CalcTempMapEquities(evalcontext * pec, tempmapwidget * ptmw)
 {
 
+    tempmapdata *atmd = g_new(tempmapdata, ptmw->n);
+    int i, j, m;
 
-    int i, j;
-    float arOutput[NUM_ROLLOUT_OUTPUTS];
-    TanBoard anBoard;
-    int aaan[6][6][8];
-    float aar[6][6];
-    cubeinfo ci;
-    cubeinfo cix;
-
-    /* calculate equities */
-
-    GetMatchStateCubeInfo(&cix, pms);
-
-    if (szTitle && *szTitle) {
-        gchar *sz = g_strdup_printf(_("Calculating equities for %s"), szTitle);
-        ProgressStartValue(sz, 21);
-        g_free(sz);
-    } else
-        ProgressStartValue(_("Calculating equities"), 21);
-
-    for (i = 0; i < 6; ++i)
-        for (j = 0; j <= i; ++j) {
-
-            memcpy(&ci, &cix, sizeof ci);
-
-            /* find best move */
-
-            memcpy(anBoard, pms->anBoard, sizeof(anBoard));
-
-            if (FindBestMove(aaan[i][j], i + 1, j + 1, anBoard, &ci, pec, defaultFilters) < 0) {
-                ProgressEnd();
-                return -1;
-            }
-
-            /* evaluate resulting position */
-
-            SwapSides(anBoard);
-            ci.fMove = !ci.fMove;
-
-            if (GeneralEvaluationE(arOutput, (ConstTanBoard) anBoard, &ci, pec) < 0) {
-                ProgressEnd();
-                return -1;
-            }
-
-            InvertEvaluationR(arOutput, &cix);
-
-            if (!cix.nMatchTo && rFac != 1.0f)
-                arOutput[OUTPUT_CUBEFUL_EQUITY] *= rFac;
-
-            aar[i][j] = arOutput[OUTPUT_CUBEFUL_EQUITY];
-            aar[j][i] = arOutput[OUTPUT_CUBEFUL_EQUITY];
-
-            if (i != j)
-                memcpy(aaan[j][i], aaan[i][j], sizeof aaan[0][0]);
-
-            ProgressValueAdd(1);
-
-        }
-
-
-
-    ProgressEnd();
-
-    memcpy(aarEquity, aar, sizeof aar);
-    memcpy(aaanMove, aaan, sizeof aaan);
+    for (m = 0; m < ptmw->n; ++m) {
+        memcpy(atmd[m].anBoard, ptmw->atm[m].pms->anBoard, sizeof(TanBoard));
+        GetMatchStateCubeInfo(&atmd[m].ci, ptmw->atm[m].pms);
+    }
 
-    return 0;
+    if (CalcTempMap(atmd, (unsigned int) ptmw->n, pec) < 0) {
+        g_free(atmd);
+        return -1;
+    }
 
-}
+    for (m = 0; m < ptmw->n; ++m) {
 
+        const float rFac = (float) (ptmw->atm[m].pms->nCube / ptmw->atm[0].pms->nCube);
 
-static int
-CalcTempMapEquities(evalcontext * pec, tempmapwidget * ptmw)
-{
+        if (!atmd[m].ci.nMatchTo && rFac != 1.0f)
+            for (i = 0; i < 6; ++i)
+                for (j = 0; j < 6; ++j)
+                    atmd[m].aarEquity[i][j] *= rFac;
 
-    int i;
+        memcpy(ptmw->atm[m].aarEquity, atmd[m].aarEquity, sizeof atmd[m].aarEquity);
+        memcpy(ptmw->atm[m].aaanMove, atmd[m].aaanMove, sizeof atmd[m].aaanMove);
+    }
 
-    for (i = 0; i < ptmw->n; ++i)
-        if (TempMapEquities(pec, ptmw->atm[i].pms,
-                            ptmw->atm[i].aarEquity,
-                            ptmw->atm[i].aaanMove,
-                            ptmw->atm[i].szTitle, (float) (ptmw->atm[i].pms->nCube / ptmw->atm[0].pms->nCube)) < 0)
-            return -1;
+    g_free(atmd);
 
     return 0;
 
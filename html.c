@@ -37,6 +37,7 @@
 #include "matchid.h"
 #include "formatgs.h"
 #include "relational.h"
+#include "multithread.h"
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -187,7 +188,7 @@ static char *
 GetStyle(const stylesheetclass ssc, const htmlexportcss hecss)
 {
 
-    static char sz[200];
+    MT_STATIC_BUFFER(sz, 200);
 
     switch (hecss) {
     case HTML_EXPORT_CSS_INLINE:
@@ -211,7 +212,7 @@ static char *
 GetStyleGeneral(const int hecss, ...)
 {
 
-    static char sz[2048];
+    MT_STATIC_BUFFER(sz, 2048);
     va_list val;
     stylesheetclass ssc;
     int i = 0;
@@ -266,7 +267,7 @@ GetStyleGeneral(const int hecss, ...)
 
 
 static void
-printRolloutTable(FILE * pf,
+printRolloutTable(GString * gsz,
                   char asz[][1024],
                   float aarOutput[][NUM_ROLLOUT_OUTPUTS],
                   float aarStdDev[][NUM_ROLLOUT_OUTPUTS],
@@ -275,95 +276,95 @@ printRolloutTable(FILE * pf,
 
     int ici;
 
-    fputs("<table>\n", pf);
+    g_string_append(gsz, "<table>\n");
 
     if (fHeader) {
 
-        fputs("<tr>", pf);
+        g_string_append(gsz, "<tr>");
 
         if (asz)
-            fputs("<td>&nbsp;</td>", pf);
-
-        fprintf(pf,
-                "<td>%s</td>"
-                "<td>%s</td>"
-                "<td>%s</td>"
-                "<td>&nbsp;</td>"
-                "<td>%s</td>"
-                "<td>%s</td>"
-                "<td>%s</td>"
-                "<td>%s</td>", _("Win"), _("W g"), _("W bg"), _("Lose"), _("L g"), _("L bg"), _("Cubeless"));
+            g_string_append(gsz, "<td>&nbsp;</td>");
+
+        g_string_append_printf(gsz,
+                                "<td>%s</td>"
+                                "<td>%s</td>"
+                                "<td>%s</td>"
+                                "<td>&nbsp;</td>"
+                                "<td>%s</td>"
+                                "<td>%s</td>"
+                                "<td>%s</td>"
+                                "<td>%s</td>", _("Win"), _("W g"), _("W bg"), _("Lose"), _("L g"), _("L bg"), _("Cubeless"));
 
         if (fCubeful)
-            fprintf(pf, "<td>%s</td>", _("Cubeful"));
+            g_string_append_printf(gsz, "<td>%s</td>", _("Cubeful"));
 
-        fputs("</tr>\n", pf);
+        g_string_append(gsz, "</tr>\n");
 
     }
 
     for (ici = 0; ici < cci; ici++) {
 
-        fputs("<tr>", pf);
+        g_string_append(gsz, "<tr>");
 
         /* output */
 
         if (asz)
-            fprintf(pf, "<td>%s</td>", asz[ici]);
+            g_string_append_printf(gsz, "<td>%s</td>", asz[ici]);
 
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WIN]));
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WINGAMMON]));
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WINBACKGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WIN]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WINGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_WINBACKGAMMON]));
 
-        fputs("<td>-</td>", pf);
+        g_string_append(gsz, "<td>-</td>");
 
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(1.0f - aarOutput[ici][OUTPUT_WIN]));
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_LOSEGAMMON]));
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_LOSEBACKGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(1.0f - aarOutput[ici][OUTPUT_WIN]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_LOSEGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarOutput[ici][OUTPUT_LOSEBACKGAMMON]));
 
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss),
-                OutputEquityScale(aarOutput[ici][OUTPUT_EQUITY], &aci[ici], &aci[0], TRUE));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss),
+                                OutputEquityScale(aarOutput[ici][OUTPUT_EQUITY], &aci[ici], &aci[0], TRUE));
 
         if (fCubeful)
-            fprintf(pf, "<td %s>%s</td>",
-                    GetStyle(CLASS_PERCENT, hecss), OutputMWC(aarOutput[ici][OUTPUT_CUBEFUL_EQUITY], &aci[0], TRUE));
+            g_string_append_printf(gsz, "<td %s>%s</td>",
+                                    GetStyle(CLASS_PERCENT, hecss), OutputMWC(aarOutput[ici][OUTPUT_CUBEFUL_EQUITY], &aci[0], TRUE));
 
-        fputs("</tr>\n", pf);
+        g_string_append(gsz, "</tr>\n");
 
         /* stddev */
 
-        fputs("<tr>", pf);
+        g_string_append(gsz, "<tr>");
 
         if (asz)
-            fprintf(pf, "<td>%s</td>", _("Standard deviation"));
+            g_string_append_printf(gsz, "<td>%s</td>", _("Standard deviation"));
 
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WIN]));
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WINGAMMON]));
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WINBACKGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WIN]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WINGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WINBACKGAMMON]));
 
-        fputs("<td>-</td>", pf);
+        g_string_append(gsz, "<td>-</td>");
 
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WIN]));
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_LOSEGAMMON]));
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_LOSEBACKGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_WIN]));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_LOSEGAMMON]));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss), OutputPercent(aarStdDev[ici][OUTPUT_LOSEBACKGAMMON]));
 
-        fprintf(pf, "<td %s>%s</td>",
-                GetStyle(CLASS_PERCENT, hecss),
-                OutputEquityScale(aarStdDev[ici][OUTPUT_EQUITY], &aci[ici], &aci[0], FALSE));
+        g_string_append_printf(gsz, "<td %s>%s</td>",
+                                GetStyle(CLASS_PERCENT, hecss),
+                                OutputEquityScale(aarStdDev[ici][OUTPUT_EQUITY], &aci[ici], &aci[0], FALSE));
 
         if (fCubeful)
-            fprintf(pf, "<td %s>%s</td>",
-                    GetStyle(CLASS_PERCENT, hecss), OutputMWC(aarStdDev[ici][OUTPUT_CUBEFUL_EQUITY], &aci[0], FALSE));
+            g_string_append_printf(gsz, "<td %s>%s</td>",
+                                    GetStyle(CLASS_PERCENT, hecss), OutputMWC(aarStdDev[ici][OUTPUT_CUBEFUL_EQUITY], &aci[0], FALSE));
 
-        fputs("</tr>\n", pf);
+        g_string_append(gsz, "</tr>\n");
 
     }
 
-    fputs("</table>\n", pf);
+    g_string_append(gsz, "</table>\n");
 
 }
 
@@ -404,7 +405,7 @@ printStatTableRow(FILE * pf, const char *format1, const char *format2, ...)
  * Print img tag.
  *
  * Input:
- *    pf : write to file
+ *    gsz: write to string
  *    szImageDir: path (URI) to images
  *    szImage: the image to print
  *    szExtension: extension of the image (e.g. gif or png)
@@ -412,17 +413,17 @@ printStatTableRow(FILE * pf, const char *format1, const char *format2, ...)
  */
 
 static void
-printImageClass(FILE * pf, const char *szImageDir, const char *szImage,
+printImageClass(GString * gsz, const char *szImageDir, const char *szImage,
                 const char *szExtension, const char *szAlt,
                 const htmlexportcss hecss, const htmlexporttype het, const stylesheetclass ssc)
 {
 
-    fprintf(pf, "<img src=\"%s%s%s.%s\" %s alt=\"%s\"/>",
-            (szImageDir) ? szImageDir : "",
-            (!szImageDir || szImageDir[strlen(szImageDir) - 1] == '/') ? "" : "/",
-            szImage, szExtension,
-            (het == HTML_EXPORT_TYPE_GNU || (het == HTML_EXPORT_TYPE_BBS && ssc != CLASS_BLOCK)) ?
-            GetStyle(ssc, hecss) : "", (szAlt) ? szAlt : "");
+    g_string_append_printf(gsz, "<img src=\"%s%s%s.%s\" %s alt=\"%s\"/>",
+                            (szImageDir) ? szImageDir : "",
+                            (!szImageDir || szImageDir[strlen(szImageDir) - 1] == '/') ? "" : "/",
+                            szImage, szExtension,
+                            (het == HTML_EXPORT_TYPE_GNU || (het == HTML_EXPORT_TYPE_BBS && ssc != CLASS_BLOCK)) ?
+                            GetStyle(ssc, hecss) : "", (szAlt) ? szAlt : "");
 
 }
 
@@ -430,7 +431,7 @@ printImageClass(FILE * pf, const char *szImageDir, const char *szImage,
  * Print img tag.
  *
  * Input:
- *    pf : write to file
+ *    gsz: write to string
  *    szImageDir: path (URI) to images
  *    szImage: the image to print
  *    szExtension: extension of the image (e.g. gif or png)
@@ -438,11 +439,11 @@ printImageClass(FILE * pf, const char *szImageDir, const char *szImage,
  */
 
 static void
-printImage(FILE * pf, const char *szImageDir, const char *szImage,
+printImage(GString * gsz, const char *szImageDir, const char *szImage,
            const char *szExtension, const char *szAlt, const htmlexportcss hecss, const htmlexporttype het)
 {
 
-    printImageClass(pf, szImageDir, szImage, szExtension, szAlt, hecss, het, CLASS_BLOCK);
+    printImageClass(gsz, szImageDir, szImage, szExtension, szAlt, hecss, het, CLASS_BLOCK);
 
 }
 
@@ -451,7 +452,7 @@ printImage(FILE * pf, const char *szImageDir, const char *szImage,
  * print image for a point
  *
  * Input:
- *    pf : write to file
+ *    gsz: write to string
  *    szImageDir: path (URI) to images
  *    szImage: the image to print
  *    szExtension: extension of the image (e.g. gif or png)
@@ -463,7 +464,7 @@ printImage(FILE * pf, const char *szImageDir, const char *szImage,
  */
 
 static void
-printPointBBS(FILE * pf, const char *szImageDir, const char *szExtension,
+printPointBBS(GString * gsz, const char *szImageDir, const char *szExtension,
               int iPoint0, int iPoint1, const int fColor, const int fUp, const htmlexportcss hecss)
 {
 
@@ -493,13 +494,13 @@ printPointBBS(FILE * pf, const char *szImageDir, const char *szExtension,
         sprintf(szAlt, "&nbsp;'");
     }
 
-    printImageClass(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+    printImageClass(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
 }
 
 
 static void
-printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
+printHTMLBoardBBS(GString * gsz, matchstate * pms, int fTurn,
                   const char *szImageDir, const char *szExtension, const htmlexportcss hecss)
 {
 
@@ -524,50 +525,50 @@ printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
     PipCount((ConstTanBoard) anBoard, anPips);
 
     /* Begin table  and print for player 0 */
-    fprintf(pf,
-            "<table style=\"page-break-inside: avoid\"><tr><th align=\"left\">%s</th><th align=\"right\">%u</th></tr>",
-            ap[0].szName, anPips[1]);
+    g_string_append_printf(gsz,
+                            "<table style=\"page-break-inside: avoid\"><tr><th align=\"left\">%s</th><th align=\"right\">%u</th></tr>",
+                            ap[0].szName, anPips[1]);
 
     /* avoid page break when printing */
-    fputs("<tr><td align=\"center\" colspan=\"2\">", pf);
+    g_string_append(gsz, "<tr><td align=\"center\" colspan=\"2\">");
 
     /* 
      * Top row
      */
 
-    printImageClass(pf, szImageDir, fTurn ? "n_high" : "n_low",
+    printImageClass(gsz, szImageDir, fTurn ? "n_high" : "n_low",
                     szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG_HEADER);
-    fputs("<br/>\n", pf);
+    g_string_append(gsz, "<br/>\n");
 
     /* chequers off */
 
     sprintf(sz, "o_w_%d", acOff[1]);
-    printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+    printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     /* player 0's inner board */
 
     for (i = 0; i < 6; i++)
-        printPointBBS(pf, szImageDir, szExtension, anBoard[1][i], anBoard[0][23 - i], !(i % 2), TRUE, hecss);
+        printPointBBS(gsz, szImageDir, szExtension, anBoard[1][i], anBoard[0][23 - i], !(i % 2), TRUE, hecss);
 
     /* player 0's chequers on the bar */
 
     sprintf(sz, "b_up_%u", anBoard[0][24]);
-    printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+    printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     /* player 0's outer board */
 
     for (i = 0; i < 6; i++)
-        printPointBBS(pf, szImageDir, szExtension, anBoard[1][i + 6], anBoard[0][17 - i], !(i % 2), TRUE, hecss);
+        printPointBBS(gsz, szImageDir, szExtension, anBoard[1][i + 6], anBoard[0][17 - i], !(i % 2), TRUE, hecss);
 
     /* player 0 owning cube */
 
     if (!pms->fCubeOwner) {
         sprintf(sz, "c_up_%d", pms->nCube);
-        printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
     } else
-        printImageClass(pf, szImageDir, "c_up_0", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, "c_up_0", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
-    fputs("<br/>\n", pf);
+    g_string_append(gsz, "<br/>\n");
 
     /* end of first row */
 
@@ -583,20 +584,20 @@ printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
                 (pms->anDice[0] < pms->anDice[1]) ?
                 pms->anDice[0] : pms->anDice[1],
                 (pms->anDice[0] < pms->anDice[1]) ? pms->anDice[1] : pms->anDice[0], pms->fMove ? "right" : "left");
-        printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     } else
         /* no dice rolled */
-        printImageClass(pf, szImageDir, "b_center", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, "b_center", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     /* center cube */
 
     if (pms->fCubeOwner == -1)
-        printImageClass(pf, szImageDir, "c_center", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, "c_center", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
     else
-        printImageClass(pf, szImageDir, "c_blank", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, "c_blank", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
-    fputs("<br/>\n", pf);
+    g_string_append(gsz, "<br/>\n");
 
     /* end of center row */
 
@@ -607,55 +608,55 @@ printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
     /* player 1's chequers off */
 
     sprintf(sz, "o_b_%d", acOff[0]);
-    printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+    printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     /* player 1's inner board */
 
     for (i = 0; i < 6; i++)
-        printPointBBS(pf, szImageDir, szExtension, anBoard[1][23 - i], anBoard[0][i], (i % 2), FALSE, hecss);
+        printPointBBS(gsz, szImageDir, szExtension, anBoard[1][23 - i], anBoard[0][i], (i % 2), FALSE, hecss);
 
     /* player 1's chequers on the bar */
 
     sprintf(sz, "b_dn_%u", anBoard[1][24]);
-    printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+    printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
     /* player 1's outer board */
 
     for (i = 0; i < 6; i++)
-        printPointBBS(pf, szImageDir, szExtension, anBoard[1][17 - i], anBoard[0][i + 6], (i % 2), FALSE, hecss);
+        printPointBBS(gsz, szImageDir, szExtension, anBoard[1][17 - i], anBoard[0][i + 6], (i % 2), FALSE, hecss);
 
     /* player 1 owning cube */
 
     if (pms->fCubeOwner == 1) {
         sprintf(sz, "c_dn_%d", pms->nCube);
-        printImageClass(pf, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, sz, szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
     } else
-        printImageClass(pf, szImageDir, "c_dn_0", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
+        printImageClass(gsz, szImageDir, "c_dn_0", szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
-    fputs("<br/>\n", pf);
+    g_string_append(gsz, "<br/>\n");
 
     /* point numbers */
 
-    printImageClass(pf, szImageDir, fTurn ? "n_low" : "n_high",
+    printImageClass(gsz, szImageDir, fTurn ? "n_low" : "n_high",
                     szExtension, NULL, hecss, HTML_EXPORT_TYPE_BBS, CLASS_BOARD_IMG);
 
-    fputs("</td></tr>\n", pf);
+    g_string_append(gsz, "</td></tr>\n");
 
-    fprintf(pf,
-            "<tr><th align=\"left\">%s</th><th align=\"right\">%u</th><th align=\"center\" colspan=\"2\"></th></tr>",
-            ap[1].szName, anPips[0]);
+    g_string_append_printf(gsz,
+                            "<tr><th align=\"left\">%s</th><th align=\"right\">%u</th><th align=\"center\" colspan=\"2\"></th></tr>",
+                            ap[1].szName, anPips[0]);
 
     /* pip counts */
 
-    fputs("<tr><td align=\"center\" colspan=\"2\">", pf);
+    g_string_append(gsz, "<tr><td align=\"center\" colspan=\"2\">");
 
 
     /* position ID Player 1 and end of table */
 
-    fprintf(pf, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
+    g_string_append_printf(gsz, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
 
-    fprintf(pf, "%s <tt>%s</tt> %s <tt>%s</tt><br/></span></td></tr></table>\n",
-            _("Position ID:"), PositionID((ConstTanBoard) pms->anBoard), _("Match ID:"), MatchIDFromMatchState(pms));
+    g_string_append_printf(gsz, "%s <tt>%s</tt> %s <tt>%s</tt><br/></span></td></tr></table>\n",
+                            _("Position ID:"), PositionID((ConstTanBoard) pms->anBoard), _("Match ID:"), MatchIDFromMatchState(pms));
 
 }
 
@@ -664,7 +665,7 @@ printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
  * print image for a point
  *
  * Input:
- *    pf : write to file
+ *    gsz: write to string
  *    szImageDir: path (URI) to images
  *    szImage: the image to print
  *    szExtension: extension of the image (e.g. gif or png)
@@ -676,7 +677,7 @@ printHTMLBoardBBS(FILE * pf, matchstate * pms, int fTurn,
  */
 
 static void
-printPointF2H(FILE * pf, const char *szImageDir, const char *szExtension,
+printPointF2H(GString * gsz, const char *szImageDir, const char *szExtension,
               int iPoint0, int iPoint1, const int fColor, const int fUp, const htmlexportcss hecss)
 {
 
@@ -703,13 +704,13 @@ printPointF2H(FILE * pf, const char *szImageDir, const char *szExtension,
         sprintf(szAlt, "&nbsp;'");
     }
 
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
 }
 
 
 static void
-printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
+printHTMLBoardF2H(GString * gsz, matchstate * pms, int fTurn,
                   const char *szImageDir, const char *szExtension, const htmlexportcss hecss)
 {
 
@@ -735,13 +736,13 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     /* top line with board numbers */
 
-    fprintf(pf, "<p>\n");
-    printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    g_string_append_printf(gsz, "<p>\n");
+    printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
     sprintf(sz, "b-%stop%s", fTurn ? "hi" : "lo", fClockwise ? "" : "r");
-    printImage(pf, szImageDir, sz, szExtension,
+    printImage(gsz, szImageDir, sz, szExtension,
                fTurn ? "+-13-14-15-16-17-18-+---+-19-20-21-22-23-24-+" :
                "+-12-11-10--9--8--7-+---+--6--5--4--3--2--1-+", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-    fprintf(pf, "<br/>\n");
+    g_string_append_printf(gsz, "<br/>\n");
 
     /* cube image */
 
@@ -751,28 +752,28 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
         if (!pms->fTurn) {
             sprintf(sz, "b-dup%d", 2 * pms->nCube);
-            printImage(pf, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
         } else
-            printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     } else {
 
         /* display arrow */
 
         if (pms->fCubeOwner == -1 || pms->fCubeOwner)
-            printImage(pf, szImageDir, fTurn ? "b-topdn" : "b-topup",
+            printImage(gsz, szImageDir, fTurn ? "b-topdn" : "b-topup",
                        szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
         else {
             sprintf(sz, "%s%d", fTurn ? "b-tdn" : "b-tup", pms->nCube);
-            printImage(pf, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
         }
 
     }
 
     /* display left border */
 
-    printImage(pf, szImageDir, "b-left", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, "b-left", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     /* display player 0's outer quadrant */
 
@@ -780,7 +781,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     for (i = 0; i < 6; i++) {
 
-        printPointF2H(pf, szImageDir, szExtension, anBoard[1][11 - i], anBoard[0][12 + i], fColor, TRUE, hecss);
+        printPointF2H(gsz, szImageDir, szExtension, anBoard[1][11 - i], anBoard[0][12 + i], fColor, TRUE, hecss);
 
         fColor = !fColor;
 
@@ -792,10 +793,10 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
         sprintf(sz, "b-bar-x%u", (anBoard[0][24] > 4) ? 4 : anBoard[0][24]);
         sprintf(szAlt, "|%1X&nbsp;|", anBoard[0][24]);
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     } else
-        printImage(pf, szImageDir, "b-bar", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-bar", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     /* display player 0's home quadrant */
 
@@ -803,7 +804,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     for (i = 0; i < 6; i++) {
 
-        printPointF2H(pf, szImageDir, szExtension, anBoard[1][5 - i], anBoard[0][18 + i], fColor, TRUE, hecss);
+        printPointF2H(gsz, szImageDir, szExtension, anBoard[1][5 - i], anBoard[0][18 + i], fColor, TRUE, hecss);
 
         fColor = !fColor;
 
@@ -811,58 +812,58 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     /* right border */
 
-    printImage(pf, szImageDir, "b-right", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, "b-right", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
-    fprintf(pf, "<br/>\n");
+    g_string_append_printf(gsz, "<br/>\n");
 
     /* center of board */
 
     if (pms->anDice[0] && pms->anDice[1]) {
 
-        printImage(pf, szImageDir, "b-midin", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midl", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midin", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midl", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
-        printImage(pf, szImageDir,
+        printImage(gsz, szImageDir,
                    fTurn ? "b-midg" : "b-midg2", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;"
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir,
+        printImage(gsz, szImageDir,
                    fTurn ? "b-midc" : aszDieO[pms->anDice[0] - 1],
                    szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir,
+        printImage(gsz, szImageDir,
                    fTurn ? "b-midg2" : aszDieO[pms->anDice[1] - 1],
                    szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir,
+        printImage(gsz, szImageDir,
                    fTurn ? aszDieX[pms->anDice[0] - 1] : "b-midg2",
                    szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir,
+        printImage(gsz, szImageDir,
                    fTurn ? aszDieX[pms->anDice[1] - 1] : "b-midc",
                    szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, fTurn ? "b-midg2" : "b-midg", szExtension,
+        printImage(gsz, szImageDir, fTurn ? "b-midg2" : "b-midg", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;"
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midr", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midr", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
-        fprintf(pf, "<br/>\n");
+        g_string_append_printf(gsz, "<br/>\n");
 
     } else {
 
         if (pms->fDoubled)
-            printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
         else
-            printImage(pf, szImageDir, "b-midin", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, "b-midin", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
-        printImage(pf, szImageDir, "b-midl", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midg", szExtension,
+        printImage(gsz, szImageDir, "b-midl", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midg", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;"
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midc", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midg", szExtension,
+        printImage(gsz, szImageDir, "b-midc", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midg", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;"
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-        printImage(pf, szImageDir, "b-midr", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-midr", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
-        fprintf(pf, "<br/>\n");
+        g_string_append_printf(gsz, "<br/>\n");
 
     }
 
@@ -874,26 +875,26 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
         if (pms->fTurn) {
             sprintf(sz, "b-ddn%d", 2 * pms->nCube);
-            printImage(pf, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
         } else
-            printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     } else {
 
         /* display cube */
 
         if (pms->fCubeOwner == -1 || !pms->fCubeOwner)
-            printImage(pf, szImageDir, fTurn ? "b-botdn" : "b-botup",
+            printImage(gsz, szImageDir, fTurn ? "b-botdn" : "b-botup",
                        szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
         else {
             sprintf(sz, "%s%d", fTurn ? "b-bdn" : "b-bup", pms->nCube);
-            printImage(pf, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+            printImage(gsz, szImageDir, sz, szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
         }
 
     }
 
-    printImage(pf, szImageDir, "b-left", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, "b-left", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     /* display player 1's outer quadrant */
 
@@ -901,7 +902,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     for (i = 0; i < 6; i++) {
 
-        printPointF2H(pf, szImageDir, szExtension, anBoard[1][12 + i], anBoard[0][11 - i], fColor, FALSE, hecss);
+        printPointF2H(gsz, szImageDir, szExtension, anBoard[1][12 + i], anBoard[0][11 - i], fColor, FALSE, hecss);
 
         fColor = !fColor;
 
@@ -913,10 +914,10 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
         sprintf(sz, "b-bar-o%u", (anBoard[1][24] > 4) ? 4 : anBoard[1][24]);
         sprintf(szAlt, "|&nbsp;%1uO|", anBoard[1][24]);
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     } else
-        printImage(pf, szImageDir, "b-bar", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+        printImage(gsz, szImageDir, "b-bar", szExtension, "|&nbsp;&nbsp;&nbsp;|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     /* display player 1's outer quadrant */
 
@@ -924,7 +925,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     for (i = 0; i < 6; i++) {
 
-        printPointF2H(pf, szImageDir, szExtension, anBoard[1][18 + i], anBoard[0][5 - i], fColor, FALSE, hecss);
+        printPointF2H(gsz, szImageDir, szExtension, anBoard[1][18 + i], anBoard[0][5 - i], fColor, FALSE, hecss);
 
         fColor = !fColor;
 
@@ -932,39 +933,39 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
 
     /* right border */
 
-    printImage(pf, szImageDir, "b-right", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-    fprintf(pf, "<br/>\n");
+    printImage(gsz, szImageDir, "b-right", szExtension, "|", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    g_string_append_printf(gsz, "<br/>\n");
 
     /* bottom */
 
 
 
-    printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
     sprintf(sz, "b-%sbot%s", fTurn ? "lo" : "hi", fClockwise ? "" : "r");
-    printImage(pf, szImageDir, sz, szExtension,
+    printImage(gsz, szImageDir, sz, szExtension,
                fTurn ?
                "+-12-11-10--9--8--7-+---+--6--5--4--3--2--1-+" :
                "+-13-14-15-16-17-18-+---+-19-20-21-22-23-24-+", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-    fprintf(pf, "<br/>\n");
+    g_string_append_printf(gsz, "<br/>\n");
 
     /* pip counts */
 
-    printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
 
     PipCount((ConstTanBoard) anBoard, anPips);
-    fprintf(pf, _("Pip counts: %s %u, %s %u<br/>\n"), ap[0].szName, anPips[1], ap[1].szName, anPips[0]);
+    g_string_append_printf(gsz, _("Pip counts: %s %u, %s %u<br/>\n"), ap[0].szName, anPips[1], ap[1].szName, anPips[0]);
 
     /* position ID */
 
-    printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
-    fprintf(pf, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
+    printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, HTML_EXPORT_TYPE_FIBS2HTML);
+    g_string_append_printf(gsz, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
 
-    fprintf(pf, _("Position ID: <tt>%s</tt> Match ID: <tt>%s</tt><br/>\n"),
-            PositionID((ConstTanBoard) pms->anBoard), MatchIDFromMatchState(pms));
+    g_string_append_printf(gsz, _("Position ID: <tt>%s</tt> Match ID: <tt>%s</tt><br/>\n"),
+                            PositionID((ConstTanBoard) pms->anBoard), MatchIDFromMatchState(pms));
 
-    fprintf(pf, "</span>");
+    g_string_append_printf(gsz, "</span>");
 
-    fprintf(pf, "</p>\n");
+    g_string_append_printf(gsz, "</p>\n");
 
 }
 
@@ -974,7 +975,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
  * print image for a point
  *
  * Input:
- *    pf : write to file
+ *    gsz: write to string
  *    szImageDir: path (URI) to images
  *    szImage: the image to print
  *    szExtension: extension of the image (e.g. gif or png)
@@ -986,7 +987,7 @@ printHTMLBoardF2H(FILE * pf, matchstate * pms, int fTurn,
  */
 
 static void
-printPointGNU(FILE * pf, const char *szImageDir, const char *szExtension,
+printPointGNU(GString * gsz, const char *szImageDir, const char *szExtension,
               int iPoint0, int iPoint1, const int fColor, const int fUp, const htmlexportcss hecss)
 {
 
@@ -1013,13 +1014,13 @@ printPointGNU(FILE * pf, const char *szImageDir, const char *szExtension,
         sprintf(szAlt, "&nbsp;'");
     }
 
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
 }
 
 
 static void
-printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
+printHTMLBoardGNU(GString * gsz, matchstate * pms, int fTurn,
                   const char *szImageDir, const char *szExtension, const htmlexportcss hecss)
 {
 
@@ -1044,51 +1045,51 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
 
     /* top line with board numbers */
 
-    fputs("<table cellpadding=\"0\" border=\"0\" cellspacing=\"0\""
-          " style=\"margin: 0; padding: 0; border: 0\">\n", pf);
+    g_string_append(gsz, "<table cellpadding=\"0\" border=\"0\" cellspacing=\"0\""
+                         " style=\"margin: 0; padding: 0; border: 0\">\n");
 
-    fputs("<tr>", pf);
-    fputs("<td colspan=\"15\">", pf);
+    g_string_append(gsz, "<tr>");
+    g_string_append(gsz, "<td colspan=\"15\">");
 
     sprintf(sz, "b-%stop%s", fTurn ? "hi" : "lo", fClockwise ? "" : "r");
-    printImage(pf, szImageDir, sz, szExtension,
+    printImage(gsz, szImageDir, sz, szExtension,
                fClockwise ?
                (fTurn ? "+-24-23-22-21-20-19-+---+-18-17-16-15-14-13-+" :
                 "+--1--2--3--4--5--6-+---+--7--8--9-10-11-12-+") :
                (fTurn ? "+-13-14-15-16-17-18-+---+-19-20-21-22-23-24-+" :
                 "+-12-11-10--9--8--7-+---+--6--5--4--3--2--1-+"), hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td></tr>\n", pf);
+    g_string_append(gsz, "</td></tr>\n");
 
     /* display left bearoff tray */
 
-    fputs("<tr>", pf);
+    g_string_append(gsz, "<tr>");
 
 
-    fputs("<td rowspan=\"2\">", pf);
+    g_string_append(gsz, "<td rowspan=\"2\">");
     if (fClockwise)
         /* Use roff as loff not generated (and probably not needed) */
         sprintf(sz, "b-roff-x%d", acOff[1]);
     else
         strcpy(sz, "b-loff-x0");
-    printImage(pf, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+    printImage(gsz, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
     /* display player 0's outer quadrant */
 
     for (i = 0; i < 6; i++) {
-        fputs("<td rowspan=\"2\">", pf);
+        g_string_append(gsz, "<td rowspan=\"2\">");
         if (fClockwise)
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][i], anBoard[0][23 - i], !(i % 2), TRUE, hecss);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][i], anBoard[0][23 - i], !(i % 2), TRUE, hecss);
         else
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][11 - i], anBoard[0][12 + i], !(i % 2), TRUE, hecss);
-        fputs("</td>", pf);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][11 - i], anBoard[0][12 + i], !(i % 2), TRUE, hecss);
+        g_string_append(gsz, "</td>");
     }
 
 
     /* display cube */
 
-    fputs("<td>", pf);
+    g_string_append(gsz, "<td>");
 
     if (!pms->fCubeOwner) {
         sprintf(sz, "b-ct-%d", pms->nCube);
@@ -1098,40 +1099,40 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         strcpy(szAlt, "|&nbsp;&nbsp;&nbsp;|");
     }
 
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td>", pf);
+    g_string_append(gsz, "</td>");
 
 
     /* display player 0's home quadrant */
 
     for (i = 0; i < 6; i++) {
-        fputs("<td rowspan=\"2\">", pf);
+        g_string_append(gsz, "<td rowspan=\"2\">");
         if (fClockwise)
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][i + 6], anBoard[0][17 - i], !(i % 2), TRUE, hecss);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][i + 6], anBoard[0][17 - i], !(i % 2), TRUE, hecss);
         else
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][5 - i], anBoard[0][18 + i], !(i % 2), TRUE, hecss);
-        fputs("</td>", pf);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][5 - i], anBoard[0][18 + i], !(i % 2), TRUE, hecss);
+        g_string_append(gsz, "</td>");
     }
 
 
     /* right bearoff tray */
 
-    fputs("<td rowspan=\"2\">", pf);
+    g_string_append(gsz, "<td rowspan=\"2\">");
     if (!fClockwise)
         sprintf(sz, "b-roff-x%d", acOff[1]);
     else
         strcpy(sz, "b-roff-x0");
-    printImage(pf, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+    printImage(gsz, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
-    fputs("</tr>\n", pf);
+    g_string_append(gsz, "</tr>\n");
 
 
     /* display bar */
 
-    fputs("<tr>", pf);
-    fputs("<td>", pf);
+    g_string_append(gsz, "<tr>");
+    g_string_append(gsz, "<td>");
 
     sprintf(sz, "b-bar-o%u", anBoard[1][24]);
     if (anBoard[1][24])
@@ -1145,29 +1146,29 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
                "|&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;"
                "|&nbsp;&nbsp;&nbsp;|"
                "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;|");
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td>", pf);
-    fputs("</tr>\n", pf);
+    g_string_append(gsz, "</td>");
+    g_string_append(gsz, "</tr>\n");
 
 
     /* center of board */
 
-    fputs("<tr>", pf);
+    g_string_append(gsz, "<tr>");
 
     /* left part of bar */
 
-    fputs("<td>", pf);
+    g_string_append(gsz, "<td>");
     if (fClockwise)
-        printImage(pf, szImageDir, "b-midlb", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, "b-midlb", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
     else
-        printImage(pf, szImageDir, fTurn ? "b-midlb-o" : "b-midlb-x", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, fTurn ? "b-midlb-o" : "b-midlb-x", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td>", pf);
+    g_string_append(gsz, "</td>");
 
     /* center of board */
 
-    fputs("<td colspan=\"6\">", pf);
+    g_string_append(gsz, "<td colspan=\"6\">");
 
     if (!pms->fMove && pms->anDice[0] && pms->anDice[1]) {
 
@@ -1177,7 +1178,7 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         sprintf(szAlt, "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;%u&nbsp;%u&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                 pms->anDice[0], pms->anDice[1]);
 
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
     } else if (!pms->fMove && pms->fDoubled) {
 
@@ -1186,19 +1187,19 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         sprintf(sz, "b-midl-c%d", 2 * pms->nCube);
         sprintf(szAlt, "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;[%d]&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                 2 * pms->nCube);
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
     } else {
 
         /* player 0 on roll */
 
-        printImage(pf, szImageDir, "b-midl", szExtension,
+        printImage(gsz, szImageDir, "b-midl", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                    hecss, HTML_EXPORT_TYPE_GNU);
 
     }
 
-    fputs("</td>", pf);
+    g_string_append(gsz, "</td>");
 
     /* centered cube */
 
@@ -1210,13 +1211,13 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         strcpy(szAlt, "|&nbsp;&nbsp;&nbsp;|");
     }
 
-    fputs("<td>", pf);
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+    g_string_append(gsz, "<td>");
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
     /* player 1 */
 
-    fputs("<td colspan=\"6\">", pf);
+    g_string_append(gsz, "<td colspan=\"6\">");
 
     if (pms->fMove && pms->anDice[0] && pms->anDice[1]) {
 
@@ -1226,7 +1227,7 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         sprintf(szAlt, "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;%u&nbsp;%u&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                 pms->anDice[0], pms->anDice[1]);
 
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
     } else if (pms->fMove && pms->fDoubled) {
 
@@ -1236,60 +1237,60 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
         sprintf(szAlt, "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;[%d]&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                 2 * pms->nCube);
 
-        printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
     } else {
 
         /* player 1 on roll */
 
-        printImage(pf, szImageDir, "b-midr", szExtension,
+        printImage(gsz, szImageDir, "b-midr", szExtension,
                    "&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;&nbsp;",
                    hecss, HTML_EXPORT_TYPE_GNU);
 
     }
 
-    fputs("</td>", pf);
+    g_string_append(gsz, "</td>");
 
     /* right part of bar */
 
-    fputs("<td>", pf);
+    g_string_append(gsz, "<td>");
     if (!fClockwise)
-        printImage(pf, szImageDir, "b-midrb", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+        printImage(gsz, szImageDir, "b-midrb", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
     else
-        printImage(pf, szImageDir, fTurn ? "b-midrb-o" : "b-midrb-x", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+        printImage(gsz, szImageDir, fTurn ? "b-midrb-o" : "b-midrb-x", szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
-    fputs("</tr>\n", pf);
+    g_string_append(gsz, "</tr>\n");
 
 
     /* display left bearoff tray */
 
-    fputs("<tr>", pf);
+    g_string_append(gsz, "<tr>");
 
-    fputs("<td rowspan=\"2\">", pf);
+    g_string_append(gsz, "<td rowspan=\"2\">");
     if (fClockwise)
         /* Use roff as loff not generated (and probably not needed) */
         sprintf(sz, "b-roff-o%d", acOff[0]);
     else
         strcpy(sz, "b-loff-o0");
-    printImage(pf, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+    printImage(gsz, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
     /* display player 1's outer quadrant */
 
     for (i = 0; i < 6; i++) {
-        fputs("<td rowspan=\"2\">", pf);
+        g_string_append(gsz, "<td rowspan=\"2\">");
         if (fClockwise)
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][23 - i], anBoard[0][i], i % 2, FALSE, hecss);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][23 - i], anBoard[0][i], i % 2, FALSE, hecss);
         else
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][12 + i], anBoard[0][11 - i], i % 2, FALSE, hecss);
-        fputs("</td>", pf);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][12 + i], anBoard[0][11 - i], i % 2, FALSE, hecss);
+        g_string_append(gsz, "</td>");
     }
 
 
     /* display bar */
 
-    fputs("<td>", pf);
+    g_string_append(gsz, "<td>");
 
     sprintf(sz, "b-bar-x%u", anBoard[0][24]);
     if (pms->fCubeOwner == 1)
@@ -1297,40 +1298,40 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
     else
         strcpy(szAlt, "|&nbsp;&nbsp;&nbsp;|");
 
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td>", pf);
+    g_string_append(gsz, "</td>");
 
 
     /* display player 1's outer quadrant */
 
     for (i = 0; i < 6; i++) {
-        fputs("<td rowspan=\"2\">", pf);
+        g_string_append(gsz, "<td rowspan=\"2\">");
         if (fClockwise)
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][17 - i], anBoard[0][i + 6], i % 2, FALSE, hecss);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][17 - i], anBoard[0][i + 6], i % 2, FALSE, hecss);
         else
-            printPointGNU(pf, szImageDir, szExtension, anBoard[1][18 + i], anBoard[0][5 - i], i % 2, FALSE, hecss);
-        fputs("</td>", pf);
+            printPointGNU(gsz, szImageDir, szExtension, anBoard[1][18 + i], anBoard[0][5 - i], i % 2, FALSE, hecss);
+        g_string_append(gsz, "</td>");
     }
 
 
     /* right bearoff tray */
 
-    fputs("<td rowspan=\"2\">", pf);
+    g_string_append(gsz, "<td rowspan=\"2\">");
     if (!fClockwise)
         sprintf(sz, "b-roff-o%d", acOff[0]);
     else
         strcpy(sz, "b-roff-o0");
-    printImage(pf, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
+    printImage(gsz, szImageDir, sz, szExtension, "|", hecss, HTML_EXPORT_TYPE_GNU);
+    g_string_append(gsz, "</td>");
 
-    fputs("</tr>\n", pf);
+    g_string_append(gsz, "</tr>\n");
 
 
     /* display cube */
 
-    fputs("<tr>", pf);
-    fputs("<td>", pf);
+    g_string_append(gsz, "<tr>");
+    g_string_append(gsz, "<td>");
 
     if (pms->fCubeOwner == 1)
         sprintf(sz, "b-cb-%d", pms->nCube);
@@ -1347,72 +1348,72 @@ printHTMLBoardGNU(FILE * pf, matchstate * pms, int fTurn,
     else
         strcpy(szAlt, "");
 
-    printImage(pf, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
+    printImage(gsz, szImageDir, sz, szExtension, szAlt, hecss, HTML_EXPORT_TYPE_GNU);
 
-    fputs("</td>", pf);
-    fputs("</tr>\n", pf);
+    g_string_append(gsz, "</td>");
+    g_string_append(gsz, "</tr>\n");
 
 
     /* bottom */
 
-    fputs("<tr>", pf);
-    fputs("<td colspan=\"15\">", pf);
+    g_string_append(gsz, "<tr>");
+    g_string_append(gsz, "<td colspan=\"15\">");
     sprintf(sz, "b-%sbot%s", fTurn ? "lo" : "hi", fClockwise ? "" : "r");
-    printImage(pf, szImageDir, sz, szExtension,
+    printImage(gsz, szImageDir, sz, szExtension,
                fClockwise ?
                (fTurn ? "+--1--2--3--4--5--6-+---+--7--8--9-10-11-12-+" :
                 "+-24-23-22-21-20-19-+---+-18-17-16-15-14-13-+") :
                (fTurn ? "+-12-11-10--9--8--7-+---+--6--5--4--3--2--1-+" :
                 "+-13-14-15-16-17-18-+---+-19-20-21-22-23-24-+"), hecss, HTML_EXPORT_TYPE_GNU);
-    fputs("</td>", pf);
-    fputs("</tr>", pf);
+    g_string_append(gsz, "</td>");
+    g_string_append(gsz, "</tr>");
 
-    fputs("</table>\n\n", pf);
+    g_string_append(gsz, "</table>\n\n");
 
     /* pip counts */
 
-    fputs("<p>", pf);
+    g_string_append(gsz, "<p>");
 
     PipCount((ConstTanBoard) anBoard, anPips);
-    fprintf(pf, _("Pip counts: %s %u, %s %u<br/>\n"), ap[0].szName, anPips[1], ap[1].szName, anPips[0]);
+    g_string_append_printf(gsz, _("Pip counts: %s %u, %s %u<br/>\n"), ap[0].szName, anPips[1], ap[1].szName, anPips[0]);
 
     /* position ID */
 
-    fprintf(pf, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
+    g_string_append_printf(gsz, "<span %s>", GetStyle(CLASS_POSITIONID, hecss));
 
-    fprintf(pf, _("Position ID: <tt>%s</tt> Match ID: <tt>%s</tt><br/>\n"),
-            PositionID((ConstTanBoard) pms->anBoard), MatchIDFromMatchState(pms));
+    g_string_append_printf(gsz, _("Position ID: <tt>%s</tt> Match ID: <tt>%s</tt><br/>\n"),
+                            PositionID((ConstTanBoard) pms->anBoard), MatchIDFromMatchState(pms));
 
-    fprintf(pf, "</span>");
+    g_string_append_printf(gsz, "</span>");
 
-    fputs("</p>\n", pf);
+    g_string_append(gsz, "</p>\n");
 
 }
 
 
 static void
-printHTMLBoard(FILE * pf, matchstate * pms, int fTurn,
+printHTMLBoard(GString * gsz, matchstate * pms, int fTurn,
                const char *szImageDir, const char *szExtension, const htmlexporttype het, const htmlexportcss hecss)
 {
 
-    fputs("\n<!--  Board -->\n\n", pf);
+    g_string_append(gsz, "\n<!--  Board -->\n\n");
 
     switch (het) {
     case HTML_EXPORT_TYPE_FIBS2HTML:
-        printHTMLBoardF2H(pf, pms, fTurn, szImageDir, szExtension, hecss);
+        printHTMLBoardF2H(gsz, pms, fTurn, szImageDir, szExtension, hecss);
         break;
     case HTML_EXPORT_TYPE_BBS:
-        printHTMLBoardBBS(pf, pms, fTurn, szImageDir, szExtension, hecss);
+        printHTMLBoardBBS(gsz, pms, fTurn, szImageDir, szExtension, hecss);
         break;
     case HTML_EXPORT_TYPE_GNU:
-        printHTMLBoardGNU(pf, pms, fTurn, szImageDir, szExtension, hecss);
+        printHTMLBoardGNU(gsz, pms, fTurn, szImageDir, szExtension, hecss);
         break;
     default:
         printf(_("unknown board type\n"));
         break;
     }
 
-    fputs("\n<!-- End Board -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- End Board -->\n\n");
 
 }
 
@@ -1421,61 +1422,61 @@ printHTMLBoard(FILE * pf, matchstate * pms, int fTurn,
  * Print html header for board: move or cube decision 
  *
  * Input:
- *   pf: output file
+ *   gsz: output string
  *   ms: current match state
  *   iMove: move no.
  *
  */
 
 static void
-HTMLBoardHeader(FILE * pf, const matchstate * pms,
+HTMLBoardHeader(GString * gsz, const matchstate * pms,
                 const htmlexporttype UNUSED(het),
                 const htmlexportcss UNUSED(hecss), const int iGame, const int iMove, const int fHR)
 {
 
-    fputs("\n<!-- Header -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- Header -->\n\n");
 
     if (fHR)
-        fputs("<hr/>\n", pf);
+        g_string_append(gsz, "<hr/>\n");
 
-    fputs("<p>", pf);
+    g_string_append(gsz, "<p>");
 
     if (iMove >= 0) {
-        fprintf(pf, "<b>" "<a name=\"game%d.move%d\">", iGame + 1, iMove + 1);
-        fprintf(pf, _("Move number %d:"), iMove + 1);
-        fputs("</a></b>", pf);
+        g_string_append_printf(gsz, "<b>" "<a name=\"game%d.move%d\">", iGame + 1, iMove + 1);
+        g_string_append_printf(gsz, _("Move number %d:"), iMove + 1);
+        g_string_append(gsz, "</a></b>");
     }
 
     if (pms->fResigned)
 
         /* resignation */
 
-        fprintf(pf,
-                ngettext(" %s resigns %d point",
-                         " %s resigns %d points",
-                         pms->fResigned * pms->nCube), ap[pms->fTurn].szName, pms->fResigned * pms->nCube);
+        g_string_append_printf(gsz,
+                                ngettext(" %s resigns %d point",
+                                         " %s resigns %d points",
+                                         pms->fResigned * pms->nCube), ap[pms->fTurn].szName, pms->fResigned * pms->nCube);
 
     else if (pms->anDice[0] && pms->anDice[1])
 
         /* chequer play decision */
 
-        fprintf(pf, _(" %s to play %u%u"), ap[pms->fMove].szName, pms->anDice[0], pms->anDice[1]
-            );
+        g_string_append_printf(gsz, _(" %s to play %u%u"), ap[pms->fMove].szName, pms->anDice[0], pms->anDice[1]
+                            );
 
     else if (pms->fDoubled)
 
         /* take decision */
 
-        fprintf(pf, _(" %s doubles to %d"), ap[!pms->fTurn].szName, pms->nCube * 2);
+        g_string_append_printf(gsz, _(" %s doubles to %d"), ap[!pms->fTurn].szName, pms->nCube * 2);
 
     else
         /* cube decision */
 
-        fprintf(pf, _(" %s on roll, cube decision?"), ap[pms->fMove].szName);
+        g_string_append_printf(gsz, _(" %s on roll, cube decision?"), ap[pms->fMove].szName);
 
-    fputs("</p>\n", pf);
+    g_string_append(gsz, "</p>\n");
 
-    fputs("\n<!-- End Header -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- End Header -->\n\n");
 
 }
 
@@ -1678,7 +1679,7 @@ HTMLEpilogueComment(FILE * pf)
  * Print cube analysis
  *
  * Input:
- *  pf: output file
+ *  gsz: output string
  *  arDouble: equitites for cube decisions
  *  fPlayer: player who doubled
  *  esDouble: eval setup
@@ -1689,7 +1690,7 @@ HTMLEpilogueComment(FILE * pf)
  */
 
 static void
-HTMLPrintCubeAnalysisTable(FILE * pf,
+HTMLPrintCubeAnalysisTable(GString * gsz,
                            float aarOutput[2][NUM_ROLLOUT_OUTPUTS],
                            float aarStdDev[2][NUM_ROLLOUT_OUTPUTS],
                            int UNUSED(fPlayer),
@@ -1734,7 +1735,7 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
     if (!fDisplay)
         return;
 
-    fputs("\n<!-- Cube Analysis -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- Cube Analysis -->\n\n");
 
 
     /* print alerts */
@@ -1745,17 +1746,17 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
         /* missed double */
 
-        fprintf(pf, "<p><span %s>%s (%s)!",
-                GetStyle(CLASS_BLUNDER, hecss),
-                _("Alert: missed double"),
-                OutputEquityDiff(arDouble[OUTPUT_NODOUBLE],
-                                 (arDouble[OUTPUT_TAKE] >
-                                  arDouble[OUTPUT_DROP]) ? arDouble[OUTPUT_DROP] : arDouble[OUTPUT_TAKE], pci));
+        g_string_append_printf(gsz, "<p><span %s>%s (%s)!",
+                                GetStyle(CLASS_BLUNDER, hecss),
+                                _("Alert: missed double"),
+                                OutputEquityDiff(arDouble[OUTPUT_NODOUBLE],
+                                                 (arDouble[OUTPUT_TAKE] >
+                                                  arDouble[OUTPUT_DROP]) ? arDouble[OUTPUT_DROP] : arDouble[OUTPUT_TAKE], pci));
 
         if (badSkill(stDouble))
-            fprintf(pf, " [%s]", gettext(aszSkillType[stDouble]));
+            g_string_append_printf(gsz, " [%s]", gettext(aszSkillType[stDouble]));
 
-        fprintf(pf, "</span></p>\n");
+        g_string_append_printf(gsz, "</span></p>\n");
 
     }
 
@@ -1767,14 +1768,14 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
         /* wrong take */
 
-        fprintf(pf, "<p><span %s>%s (%s)!",
-                GetStyle(CLASS_BLUNDER, hecss),
-                _("Alert: wrong take"), OutputEquityDiff(arDouble[OUTPUT_DROP], arDouble[OUTPUT_TAKE], pci));
+        g_string_append_printf(gsz, "<p><span %s>%s (%s)!",
+                                GetStyle(CLASS_BLUNDER, hecss),
+                                _("Alert: wrong take"), OutputEquityDiff(arDouble[OUTPUT_DROP], arDouble[OUTPUT_TAKE], pci));
 
         if (badSkill(stTake))
-            fprintf(pf, " [%s]", gettext(aszSkillType[stTake]));
+            g_string_append_printf(gsz, " [%s]", gettext(aszSkillType[stTake]));
 
-        fprintf(pf, "</span></p>\n");
+        g_string_append_printf(gsz, "</span></p>\n");
 
     }
 
@@ -1786,14 +1787,14 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
         /* wrong pass */
 
-        fprintf(pf, "<p><span %s>%s (%s)!",
-                GetStyle(CLASS_BLUNDER, hecss),
-                _("Alert: wrong pass"), OutputEquityDiff(arDouble[OUTPUT_TAKE], arDouble[OUTPUT_DROP], pci));
+        g_string_append_printf(gsz, "<p><span %s>%s (%s)!",
+                                GetStyle(CLASS_BLUNDER, hecss),
+                                _("Alert: wrong pass"), OutputEquityDiff(arDouble[OUTPUT_TAKE], arDouble[OUTPUT_DROP], pci));
 
         if (badSkill(stTake))
-            fprintf(pf, " [%s]", gettext(aszSkillType[stTake]));
+            g_string_append_printf(gsz, " [%s]", gettext(aszSkillType[stTake]));
 
-        fprintf(pf, "</span></p>\n");
+        g_string_append_printf(gsz, "</span></p>\n");
 
     }
 
@@ -1809,109 +1810,109 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
         /* wrong double */
 
-        fprintf(pf, "<p><span %s>%s (%s)!",
-                GetStyle(CLASS_BLUNDER, hecss),
-                _("Alert: wrong double"),
-                OutputEquityDiff((arDouble[OUTPUT_TAKE] >
-                                  arDouble[OUTPUT_DROP]) ?
-                                 arDouble[OUTPUT_DROP] : arDouble[OUTPUT_TAKE], arDouble[OUTPUT_NODOUBLE], pci));
+        g_string_append_printf(gsz, "<p><span %s>%s (%s)!",
+                                GetStyle(CLASS_BLUNDER, hecss),
+                                _("Alert: wrong double"),
+                                OutputEquityDiff((arDouble[OUTPUT_TAKE] >
+                                                  arDouble[OUTPUT_DROP]) ?
+                                                 arDouble[OUTPUT_DROP] : arDouble[OUTPUT_TAKE], arDouble[OUTPUT_NODOUBLE], pci));
 
         if (badSkill(stDouble))
-            fprintf(pf, " [%s]", gettext(aszSkillType[stDouble]));
+            g_string_append_printf(gsz, " [%s]", gettext(aszSkillType[stDouble]));
 
-        fprintf(pf, "</span></p>\n");
+        g_string_append_printf(gsz, "</span></p>\n");
 
     }
 
     if ((badSkill(stDouble) || badSkill(stTake)) && !fAnno) {
 
         if (badSkill(stDouble)) {
-            fprintf(pf, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
-            fprintf(pf, _("Alert: double decision marked %s"), gettext(aszSkillType[stDouble]));
-            fputs("</span></p>\n", pf);
+            g_string_append_printf(gsz, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
+            g_string_append_printf(gsz, _("Alert: double decision marked %s"), gettext(aszSkillType[stDouble]));
+            g_string_append(gsz, "</span></p>\n");
         }
 
         if (badSkill(stTake)) {
-            fprintf(pf, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
-            fprintf(pf, _("Alert: take decision marked %s"), gettext(aszSkillType[stTake]));
-            fputs("</span></p>\n", pf);
+            g_string_append_printf(gsz, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
+            g_string_append_printf(gsz, _("Alert: take decision marked %s"), gettext(aszSkillType[stTake]));
+            g_string_append(gsz, "</span></p>\n");
         }
 
     }
 
     /* print table */
 
-    fprintf(pf, "<table %s>\n", GetStyle(CLASS_CUBEDECISION, hecss));
+    g_string_append_printf(gsz, "<table %s>\n", GetStyle(CLASS_CUBEDECISION, hecss));
 
     /* header */
 
-    fprintf(pf,
-            "<tr><th colspan=\"4\" %s>%s</th></tr>\n", GetStyle(CLASS_CUBEDECISIONHEADER, hecss), _("Cube decision"));
+    g_string_append_printf(gsz,
+                            "<tr><th colspan=\"4\" %s>%s</th></tr>\n", GetStyle(CLASS_CUBEDECISIONHEADER, hecss), _("Cube decision"));
 
     /* ply & cubeless equity */
 
     /* FIXME: about parameters if exsExport.afCubeParameters */
 
-    fprintf(pf, "<tr>");
+    g_string_append_printf(gsz, "<tr>");
 
     /* ply */
 
-    fprintf(pf, "<td colspan=\"2\">" "<span %s>", GetStyle(CLASS_CUBE_PLY, hecss));
+    g_string_append_printf(gsz, "<td colspan=\"2\">" "<span %s>", GetStyle(CLASS_CUBE_PLY, hecss));
 
     switch (pes->et) {
     case EVAL_NONE:
-        fputs(_("n/a"), pf);
+        g_string_append(gsz, _("n/a"));
         break;
     case EVAL_EVAL:
-        fprintf(pf, _("%d-ply"), pes->ec.nPlies);
+        g_string_append_printf(gsz, _("%d-ply"), pes->ec.nPlies);
         break;
     case EVAL_ROLLOUT:
-        fputs(_("Rollout"), pf);
+        g_string_append(gsz, _("Rollout"));
         break;
     }
 
     /* cubeless equity */
 
     if (pci->nMatchTo)
-        fprintf(pf,
-                "</span> %s</td>"
-                "<td %s>%s</td>"
-                "<td %s>(%s: <span %s>%s</span>)</td>\n",
-                (!pci->nMatchTo || !fOutputMWC) ?
-                _("cubeless equity") : _("cubeless MWC"),
-                GetStyle(CLASS_CUBE_EQUITY, hecss),
-                OutputEquity(aarOutput[0][OUTPUT_EQUITY], pci, TRUE),
-                GetStyle(CLASS_CUBE_CUBELESS_TEXT, hecss),
-                _("Money"), GetStyle(CLASS_CUBE_EQUITY, hecss), OutputMoneyEquity(aarOutput[0], TRUE));
+        g_string_append_printf(gsz,
+                                "</span> %s</td>"
+                                "<td %s>%s</td>"
+                                "<td %s>(%s: <span %s>%s</span>)</td>\n",
+                                (!pci->nMatchTo || !fOutputMWC) ?
+                                _("cubeless equity") : _("cubeless MWC"),
+                                GetStyle(CLASS_CUBE_EQUITY, hecss),
+                                OutputEquity(aarOutput[0][OUTPUT_EQUITY], pci, TRUE),
+                                GetStyle(CLASS_CUBE_CUBELESS_TEXT, hecss),
+                                _("Money"), GetStyle(CLASS_CUBE_EQUITY, hecss), OutputMoneyEquity(aarOutput[0], TRUE));
     else
-        fprintf(pf, " cubeless equity</td><td>%s</td><td>&nbsp;</td>\n", OutputMoneyEquity(aarOutput[0], TRUE));
+        g_string_append_printf(gsz, " cubeless equity</td><td>%s</td><td>&nbsp;</td>\n", OutputMoneyEquity(aarOutput[0], TRUE));
 
 
-    fprintf(pf, "</tr>\n");
+    g_string_append_printf(gsz, "</tr>\n");
 
     /* percentages */
 
     if (exsExport.fCubeDetailProb && pes->et == EVAL_EVAL) {
 
-        fprintf(pf, "<tr><td>&nbsp;</td>" "<td colspan=\"3\" %s>", GetStyle(CLASS_CUBE_PROBABILITIES, hecss));
+        g_string_append_printf(gsz, "<tr><td>&nbsp;</td>" "<td colspan=\"3\" %s>", GetStyle(CLASS_CUBE_PROBABILITIES, hecss));
 
-        fputs(OutputPercents(aarOutput[0], TRUE), pf);
+        g_string_append(gsz, OutputPercents(aarOutput[0], TRUE));
 
-        fputs("</td></tr>\n", pf);
+        g_string_append(gsz, "</td></tr>\n");
 
     }
 
     /* equities */
 
-    fprintf(pf, "<tr><td colspan=\"4\">%s</td></tr>\n", _("Cubeful equities:"));
+    g_string_append_printf(gsz, "<tr><td colspan=\"4\">%s</td></tr>\n", _("Cubeful equities:"));
 
     /* evaluate parameters */
 
     if (pes->et == EVAL_EVAL && exsExport.afCubeParameters[0]) {
 
-        fputs("<tr><td>&nbsp;</td>" "<td colspan=\"3\">", pf);
-        fputs(OutputEvalContext(&pes->ec, FALSE), pf);
-        fputs("</td></tr>\n", pf);
+        g_string_append(gsz, "<tr><td>&nbsp;</td>" "<td colspan=\"3\">");
+        g_string_append(gsz, OutputEvalContext(&pes->ec, FALSE));
+        g_string_append(gsz, "</td></tr>\n");
 
     }
 
@@ -1919,38 +1920,38 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
     for (i = 0; i < 3; i++) {
 
-        fprintf(pf, "<tr><td>%d.</td><td>%s</td>", i + 1, gettext(aszCube[ai[i]]));
+        g_string_append_printf(gsz, "<tr><td>%d.</td><td>%s</td>", i + 1, gettext(aszCube[ai[i]]));
 
-        fprintf(pf, "<td %s>%s</td>", GetStyle(CLASS_CUBE_EQUITY, hecss), OutputEquity(arDouble[ai[i]], pci, TRUE));
+        g_string_append_printf(gsz, "<td %s>%s</td>", GetStyle(CLASS_CUBE_EQUITY, hecss), OutputEquity(arDouble[ai[i]], pci, TRUE));
 
         if (i)
-            fprintf(pf, "<td>%s</td>", OutputEquityDiff(arDouble[ai[i]], arDouble[OUTPUT_OPTIMAL], pci));
+            g_string_append_printf(gsz, "<td>%s</td>", OutputEquityDiff(arDouble[ai[i]], arDouble[OUTPUT_OPTIMAL], pci));
         else
-            fputs("<td>&nbsp;</td>", pf);
+            g_string_append(gsz, "<td>&nbsp;</td>");
 
-        fputs("</tr>\n", pf);
+        g_string_append(gsz, "</tr>\n");
 
     }
 
     /* cube decision */
 
-    fprintf(pf,
-            "<tr><td colspan=\"2\">%s</td>"
-            "<td colspan=\"2\" %s>%s",
-            _("Proper cube action:"), GetStyle(CLASS_CUBE_ACTION, hecss), GetCubeRecommendation(cd));
+    g_string_append_printf(gsz,
+                            "<tr><td colspan=\"2\">%s</td>"
+                            "<td colspan=\"2\" %s>%s",
+                            _("Proper cube action:"), GetStyle(CLASS_CUBE_ACTION, hecss), GetCubeRecommendation(cd));
 
     if ((r = getPercent(cd, arDouble)) >= 0.0f)
-        fprintf(pf, " (%.1f%%)", 100.0f * r);
+        g_string_append_printf(gsz, " (%.1f%%)", 100.0f * r);
 
 
 
-    fprintf(pf, "</td></tr>\n");
+    g_string_append_printf(gsz, "</td></tr>\n");
 
     /* rollout details */
 
     if (pes->et == EVAL_ROLLOUT && (exsExport.fCubeDetailProb || exsExport.afCubeParameters[1])) {
 
-        fprintf(pf, "<tr><th colspan=\"4\">%s</th></tr>\n", _("Rollout details"));
+        g_string_append_printf(gsz, "<tr><th colspan=\"4\">%s</th></tr>\n", _("Rollout details"));
 
     }
 
@@ -1972,11 +1973,11 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
         }
 
-        fputs("<tr>" "<td colspan=\"4\">", pf);
+        g_string_append(gsz, "<tr>" "<td colspan=\"4\">");
 
-        printRolloutTable(pf, asz, aarOutput, aarStdDev, aci, 2, pes->rc.fCubeful, TRUE, hecss);
+        printRolloutTable(gsz, asz, aarOutput, aarStdDev, aci, 2, pes->rc.fCubeful, TRUE, hecss);
 
-        fputs("</td></tr>\n", pf);
+        g_string_append(gsz, "</td></tr>\n");
 
     }
 
@@ -1988,7 +1989,7 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
         while ((pcE = strstr(pcS, "\n"))) {
 
             *pcE = 0;
-            fprintf(pf, "<tr><td colspan=\"4\">%s</td></tr>\n", pcS);
+            g_string_append_printf(gsz, "<tr><td colspan=\"4\">%s</td></tr>\n", pcS);
             pcS = pcE + 1;
 
         }
@@ -1997,11 +1998,11 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
 
     }
 
-    fprintf(pf, "</table>\n");
+    g_string_append_printf(gsz, "</table>\n");
 
-    fputs("<p>&nbsp;</p>\n", pf);
+    g_string_append(gsz, "<p>&nbsp;</p>\n");
 
-    fputs("\n<!-- End Cube Analysis -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- End Cube Analysis -->\n\n");
 
 }
 
@@ -2011,7 +2012,7 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
  * Wrapper for print cube analysis
  *
  * Input:
- *  pf: output file
+ *  gsz: output string
  *  pms: match state
  *  pmr: current move record
  *  szImageDir: URI to images
@@ -2021,15 +2022,12 @@ HTMLPrintCubeAnalysisTable(FILE * pf,
  */
 
 static void
-HTMLPrintCubeAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
+HTMLPrintCubeAnalysis(GString * gsz, matchstate * pms, moverecord * pmr,
                       const char *UNUSED(szImageDir), const char *UNUSED(szExtension),
                       const htmlexporttype UNUSED(het), const htmlexportcss hecss)
 {
 
     cubeinfo ci;
-    /* we need to remember the double type to be able to do the right
-     * thing for beavers and racoons */
-    static doubletype dt = DT_NORMAL;
 
     GetMatchStateCubeInfo(&ci, pms);
 
@@ -2039,23 +2037,21 @@ HTMLPrintCubeAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
 
         /* cube analysis from move */
 
-        HTMLPrintCubeAnalysisTable(pf,
+        HTMLPrintCubeAnalysisTable(gsz,
                                    pmr->CubeDecPtr->aarOutput, pmr->CubeDecPtr->aarStdDev,
                                    pmr->fPlayer,
                                    &pmr->CubeDecPtr->esDouble, &ci, FALSE, -1, pmr->stCube, SKILL_NONE, hecss);
-        dt = DT_NORMAL;
 
         break;
 
     case MOVE_DOUBLE:
 
-        dt = DoubleType(pms->fDoubled, pms->fMove, pms->fTurn);
-        if (dt != DT_NORMAL) {
-            fprintf(pf, "<p><span %s> Cannot analyse doubles nor raccoons!</span></p>\n",
-                    GetStyle(CLASS_BLUNDER, hecss));
+        if (DoubleType(pms->fDoubled, pms->fMove, pms->fTurn) != DT_NORMAL) {
+            g_string_append_printf(gsz, "<p><span %s> Cannot analyse doubles nor raccoons!</span></p>\n",
+                                    GetStyle(CLASS_BLUNDER, hecss));
             break;
         }
-        HTMLPrintCubeAnalysisTable(pf,
+        HTMLPrintCubeAnalysisTable(gsz,
                                    pmr->CubeDecPtr->aarOutput,
                                    pmr->CubeDecPtr->aarStdDev,
                                    pmr->fPlayer,
@@ -2066,15 +2062,15 @@ HTMLPrintCubeAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
     case MOVE_TAKE:
     case MOVE_DROP:
 
-        /* cube analysis from double, {take, drop, beaver} */
+        /* cube analysis from double, {take, drop, beaver}; the match
+         * state counts the beavers of the double being answered */
 
-        if (dt != DT_NORMAL) {
-            dt = DT_NORMAL;
-            fprintf(pf, "<p><span %s> Cannot analyse doubles nor raccoons!</span></p>\n",
-                    GetStyle(CLASS_BLUNDER, hecss));
+        if (pms->cBeavers) {
+            g_string_append_printf(gsz, "<p><span %s> Cannot analyse doubles nor raccoons!</span></p>\n",
+                                    GetStyle(CLASS_BLUNDER, hecss));
             break;
         }
-        HTMLPrintCubeAnalysisTable(pf, pmr->CubeDecPtr->aarOutput, pmr->CubeDecPtr->aarStdDev, pmr->fPlayer, &pmr->CubeDecPtr->esDouble, &ci, TRUE, pmr->mt == MOVE_TAKE, SKILL_NONE,   /* FIXME: skill from prev. cube */
+        HTMLPrintCubeAnalysisTable(gsz, pmr->CubeDecPtr->aarOutput, pmr->CubeDecPtr->aarStdDev, pmr->fPlayer, &pmr->CubeDecPtr->esDouble, &ci, TRUE, pmr->mt == MOVE_TAKE, SKILL_NONE,   /* FIXME: skill from prev. cube */
                                    pmr->stCube, hecss);
 
         break;
@@ -2094,7 +2090,7 @@ HTMLPrintCubeAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
  * Print move analysis
  *
  * Input:
- *  pf: output file
+ *  gsz: output string
  *  pms: match state
  *  pmr: current move record
  *  szImageDir: URI to images
@@ -2103,7 +2099,7 @@ HTMLPrintCubeAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
  */
 
 static void
-HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
+HTMLPrintMoveAnalysis(GString * gsz, matchstate * pms, moverecord * pmr,
                       const char *UNUSED(szImageDir), const char *UNUSED(szExtension),
                       const htmlexporttype UNUSED(het), const htmlexportcss hecss)
 {
@@ -2121,7 +2117,7 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
     if (!exsExport.afMovesDisplay[pmr->n.stMove])
         return;
 
-    fputs("\n<!-- Move Analysis -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- Move Analysis -->\n\n");
 
     /* print alerts */
 
@@ -2129,16 +2125,16 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
 
         /* blunder or error */
 
-        fprintf(pf, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
-        fprintf(pf, _("Alert: %s move"), gettext(aszSkillType[pmr->n.stMove]));
+        g_string_append_printf(gsz, "<p><span %s>", GetStyle(CLASS_BLUNDER, hecss));
+        g_string_append_printf(gsz, _("Alert: %s move"), gettext(aszSkillType[pmr->n.stMove]));
 
         if (!pms->nMatchTo || !fOutputMWC)
-            fprintf(pf, " (%+7.3f)</span></p>\n", pmr->ml.amMoves[pmr->n.iMove].rScore - pmr->ml.amMoves[0].rScore);
+            g_string_append_printf(gsz, " (%+7.3f)</span></p>\n", pmr->ml.amMoves[pmr->n.iMove].rScore - pmr->ml.amMoves[0].rScore);
         else
-            fprintf(pf, " (%+6.3f%%)</span></p>\n",
-                    100.0f *
-                    eq2mwc(pmr->ml.amMoves[pmr->n.iMove].rScore, &ci) -
-                    100.0f * eq2mwc(pmr->ml.amMoves[0].rScore, &ci));
+            g_string_append_printf(gsz, " (%+6.3f%%)</span></p>\n",
+                                    100.0f *
+                                    eq2mwc(pmr->ml.amMoves[pmr->n.iMove].rScore, &ci) -
+                                    100.0f * eq2mwc(pmr->ml.amMoves[0].rScore, &ci));
 
     }
 
@@ -2146,29 +2142,29 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
 
         /* joker */
 
-        fprintf(pf, "<p><span %s>", GetStyle(CLASS_JOKER, hecss));
-        fprintf(pf, _("Alert: %s roll!"), gettext(aszLuckType[pmr->lt]));
+        g_string_append_printf(gsz, "<p><span %s>", GetStyle(CLASS_JOKER, hecss));
+        g_string_append_printf(gsz, _("Alert: %s roll!"), gettext(aszLuckType[pmr->lt]));
 
         if (!pms->nMatchTo || !fOutputMWC)
-            fprintf(pf, " (%+7.3f)</span></p>\n", pmr->rLuck);
+            g_string_append_printf(gsz, " (%+7.3f)</span></p>\n", pmr->rLuck);
         else
-            fprintf(pf, " (%+6.3f%%)</span></p>\n", 100.0f * eq2mwc(pmr->rLuck, &ci) - 100.0f * eq2mwc(0.0f, &ci));
+            g_string_append_printf(gsz, " (%+6.3f%%)</span></p>\n", 100.0f * eq2mwc(pmr->rLuck, &ci) - 100.0f * eq2mwc(0.0f, &ci));
 
     }
 
 
     /* table header */
 
-    fprintf(pf,
-            "<table border=\"0\" cellspacing=\"0\" cellpadding=\"0\" %s>\n" "<tr>\n", GetStyle(CLASS_MOVETABLE, hecss));
-    fprintf(pf, "<th %s colspan=\"2\">%s</th>\n",
-            GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVENUMBER, -1), _("#"));
-    fprintf(pf, "<th %s>%s</th>\n", GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEPLY, -1), _("Ply"));
-    fprintf(pf, "<th %s>%s</th>\n", GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEMOVE, -1), Q_("noun|Move"));
-    fprintf(pf,
-            "<th %s>%s</th>\n" "</tr>\n",
-            GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEEQUITY, -1),
-            (!pms->nMatchTo || !fOutputMWC) ? _("Equity") : _("MWC"));
+    g_string_append_printf(gsz,
+                            "<table border=\"0\" cellspacing=\"0\" cellpadding=\"0\" %s>\n" "<tr>\n", GetStyle(CLASS_MOVETABLE, hecss));
+    g_string_append_printf(gsz, "<th %s colspan=\"2\">%s</th>\n",
+                            GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVENUMBER, -1), _("#"));
+    g_string_append_printf(gsz, "<th %s>%s</th>\n", GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEPLY, -1), _("Ply"));
+    g_string_append_printf(gsz, "<th %s>%s</th>\n", GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEMOVE, -1), Q_("noun|Move"));
+    g_string_append_printf(gsz,
+                            "<th %s>%s</th>\n" "</tr>\n",
+                            GetStyleGeneral(hecss, CLASS_MOVEHEADER, CLASS_MOVEEQUITY, -1),
+                            (!pms->nMatchTo || !fOutputMWC) ? _("Equity") : _("MWC"));
 
 
     if (pmr->ml.cMoves) {
@@ -2179,43 +2175,43 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
                 continue;
 
             if (i == pmr->n.iMove)
-                fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
+                g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
             else if (i % 2)
-                fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
+                g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
             else
-                fputs("<tr>\n", pf);
+                g_string_append(gsz, "<tr>\n");
 
             /* selected move or not */
 
-            fprintf(pf, "<td %s>%s</td>\n", GetStyle(CLASS_MOVENUMBER, hecss), (i == pmr->n.iMove) ? bullet : "&nbsp;");
+            g_string_append_printf(gsz, "<td %s>%s</td>\n", GetStyle(CLASS_MOVENUMBER, hecss), (i == pmr->n.iMove) ? bullet : "&nbsp;");
 
             /* move no */
 
             if (i != pmr->n.iMove || i != pmr->ml.cMoves - 1 || pmr->ml.cMoves == 1 || i < exsExport.nMoves)
-                fprintf(pf, "<td %s>%u</td>\n", GetStyle(CLASS_MOVENUMBER, hecss), i + 1);
+                g_string_append_printf(gsz, "<td %s>%u</td>\n", GetStyle(CLASS_MOVENUMBER, hecss), i + 1);
             else
-                fprintf(pf, "<td %s>\?\?</td>\n", GetStyle(CLASS_MOVENUMBER, hecss));
+                g_string_append_printf(gsz, "<td %s>\?\?</td>\n", GetStyle(CLASS_MOVENUMBER, hecss));
 
             /* ply */
 
             switch (pmr->ml.amMoves[i].esMove.et) {
             case EVAL_NONE:
-                fprintf(pf, "<td %s>n/a</td>\n", GetStyle(CLASS_MOVEPLY, hecss));
+                g_string_append_printf(gsz, "<td %s>n/a</td>\n", GetStyle(CLASS_MOVEPLY, hecss));
                 break;
             case EVAL_EVAL:
-                fprintf(pf, "<td %s>%u</td>\n", GetStyle(CLASS_MOVEPLY, hecss), pmr->ml.amMoves[i].esMove.ec.nPlies);
+                g_string_append_printf(gsz, "<td %s>%u</td>\n", GetStyle(CLASS_MOVEPLY, hecss), pmr->ml.amMoves[i].esMove.ec.nPlies);
                 break;
             case EVAL_ROLLOUT:
-                fprintf(pf, "<td %s>R</td>\n", GetStyle(CLASS_MOVEPLY, hecss));
+                g_string_append_printf(gsz, "<td %s>R</td>\n", GetStyle(CLASS_MOVEPLY, hecss));
                 break;
             }
 
             /* move */
 
-            fprintf(pf,
-                    "<td %s>%s</td>\n",
-                    GetStyle(CLASS_MOVEMOVE, hecss),
-                    FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->ml.amMoves[i].anMove));
+            g_string_append_printf(gsz,
+                                    "<td %s>%s</td>\n",
+                                    GetStyle(CLASS_MOVEMOVE, hecss),
+                                    FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->ml.amMoves[i].anMove));
 
             /* equity */
 
@@ -2223,16 +2219,16 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
             rEqTop = pmr->ml.amMoves[0].rScore;
 
             if (i)
-                fprintf(pf,
-                        "<td %s>%s (%s)</td>\n",
-                        GetStyle(CLASS_MOVEEQUITY, hecss),
-                        OutputEquity(rEq, &ci, TRUE), OutputEquityDiff(rEq, rEqTop, &ci));
+                g_string_append_printf(gsz,
+                                        "<td %s>%s (%s)</td>\n",
+                                        GetStyle(CLASS_MOVEEQUITY, hecss),
+                                        OutputEquity(rEq, &ci, TRUE), OutputEquityDiff(rEq, rEqTop, &ci));
             else
-                fprintf(pf, "<td %s>%s</td>\n", GetStyle(CLASS_MOVEEQUITY, hecss), OutputEquity(rEq, &ci, TRUE));
+                g_string_append_printf(gsz, "<td %s>%s</td>\n", GetStyle(CLASS_MOVEEQUITY, hecss), OutputEquity(rEq, &ci, TRUE));
 
             /* end row */
 
-            fprintf(pf, "</tr>\n");
+            g_string_append_printf(gsz, "</tr>\n");
 
             /*
              * print row with detailed probabilities 
@@ -2245,24 +2241,24 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
                 /* percentages */
 
                 if (i == pmr->n.iMove)
-                    fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
+                    g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
                 else if (i % 2)
-                    fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
+                    g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
                 else
-                    fputs("<tr>\n", pf);
+                    g_string_append(gsz, "<tr>\n");
 
-                fputs("<td colspan=\"3\">&nbsp;</td>\n", pf);
+                g_string_append(gsz, "<td colspan=\"3\">&nbsp;</td>\n");
 
 
-                fputs("<td>", pf);
+                g_string_append(gsz, "<td>");
 
 
                 switch (pmr->ml.amMoves[i].esMove.et) {
                 case EVAL_EVAL:
-                    fputs(OutputPercents(ar, TRUE), pf);
+                    g_string_append(gsz, OutputPercents(ar, TRUE));
                     break;
                 case EVAL_ROLLOUT:
-                    printRolloutTable(pf, NULL, (float (*)[NUM_ROLLOUT_OUTPUTS])
+                    printRolloutTable(gsz, NULL, (float (*)[NUM_ROLLOUT_OUTPUTS])
                                       pmr->ml.amMoves[i].arEvalMove, (float (*)[NUM_ROLLOUT_OUTPUTS])
                                       pmr->ml.amMoves[i].arEvalStdDev,
                                       &ci, 1, pmr->ml.amMoves[i].esMove.rc.fCubeful, FALSE, hecss);
@@ -2271,11 +2267,11 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
                     break;
                 }
 
-                fputs("</td>\n", pf);
+                g_string_append(gsz, "</td>\n");
 
-                fputs("<td>&nbsp;</td>\n", pf);
+                g_string_append(gsz, "<td>&nbsp;</td>\n");
 
-                fputs("</tr>\n", pf);
+                g_string_append(gsz, "</tr>\n");
             }
 
             /*
@@ -2290,21 +2286,21 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
                 case EVAL_EVAL:
 
                     if (i == pmr->n.iMove)
-                        fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
+                        g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
                     else if (i % 2)
-                        fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
+                        g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
                     else
-                        fputs("<tr>\n", pf);
+                        g_string_append(gsz, "<tr>\n");
 
-                    fprintf(pf, "<td colspan=\"3\">&nbsp;</td>\n");
+                    g_string_append_printf(gsz, "<td colspan=\"3\">&nbsp;</td>\n");
 
-                    fputs("<td>", pf);
-                    fputs(OutputEvalContext(&pes->ec, TRUE), pf);
-                    fputs("</td>\n", pf);
+                    g_string_append(gsz, "<td>");
+                    g_string_append(gsz, OutputEvalContext(&pes->ec, TRUE));
+                    g_string_append(gsz, "</td>\n");
 
-                    fputs("<td>&nbsp;</td>\n", pf);
+                    g_string_append(gsz, "<td>&nbsp;</td>\n");
 
-                    fputs("</tr>\n", pf);
+                    g_string_append(gsz, "</tr>\n");
 
                     break;
 
@@ -2318,21 +2314,21 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
                             *pcE = 0;
 
                             if (i == pmr->n.iMove)
-                                fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
+                                g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVETHEMOVE, hecss));
                             else if (i % 2)
-                                fprintf(pf, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
+                                g_string_append_printf(gsz, "<tr %s>\n", GetStyle(CLASS_MOVEODD, hecss));
                             else
-                                fputs("<tr>\n", pf);
+                                g_string_append(gsz, "<tr>\n");
 
-                            fprintf(pf, "<td colspan=\"3\">&nbsp;</td>\n");
+                            g_string_append_printf(gsz, "<td colspan=\"3\">&nbsp;</td>\n");
 
-                            fputs("<td>", pf);
-                            fputs(pcS, pf);
-                            fputs("</td>\n", pf);
+                            g_string_append(gsz, "<td>");
+                            g_string_append(gsz, pcS);
+                            g_string_append(gsz, "</td>\n");
 
-                            fputs("<td>&nbsp;</td>\n", pf);
+                            g_string_append(gsz, "<td>&nbsp;</td>\n");
 
-                            fputs("</tr>\n", pf);
+                            g_string_append(gsz, "</tr>\n");
 
                             pcS = pcE + 1;
 
@@ -2358,24 +2354,24 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
 
         if (pmr->n.anMove[0] >= 0)
             /* no movelist saved */
-            fprintf(pf,
-                    "<tr %s><td>&nbsp;</td><td>&nbsp;</td>"
-                    "<td>&nbsp;</td><td>%s</td><td>&nbsp;</td></tr>\n",
-                    GetStyle(CLASS_MOVETHEMOVE, hecss), FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->n.anMove));
+            g_string_append_printf(gsz,
+                                    "<tr %s><td>&nbsp;</td><td>&nbsp;</td>"
+                                    "<td>&nbsp;</td><td>%s</td><td>&nbsp;</td></tr>\n",
+                                    GetStyle(CLASS_MOVETHEMOVE, hecss), FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->n.anMove));
         else
             /* no legal moves */
             /* FIXME: output equity?? */
-            fprintf(pf,
-                    "<tr %s><td>&nbsp;</td><td>&nbsp;</td>"
-                    "<td>&nbsp;</td><td>%s</td><td>&nbsp;</td></tr>\n",
-                    GetStyle(CLASS_MOVETHEMOVE, hecss), _("Cannot move"));
+            g_string_append_printf(gsz,
+                                    "<tr %s><td>&nbsp;</td><td>&nbsp;</td>"
+                                    "<td>&nbsp;</td><td>%s</td><td>&nbsp;</td></tr>\n",
+                                    GetStyle(CLASS_MOVETHEMOVE, hecss), _("Cannot move"));
 
     }
 
 
-    fprintf(pf, "</table>\n");
+    g_string_append_printf(gsz, "</table>\n");
 
-    fputs("\n<!-- End Move Analysis -->\n\n", pf);
+    g_string_append(gsz, "\n<!-- End Move Analysis -->\n\n");
 
     return;
 
@@ -2389,7 +2385,7 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
  * Print cube analysis
  *
  * Input:
- *  pf: output file
+ *  gsz: output string
  *  pms: match state
  *  pmr: current move record
  *  szImageDir: URI to images
@@ -2398,7 +2394,7 @@ HTMLPrintMoveAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
  */
 
 static void
-HTMLAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
+HTMLAnalysis(GString * gsz, matchstate * pms, moverecord * pmr,
              const char *szImageDir, const char *szExtension, const htmlexporttype het, const htmlexportcss hecss)
 {
 
@@ -2408,26 +2404,26 @@ HTMLAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
 
     case MOVE_NORMAL:
 
-        fprintf(pf, "<p>");
+        g_string_append_printf(gsz, "<p>");
 
         if (het == HTML_EXPORT_TYPE_FIBS2HTML)
-            printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, het);
+            printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, het);
 
         if (pmr->n.anMove[0] >= 0)
-            fprintf(pf,
-                    _("%s%s moves %s"), bullet,
-                    ap[pmr->fPlayer].szName, FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->n.anMove));
+            g_string_append_printf(gsz,
+                                    _("%s%s moves %s"), bullet,
+                                    ap[pmr->fPlayer].szName, FormatMove(sz, (ConstTanBoard) pms->anBoard, pmr->n.anMove));
         else if (!pmr->ml.cMoves)
-            fprintf(pf, _("%s%s cannot move"), bullet, ap[pmr->fPlayer].szName);
+            g_string_append_printf(gsz, _("%s%s cannot move"), bullet, ap[pmr->fPlayer].szName);
 
-        fputs("</p>\n", pf);
+        g_string_append(gsz, "</p>\n");
 
-        /* HTMLRollAlert ( pf, pms, pmr, szImageDir, szExtension ); */
+        /* HTMLRollAlert ( gsz, pms, pmr, szImageDir, szExtension ); */
 
         if (exsExport.fIncludeAnalysis) {
-            HTMLPrintCubeAnalysis(pf, pms, pmr, szImageDir, szExtension, het, hecss);
+            HTMLPrintCubeAnalysis(gsz, pms, pmr, szImageDir, szExtension, het, hecss);
 
-            HTMLPrintMoveAnalysis(pf, pms, pmr, szImageDir, szExtension, het, hecss);
+            HTMLPrintMoveAnalysis(gsz, pms, pmr, szImageDir, szExtension, het, hecss);
         }
 
         break;
@@ -2436,20 +2432,20 @@ HTMLAnalysis(FILE * pf, matchstate * pms, moverecord * pmr,
     case MOVE_DROP:
     case MOVE_DOUBLE:
 
-        fprintf(pf, "<p>");
+        g_string_append_printf(gsz, "<p>");
 
         if (het == HTML_EXPORT_TYPE_FIBS2HTML)
-            printImage(pf, szImageDir, "b-indent", szExtension, "", hecss, het);
+            printImage(gsz, szImageDir, "b-indent", szExtension, "", hecss, het);
 
         if (pmr->mt == MOVE_DOUBLE)
-            fprintf(pf, "%s%s doubles</p>\n", bullet, ap[pmr->fPlayer].szName);
+            g_string_append_printf(gsz, "%s%s doubles</p>\n", bullet, ap[pmr->fPlayer].szName);
         else
-            fprintf(pf,
-                    "%s%s %s</p>\n", bullet,
-                    ap[pmr->fPlayer].szName, (pmr->mt == MOVE_TAKE) ? _("accepts") : _("rejects"));
+            g_string_append_printf(gsz,
+                                    "%s%s %s</p>\n", bullet,
+                                    ap[pmr->fPlayer].szName, (pmr->mt == MOVE_TAKE) ? _("accepts") : _("rejects"));
 
         if (exsExport.fIncludeAnalysis)
-            HTMLPrintCubeAnalysis(pf, pms, pmr, szImageDir, szExtension, het, hecss);
+            HTMLPrintCubeAnalysis(gsz, pms, pmr, szImageDir, szExtension, het, hecss);
 
         break;
 
@@ -2579,7 +2575,7 @@ HTMLDumpStatcontext(FILE * pf, const statcontext * psc,
 
 
 static void
-HTMLPrintComment(FILE * pf, const moverecord * pmr, const htmlexportcss hecss)
+HTMLPrintComment(GString * gsz, const moverecord * pmr, const htmlexportcss hecss)
 {
 
     char *sz = pmr->sz;
@@ -2587,28 +2583,28 @@ HTMLPrintComment(FILE * pf, const moverecord * pmr, const htmlexportcss hecss)
     if (sz) {
 
 
-        fputs("<!-- Annotation -->\n\n", pf);
+        g_string_append(gsz, "<!-- Annotation -->\n\n");
 
-        fprintf(pf, "<p></p>\n" "<div %s>", GetStyle(CLASS_COMMENTHEADER, hecss));
-        fputs(_("Annotation"), pf);
-        fputs("</div>\n", pf);
+        g_string_append_printf(gsz, "<p></p>\n" "<div %s>", GetStyle(CLASS_COMMENTHEADER, hecss));
+        g_string_append(gsz, _("Annotation"));
+        g_string_append(gsz, "</div>\n");
 
-        fprintf(pf, "<div %s>", GetStyle(CLASS_COMMENT, hecss));
+        g_string_append_printf(gsz, "<div %s>", GetStyle(CLASS_COMMENT, hecss));
 
         while (*sz) {
 
             if (*sz == '\n')
-                fputs("<br/>\n", pf);
+                g_string_append(gsz, "<br/>\n");
             else
-                fputc(*sz, pf);
+                g_string_append_c(gsz, *sz);
 
             sz++;
 
         }
 
-        fputs("</div>\n\n", pf);
+        g_string_append(gsz, "</div>\n\n");
 
-        fputs("<!-- End Annotation -->\n\n", pf);
+        g_string_append(gsz, "<!-- End Annotation -->\n\n");
 
 
     }
@@ -2699,6 +2695,40 @@ HTMLMatchInfo(FILE * pf, const matchinfo * pmi, const htmlexportcss UNUSED(hecss
 
 }
 
+/* The output of each move record is rendered as a fragment */
+
+typedef struct _htmlexport {
+    FILE *pf;
+    const char *szImageDir;
+    const char *szExtension;
+    htmlexporttype het;
+    htmlexportcss hecss;
+} htmlexport;
+
+static void
+RenderHTMLFragment(exportfragment * pef, void *pData)
+{
+    const htmlexport *phe = (const htmlexport *) pData;
+    GString *gsz = g_string_new(NULL);
+
+    if (pef->iMove >= 0) {
+        HTMLBoardHeader(gsz, &pef->ms, phe->het, phe->hecss, pef->iGame, pef->iMove, TRUE);
+        printHTMLBoard(gsz, &pef->ms, pef->ms.fTurn, phe->szImageDir, phe->szExtension, phe->het, phe->hecss);
+        HTMLAnalysis(gsz, &pef->ms, pef->pmr, phe->szImageDir, phe->szExtension, phe->het, phe->hecss);
+    }
+
+    if (exsExport.fIncludeAnnotation)
+        HTMLPrintComment(gsz, pef->pmr, phe->hecss);
+
+    pef->agsz[0] = gsz;
+}
+
+static void
+WriteHTMLFragment(exportfragment * pef, void *pData)
+{
+    fputs(pef->agsz[0]->str, ((const htmlexport *) pData)->pf);
+}
+
 /*
  * Export a game in HTML
  *
@@ -2706,24 +2736,27 @@ HTMLMatchInfo(FILE * pf, const matchinfo * pmi, const htmlexportcss UNUSED(hecss
  *   pf: output file
  *   plGame: list of moverecords for the current game
  *
+ * Returns: 0 on success, -1 if interrupted
+ *
  */
 
-static void
+static int
 ExportGameHTML(FILE * pf, listOLD * plGame, const char *szImageDir,
                const char *szExtension,
                const htmlexporttype het,
                const htmlexportcss hecss, const int iGame, const int fLastGame, char *aszLinks[4])
 {
-    listOLD *pl;
     moverecord *pmr;
-    matchstate msExport;
     matchstate msOrig;
-    int iMove = 0;
     statcontext *psc = NULL;
     static statcontext scTotal;
     xmovegameinfo *pmgi = NULL;
     listOLD *pl_hint = NULL;
     statcontext *psc_rel = NULL;
+    exportfragment *aef;
+    unsigned int n;
+    htmlexport he;
+    int result;
 
     msOrig.nMatchTo = 0;
 
@@ -2735,84 +2768,43 @@ ExportGameHTML(FILE * pf, listOLD * plGame, const char *szImageDir,
     if (game_is_last(plGame))
         pl_hint = game_add_pmr_hint(plGame);
 
-    for (pl = plGame->plNext; pl != plGame; pl = pl->plNext) {
-
-        pmr = pl->p;
-
-        FixMatchState(&msExport, pmr);
+    aef = ExportGameFragments(plGame, iGame, &n);
 
-        switch (pmr->mt) {
+    if (n && (pmr = aef[0].pmr)->mt == MOVE_GAMEINFO) {
 
-        case MOVE_GAMEINFO:
+        HTMLPrologue(pf, &aef[0].ms, iGame, aszLinks, het, hecss);
 
-            ApplyMoveRecord(&msExport, plGame, pmr);
+        if (exsExport.fIncludeMatchInfo)
+            HTMLMatchInfo(pf, &mi, hecss);
 
-            HTMLPrologue(pf, &msExport, iGame, aszLinks, het, hecss);
+        msOrig = aef[0].ms;
+        pmgi = &pmr->g;
 
-            if (exsExport.fIncludeMatchInfo)
-                HTMLMatchInfo(pf, &mi, hecss);
+        psc = &pmr->g.sc;
 
-            msOrig = msExport;
-            pmgi = &pmr->g;
+        AddStatcontext(psc, &scTotal);
 
-            psc = &pmr->g.sc;
-
-            AddStatcontext(psc, &scTotal);
-
-            /* FIXME: game introduction */
-            break;
-
-        case MOVE_NORMAL:
-
-            if (pmr->fPlayer != msExport.fMove) {
-                SwapSides(msExport.anBoard);
-                msExport.fMove = pmr->fPlayer;
-            }
-
-            msExport.fTurn = msExport.fMove = pmr->fPlayer;
-            msExport.anDice[0] = pmr->anDice[0];
-            msExport.anDice[1] = pmr->anDice[1];
-
-            HTMLBoardHeader(pf, &msExport, het, hecss, iGame, iMove, TRUE);
-
-            printHTMLBoard(pf, &msExport, msExport.fTurn, szImageDir, szExtension, het, hecss);
-            HTMLAnalysis(pf, &msExport, pmr, szImageDir, szExtension, het, hecss);
-
-            iMove++;
-
-            break;
-
-        case MOVE_DOUBLE:
-        case MOVE_TAKE:
-        case MOVE_DROP:
-
-            HTMLBoardHeader(pf, &msExport, het, hecss, iGame, iMove, TRUE);
-
-            printHTMLBoard(pf, &msExport, msExport.fTurn, szImageDir, szExtension, het, hecss);
-
-            HTMLAnalysis(pf, &msExport, pmr, szImageDir, szExtension, het, hecss);
-
-            iMove++;
-
-            break;
-
-
-        default:
-
-            break;
+        /* FIXME: game introduction */
+    }
 
-        }
+    /* the boards and analysis of the moves */
 
-        if (exsExport.fIncludeAnnotation)
-            HTMLPrintComment(pf, pmr, hecss);
+    he.pf = pf;
+    he.szImageDir = szImageDir;
+    he.szExtension = szExtension;
+    he.het = het;
+    he.hecss = hecss;
 
-        ApplyMoveRecord(&msExport, plGame, pmr);
+    result = ExportFragments(aef, n, RenderHTMLFragment, WriteHTMLFragment, &he);
 
-    }
+    g_free(aef);
 
     if (pl_hint)
         game_remove_pmr_hint(pl_hint);
 
+    if (result < 0)
+        return -1;
+
     if (pmgi && pmgi->fWinner != -1) {
 
         /* print game result */
@@ -2847,8 +2839,9 @@ ExportGameHTML(FILE * pf, listOLD * plGame, const char *szImageDir,
     }
 
 
-    HTMLEpilogue(pf, &msExport, aszLinks, hecss);
+    HTMLEpilogue(pf, &msOrig, aszLinks, hecss);
 
+    return 0;
 }
 
 /*
@@ -2967,7 +2960,7 @@ CommandExportMatchHtml(char *sz)
     int nGames;
     char *aszLinks[4], *filenames[4];
     char *szCurrent;
-    int i, j;
+    int i, j, result;
 
     sz = NextToken(&sz);
 
@@ -3030,9 +3023,9 @@ CommandExportMatchHtml(char *sz)
             return;
         }
 
-        ExportGameHTML(pf, pl->p,
-                       exsExport.szHTMLPictureURL, exsExport.szHTMLExtension,
-                       exsExport.het, exsExport.hecss, i, i == nGames - 1, aszLinks);
+        result = ExportGameHTML(pf, pl->p,
+                                exsExport.szHTMLPictureURL, exsExport.szHTMLExtension,
+                                exsExport.het, exsExport.hecss, i, i == nGames - 1, aszLinks);
 
         for (j = 0; j < 4; j++) {
             g_free(aszLinks[j]);
@@ -3043,6 +3036,9 @@ CommandExportMatchHtml(char *sz)
         if (pf != stdout)
             fclose(pf);
 
+        if (result < 0)
+            break;
+
     }
 
     /* external stylesheet */
@@ -3063,6 +3059,7 @@ CommandExportPositionHtml(char *sz)
     int fHistory;
     moverecord *pmr;
     int iMove;
+    GString *gsz;
 
     sz = NextToken(&sz);
 
@@ -3101,21 +3098,26 @@ CommandExportPositionHtml(char *sz)
     else
         iMove = -1;
 
-    HTMLBoardHeader(pf, &ms, exsExport.het, exsExport.hecss, getGameNumber(plGame), iMove, TRUE);
+    gsz = g_string_new(NULL);
 
-    printHTMLBoard(pf, &ms, ms.fTurn,
+    HTMLBoardHeader(gsz, &ms, exsExport.het, exsExport.hecss, getGameNumber(plGame), iMove, TRUE);
+
+    printHTMLBoard(gsz, &ms, ms.fTurn,
                    exsExport.szHTMLPictureURL, exsExport.szHTMLExtension, exsExport.het, exsExport.hecss);
 
     if (pmr) {
 
-        HTMLAnalysis(pf, &ms, pmr,
+        HTMLAnalysis(gsz, &ms, pmr,
                      exsExport.szHTMLPictureURL, exsExport.szHTMLExtension, exsExport.het, exsExport.hecss);
 
         if (exsExport.fIncludeAnnotation)
-            HTMLPrintComment(pf, pmr, exsExport.hecss);
+            HTMLPrintComment(gsz, pmr, exsExport.hecss);
 
     }
 
+    fputs(gsz->str, pf);
+    g_string_free(gsz, TRUE);
+
     HTMLEpilogue(pf, &ms, NULL, exsExport.hecss);
 
     if (pf != stdout)
@@ -3138,6 +3140,7 @@ ExportPositionGammOnLine(FILE * pf)
 {
     int fHistory;
     moverecord *pmr = get_current_moverecord(&fHistory);
+    GString *gsz;
 
     if (!pmr) {
         outputerrf(_("Unable to export this position"));
@@ -3163,15 +3166,20 @@ ExportPositionGammOnLine(FILE * pf)
 
     fputs("\n<!-- End Score -->\n\n", pf);
 
-    printHTMLBoard(pf, &ms, ms.fTurn, "../Images/", "gif", HTML_EXPORT_TYPE_BBS, HTML_EXPORT_CSS_INLINE);
+    gsz = g_string_new(NULL);
+
+    printHTMLBoard(gsz, &ms, ms.fTurn, "../Images/", "gif", HTML_EXPORT_TYPE_BBS, HTML_EXPORT_CSS_INLINE);
 
     if (pmr) {
-        HTMLAnalysis(pf, &ms, pmr, "../Images/", "gif", HTML_EXPORT_TYPE_BBS, HTML_EXPORT_CSS_INLINE);
+        HTMLAnalysis(gsz, &ms, pmr, "../Images/", "gif", HTML_EXPORT_TYPE_BBS, HTML_EXPORT_CSS_INLINE);
 
-        HTMLPrintComment(pf, pmr, HTML_EXPORT_CSS_INLINE);
+        HTMLPrintComment(gsz, pmr, HTML_EXPORT_CSS_INLINE);
 
     }
 
+    fputs(gsz->str, pf);
+    g_string_free(gsz, TRUE);
+
     HTMLEpilogueComment(pf);
 
 }
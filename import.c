@@ -43,6 +43,10 @@
 #include "file.h"
 #include "positionid.h"
 #include "matchequity.h"
+#include "multithread.h"
+#include "gbf.h"
+#include "relational.h"
+#include "sgf.h"
 
 #if !GLIB_CHECK_VERSION (2,26,0)
 #ifdef WIN32
@@ -3629,6 +3633,17 @@ CommandImportParty(char *sz)
     g_free(tmpfile);
 }
 
+/* The command importing sz, which is of the given type */
+
+static char *
+ImportCommand(const char *sz, ImportType type)
+{
+    if (type == IMPORT_SGF)
+        return g_strdup_printf("load match \"%s\"", sz);
+    else
+        return g_strdup_printf("import %s \"%s\"", import_format[type].clname, sz);
+}
+
 extern void
 CommandImportAuto(char *sz)
 {
@@ -3654,16 +3669,309 @@ CommandImportAuto(char *sz)
         outputf(_("The format of '%s' is not recognized"), sz);
         g_free(fdp);
         return;
-    } else if (fdp->type == IMPORT_SGF)
-        cmd = g_strdup_printf("load match \"%s\"", sz);
-    else
-        cmd = g_strdup_printf("import %s \"%s\"", import_format[fdp->type].clname, sz);
+    }
 
+    cmd = ImportCommand(sz, fdp->type);
     HandleCommand(cmd, acTop);
     g_free(cmd);
     g_free(fdp);
 }
 
+/* The files of a batch import.  They are read a few at a time per
+ * thread, from iBatchNext up to iBatchEnd. */
+
+#define BATCH_READ_AHEAD 4
+
+typedef struct _batchfile {
+    char *szFile;
+    ImportType type;
+    sgfcollection *psc;         /* the games of an SGF file */
+    gchar *pchGBF;              /* the contents of a GBF file */
+    gsize cbGBF;
+} batchfile;
+
+static batchfile *abfBatch;
+static int cBatch, iBatchNext, iBatchEnd, cBatchDone;
+
+/* Detect the format of the files and read the SGF and GBF ones, which
+ * can be done away from the match */
+
+static void
+ReadBatchMT(void *UNUSED(unused))
+{
+    int i;
+
+    while ((i = MT_SafeIncCheck(&iBatchNext)) < iBatchEnd && !fInterrupt) {
+        batchfile *pbf = abfBatch + i;
+        FilePreviewData *fpd = ReadFilePreview(pbf->szFile);
+
+        pbf->type = fpd ? fpd->type : N_IMPORT_TYPES;
+        g_free(fpd);
+
+        if (pbf->type == IMPORT_SGF)
+            pbf->psc = SGFReadCollection(pbf->szFile, NULL);
+        else if (pbf->type == IMPORT_GBF && !g_file_get_contents(pbf->szFile, &pbf->pchGBF, &pbf->cbGBF, NULL))
+            pbf->pchGBF = NULL;
+
+        MT_SafeInc(&cBatchDone);
+    }
+}
+
+static void
+FreeBatchFile(batchfile * pbf)
+{
+    SGFFreeCollection(pbf->psc);
+    pbf->psc = NULL;
+    g_free(pbf->pchGBF);
+    pbf->pchGBF = NULL;
+}
+
+static gboolean
+UpdateReadProgress(gpointer UNUSED(unused))
+{
+    ProgressValue(MT_SafeGet(&cBatchDone));
+    return TRUE;
+}
+
+static int
+CompareFilenames(gconstpointer p0, gconstpointer p1)
+{
+    return strcmp(*(char *const *) p0, *(char *const *) p1);
+}
+
+/* Add the files in szDir and its subdirectories, in name order */
+
+static void
+AddBatchDirectory(GPtrArray * pa, const char *szDir)
+{
+    GDir *pd;
+    const char *szName;
+    GPtrArray *paDir;
+    unsigned int i;
+
+    if (!(pd = g_dir_open(szDir, 0, NULL))) {
+        outputerr(szDir);
+        return;
+    }
+
+    paDir = g_ptr_array_new();
+    while ((szName = g_dir_read_name(pd)))
+        g_ptr_array_add(paDir, g_build_filename(szDir, szName, NULL));
+    g_dir_close(pd);
+
+    g_ptr_array_sort(paDir, CompareFilenames);
+
+    for (i = 0; i < paDir->len; ++i) {
+        char *szFile = g_ptr_array_index(paDir, i);
+
+        if (g_file_test(szFile, G_FILE_TEST_IS_DIR)) {
+            AddBatchDirectory(pa, szFile);
+            g_free(szFile);
+        } else
+            g_ptr_array_add(pa, szFile);
+    }
+
+    g_ptr_array_free(paDir, TRUE);
+}
+
+/* Add the files listed in a manifest, one per line.  Blank lines and
+ * lines starting with '#' are skipped; relative names are relative to
+ * the manifest. */
+
+static void
+AddBatchManifest(GPtrArray * pa, const char *szManifest)
+{
+    char *pchContents, *szDir;
+    char **asz;
+    GError *error = NULL;
+    unsigned int i;
+
+    if (!g_file_get_contents(szManifest, &pchContents, NULL, &error)) {
+        outputerrf("%s: %s", szManifest, error->message);
+        g_error_free(error);
+        return;
+    }
+
+    szDir = g_path_get_dirname(szManifest);
+    asz = g_strsplit(pchContents, "\n", -1);
+    g_free(pchContents);
+
+    for (i = 0; asz[i]; ++i) {
+        char *sz = g_strstrip(asz[i]);
+
+        if (!*sz || *sz == '#')
+            continue;
+
+        if (g_path_is_absolute(sz))
+            g_ptr_array_add(pa, g_strdup(sz));
+        else
+            g_ptr_array_add(pa, g_build_filename(szDir, sz, NULL));
+    }
+
+    g_strfreev(asz);
+    g_free(szDir);
+}
+
+/*
+ * Import every match in a directory (or listed in a manifest) and add
+ * it to the relational database, optionally analysing it first.
+ *
+ * The files are taken a few per thread at a time.  All threads detect
+ * their formats, and parse the SGF and GBF files into matches of their
+ * own.  Each match is then made the current one and added to the
+ * database, in file order, on this thread, since the relational writer
+ * and the analysis work on the global match state; the files in other
+ * formats are imported here too, as their importers build the match in
+ * that state.  The match the user had is put aside in GBF form and
+ * restored at the end.
+ */
+
+extern void
+CommandImportBatch(char *sz)
+{
+    char *szPath, *szArg;
+    relwriter *prw;
+    int fAnalyse = FALSE;
+    GPtrArray *pa;
+    GByteArray *pbaSaved = NULL;
+    int nConfirmDefaultSave = nConfirmDefault;
+    int fGotoFirstGameSave = fGotoFirstGame;
+    int fAutoSaveConfirmDeleteSave = fAutoSaveConfirmDelete;
+    int i, iChunk, cImported = 0, cSkipped = 0;
+
+    szPath = NextToken(&sz);
+    if ((szArg = NextToken(&sz)))
+        fAnalyse = !StrNCaseCmp(szArg, "analyse", strlen(szArg)) || !StrNCaseCmp(szArg, "analyze", strlen(szArg));
+
+    if (!szPath || !*szPath) {
+        outputl(_("You must specify a directory or list of files to import (see `help import batch')."));
+        return;
+    }
+
+    if ((prw = RelationalWriterOpen()) == NULL) {
+        outputerrf(_("Error opening database"));
+        return;
+    }
+
+    pa = g_ptr_array_new();
+    if (g_file_test(szPath, G_FILE_TEST_IS_DIR))
+        AddBatchDirectory(pa, szPath);
+    else if (g_file_test(szPath, G_FILE_TEST_EXISTS))
+        AddBatchManifest(pa, szPath);
+    else {
+        outputerrf(_("The file `%s' doesn't exist"), szPath);
+        g_ptr_array_free(pa, TRUE);
+        RelationalWriterClose(prw);
+        return;
+    }
+
+    cBatch = (int) pa->len;
+    abfBatch = g_new0(batchfile, cBatch);
+    for (i = 0; i < cBatch; ++i) {
+        abfBatch[i].szFile = g_ptr_array_index(pa, i);
+        abfBatch[i].type = N_IMPORT_TYPES;
+    }
+    g_ptr_array_free(pa, FALSE);
+
+    if (!ListEmpty(&lMatch))
+        pbaSaved = GBFSaveMatch();
+
+    /* don't stop to ask whether to discard each match in turn */
+    nConfirmDefault = TRUE;
+    fGotoFirstGame = FALSE;
+    fAutoSaveConfirmDelete = FALSE;
+
+    cBatchDone = 0;
+    for (iChunk = 0; iChunk < cBatch && !fInterrupt; iChunk = iBatchEnd) {
+        iBatchNext = iChunk;
+        iBatchEnd = MIN(iChunk + BATCH_READ_AHEAD * (int) MT_GetNumThreads(), cBatch);
+
+        ProgressStartValue(_("Reading matches"), cBatch);
+        ProgressValue(cBatchDone);
+        mt_add_tasks(MT_GetNumThreads(), ReadBatchMT, NULL, NULL);
+        MT_WaitForTasks(UpdateReadProgress, 250, FALSE);
+        ProgressEnd();
+
+        for (i = iChunk; i < iBatchEnd && !fInterrupt; ++i) {
+            batchfile *pbf = abfBatch + i;
+            char *cmd;
+
+            if (pbf->type == N_IMPORT_TYPES || pbf->type == IMPORT_POS) {
+                cSkipped++;
+                continue;
+            }
+
+            FreeMatch();
+            ClearMatch();
+
+            switch (pbf->type) {
+            case IMPORT_SGF:
+                if (pbf->psc)
+                    SGFRestoreCollection(pbf->psc, pbf->szFile);
+                break;
+
+            case IMPORT_GBF:
+                /* a damaged file leaves no match behind */
+                if (pbf->pchGBF)
+                    GBFLoadMatch((const guchar *) pbf->pchGBF, pbf->cbGBF);
+                break;
+
+            default:
+                cmd = ImportCommand(pbf->szFile, pbf->type);
+                HandleCommand(cmd, acTop);
+                g_free(cmd);
+                break;
+            }
+
+            FreeBatchFile(pbf);
+
+            if (ListEmpty(&lMatch)) {
+                outputerrf(_("`%s' could not be imported"), pbf->szFile);
+                cSkipped++;
+                continue;
+            }
+
+            if (fAnalyse)
+                CommandAnalyseMatch(NULL);
+            if (fInterrupt)
+                break;
+            if (RelationalWriterAddMatch(prw))
+                cImported++;
+            else {
+                outputerrf(_("`%s' could not be added to the database"), pbf->szFile);
+                cSkipped++;
+            }
+        }
+    }
+
+    RelationalWriterClose(prw);
+
+    nConfirmDefault = nConfirmDefaultSave;
+    fGotoFirstGame = fGotoFirstGameSave;
+    fAutoSaveConfirmDelete = fAutoSaveConfirmDeleteSave;
+
+    FreeMatch();
+    ClearMatch();
+    if (pbaSaved) {
+        GBFLoadMatch(pbaSaved->data, pbaSaved->len);
+        g_byte_array_free(pbaSaved, TRUE);
+    }
+    UpdateSettings();
+#if USE_GTK
+    if (fX)
+        GTKSet(ap);
+#endif
+
+    for (i = 0; i < cBatch; ++i) {
+        FreeBatchFile(abfBatch + i);
+        g_free(abfBatch[i].szFile);
+    }
+    g_free(abfBatch);
+    abfBatch = NULL;
+
+    outputf(_("%d matches imported, %d files skipped.\n"), cImported, cSkipped);
+}
+
 #define BGR_STRING "BGF version"
 static int moveNum;
 
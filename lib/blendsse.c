@@ -0,0 +1,251 @@
+/*
+ * blendsse.c
+ *
+ * SIMD versions of the blending kernels in render.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+#include "common.h"
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+
+#include "blendsse.h"
+
+#if defined(USE_AVX)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+/* Four pixels at a time.  The RGB pixels are widened to RGBx in a
+ * 32 bit lane each, the arithmetic is done on 16 bit channels and the
+ * results narrowed again.  x / 255 is computed exactly as
+ * (x + 1 + (x >> 8)) >> 8, which holds for all x <= 255 * 255, so the
+ * output is identical to the scalar code in render.c. */
+
+static inline int
+LoadRGB(const unsigned char *puch)
+{
+    return puch[0] | (puch[1] << 8) | (puch[2] << 16);
+}
+
+static inline __m128i
+Load4RGB(const unsigned char *puch)
+{
+    return _mm_setr_epi32(LoadRGB(puch), LoadRGB(puch + 3), LoadRGB(puch + 6), LoadRGB(puch + 9));
+}
+
+static inline void
+Store4RGB(unsigned char *puch, __m128i v)
+{
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        unsigned int n = (unsigned int) _mm_cvtsi128_si32(v);
+
+        *puch++ = (unsigned char) n;
+        *puch++ = (unsigned char) (n >> 8);
+        *puch++ = (unsigned char) (n >> 16);
+        v = _mm_srli_si128(v, 4);
+    }
+}
+
+static inline __m128i
+Div255(__m128i x)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+/* alpha of each pixel in all four channels */
+
+static inline __m128i
+Alpha(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xFF), 0xFF);
+}
+
+static inline unsigned char
+clamp(int n)
+{
+    return n > 0xFF ? 0xFF : (unsigned char) n;
+}
+
+/* back * a / 255 + fore for four pixels */
+
+static inline __m128i
+Blend4(__m128i back, __m128i fore)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i f0 = _mm_unpacklo_epi8(fore, zero);
+    __m128i f1 = _mm_unpackhi_epi8(fore, zero);
+    __m128i b0 = _mm_unpacklo_epi8(back, zero);
+    __m128i b1 = _mm_unpackhi_epi8(back, zero);
+
+    b0 = _mm_add_epi16(Div255(_mm_mullo_epi16(b0, Alpha(f0))), f0);
+    b1 = _mm_add_epi16(Div255(_mm_mullo_epi16(b1, Alpha(f1))), f1);
+
+    return _mm_packus_epi16(b0, b1);
+}
+
+extern void
+AlphaBlendBaseSSE(unsigned char *puchDest, int nDestStride,
+                  unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
+{
+    int x;
+
+    nDestStride -= cx * 3;
+    nBackStride -= cx * 3;
+    nForeStride -= cx * 4;
+
+    for (; cy; cy--) {
+        for (x = cx; x >= 4; x -= 4) {
+            __m128i v = Blend4(Load4RGB(puchBack), _mm_loadu_si128((const __m128i *) puchFore));
+
+            Store4RGB(puchDest, v);
+            puchDest += 12;
+            puchBack += 12;
+            puchFore += 16;
+        }
+        for (; x; x--) {
+            unsigned int a = puchFore[3];
+
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            puchFore++;
+        }
+        puchDest += nDestStride;
+        puchBack += nBackStride;
+        puchFore += nForeStride;
+    }
+}
+
+extern void
+AlphaBlend2SSE(unsigned char *puchDest, int nDestStride,
+               unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ff = _mm_set1_epi16(0xFF);
+    int x;
+
+    nDestStride -= cx * 3;
+    nBackStride -= cx * 3;
+    nForeStride -= cx * 4;
+
+    for (; cy; cy--) {
+        for (x = cx; x >= 4; x -= 4) {
+            __m128i fore = _mm_loadu_si128((const __m128i *) puchFore);
+            __m128i back = Load4RGB(puchBack);
+            __m128i f0 = _mm_unpacklo_epi8(fore, zero);
+            __m128i f1 = _mm_unpackhi_epi8(fore, zero);
+            __m128i b0 = _mm_unpacklo_epi8(back, zero);
+            __m128i b1 = _mm_unpackhi_epi8(back, zero);
+            __m128i a0 = Alpha(f0);
+            __m128i a1 = Alpha(f1);
+
+            b0 = _mm_add_epi16(Div255(_mm_mullo_epi16(b0, _mm_sub_epi16(ff, a0))), Div255(_mm_mullo_epi16(f0, a0)));
+            b1 = _mm_add_epi16(Div255(_mm_mullo_epi16(b1, _mm_sub_epi16(ff, a1))), Div255(_mm_mullo_epi16(f1, a1)));
+
+            Store4RGB(puchDest, _mm_packus_epi16(b0, b1));
+            puchDest += 12;
+            puchBack += 12;
+            puchFore += 16;
+        }
+        for (; x; x--) {
+            unsigned int a = puchFore[3];
+
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            puchFore++;
+        }
+        puchDest += nDestStride;
+        puchBack += nBackStride;
+        puchFore += nForeStride;
+    }
+}
+
+extern void
+RefractBlendSSE(unsigned char *puchDest, int nDestStride,
+                unsigned char *puchBack, int nBackStride,
+                unsigned char *puchFore, int nForeStride, unsigned short *psRefract, int nRefractStride, int cx, int cy)
+{
+    int x;
+
+#define REFRACT(s) (puchBack + ((s) >> 8) * nBackStride + ((s) & 0xFF) * 3)
+
+    nDestStride -= cx * 3;
+    nForeStride -= cx * 4;
+    nRefractStride -= cx;
+
+    for (; cy; cy--) {
+        for (x = cx; x >= 4; x -= 4) {
+            __m128i back = _mm_setr_epi32(LoadRGB(REFRACT(psRefract[0])), LoadRGB(REFRACT(psRefract[1])),
+                                          LoadRGB(REFRACT(psRefract[2])), LoadRGB(REFRACT(psRefract[3])));
+
+            Store4RGB(puchDest, Blend4(back, _mm_loadu_si128((const __m128i *) puchFore)));
+            puchDest += 12;
+            puchFore += 16;
+            psRefract += 4;
+        }
+        for (; x; x--) {
+            unsigned int a = puchFore[3];
+            unsigned char *puch = REFRACT(*psRefract);
+
+            *puchDest++ = clamp((puch[0] * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((puch[1] * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((puch[2] * a) / 0xFF + *puchFore++);
+            puchFore++;
+            psRefract++;
+        }
+        puchDest += nDestStride;
+        puchFore += nForeStride;
+        psRefract += nRefractStride;
+    }
+
+#undef REFRACT
+}
+
+extern void
+CopyRGBToRGBASSE(unsigned char *puchDest, int nDestStride,
+                 unsigned char *puchSrc, int nSrcStride, int cx, int cy, unsigned char uchAlpha)
+{
+    const __m128i alpha = _mm_set1_epi32((int) ((unsigned int) uchAlpha << 24));
+    int x;
+
+    nDestStride -= cx * 4;
+    nSrcStride -= cx * 3;
+
+    for (; cy; cy--) {
+        for (x = cx; x >= 4; x -= 4) {
+            _mm_storeu_si128((__m128i *) puchDest, _mm_or_si128(Load4RGB(puchSrc), alpha));
+            puchDest += 16;
+            puchSrc += 12;
+        }
+        for (; x; x--) {
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = uchAlpha;
+        }
+        puchDest += nDestStride;
+        puchSrc += nSrcStride;
+    }
+}
+
+#endif                          /* USE_AVX || USE_SSE2 */
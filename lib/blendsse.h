@@ -0,0 +1,39 @@
+/*
+ * blendsse.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef BLENDSSE_H
+#define BLENDSSE_H
+
+extern void AlphaBlendBaseSSE(unsigned char *puchDest, int nDestStride,
+                              unsigned char *puchBack, int nBackStride,
+                              unsigned char *puchFore, int nForeStride, int cx, int cy);
+
+extern void AlphaBlend2SSE(unsigned char *puchDest, int nDestStride,
+                           unsigned char *puchBack, int nBackStride,
+                           unsigned char *puchFore, int nForeStride, int cx, int cy);
+
+extern void RefractBlendSSE(unsigned char *puchDest, int nDestStride,
+                            unsigned char *puchBack, int nBackStride,
+                            unsigned char *puchFore, int nForeStride,
+                            unsigned short *psRefract, int nRefractStride, int cx, int cy);
+
+extern void CopyRGBToRGBASSE(unsigned char *puchDest, int nDestStride,
+                             unsigned char *puchSrc, int nSrcStride, int cx, int cy, unsigned char uchAlpha);
+
+#endif                          /* BLENDSSE_H */
@@ -0,0 +1,275 @@
+/*
+ * blendssetest.c
+ *
+ * Check the SIMD blending kernels of blendsse.c against the scalar
+ * loops of render.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(USE_AVX) || defined(USE_SSE2)
+
+#include "blendsse.h"
+
+/* The kernels are run over random images of every width up to
+ * MAX_WIDTH (so all remainders of the four pixel loop are met) and
+ * with row strides padded by up to MAX_PAD bytes, which are mostly not
+ * multiples of 16.  The destinations, padding included, must come out
+ * byte for byte the same as with the scalar code. */
+
+#define MAX_WIDTH 37
+#define MAX_HEIGHT 5
+#define MAX_PAD 19
+
+/* The scalar loops, as in render.c */
+
+static inline unsigned char
+clamp(float f)
+{
+
+    if (f < 0.0f)
+        return 0;
+    else if (f > 255.0f)
+        return 0xFF;
+    else
+        return (unsigned char) f;
+}
+
+static void
+AlphaBlendBase(unsigned char *puchDest, int nDestStride,
+               unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
+{
+    int x;
+
+    nDestStride -= cx * 3;
+    nBackStride -= cx * 3;
+    nForeStride -= cx * 4;
+
+    for (; cy; cy--) {
+        for (x = cx; x; x--) {
+            unsigned int a = puchFore[3];
+
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((*puchBack++ * a) / 0xFF + *puchFore++);
+            puchFore++;         /* skip the alpha channel */
+        }
+        puchDest += nDestStride;
+        puchBack += nBackStride;
+        puchFore += nForeStride;
+    }
+}
+
+static void
+AlphaBlend2(unsigned char *puchDest, int nDestStride,
+            unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
+{
+    int x;
+
+    nDestStride -= cx * 3;
+    nBackStride -= cx * 3;
+    nForeStride -= cx * 4;
+
+    for (; cy; cy--) {
+        for (x = cx; x; x--) {
+            unsigned int a = puchFore[3];
+
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            *puchDest++ = clamp((*puchBack++ * (0xFF - a)) / 0xFF + (*puchFore++ * a) / 0xFF);
+            puchFore++;         /* skip the alpha channel */
+        }
+        puchDest += nDestStride;
+        puchBack += nBackStride;
+        puchFore += nForeStride;
+    }
+}
+
+static void
+RefractBlend(unsigned char *puchDest, int nDestStride,
+             unsigned char *puchBack, int nBackStride,
+             unsigned char *puchFore, int nForeStride, unsigned short *psRefract, int nRefractStride, int cx, int cy)
+{
+    int x;
+
+    nDestStride -= cx * 3;
+    nForeStride -= cx * 4;
+    nRefractStride -= cx;
+
+    for (; cy; cy--) {
+        for (x = cx; x; x--) {
+            unsigned int a = puchFore[3];
+            unsigned char *puch = puchBack + (*psRefract >> 8) * nBackStride + (*psRefract & 0xFF) * 3;
+
+            *puchDest++ = clamp((puch[0] * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((puch[1] * a) / 0xFF + *puchFore++);
+            *puchDest++ = clamp((puch[2] * a) / 0xFF + *puchFore++);
+            puchFore++;         /* skip the alpha channel */
+            psRefract++;
+        }
+        puchDest += nDestStride;
+        puchFore += nForeStride;
+        psRefract += nRefractStride;
+    }
+}
+
+static void
+Copy_RGB_to_RGBA(unsigned char *puchDest, int nDestStride,
+                 unsigned char *puchSrc, int nSrcStride, int cx, int cy, unsigned char uchAlpha)
+{
+    int x;
+
+    nDestStride -= cx * 4;      /* 8 bit alpha + 24 packed rgb bits */
+    nSrcStride -= cx * 3;       /* 24 packed rgb bits */
+
+    for (; cy; cy--) {
+        for (x = cx; x; x--) {
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = *puchSrc++;
+            *puchDest++ = uchAlpha;
+        }
+        puchDest += nDestStride;
+        puchSrc += nSrcStride;
+    }
+}
+
+static void
+Randomise(unsigned char *puch, size_t cb)
+{
+    while (cb--)
+        *puch++ = (unsigned char) (rand() >> 4);
+}
+
+/* Extreme values are where the rounding and saturation go wrong */
+
+static void
+RandomiseEdges(unsigned char *puch, size_t cb)
+{
+    static const unsigned char auch[] = { 0, 1, 127, 128, 254, 255 };
+
+    while (cb--)
+        *puch++ = (rand() & 1) ? auch[rand() % sizeof(auch)] : (unsigned char) (rand() >> 4);
+}
+
+static int cFailed;
+
+static void
+Compare(const char *szKernel, const unsigned char *puch, const unsigned char *puchSIMD, size_t cb, int cx, int cy,
+        int nStride)
+{
+    size_t i;
+
+    for (i = 0; i < cb; i++)
+        if (puch[i] != puchSIMD[i]) {
+            fprintf(stderr, "%s: %dx%d, stride %d: byte %lu is %d, not %d\n", szKernel, cx, cy, nStride,
+                    (unsigned long) i, puchSIMD[i], puch[i]);
+            cFailed++;
+            return;
+        }
+}
+
+static void
+TestSize(int cx, int cy, int nPad, void (*pfRandomise) (unsigned char *, size_t))
+{
+    int nStride3 = cx * 3 + nPad;
+    int nStride4 = cx * 4 + nPad;
+    int nRefractStride = cx + nPad;
+    size_t cb3 = (size_t) nStride3 * cy;
+    size_t cb4 = (size_t) nStride4 * cy;
+    unsigned char *puchBack = malloc(cb3);
+    unsigned char *puchFore = malloc(cb4);
+    unsigned char *puchDest = malloc(cb4);
+    unsigned char *puchDestSIMD = malloc(cb4);
+    unsigned short *psRefract = malloc((size_t) nRefractStride * cy * sizeof(unsigned short));
+    int i;
+
+    pfRandomise(puchBack, cb3);
+    pfRandomise(puchFore, cb4);
+
+    /* the padding of the destination must be left alone too */
+    pfRandomise(puchDest, cb4);
+    memcpy(puchDestSIMD, puchDest, cb4);
+    AlphaBlendBase(puchDest, nStride3, puchBack, nStride3, puchFore, nStride4, cx, cy);
+    AlphaBlendBaseSSE(puchDestSIMD, nStride3, puchBack, nStride3, puchFore, nStride4, cx, cy);
+    Compare("AlphaBlendBaseSSE", puchDest, puchDestSIMD, cb3, cx, cy, nStride3);
+
+    pfRandomise(puchDest, cb4);
+    memcpy(puchDestSIMD, puchDest, cb4);
+    AlphaBlend2(puchDest, nStride3, puchBack, nStride3, puchFore, nStride4, cx, cy);
+    AlphaBlend2SSE(puchDestSIMD, nStride3, puchBack, nStride3, puchFore, nStride4, cx, cy);
+    Compare("AlphaBlend2SSE", puchDest, puchDestSIMD, cb3, cx, cy, nStride3);
+
+    /* anywhere in the background: high byte the row, low byte the column */
+    for (i = 0; i < nRefractStride * cy; i++)
+        psRefract[i] = (unsigned short) (((rand() % cy) << 8) | (rand() % cx));
+
+    pfRandomise(puchDest, cb4);
+    memcpy(puchDestSIMD, puchDest, cb4);
+    RefractBlend(puchDest, nStride3, puchBack, nStride3, puchFore, nStride4, psRefract, nRefractStride, cx, cy);
+    RefractBlendSSE(puchDestSIMD, nStride3, puchBack, nStride3, puchFore, nStride4, psRefract, nRefractStride, cx,
+                    cy);
+    Compare("RefractBlendSSE", puchDest, puchDestSIMD, cb3, cx, cy, nStride3);
+
+    pfRandomise(puchDest, cb4);
+    memcpy(puchDestSIMD, puchDest, cb4);
+    Copy_RGB_to_RGBA(puchDest, nStride4, puchBack, nStride3, cx, cy, puchFore[0]);
+    CopyRGBToRGBASSE(puchDestSIMD, nStride4, puchBack, nStride3, cx, cy, puchFore[0]);
+    Compare("CopyRGBToRGBASSE", puchDest, puchDestSIMD, cb4, cx, cy, nStride4);
+
+    free(psRefract);
+    free(puchDestSIMD);
+    free(puchDest);
+    free(puchFore);
+    free(puchBack);
+}
+
+extern int
+main(void)
+{
+    int cx, cy, nPad;
+
+    srand(1);
+
+    for (cx = 1; cx <= MAX_WIDTH; cx++)
+        for (cy = 1; cy <= MAX_HEIGHT; cy++)
+            for (nPad = 0; nPad <= MAX_PAD; nPad += (cx & 1) ? 3 : 5) {
+                TestSize(cx, cy, nPad, Randomise);
+                TestSize(cx, cy, nPad, RandomiseEdges);
+            }
+
+    if (cFailed)
+        fprintf(stderr, "%d mismatches\n", cFailed);
+
+    return cFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#else
+
+extern int
+main(void)
+{
+    /* nothing to test; tell make check it was skipped */
+    return 77;
+}
+
+#endif                          /* USE_AVX || USE_SSE2 */
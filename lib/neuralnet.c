@@ -68,6 +68,23 @@ NeuralNetCreate(neuralnet * pnn, unsigned int cInput, unsigned int cHidden,
     return 0;
 }
 
+/* Make pnnNew a copy of pnn, with weights of its own */
+extern int
+NeuralNetCopy(neuralnet * pnnNew, const neuralnet * pnn)
+{
+    if (NeuralNetCreate(pnnNew, pnn->cInput, pnn->cHidden, pnn->cOutput, pnn->rBetaHidden, pnn->rBetaOutput))
+        return -1;
+
+    pnnNew->nTrained = pnn->nTrained;
+
+    memcpy(pnnNew->arHiddenWeight, pnn->arHiddenWeight, pnn->cHidden * pnn->cInput * sizeof(float));
+    memcpy(pnnNew->arOutputWeight, pnn->arOutputWeight, pnn->cOutput * pnn->cHidden * sizeof(float));
+    memcpy(pnnNew->arHiddenThreshold, pnn->arHiddenThreshold, pnn->cHidden * sizeof(float));
+    memcpy(pnnNew->arOutputThreshold, pnn->arOutputThreshold, pnn->cOutput * sizeof(float));
+
+    return 0;
+}
+
 extern void
 NeuralNetDestroy(neuralnet * pnn)
 {
@@ -119,6 +136,30 @@ NNevalAction(NNState * pnState)
     return NNEVAL_NONE;         /* for the picky compiler */
 }
 
+/* Apply the sigmoid to the hidden activities and calculate the outputs */
+static void
+EvaluateOutput(const neuralnet * pnn, float ar[], float arOutput[])
+{
+    const unsigned int cHidden = pnn->cHidden;
+    unsigned int i, j;
+    const float *prWeight;
+
+    for (i = 0; i < cHidden; i++)
+        ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
+
+    /* Calculate activity at output nodes */
+    prWeight = pnn->arOutputWeight;
+
+    for (i = 0; i < pnn->cOutput; i++) {
+        float r = pnn->arOutputThreshold[i];
+
+        for (j = 0; j < cHidden; j++)
+            r += ar[j] * *prWeight++;
+
+        arOutput[i] = sigmoid(-pnn->rBetaOutput * r);
+    }
+}
+
 static void
 Evaluate(const neuralnet * pnn, const float arInput[], float ar[], float arOutput[], float *saveAr)
 {
@@ -152,20 +193,7 @@ Evaluate(const neuralnet * pnn, const float arInput[], float ar[], float arOutpu
     if (saveAr)
         memcpy(saveAr, ar, cHidden * sizeof(*saveAr));
 
-    for (i = 0; i < cHidden; i++)
-        ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
-
-    /* Calculate activity at output nodes */
-    prWeight = pnn->arOutputWeight;
-
-    for (i = 0; i < pnn->cOutput; i++) {
-        float r = pnn->arOutputThreshold[i];
-
-        for (j = 0; j < cHidden; j++)
-            r += ar[j] * *prWeight++;
-
-        arOutput[i] = sigmoid(-pnn->rBetaOutput * r);
-    }
+    EvaluateOutput(pnn, ar, arOutput);
 }
 
 static void
@@ -200,20 +228,7 @@ EvaluateFromBase(const neuralnet * pnn, const float arInputDif[], float ar[], fl
         }
     }
 
-    for (i = 0; i < pnn->cHidden; i++)
-        ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
-
-    /* Calculate activity at output nodes */
-    prWeight = pnn->arOutputWeight;
-
-    for (i = 0; i < pnn->cOutput; i++) {
-        float r = pnn->arOutputThreshold[i];
-
-        for (j = 0; j < pnn->cHidden; j++)
-            r += ar[j] * *prWeight++;
-
-        arOutput[i] = sigmoid(-pnn->rBetaOutput * r);
-    }
+    EvaluateOutput(pnn, ar, arOutput);
 }
 
 extern int
@@ -260,6 +275,46 @@ NeuralNetEvaluate(const neuralnet * pnn, float arInput[], float arOutput[], NNSt
     }
     return 0;
 }
+
+/*
+ * Evaluate cBatch inputs with the same net.  The hidden activities are
+ * accumulated one input at a time across the whole batch, so each row
+ * of hidden weights is fetched once per batch rather than once per
+ * position.
+ */
+extern int
+NeuralNetEvaluateBatch(const neuralnet * pnn, unsigned int cBatch, float *aarInput[], float *aarOutput[])
+{
+    const unsigned int cHidden = pnn->cHidden;
+    float *aar = (float *) g_alloca(cBatch * cHidden * sizeof(float));
+    const float *prRow;
+    unsigned int i, j, k;
+
+    for (k = 0; k < cBatch; k++)
+        memcpy(aar + k * cHidden, pnn->arHiddenThreshold, cHidden * sizeof(float));
+
+    prRow = pnn->arHiddenWeight;
+
+    for (i = 0; i < pnn->cInput; i++, prRow += cHidden)
+        for (k = 0; k < cBatch; k++) {
+            float const ari = aarInput[k][i];
+            float *pr = aar + k * cHidden;
+
+            if (ari == 0.0f)
+                continue;
+            else if (ari == 1.0f)
+                for (j = 0; j < cHidden; j++)
+                    pr[j] += prRow[j];
+            else
+                for (j = 0; j < cHidden; j++)
+                    pr[j] += prRow[j] * ari;
+        }
+
+    for (k = 0; k < cBatch; k++)
+        EvaluateOutput(pnn, aar + k * cHidden, aarOutput[k]);
+
+    return 0;
+}
 #endif
 
 extern int
@@ -59,10 +59,13 @@ typedef struct _NNState {
 } NNState;
 
 extern void NeuralNetDestroy(neuralnet * pnn);
+extern int NeuralNetCopy(neuralnet * pnnNew, const neuralnet * pnn);
 #if !defined(USE_SIMD_INSTRUCTIONS)
 extern int NeuralNetEvaluate(const neuralnet * pnn, float arInput[], float arOutput[], NNState * pnState);
+extern int NeuralNetEvaluateBatch(const neuralnet * pnn, unsigned int cBatch, float *aarInput[], float *aarOutput[]);
 #else
 extern int NeuralNetEvaluateSSE(const neuralnet * pnn, float arInput[], float arOutput[], NNState * pnState);
+extern int NeuralNetEvaluateBatchSSE(const neuralnet * pnn, unsigned int cBatch, float *aarInput[], float *aarOutput[]);
 #endif
 extern int NeuralNetLoad(neuralnet * pnn, FILE * pf);
 extern int NeuralNetLoadBinary(neuralnet * pnn, FILE * pf);
@@ -313,8 +313,9 @@ for (j = (cHidden >> LOG2VEC_SIZE); j; j--, pr += VEC_SIZE, prWeight += VEC_SIZE
 }
 #endif
 
+/* Apply the sigmoid to the hidden activities and calculate the outputs */
 static void
-EvaluateSSE(const neuralnet * pnn, const float arInput[], float ar[], float arOutput[])
+EvaluateSSEOutput(const neuralnet * pnn, float ar[], float arOutput[])
 {
     const unsigned int cHidden = pnn->cHidden;
     unsigned int i, j;
@@ -326,6 +327,127 @@ EvaluateSSE(const neuralnet * pnn, const float arInput[], float ar[], float arOu
 #else
     float_vector vec0, vec1, vec3, scalevec, sum;
 #endif
+#endif
+
+#if defined(USE_SSE2) || defined(USE_AVX) || defined(USE_NEON)
+#if defined(USE_AVX)
+    scalevec = _mm256_set1_ps(pnn->rBetaHidden);
+#elif defined(HAVE_SSE)
+    scalevec = _mm_set1_ps(pnn->rBetaHidden);
+#else
+    scalevec = vdupq_n_f32(pnn->rBetaHidden);
+#endif
+
+    for (par = ar, i = (cHidden >> LOG2VEC_SIZE); i; i--, par += VEC_SIZE) {
+#if defined(USE_AVX)
+        float_vector vec = _mm256_load_ps(par);
+        vec = _mm256_mul_ps(vec, scalevec);
+        vec = sigmoid_ps(vec);
+        _mm256_store_ps(par, vec);
+#elif defined(HAVE_SSE)
+        float_vector vec = _mm_load_ps(par);
+        vec = _mm_mul_ps(vec, scalevec);
+        vec = sigmoid_ps(vec);
+        _mm_store_ps(par, vec);
+#else
+        float_vector vec = vld1q_f32(par);
+        vec = vmulq_f32(vec, scalevec);
+        vec = sigmoid_ps(vec);
+        vst1q_f32(par, vec);
+#endif
+    }
+#else
+    for (i = 0; i < cHidden; i++)
+        ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
+#endif
+
+    /* Calculate activity at output nodes */
+    prWeight = pnn->arOutputWeight;
+
+    for (i = 0; i < pnn->cOutput; i++) {
+
+#if defined(USE_AVX)
+        SSE_ALIGN(float r[8]);
+#else
+        float r;
+#endif
+        float *pr = ar;
+#if defined(USE_AVX)
+        sum = _mm256_setzero_ps();
+#elif defined(HAVE_SSE)
+        sum = _mm_setzero_ps();
+#else
+        sum = vdupq_n_f32(0.0f);
+#endif
+        for (j = (cHidden >> LOG2VEC_SIZE); j; j--, prWeight += VEC_SIZE, pr += VEC_SIZE) {
+#if defined(USE_AVX)
+            vec0 = _mm256_load_ps(pr);  /* Eight floats into vec0 */
+            vec1 = _mm256_load_ps(prWeight);    /* Eight weights into vec1 */
+#if defined(USE_FMA3)
+            sum = _mm256_fmadd_ps(vec0, vec1, sum);
+#else
+            vec3 = _mm256_mul_ps(vec0, vec1);   /* Multiply */
+            sum = _mm256_add_ps(sum, vec3);     /* Add */
+#endif
+#elif defined(HAVE_SSE)
+            vec0 = _mm_load_ps(pr);     /* Four floats into vec0 */
+            vec1 = _mm_load_ps(prWeight);       /* Four weights into vec1 */
+            vec3 = _mm_mul_ps(vec0, vec1);      /* Multiply */
+            sum = _mm_add_ps(sum, vec3);        /* Add */
+#else
+            vec0 = vld1q_f32(pr);     /* Four floats into vec0 */
+            vec1 = vld1q_f32(prWeight);       /* Four weights into vec1 */
+            vec3 = vmulq_f32(vec0, vec1);      /* Multiply */
+            sum = vaddq_f32(sum, vec3);        /* Add */
+#endif
+        }
+
+#if defined(USE_AVX)
+        vec0 = _mm256_hadd_ps(sum, sum);
+        vec1 = _mm256_hadd_ps(vec0, vec0);
+        _mm256_store_ps(r, vec1);
+
+        arOutput[i] = sigmoid(-pnn->rBetaOutput * (r[0] + r[4] + pnn->arOutputThreshold[i]));
+#elif defined(HAVE_SSE)
+        vec0 = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1));
+        vec1 = _mm_add_ps(sum, vec0);
+        vec0 = _mm_shuffle_ps(vec1, vec1, _MM_SHUFFLE(1, 1, 3, 3));
+        sum = _mm_add_ps(vec1, vec0);
+        _mm_store_ss(&r, sum);
+
+        arOutput[i] = sigmoid(-pnn->rBetaOutput * (r + pnn->arOutputThreshold[i]));
+
+#else
+       {
+       float32x2_t vec0_h, vec0_l, vec1;
+
+       vec0_h = vget_high_f32(sum);
+       vec0_l = vget_low_f32(sum);
+       vec1 = vpadd_f32(vec0_h, vec0_l);
+       vec1 = vpadd_f32(vec1, vec1);
+       vst1_lane_f32(&r, vec1, 0);
+
+       arOutput[i] = sigmoid(-pnn->rBetaOutput * (r + pnn->arOutputThreshold[i]));
+       }
+#endif
+    }
+#if defined(USE_AVX)
+    _mm256_zeroupper();
+#endif
+}
+
+static void
+EvaluateSSE(const neuralnet * pnn, const float arInput[], float ar[], float arOutput[])
+{
+    const unsigned int cHidden = pnn->cHidden;
+    unsigned int i, j;
+    float *prWeight;
+#if defined(USE_SSE2) || defined(USE_AVX) || defined(USE_NEON)
+#if defined(USE_FMA3)
+    float_vector vec0, vec1, scalevec, sum;
+#else
+    float_vector vec0, vec1, vec3, scalevec, sum;
+#endif
 #endif
 
     /* Calculate activity at hidden nodes */
@@ -446,111 +568,7 @@ EvaluateSSE(const neuralnet * pnn, const float arInput[], float ar[], float arOu
             }
         }
 
-#if defined(USE_SSE2) || defined(USE_AVX) || defined(USE_NEON)
-#if defined(USE_AVX)
-    scalevec = _mm256_set1_ps(pnn->rBetaHidden);
-#elif defined(HAVE_SSE)
-    scalevec = _mm_set1_ps(pnn->rBetaHidden);
-#else
-    scalevec = vdupq_n_f32(pnn->rBetaHidden);
-#endif
-
-    for (par = ar, i = (cHidden >> LOG2VEC_SIZE); i; i--, par += VEC_SIZE) {
-#if defined(USE_AVX)
-        float_vector vec = _mm256_load_ps(par);
-        vec = _mm256_mul_ps(vec, scalevec);
-        vec = sigmoid_ps(vec);
-        _mm256_store_ps(par, vec);
-#elif defined(HAVE_SSE)
-        float_vector vec = _mm_load_ps(par);
-        vec = _mm_mul_ps(vec, scalevec);
-        vec = sigmoid_ps(vec);
-        _mm_store_ps(par, vec);
-#else
-        float_vector vec = vld1q_f32(par);
-        vec = vmulq_f32(vec, scalevec);
-        vec = sigmoid_ps(vec);
-        vst1q_f32(par, vec);
-#endif
-    }
-#else
-    for (i = 0; i < cHidden; i++)
-        ar[i] = sigmoid(-pnn->rBetaHidden * ar[i]);
-#endif
-
-    /* Calculate activity at output nodes */
-    prWeight = pnn->arOutputWeight;
-
-    for (i = 0; i < pnn->cOutput; i++) {
-
-#if defined(USE_AVX)
-        SSE_ALIGN(float r[8]);
-#else
-        float r;
-#endif
-        float *pr = ar;
-#if defined(USE_AVX)
-        sum = _mm256_setzero_ps();
-#elif defined(HAVE_SSE)
-        sum = _mm_setzero_ps();
-#else
-        sum = vdupq_n_f32(0.0f);
-#endif
-        for (j = (cHidden >> LOG2VEC_SIZE); j; j--, prWeight += VEC_SIZE, pr += VEC_SIZE) {
-#if defined(USE_AVX)
-            vec0 = _mm256_load_ps(pr);  /* Eight floats into vec0 */
-            vec1 = _mm256_load_ps(prWeight);    /* Eight weights into vec1 */
-#if defined(USE_FMA3)
-            sum = _mm256_fmadd_ps(vec0, vec1, sum);
-#else
-            vec3 = _mm256_mul_ps(vec0, vec1);   /* Multiply */
-            sum = _mm256_add_ps(sum, vec3);     /* Add */
-#endif
-#elif defined(HAVE_SSE)
-            vec0 = _mm_load_ps(pr);     /* Four floats into vec0 */
-            vec1 = _mm_load_ps(prWeight);       /* Four weights into vec1 */
-            vec3 = _mm_mul_ps(vec0, vec1);      /* Multiply */
-            sum = _mm_add_ps(sum, vec3);        /* Add */
-#else
-            vec0 = vld1q_f32(pr);     /* Four floats into vec0 */
-            vec1 = vld1q_f32(prWeight);       /* Four weights into vec1 */
-            vec3 = vmulq_f32(vec0, vec1);      /* Multiply */
-            sum = vaddq_f32(sum, vec3);        /* Add */
-#endif
-        }
-
-#if defined(USE_AVX)
-        vec0 = _mm256_hadd_ps(sum, sum);
-        vec1 = _mm256_hadd_ps(vec0, vec0);
-        _mm256_store_ps(r, vec1);
-
-        arOutput[i] = sigmoid(-pnn->rBetaOutput * (r[0] + r[4] + pnn->arOutputThreshold[i]));
-#elif defined(HAVE_SSE)
-        vec0 = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1));
-        vec1 = _mm_add_ps(sum, vec0);
-        vec0 = _mm_shuffle_ps(vec1, vec1, _MM_SHUFFLE(1, 1, 3, 3));
-        sum = _mm_add_ps(vec1, vec0);
-        _mm_store_ss(&r, sum);
-
-        arOutput[i] = sigmoid(-pnn->rBetaOutput * (r + pnn->arOutputThreshold[i]));
-
-#else
-       {
-       float32x2_t vec0_h, vec0_l, vec1;
-
-       vec0_h = vget_high_f32(sum);
-       vec0_l = vget_low_f32(sum);
-       vec1 = vpadd_f32(vec0_h, vec0_l);
-       vec1 = vpadd_f32(vec1, vec1);
-       vst1_lane_f32(&r, vec1, 0);
-
-       arOutput[i] = sigmoid(-pnn->rBetaOutput * (r + pnn->arOutputThreshold[i]));
-       }
-#endif
-    }
-#if defined(USE_AVX)
-    _mm256_zeroupper();
-#endif
+    EvaluateSSEOutput(pnn, ar, arOutput);
 }
 
 
@@ -570,4 +588,56 @@ NeuralNetEvaluateSSE(const neuralnet * pnn, /*lint -e{818} */ float arInput[],
     return 0;
 }
 
+/*
+ * Evaluate cBatch inputs with the same net.  The hidden activities are
+ * accumulated one input at a time across the whole batch, so each row
+ * of hidden weights is fetched once per batch rather than once per
+ * position.
+ */
+extern int
+NeuralNetEvaluateBatchSSE(const neuralnet * pnn, unsigned int cBatch, float *aarInput[], float *aarOutput[])
+{
+    const unsigned int cHidden = pnn->cHidden;
+    SSE_ALIGN(float aar[cBatch * cHidden]);
+    const float *prRow;
+    unsigned int i, j, k;
+#if defined(USE_FMA3)
+    float_vector vec0, vec1, scalevec, sum;
+#else
+    float_vector vec0, vec1, vec3, scalevec, sum;
+#endif
+
+    for (k = 0; k < cBatch; k++)
+        memcpy(aar + k * cHidden, pnn->arHiddenThreshold, cHidden * sizeof(float));
+
+    prRow = pnn->arHiddenWeight;
+
+    for (i = 0; i < pnn->cInput; i++, prRow += cHidden)
+        for (k = 0; k < cBatch; k++) {
+            float const ari = aarInput[k][i];
+            float *pr = aar + k * cHidden;
+            const float *prWeight = prRow;
+
+            if (likely(ari == 0.0f))
+                continue;
+            else if (ari == 1.0f) {
+                INPUT_ADD();
+            } else {
+#if defined(USE_AVX)
+                scalevec = _mm256_set1_ps(ari);
+#elif defined(HAVE_SSE)
+                scalevec = _mm_set1_ps(ari);
+#else
+                scalevec = vdupq_n_f32(ari);
+#endif
+                INPUT_MULTADD();
+            }
+        }
+
+    for (k = 0; k < cBatch; k++)
+        EvaluateSSEOutput(pnn, aar + k * cHidden, aarOutput[k]);
+
+    return 0;
+}
+
 #endif
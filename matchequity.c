@@ -40,6 +40,7 @@
 
 #include "eval.h"
 #include "matchequity.h"
+#include "matchid.h"
 #include "backgammon.h"
 
 
@@ -86,12 +87,32 @@ typedef struct _metdata {
 float aafMET[MAXSCORE][MAXSCORE];
 float aafMETPostCrawford[2][MAXSCORE];
 
-/* gammon prices (calculated once for efficiency) */
+/*
+ * Score dependent data, calculated on demand for each match length in
+ * use and kept until the match equity table changes.
+ *
+ * The block for a nMatchTo point match holds the pre-Crawford gammon
+ * prices for all nAway0, nAway1 < nMatchTo followed by the post-Crawford
+ * prices, both for all cube levels, so that all the prices needed during
+ * a match are in one contiguous allocation.
+ *
+ * The coefficients for the cubeless to cubeful conversion are bigger and
+ * only a few scores are used during a match, so they are calculated one
+ * score and cube value at a time.
+ */
+
+typedef struct _metcache {
+    int nMatchTo;
+    float *arPre;               /* [MAXCUBELEVEL][nMatchTo][nMatchTo][4] */
+    float *arPostCrawford;      /* [MAXCUBELEVEL][nMatchTo][2][4] */
+    cubefulcoefs **apcc;        /* [2][MAXCUBELEVEL][nMatchTo][nMatchTo] */
+} metcache;
+
+static metcache *apmc[MAXSCORE + 1];
+
+G_LOCK_DEFINE_STATIC(metcache);
 
-float aaaafGammonPrices[MAXCUBELEVEL]
-    [MAXSCORE][MAXSCORE][4];
-float aaaafGammonPricesPostCrawford[MAXCUBELEVEL]
-    [MAXSCORE][2][4];
+static metcache *getMETCache(const int nMatchTo);
 
 
 metinfo miCurrent;
@@ -383,27 +404,27 @@ initMETZadeh(float aafMET[MAXSCORE][MAXSCORE],
 
 }
 
-extern int
-GetPoints(float arOutput[5], const cubeinfo * pci, float arCP[2])
-{
-
-    /*
-     * Input:
-     * - arOutput: we need the gammon and backgammon ratios
-     *   (we assume arOutput is evaluate for pci -> fMove)
-     * - anScore: the current score.
-     * - nMatchTo: matchlength
-     * - pci: value of cube, who's turn is it
-     * 
-     *
-     * Output:
-     * - arCP : cash points with live cube
-     * These points are necessary for the linear
-     * interpolation used in cubeless -> cubeful equity 
-     * transformation.
-     */
+/*
+ * Calculate the score dependent part of the cash points and of the
+ * cubeless to cubeful conversion.
+ *
+ * The match winning chances used by GetPoints() are linear in the gammon
+ * and backgammon ratios, so for each cube level we store the mwc for a
+ * normal win and the increments for gammons and backgammons.  GetPoints()
+ * then only needs a few multiply-adds per cube level.
+ *
+ * Input:
+ *   pci: the cube position (only score, match length, cube value and
+ *        Crawford flag are used)
+ *
+ * Output:
+ *   pcc: the coefficients
+ *
+ */
 
-    /* Match play */
+static void
+calcCubefulCoefs(cubefulcoefs * pcc, const cubeinfo * pci)
+{
 
     /* normalize score */
 
@@ -412,60 +433,12 @@ GetPoints(float arOutput[5], const cubeinfo * pci, float arCP[2])
 
     int nCube = pci->nCube;
 
-    float arCPLive[2][MAXCUBELEVEL];
-    float arCPDead[2][MAXCUBELEVEL];
-    float arG[2], arBG[2];
-
-    float rDP, rRDP, rDTW, rDTL;
-
     int nDead, n, nMax, nCubeValue, k;
 
-
     float aarMETResults[2][DTLBP1 + 1];
 
-    /* Gammon and backgammon ratio's. 
-     * Avoid division by zero in extreme cases. */
-
-    if (!pci->fMove) {
-
-        /* arOutput evaluated for player 0 */
-
-        if (arOutput[OUTPUT_WIN] > 0.0f) {
-            arG[0] = (arOutput[OUTPUT_WINGAMMON] - arOutput[OUTPUT_WINBACKGAMMON]) / arOutput[OUTPUT_WIN];
-            arBG[0] = arOutput[OUTPUT_WINBACKGAMMON] / arOutput[OUTPUT_WIN];
-        } else {
-            arG[0] = 0.0;
-            arBG[0] = 0.0;
-        }
-
-        if (arOutput[OUTPUT_WIN] < 1.0f) {
-            arG[1] = (arOutput[OUTPUT_LOSEGAMMON] - arOutput[OUTPUT_LOSEBACKGAMMON]) / (1.0f - arOutput[OUTPUT_WIN]);
-            arBG[1] = arOutput[OUTPUT_LOSEBACKGAMMON] / (1.0f - arOutput[OUTPUT_WIN]);
-        } else {
-            arG[1] = 0.0;
-            arBG[1] = 0.0;
-        }
-
-    } else {
-
-        /* arOutput evaluated for player 1 */
-
-        if (arOutput[OUTPUT_WIN] > 0.0f) {
-            arG[1] = (arOutput[OUTPUT_WINGAMMON] - arOutput[OUTPUT_WINBACKGAMMON]) / arOutput[OUTPUT_WIN];
-            arBG[1] = arOutput[OUTPUT_WINBACKGAMMON] / arOutput[OUTPUT_WIN];
-        } else {
-            arG[1] = 0.0;
-            arBG[1] = 0.0;
-        }
-
-        if (arOutput[OUTPUT_WIN] < 1.0f) {
-            arG[0] = (arOutput[OUTPUT_LOSEGAMMON] - arOutput[OUTPUT_LOSEBACKGAMMON]) / (1.0f - arOutput[OUTPUT_WIN]);
-            arBG[0] = arOutput[OUTPUT_LOSEBACKGAMMON] / (1.0f - arOutput[OUTPUT_WIN]);
-        } else {
-            arG[0] = 0.0;
-            arBG[0] = 0.0;
-        }
-    }
+    getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo,
+                  pci->nCube, -1, -1, pci->fCrawford, aafMET, aafMETPostCrawford, pcc->aarMET[0], pcc->aarMET[1]);
 
     /* Find out what value the cube has when you or your
      * opponent give a dead cube. */
@@ -478,62 +451,54 @@ GetPoints(float arOutput[5], const cubeinfo * pci, float arCP[2])
         nDead *= 2;
     }
 
-    for (nCubeValue = nDead, n = nMax; n >= 0; nCubeValue >>= 1, n--) {
+    pcc->nMax = nMax;
 
-        /* Calculate dead and live cube cash points.
-         * See notes by me (Joern Thyssen) available from the
-         * 'doc' directory.  (FIXME: write notes :-) ) */
+    for (nCubeValue = nDead, n = nMax; n >= 0; nCubeValue >>= 1, n--) {
 
         /* Even though it's a dead cube we take account of the opponents
          * automatic redouble. */
 
-        /* Dead cube cash point for player 0 */
-
         getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo, nCubeValue, GetCubePrimeValue(i, j, nCubeValue), /* 0 */
                       GetCubePrimeValue(j, i, nCubeValue),      /* 1 */
                       pci->fCrawford, aafMET, aafMETPostCrawford, aarMETResults[0], aarMETResults[1]);
 
         for (k = 0; k < 2; k++) {
 
+            cashpointcoefs *pcpc = &pcc->aacpc[n][k];
 
-
-            /* Live cube cash point for player */
+            pcpc->rDP = aarMETResults[k][DP];
 
             if ((i < 2 * nCubeValue) || (j < 2 * nCubeValue)) {
 
-                rDTL = (1.0f - arG[!k] - arBG[!k]) * aarMETResults[k][k ? DTLP1 : DTLP0]
-                    + arG[!k] * aarMETResults[k][k ? DTLGP1 : DTLGP0]
-                    + arBG[!k] * aarMETResults[k][k ? DTLBP1 : DTLBP0];
+                /* The doubled cube is going to be dead */
 
+                pcpc->fDead = TRUE;
 
-                rDP = aarMETResults[k][DP];
+                pcpc->arDTL[0] = aarMETResults[k][k ? DTLP1 : DTLP0];
+                pcpc->arDTL[1] = aarMETResults[k][k ? DTLGP1 : DTLGP0] - pcpc->arDTL[0];
+                pcpc->arDTL[2] = aarMETResults[k][k ? DTLBP1 : DTLBP0] - pcpc->arDTL[0];
 
-                rDTW = (1.0f - arG[k] - arBG[k]) * aarMETResults[k][k ? DTWP1 : DTWP0]
-                    + arG[k] * aarMETResults[k][k ? DTWGP1 : DTWGP0]
-                    + arBG[k] * aarMETResults[k][k ? DTWBP1 : DTWBP0];
+                pcpc->arDTW[0] = aarMETResults[k][k ? DTWP1 : DTWP0];
+                pcpc->arDTW[1] = aarMETResults[k][k ? DTWGP1 : DTWGP0] - pcpc->arDTW[0];
+                pcpc->arDTW[2] = aarMETResults[k][k ? DTWBP1 : DTWBP0] - pcpc->arDTW[0];
 
-                arCPDead[k][n] = (rDTL - rDP) / (rDTL - rDTW);
-
-                /* The doubled cube is going to be dead */
-                arCPLive[k][n] = arCPDead[k][n];
+                pcpc->rRDP = 0.0f;
 
             } else {
 
                 /* Doubled cube is alive */
 
-                /* redouble, pass */
-                rRDP = aarMETResults[k][DTL];
+                pcpc->fDead = FALSE;
 
-                /* double, pass */
-                rDP = aarMETResults[k][DP];
+                /* redouble, pass */
+                pcpc->rRDP = aarMETResults[k][DTL];
 
                 /* double, take win */
+                pcpc->arDTW[0] = aarMETResults[k][DTW];
+                pcpc->arDTW[1] = aarMETResults[k][DTWG] - pcpc->arDTW[0];
+                pcpc->arDTW[2] = aarMETResults[k][DTWB] - pcpc->arDTW[0];
 
-                rDTW = (1.0f - arG[k] - arBG[k]) * aarMETResults[k][DTW]
-                    + arG[k] * aarMETResults[k][DTWG]
-                    + arBG[k] * aarMETResults[k][DTWB];
-
-                arCPLive[k][n] = 1.0f - arCPLive[!k][n + 1] * (rDP - rDTW) / (rRDP - rDTW);
+                pcpc->arDTL[0] = pcpc->arDTL[1] = pcpc->arDTL[2] = 0.0f;
 
             }
 
@@ -541,23 +506,146 @@ GetPoints(float arOutput[5], const cubeinfo * pci, float arCP[2])
 
     }
 
+}
+
+/*
+ * Get the score dependent coefficients for the cubeless to cubeful
+ * conversion for the cube position pci. They are calculated the first
+ * time a score and cube value is asked for.
+ */
+
+extern const cubefulcoefs *
+getCubefulCoefs(const cubeinfo * pci)
+{
+
+    const int nMatchTo = pci->nMatchTo;
+    const int nAway0 = nMatchTo - pci->anScore[0] - 1;
+    const int nAway1 = nMatchTo - pci->anScore[1] - 1;
+    const int nLogCube = LogCube(pci->nCube);
+
+    /* a Crawford game where neither player is 1-away can't happen
+     * in a real match but give it its own entries anyway */
+    const int fCrawford = pci->fCrawford && nAway0 && nAway1;
+
+    metcache *pmc = getMETCache(nMatchTo);
+    cubefulcoefs **ppcc;
+    cubefulcoefs *pcc;
+
+    g_assert(nLogCube >= 0 && nLogCube < MAXCUBELEVEL);
+
+    ppcc = &pmc->apcc[((fCrawford * MAXCUBELEVEL + nLogCube) * nMatchTo + nAway0) * nMatchTo + nAway1];
+
+    pcc = g_atomic_pointer_get(ppcc);
+
+    if (unlikely(!pcc)) {
+        G_LOCK(metcache);
+        if (!(pcc = *ppcc)) {
+            pcc = g_malloc(sizeof(cubefulcoefs));
+            calcCubefulCoefs(pcc, pci);
+            g_atomic_pointer_set(ppcc, pcc);
+        }
+        G_UNLOCK(metcache);
+    }
+
+    return pcc;
+
+}
+
+/*
+ * Calculate live cube cash points from the precalculated coefficients.
+ *
+ * Input:
+ *   pcc: coefficients for the score and cube value
+ *   arG, arBG: gammon and backgammon ratios for player 0 and 1
+ *
+ * Output:
+ *   arCP: cash points with live cube
+ *
+ */
+
+extern void
+GetPointsFromCoefs(const cubefulcoefs * pcc, const float arG[2], const float arBG[2], float arCP[2])
+{
+
+    float arCPLive[2][MAXCUBELEVEL];
+    int n, k;
+
+    for (n = pcc->nMax; n >= 0; n--) {
+
+        /* See notes by me (Joern Thyssen) available from the
+         * 'doc' directory.  (FIXME: write notes :-) ) */
+
+        for (k = 0; k < 2; k++) {
+
+            const cashpointcoefs *pcpc = &pcc->aacpc[n][k];
+
+            float rDTW = pcpc->arDTW[0] + arG[k] * pcpc->arDTW[1] + arBG[k] * pcpc->arDTW[2];
+
+            if (pcpc->fDead) {
+
+                float rDTL = pcpc->arDTL[0] + arG[!k] * pcpc->arDTL[1] + arBG[!k] * pcpc->arDTL[2];
+
+                arCPLive[k][n] = (rDTL - pcpc->rDP) / (rDTL - rDTW);
+
+            } else
+
+                arCPLive[k][n] = 1.0f - arCPLive[!k][n + 1] * (pcpc->rDP - rDTW) / (pcpc->rRDP - rDTW);
+
+        }
+
+    }
+
     /* return cash point for current cube level */
 
     arCP[0] = arCPLive[0][0];
     arCP[1] = arCPLive[1][0];
 
-#if 0
-    for (n = nMax; n >= 0; n--) {
+}
+
+extern int
+GetPoints(float arOutput[5], const cubeinfo * pci, float arCP[2])
+{
+
+    /*
+     * Input:
+     * - arOutput: we need the gammon and backgammon ratios
+     *   (we assume arOutput is evaluate for pci -> fMove)
+     * - anScore: the current score.
+     * - nMatchTo: matchlength
+     * - pci: value of cube, who's turn is it
+     * 
+     *
+     * Output:
+     * - arCP : cash points with live cube
+     * These points are necessary for the linear
+     * interpolation used in cubeless -> cubeful equity 
+     * transformation.
+     */
 
-        printf("Cube %i\n"
-               "Dead cube:    cash point 0 %6.3f\n"
-               "              cash point 1 %6.3f\n"
-               "Live cube:    cash point 0 %6.3f\n"
-               "              cash point 1 %6.3f\n\n",
-               n, arCPDead[0][n], arCPDead[1][n], arCPLive[0][n], arCPLive[1][n]);
+    /* Match play */
 
+    float arG[2], arBG[2];
+
+    /* Gammon and backgammon ratio's. 
+     * Avoid division by zero in extreme cases. */
+
+    if (arOutput[OUTPUT_WIN] > 0.0f) {
+        arG[pci->fMove] = (arOutput[OUTPUT_WINGAMMON] - arOutput[OUTPUT_WINBACKGAMMON]) / arOutput[OUTPUT_WIN];
+        arBG[pci->fMove] = arOutput[OUTPUT_WINBACKGAMMON] / arOutput[OUTPUT_WIN];
+    } else {
+        arG[pci->fMove] = 0.0;
+        arBG[pci->fMove] = 0.0;
+    }
+
+    if (arOutput[OUTPUT_WIN] < 1.0f) {
+        arG[!pci->fMove] = (arOutput[OUTPUT_LOSEGAMMON] - arOutput[OUTPUT_LOSEBACKGAMMON]) / (1.0f - arOutput[OUTPUT_WIN]);
+        arBG[!pci->fMove] = arOutput[OUTPUT_LOSEBACKGAMMON] / (1.0f - arOutput[OUTPUT_WIN]);
+    } else {
+        arG[!pci->fMove] = 0.0;
+        arBG[!pci->fMove] = 0.0;
     }
-#endif
+
+    GetPointsFromCoefs(getCubefulCoefs(pci), arG, arBG, arCP);
 
     return 0;
 
@@ -609,12 +697,11 @@ GetDoublePointDeadCube(float arOutput[5], cubeinfo * pci)
 
         /* Match play */
 
-        float aarMETResults[2][DTLBP1 + 1];
-
         /* normalize score */
 
         float rG1, rBG1, rG2, rBG2, rDTW, rNDW, rDTL, rNDL;
         float rRisk, rGain;
+        const float *arMET = getCubefulCoefs(pci)->aarMET[player];
 
         /* FIXME: avoid division by zero */
         if (arOutput[OUTPUT_WIN] > 0.0f) {
@@ -633,29 +720,25 @@ GetDoublePointDeadCube(float arOutput[5], cubeinfo * pci)
             rBG2 = 0.0;
         }
 
-        getMEMultiple(pci->anScore[0], pci->anScore[1], pci->nMatchTo,
-                      pci->nCube, -1, -1,
-                      pci->fCrawford, aafMET, aafMETPostCrawford, aarMETResults[0], aarMETResults[1]);
-
         /* double point */
 
         /* double point */
 
-        rDTW = (1.0f - rG1 - rBG1) * aarMETResults[player][DTW]
-            + rG1 * aarMETResults[player][DTWG]
-            + rBG1 * aarMETResults[player][DTWB];
+        rDTW = (1.0f - rG1 - rBG1) * arMET[DTW]
+            + rG1 * arMET[DTWG]
+            + rBG1 * arMET[DTWB];
 
-        rNDW = (1.0f - rG1 - rBG1) * aarMETResults[player][NDW]
-            + rG1 * aarMETResults[player][NDWG]
-            + rBG1 * aarMETResults[player][NDWB];
+        rNDW = (1.0f - rG1 - rBG1) * arMET[NDW]
+            + rG1 * arMET[NDWG]
+            + rBG1 * arMET[NDWB];
 
-        rDTL = (1.0f - rG2 - rBG2) * aarMETResults[player][DTL]
-            + rG2 * aarMETResults[player][DTLG]
-            + rBG2 * aarMETResults[player][DTLB];
+        rDTL = (1.0f - rG2 - rBG2) * arMET[DTL]
+            + rG2 * arMET[DTLG]
+            + rBG2 * arMET[DTLB];
 
-        rNDL = (1.0f - rG2 - rBG2) * aarMETResults[player][NDL]
-            + rG2 * aarMETResults[player][NDLG]
-            + rBG2 * aarMETResults[player][NDLB];
+        rNDL = (1.0f - rG2 - rBG2) * arMET[NDL]
+            + rG2 * arMET[NDLG]
+            + rBG2 * arMET[NDLB];
 
         /* risk & gain */
 
@@ -1475,40 +1558,131 @@ getGammonPrice(float arGammonPrice[4],
 }
 
 /*
- * Calculate all gammon and backgammon prices
+ * Calculate all gammon and backgammon prices for a match to nMatchTo
  *
  * Input:
  *   aafMET, aafMETPostCrawford: match equity tables
+ *   nMatchTo: match length
  *
- * Output:
- *   aaaafGammonPrices: all gammon prices
+ * Returns:
+ *   newly allocated cache with the gammon prices filled in
  *
  */
 
-static void
-calcGammonPrices(float aafMET[MAXSCORE][MAXSCORE],
-                 float aafMETPostCrawford[2][MAXSCORE], float aaaafGammonPrices[MAXCUBELEVEL]
-                 [MAXSCORE][MAXSCORE][4], float aaaafGammonPricesPostCrawford[MAXCUBELEVEL]
-                 [MAXSCORE][2][4])
+static metcache *
+calcGammonPrices(float aafMET[MAXSCORE][MAXSCORE], float aafMETPostCrawford[2][MAXSCORE], const int nMatchTo)
 {
 
     int i, j, k;
     int nCube;
+    metcache *pgp = g_malloc(sizeof(metcache));
+    float *pr;
+
+    pgp->nMatchTo = nMatchTo;
+    pgp->apcc = g_malloc0(2 * MAXCUBELEVEL * nMatchTo * nMatchTo * sizeof(cubefulcoefs *));
+    pgp->arPre = pr = g_malloc(MAXCUBELEVEL * nMatchTo * nMatchTo * 4 * sizeof(float));
 
     for (i = 0, nCube = 1; i < MAXCUBELEVEL; i++, nCube *= 2)
-        for (j = 0; j < MAXSCORE; j++)
-            for (k = 0; k < MAXSCORE; k++)
-                getGammonPrice(aaaafGammonPrices[i][j][k],
-                               MAXSCORE - j - 1, MAXSCORE - k - 1, MAXSCORE,
-                               nCube, (MAXSCORE == j) || (MAXSCORE == k), aafMET, aafMETPostCrawford);
+        for (j = 0; j < nMatchTo; j++)
+            for (k = 0; k < nMatchTo; k++, pr += 4)
+                getGammonPrice(pr, nMatchTo - j - 1, nMatchTo - k - 1, nMatchTo,
+                               nCube, FALSE, aafMET, aafMETPostCrawford);
+
+    pgp->arPostCrawford = pr = g_malloc(MAXCUBELEVEL * nMatchTo * 2 * 4 * sizeof(float));
 
     for (i = 0, nCube = 1; i < MAXCUBELEVEL; i++, nCube *= 2)
-        for (j = 0; j < MAXSCORE; j++) {
-            getGammonPrice(aaaafGammonPricesPostCrawford[i][j][0],
-                           MAXSCORE - 1, MAXSCORE - j - 1, MAXSCORE, nCube, FALSE, aafMET, aafMETPostCrawford);
-            getGammonPrice(aaaafGammonPricesPostCrawford[i][j][1],
-                           MAXSCORE - j - 1, MAXSCORE - 1, MAXSCORE, nCube, FALSE, aafMET, aafMETPostCrawford);
+        for (j = 0; j < nMatchTo; j++, pr += 8) {
+            getGammonPrice(pr, nMatchTo - 1, nMatchTo - j - 1, nMatchTo, nCube, FALSE, aafMET, aafMETPostCrawford);
+            getGammonPrice(pr + 4, nMatchTo - j - 1, nMatchTo - 1, nMatchTo, nCube, FALSE, aafMET, aafMETPostCrawford);
+        }
+
+    return pgp;
+
+}
+
+/*
+ * Forget all calculated gammon prices and cubeful coefficients. Must
+ * not be called while evaluations are running.
+ */
+
+static void
+freeMETCache(void)
+{
+
+    int i, j;
+
+    for (i = 0; i <= MAXSCORE; i++)
+        if (apmc[i]) {
+            for (j = 0; j < 2 * MAXCUBELEVEL * i * i; j++)
+                g_free(apmc[i]->apcc[j]);
+            g_free(apmc[i]->apcc);
+            g_free(apmc[i]->arPre);
+            g_free(apmc[i]->arPostCrawford);
+            g_free(apmc[i]);
+            apmc[i] = NULL;
+        }
+
+}
+
+static metcache *
+getMETCache(const int nMatchTo)
+{
+
+    metcache *pmc;
+
+    g_assert(nMatchTo > 0 && nMatchTo <= MAXSCORE);
+
+    pmc = g_atomic_pointer_get(&apmc[nMatchTo]);
+
+    if (unlikely(!pmc)) {
+        G_LOCK(metcache);
+        if (!(pmc = apmc[nMatchTo])) {
+            pmc = calcGammonPrices(aafMET, aafMETPostCrawford, nMatchTo);
+            g_atomic_pointer_set(&apmc[nMatchTo], pmc);
         }
+        G_UNLOCK(metcache);
+    }
+
+    return pmc;
+
+}
+
+/*
+ * Get gammon and backgammon prices
+ *
+ * The prices for all scores of a match are calculated the first
+ * time a score of that match length is asked for.
+ *
+ * Input:
+ *   nMatchTo: match length
+ *   nAway0, nAway1: points needed by player 0 and 1, minus 1
+ *   nLogCube: log2 of the cube value
+ *   fPostCrawford: this game is post-Crawford
+ *
+ * Output:
+ *   arGammonPrice: gammon and backgammon prices
+ *
+ */
+
+extern void
+getGammonPrices(float arGammonPrice[4], const int nMatchTo, const int nAway0, const int nAway1,
+                const int nLogCube, const int fPostCrawford)
+{
+
+    const metcache *pgp = getMETCache(nMatchTo);
+    const float *pr;
+
+    g_assert(nLogCube >= 0 && nLogCube < MAXCUBELEVEL);
+
+    if (fPostCrawford) {
+        if (!nAway0)
+            pr = pgp->arPostCrawford + ((nLogCube * nMatchTo + nAway1) * 2 + 0) * 4;
+        else
+            pr = pgp->arPostCrawford + ((nLogCube * nMatchTo + nAway0) * 2 + 1) * 4;
+    } else
+        pr = pgp->arPre + ((nLogCube * nMatchTo + nAway0) * nMatchTo + nAway1) * 4;
+
+    memcpy(arGammonPrice, pr, 4 * sizeof(float));
 
 }
 
@@ -1589,8 +1763,8 @@ InitMatchEquity(const char *szFileName)
     /* save match equity table information */
     memcpy(&miCurrent, &md.mi, sizeof(metinfo));
 
-    /* initialise gammon prices */
-    calcGammonPrices(aafMET, aafMETPostCrawford, aaaafGammonPrices, aaaafGammonPricesPostCrawford);
+    /* gammon prices are calculated when needed */
+    freeMETCache();
 }
 
 
@@ -1721,7 +1895,7 @@ invertMET(void)
         }
     }
 
-    calcGammonPrices(aafMET, aafMETPostCrawford, aaaafGammonPrices, aaaafGammonPricesPostCrawford);
+    freeMETCache();
 }
 
 /* given a match score, return a pair of arrays with the METs for
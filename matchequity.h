@@ -49,13 +49,11 @@ typedef struct _metinfo {
 extern float aafMET[MAXSCORE][MAXSCORE];
 extern float aafMETPostCrawford[2][MAXSCORE];
 
-/* gammon prices (calculated once for efficiency) */
-
-extern float aaaafGammonPrices[MAXCUBELEVEL]
-    [MAXSCORE][MAXSCORE][4];
-extern float aaaafGammonPricesPostCrawford[MAXCUBELEVEL]
-    [MAXSCORE][2][4];
+/* gammon prices (calculated once per match length for efficiency) */
 
+extern void
+ getGammonPrices(float arGammonPrice[4], const int nMatchTo, const int nAway0, const int nAway1,
+                 const int nLogCube, const int fPostCrawford);
 
 
 extern metinfo miCurrent;
@@ -114,6 +112,32 @@ typedef enum met_indices {
     NDLP1, DTLP1, NDLBP1, DTLGP1, DTLBP1
 } e_met_indices;
 
+/*
+ * Score dependent coefficients for the cubeless to cubeful conversion
+ * in match play, see getCubefulCoefs()
+ */
+
+typedef struct _cashpointcoefs {
+    int fDead;                  /* the doubled cube is dead */
+    float rDP;                  /* mwc for double, pass */
+    float rRDP;                 /* mwc for redouble, pass (live cube) */
+    float arDTW[3];             /* mwc for double, take, win: normal and
+                                 * the increments for gammon and backgammon */
+    float arDTL[3];             /* same for double, take, lose (dead cube) */
+} cashpointcoefs;
+
+typedef struct _cubefulcoefs {
+    int nMax;                   /* cube level (above the current one) at
+                                 * which a double gives a dead cube */
+    float aarMET[2][DTLB + 1];  /* getMEMultiple() for the current cube */
+    cashpointcoefs aacpc[MAXCUBELEVEL][2];
+} cubefulcoefs;
+
+extern const cubefulcoefs *getCubefulCoefs(const cubeinfo * pci);
+
+extern void
+ GetPointsFromCoefs(const cubefulcoefs * pcc, const float arG[2], const float arBG[2], float arCP[2]);
+
 
 extern void
 
@@ -25,6 +25,7 @@
 #include "positionid.h"
 #include "matchequity.h"
 #include "matchid.h"
+#include "multithread.h"
 #include <string.h>
 
 /*
@@ -119,7 +120,7 @@ MatchIDFromKey(unsigned char auchKey[9])
 {
 
     unsigned char *puch = auchKey;
-    static char szID[L_MATCHID + 1];
+    MT_STATIC_BUFFER(szID, L_MATCHID + 1);
     char *pch = szID;
     static char aszBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
     int i;
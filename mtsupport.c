@@ -35,11 +35,20 @@
 
 SSE_ALIGN(ThreadData td);
 
+/* The scratch memory of a thread starts with room for a few lists of
+ * moves and grows when needed; what is handed out is aligned as
+ * malloc() would */
+#define SCRATCH_SIZE 65536
+#define SCRATCH_ALIGN 16
+
 extern ThreadLocalData *
 MT_CreateThreadLocalData(int id)
 {
     ThreadLocalData *tld = (ThreadLocalData *) malloc(sizeof(ThreadLocalData));
     tld->id = id;
+    tld->iNode = -1;
+    tld->pen = NULL;
+    tld->fExit = FALSE;
     tld->pnnState = (NNState *) malloc(sizeof(NNState) * 3);
     memset(tld->pnnState, 0, sizeof(NNState) * 3);
     tld->pnnState[CLASS_RACE - CLASS_RACE].savedBase = malloc(nnRace.cHidden * sizeof(float));
@@ -57,9 +66,85 @@ MT_CreateThreadLocalData(int id)
 
     tld->aMoves = (move *) malloc(sizeof(move) * MAX_INCOMPLETE_MOVES);
     memset(tld->aMoves, 0, sizeof(move) * MAX_INCOMPLETE_MOVES);
+
+    tld->cbScratch = SCRATCH_SIZE;
+    tld->pchScratch = g_malloc(tld->cbScratch);
+    tld->cbScratchUsed = 0;
+    tld->plScratchOld = NULL;
     return tld;
 }
 
+static void
+FreeScratchOld(ThreadLocalData * tld)
+{
+    GSList *pl;
+
+    for (pl = tld->plScratchOld; pl; pl = pl->next)
+        g_free(pl->data);
+    g_slist_free(tld->plScratchOld);
+    tld->plScratchOld = NULL;
+}
+
+extern void
+MT_FreeThreadLocalData(ThreadLocalData * tld)
+{
+    int i;
+
+    free(tld->aMoves);
+
+    FreeScratchOld(tld);
+    g_free(tld->pchScratch);
+
+    for (i = 0; i < 3; i++) {
+        free(tld->pnnState[i].savedBase);
+        free(tld->pnnState[i].savedIBase);
+    }
+    free(tld->pnnState);
+    free(tld);
+}
+
+extern size_t
+MT_ScratchMark(void)
+{
+    return MT_GetTLD()->cbScratchUsed;
+}
+
+extern void *
+MT_ScratchAlloc(size_t cb)
+{
+    ThreadLocalData *tld = MT_GetTLD();
+    size_t iOffset = tld->cbScratchUsed;
+
+    cb = (cb + SCRATCH_ALIGN - 1) & ~(size_t) (SCRATCH_ALIGN - 1);
+
+    if (iOffset + cb > tld->cbScratch) {
+        /* What was handed out may still be in use, so the block can't
+         * move.  Start a bigger one at the same offset, so the marks
+         * taken so far stay good, and keep the old one until
+         * everything is given back. */
+        tld->plScratchOld = g_slist_prepend(tld->plScratchOld, tld->pchScratch);
+        tld->cbScratch = MAX(2 * tld->cbScratch, iOffset + cb);
+        tld->pchScratch = g_malloc(tld->cbScratch);
+    }
+
+    tld->cbScratchUsed = iOffset + cb;
+
+    return tld->pchScratch + iOffset;
+}
+
+extern void
+MT_ScratchRelease(size_t iMark)
+{
+    ThreadLocalData *tld = MT_GetTLD();
+
+    g_assert(iMark <= tld->cbScratchUsed);
+
+    tld->cbScratchUsed = iMark;
+
+    if (!iMark && tld->plScratchOld)
+        FreeScratchOld(tld);
+}
+
 #if defined(USE_MULTITHREAD)
 
 #if defined(DEBUG_MULTITHREADED) && defined(WIN32)
@@ -81,6 +166,19 @@ TLSCreate(TLSItem * pItem)
 {
     *pItem = &private_item;
 }
+
+extern char *
+MT_GetBuffer(GPrivate * pItem, size_t cb)
+{
+    char *sz = (char *) g_private_get(pItem);
+
+    if (!sz) {
+        sz = g_malloc0(cb);
+        g_private_set(pItem, sz);
+    }
+
+    return sz;
+}
 #else
 extern void
 TLSCreate(TLSItem * pItem)
@@ -286,21 +384,9 @@ MT_InitThreads(void)
 extern void
 CloseThread(void *UNUSED(unused))
 {
-    int i;
-    NNState *pnnState = ((ThreadLocalData *) TLSGet(td.tlsItem))->pnnState;
-
     g_assert(MT_SafeCompare(&td.closingThreads, TRUE));
 
-    ThreadLocalData *pTLD = (ThreadLocalData *) TLSGet(td.tlsItem);
-    if (pTLD->aMoves)
-        free(pTLD->aMoves);
-
-    for (i = 0; i < 3; i++) {
-        free(pnnState[i].savedBase);
-        free(pnnState[i].savedIBase);
-    }
-    free(((ThreadLocalData *) TLSGet(td.tlsItem))->pnnState);
-    free((void *) TLSGet(td.tlsItem));
+    MT_FreeThreadLocalData((ThreadLocalData *) TLSGet(td.tlsItem));
     MT_SafeInc(&td.result);
 }
 
@@ -394,20 +480,10 @@ MT_InitThreads(void)
 extern void
 MT_Close(void)
 {
-    int i;
-    NNState *pnnState;
-
     if (!td.tld)
         return;
 
-    free(td.tld->aMoves);
-    pnnState = td.tld->pnnState;
-    for (i = 0; i < 3; i++) {
-        free(pnnState[i].savedBase);
-        free(pnnState[i].savedIBase);
-    }
-    free(pnnState);
-    free(td.tld);
+    MT_FreeThreadLocalData(td.tld);
 }
 
 #endif
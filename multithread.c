@@ -30,7 +30,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include <glib.h>
+#if defined(HAVE_SCHED_SETAFFINITY)
+#include <sched.h>
+#endif
 #if defined(USE_GTK)
 #include <gtkgame.h>
 #endif
@@ -42,7 +46,130 @@
 
 #if defined(USE_MULTITHREAD)
 
-static GThread* thread[MAX_NUMTHREADS];
+static GPtrArray *paThreads;    /* the threads of the pool */
+static GPtrArray *paExited;     /* the ones that have left it (MT_RemoveThreads()) */
+static int fAutoThreads = TRUE; /* as many threads as processors ("set threads auto") */
+
+const char *aszNUMAMode[] = { "off", "on", "sharded" };
+
+static numamode nmNUMA = NUMA_OFF;
+static unsigned int cNUMANodes;  /* 0 until the machine has been looked at */
+#if defined(HAVE_SCHED_SETAFFINITY)
+static cpu_set_t acsNode[MAX_NUMA_NODES];       /* the CPUs of each node */
+#endif
+static evalnode *apenNode[MAX_NUMA_NODES];
+static unsigned int acNodeThreads[MAX_NUMA_NODES];
+
+#if defined(HAVE_SCHED_SETAFFINITY)
+/* Read a list of CPUs such as "0-31,64-95" */
+static void
+ParseCPUList(const char *sz, cpu_set_t * pcs)
+{
+    CPU_ZERO(pcs);
+
+    for (;;) {
+        char *pch;
+        unsigned long i, n0, n1;
+
+        n0 = n1 = strtoul(sz, &pch, 10);
+        if (pch == sz)
+            return;
+
+        if (*pch == '-')
+            n1 = strtoul(pch + 1, &pch, 10);
+
+        for (i = n0; i <= n1 && i < CPU_SETSIZE; i++)
+            CPU_SET(i, pcs);
+
+        if (*pch != ',')
+            return;
+
+        sz = pch + 1;
+    }
+}
+#endif
+
+/* The NUMA nodes with CPUs we may run on; only known on Linux, and 1
+ * elsewhere */
+extern unsigned int
+MT_GetNUMANodes(void)
+{
+    if (cNUMANodes)
+        return cNUMANodes;
+
+#if defined(HAVE_SCHED_SETAFFINITY)
+    {
+        cpu_set_t csAllowed;
+        unsigned int i;
+
+        if (!sched_getaffinity(0, sizeof(csAllowed), &csAllowed))
+            for (i = 0; i < MAX_NUMA_NODES; i++) {
+                char szFile[64];
+                gchar *pch;
+
+                sprintf(szFile, "/sys/devices/system/node/node%u/cpulist", i);
+                if (!g_file_get_contents(szFile, &pch, NULL, NULL))
+                    continue;
+
+                ParseCPUList(pch, &acsNode[cNUMANodes]);
+                g_free(pch);
+
+                /* skip nodes with memory only, or with CPUs we're not allowed */
+                CPU_AND(&acsNode[cNUMANodes], &acsNode[cNUMANodes], &csAllowed);
+                if (CPU_COUNT(&acsNode[cNUMANodes]))
+                    cNUMANodes++;
+            }
+    }
+#endif
+
+    if (!cNUMANodes)
+        cNUMANodes = 1;
+
+    return cNUMANodes;
+}
+
+extern numamode
+MT_GetNUMA(void)
+{
+    return nmNUMA;
+}
+
+/* The node with the fewest threads, for a new one */
+static int
+MT_ChooseNode(void)
+{
+    unsigned int i, iNode = 0;
+
+    for (i = 1; i < cNUMANodes; i++)
+        if (acNodeThreads[i] < acNodeThreads[iNode])
+            iNode = i;
+
+    acNodeThreads[iNode]++;
+
+    return (int) iNode;
+}
+
+/* Pin the thread to its node.  The first thread on the node copies the
+ * nets (and makes the cache) there, so the memory is local to them. */
+static void
+MT_PlaceThread(ThreadLocalData * pTLD)
+{
+    if (pTLD->iNode < 0)
+        return;
+
+#if defined(HAVE_SCHED_SETAFFINITY)
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &acsNode[pTLD->iNode])) {
+        pTLD->iNode = -1;
+        return;
+    }
+#endif
+
+    MT_Exclusive();
+    if (!apenNode[pTLD->iNode])
+        apenNode[pTLD->iNode] = EvalNodeNew(nmNUMA == NUMA_SHARDED ? cNUMANodes : 0);
+    pTLD->pen = apenNode[pTLD->iNode];
+    MT_Release();
+}
 
 extern unsigned int
 MT_GetNumThreads(void)
@@ -59,8 +186,20 @@ MT_CloseThreads(void)
     mt_add_tasks(td.numThreads, CloseThread, NULL, NULL);
     if (MT_WaitForTasks(NULL, 0, FALSE) != (int) td.numThreads)
         g_print("Error closing threads!\n");
-    for (i = 0; i < td.numThreads; i++)
-        g_thread_join(thread[i]);
+    if (paThreads) {
+        for (i = 0; i < paThreads->len; i++)
+            g_thread_join(g_ptr_array_index(paThreads, i));
+        g_ptr_array_set_size(paThreads, 0);
+    }
+    td.numThreads = 0;
+
+    for (i = 0; i < MAX_NUMA_NODES; i++) {
+        if (apenNode[i]) {
+            EvalNodeFree(apenNode[i]);
+            apenNode[i] = NULL;
+        }
+        acNodeThreads[i] = 0;
+    }
 }
 
 static void
@@ -129,6 +268,7 @@ MT_WorkerThreadFunction(void *tld)
     {
         ThreadLocalData *pTLD = (ThreadLocalData *) tld;
         TLSSetValue(td.tlsItem, (size_t) pTLD);
+        MT_PlaceThread(pTLD);
 
         MT_SafeInc(&td.result);
         MT_TaskDone(NULL);      /* Thread created */
@@ -140,7 +280,12 @@ MT_WorkerThreadFunction(void *tld)
                 task->fun(task->data);
                 MT_TaskDone(task);
             }
-        } while (MT_SafeCompare(&td.closingThreads, FALSE));
+        } while (MT_SafeCompare(&td.closingThreads, FALSE) && !pTLD->fExit);
+
+        if (MT_SafeCompare(&td.closingThreads, FALSE))
+            /* left the pool on its own (MT_ExitThread()); when closing
+             * CloseThread() has freed its data */
+            MT_FreeThreadLocalData(pTLD);
 
 #if 0
 #if __GNUC__ && defined(WIN32)
@@ -159,51 +304,111 @@ WaitingForThreads(gpointer UNUSED(unused))
     return FALSE;
 }
 
+/* Add c threads to the pool */
 static void
-MT_CreateThreads(void)
+MT_AddThreads(unsigned int c)
 {
-    unsigned int i;
+    unsigned int i, cCreated = 0;
 #if defined(DEBUG_MULTITHREADED)
-    gchar *buf = g_strdup_printf("create %u threads", td.numThreads);
+    gchar *buf = g_strdup_printf("create %u threads", c);
     multi_debug(buf);
     g_free(buf);
 #endif
+    if (!paThreads)
+        paThreads = g_ptr_array_new();
+
     td.result = 0;
     MT_SafeSet(&td.closingThreads, FALSE);
-    for (i = 0; i < td.numThreads; i++) {
-        ThreadLocalData *pTLD = MT_CreateThreadLocalData(i);
+    for (i = 0; i < c; i++) {
+        ThreadLocalData *pTLD = MT_CreateThreadLocalData(td.numThreads + i);
+        GThread *pt;
+
+        /* spread the threads over the nodes */
+        if (nmNUMA != NUMA_OFF && MT_GetNUMANodes() > 1)
+            pTLD->iNode = MT_ChooseNode();
 
 #if GLIB_CHECK_VERSION (2,32,0)
-        if (!(thread[i] = g_thread_try_new(NULL, MT_WorkerThreadFunction, pTLD, NULL)))
+        if (!(pt = g_thread_try_new(NULL, MT_WorkerThreadFunction, pTLD, NULL))) {
 #else
-        if (!(thread[i] = g_thread_create(MT_WorkerThreadFunction, pTLD, TRUE, NULL)))
+        if (!(pt = g_thread_create(MT_WorkerThreadFunction, pTLD, TRUE, NULL))) {
 #endif
             printf("Failed to create thread\n");
-        else {
+            if (pTLD->iNode >= 0)
+                acNodeThreads[pTLD->iNode]--;
+            MT_FreeThreadLocalData(pTLD);
+        } else {
+            g_ptr_array_add(paThreads, pt);
+            cCreated++;
             multi_debug("1 thread created");
         }
     }
-    td.addedTasks = td.numThreads;
+    td.addedTasks = cCreated;
     /* Wait for all the threads to be created (timeout after 1 second) */
-    if (MT_WaitForTasks(WaitingForThreads, 1000, FALSE) != (int) td.numThreads)
+    if (MT_WaitForTasks(WaitingForThreads, 1000, FALSE) != (int) cCreated)
         g_print("Error creating threads!\n");
+    td.numThreads += cCreated;
 }
 
-void
-MT_SetNumThreads(unsigned int num)
+/* Run by a thread to leave the pool */
+static void
+MT_ExitThread(void *UNUSED(unused))
+{
+    ThreadLocalData *pTLD = MT_GetTLD();
+
+    pTLD->fExit = TRUE;
+
+    MT_Exclusive();
+    g_ptr_array_add(paExited, g_thread_self());
+    if (pTLD->iNode >= 0)
+        acNodeThreads[pTLD->iNode]--;
+    MT_Release();
+
+    MT_SafeInc(&td.result);
+}
+
+/* Take c threads out of the pool; the others are left running */
+static void
+MT_RemoveThreads(unsigned int c)
+{
+    unsigned int i;
+
+    if (!paExited)
+        paExited = g_ptr_array_new();
+
+    /* a thread leaves as soon as it has run one of these */
+    mt_add_tasks(c, MT_ExitThread, NULL, NULL);
+    if (MT_WaitForTasks(NULL, 0, FALSE) != (int) c)
+        g_print("Error closing threads!\n");
+
+    for (i = 0; i < paExited->len; i++) {
+        GThread *pt = g_ptr_array_index(paExited, i);
+
+        g_thread_join(pt);
+        g_ptr_array_remove_fast(paThreads, pt);
+    }
+    td.numThreads -= paExited->len;
+    g_ptr_array_set_size(paExited, 0);
+}
+
+/* Grow or shrink the pool to num threads */
+static void
+MT_ResizePool(unsigned int num)
 {
     if (num != td.numThreads) {
-        if (td.numThreads != 0)
-            MT_CloseThreads();
-        td.numThreads = num;
-        MT_CreateThreads();
-        if (num == 1) {         /* No locking in evals */
+        if (num > td.numThreads)
+            MT_AddThreads(num - td.numThreads);
+        else
+            MT_RemoveThreads(td.numThreads - num);
+
+        if (td.numThreads <= 1) {       /* No locking in evals */
             EvaluatePosition = EvaluatePositionNoLocking;
             GeneralCubeDecisionE = GeneralCubeDecisionENoLocking;
             GeneralEvaluationE = GeneralEvaluationENoLocking;
             ScoreMove = ScoreMoveNoLocking;
             FindBestMove = FindBestMoveNoLocking;
             FindnSaveBestMoves = FindnSaveBestMovesNoLocking;
+            FindnSaveBestMovesScratch = FindnSaveBestMovesScratchNoLocking;
+            EvaluateRollsVarRedn = EvaluateRollsVarRednNoLocking;
             BasicCubefulRollout = BasicCubefulRolloutNoLocking;
         } else {                /* Locking version of evals */
             EvaluatePosition = EvaluatePositionWithLocking;
@@ -212,23 +417,109 @@ MT_SetNumThreads(unsigned int num)
             ScoreMove = ScoreMoveWithLocking;
             FindBestMove = FindBestMoveWithLocking;
             FindnSaveBestMoves = FindnSaveBestMovesWithLocking;
+            FindnSaveBestMovesScratch = FindnSaveBestMovesScratchWithLocking;
+            EvaluateRollsVarRedn = EvaluateRollsVarRednWithLocking;
             BasicCubefulRollout = BasicCubefulRolloutWithLocking;
         }
     }
 }
 
 extern void
-MT_StartThreads(void)
+MT_SetNumThreads(unsigned int num)
+{
+    fAutoThreads = FALSE;
+    MT_ResizePool(num);
+}
+
+/* Read a number from a file, or -1 */
+static long
+ReadNumber(const char *szFile)
 {
-    if (td.numThreads == 0) {
-        /* We could set it to something else (the number of cores or some
-         * fraction of that ?) but it is probably not a good idea to hog
-         * a lot of resources by default.
-         */
-        td.numThreads = 1;
+    gchar *pch;
+    long n = -1;
 
-        MT_CreateThreads();
+    if (g_file_get_contents(szFile, &pch, NULL, NULL)) {
+        if (sscanf(pch, "%ld", &n) != 1)
+            n = -1;
+        g_free(pch);
     }
+
+    return n;
+}
+
+/* The processors we may use: those the process may run on, and no more
+ * than the CPU quota of its control group (as in containers) */
+extern unsigned int
+MT_GetDefaultThreads(void)
+{
+    unsigned int c = 1;
+    long nQuota = -1, nPeriod = -1;
+    gchar *pch;
+
+#if GLIB_CHECK_VERSION (2,36,0)
+    c = g_get_num_processors();
+#elif defined(HAVE_SCHED_SETAFFINITY)
+    {
+        cpu_set_t cs;
+
+        if (!sched_getaffinity(0, sizeof(cs), &cs))
+            c = CPU_COUNT(&cs);
+    }
+#endif
+
+    if (g_file_get_contents("/sys/fs/cgroup/cpu.max", &pch, NULL, NULL)) {
+        /* cgroup v2: "<quota> <period>", or "max <period>" */
+        if (sscanf(pch, "%ld %ld", &nQuota, &nPeriod) != 2)
+            nQuota = -1;
+        g_free(pch);
+    } else {
+        /* cgroup v1 */
+        nQuota = ReadNumber("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        nPeriod = ReadNumber("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    }
+
+    if (nQuota > 0 && nPeriod > 0 && ceil((double) nQuota / nPeriod) < c)
+        c = (unsigned int) ceil((double) nQuota / nPeriod);
+
+    return CLAMP(c, 1, MAX_NUMTHREADS);
+}
+
+extern void
+MT_SetAutoThreads(void)
+{
+    fAutoThreads = TRUE;
+    MT_ResizePool(MT_GetDefaultThreads());
+}
+
+extern int
+MT_GetAutoThreads(void)
+{
+    return fAutoThreads;
+}
+
+extern void
+MT_SetNUMA(numamode nm)
+{
+    if (nm == nmNUMA)
+        return;
+
+    nmNUMA = nm;
+
+    if (td.numThreads) {
+        /* place the threads again */
+        unsigned int c = td.numThreads;
+
+        MT_CloseThreads();
+        MT_AddThreads(c);
+    }
+}
+
+extern void
+MT_StartThreads(void)
+{
+    if (td.numThreads == 0)
+        /* unless set otherwise, as many as the processors we may use */
+        MT_ResizePool(fAutoThreads ? MT_GetDefaultThreads() : 1);
 }
 
 void
@@ -54,14 +54,34 @@ typedef struct _AnalyseMoveTask {
     listOLD *plGame;
     statcontext *psc;
     matchstate ms;
+    unsigned int nInputs;       /* see AnalysisInputs() */
 } AnalyseMoveTask;
 
 typedef struct _ThreadLocalData {
     int id;
+    int iNode;                  /* the NUMA node the thread is placed on, or -1 */
     move *aMoves;
     NNState *pnnState;
+    evalnode *pen;              /* the nets and cache of that node, or NULL */
+    int fExit;                  /* the thread is leaving the pool */
+    char *pchScratch;           /* scratch memory (MT_ScratchAlloc()) */
+    size_t cbScratch;
+    size_t cbScratchUsed;
+    GSList *plScratchOld;       /* outgrown blocks, until all is given back */
 } ThreadLocalData;
 
+/* Placement of the calculation threads on the NUMA nodes of the
+ * machine ("set numa") */
+#define MAX_NUMA_NODES 64
+
+typedef enum _numamode {
+    NUMA_OFF,                   /* left to the system */
+    NUMA_ON,                    /* pinned to the nodes in turn, with copies of the nets */
+    NUMA_SHARDED                /* and the evaluation cache split between the nodes */
+} numamode;
+
+extern const char *aszNUMAMode[];
+
 typedef struct _ManualEvent {
 #if GLIB_CHECK_VERSION (2,32,0)
     GCond cond;
@@ -111,6 +131,16 @@ extern void MT_Close(void);
 extern void MT_CloseThreads(void);
 extern void CloseThread(void *unused);
 extern ThreadLocalData *MT_CreateThreadLocalData(int id);
+extern void MT_FreeThreadLocalData(ThreadLocalData * tld);
+
+/* Scratch memory of the calling thread, for arrays needed until a
+ * function returns: MT_ScratchAlloc() hands out the next cb bytes, and
+ * MT_ScratchRelease() gives back all handed out since MT_ScratchMark()
+ * returned iMark.  Cheaper than malloc() and free() but the memory
+ * must be given back in the reverse order it was taken. */
+extern size_t MT_ScratchMark(void);
+extern void *MT_ScratchAlloc(size_t cb);
+extern void MT_ScratchRelease(size_t iMark);
 
 extern ThreadData td;
 
@@ -131,19 +161,25 @@ extern void FreeMutex(Mutex * mutex);
 #define TLSGet(item) *((size_t*)g_private_get(item))
 
 #if !defined(MAX_NUMTHREADS)
-#define MAX_NUMTHREADS 48
+#define MAX_NUMTHREADS 1024
 #endif
 
 extern void MT_Release(void);
 extern void MT_Exclusive(void);
 extern void MT_StartThreads(void);
 extern void MT_SetNumThreads(unsigned int num);
+extern void MT_SetAutoThreads(void);
+extern int MT_GetAutoThreads(void);
+extern unsigned int MT_GetDefaultThreads(void);
 extern void MT_SyncInit(void);
 extern void MT_SyncStart(void);
 extern double MT_SyncEnd(void);
 extern void MT_SetResultFailed(void);
 extern void TLSCreate(TLSItem * pItem);
 extern unsigned int MT_GetNumThreads(void);
+extern void MT_SetNUMA(numamode nm);
+extern numamode MT_GetNUMA(void);
+extern unsigned int MT_GetNUMANodes(void);
 
 #define MT_GetTLD() ((ThreadLocalData *)TLSGet(td.tlsItem))
 #define MT_GetThreadID() ((ThreadLocalData *)TLSGet(td.tlsItem))->id
@@ -169,6 +205,18 @@ extern unsigned int MT_GetNumThreads(void);
 #define MT_SafeSet(x, y) g_atomic_int_set(x, y)
 #define MT_SafeCompare(x, y) g_atomic_int_compare_and_exchange(x, y, y)
 
+#if GLIB_CHECK_VERSION (2,32,0)
+/* A static result buffer of its own for each thread, so functions
+ * returning one (OutputPercent() and friends) may be used in tasks */
+#define MT_STATIC_BUFFER(sz, cb) \
+    static GPrivate sz##Item = G_PRIVATE_INIT(g_free); \
+    char *sz = MT_GetBuffer(&sz##Item, cb)
+#define MT_SAFE_STATIC_BUFFERS 1
+extern char *MT_GetBuffer(GPrivate * pItem, size_t cb);
+#else
+#define MT_STATIC_BUFFER(sz, cb) static char sz[cb]
+#endif
+
 #else                           /*USE_MULTITHREAD */
 #if !defined(MAX_NUMTHREADS)
 #define MAX_NUMTHREADS 1
@@ -177,6 +225,8 @@ extern int asyncRet;
 #define MT_Exclusive() {}
 #define MT_Release() {}
 #define MT_GetNumThreads() 1
+#define MT_GetNUMA() NUMA_OFF
+#define MT_GetNUMANodes() 1
 #define MT_SetResultFailed() asyncRet = -1
 #define MT_SafeInc(x) (++(*x))
 #define MT_SafeIncValue(x) (++(*x))
@@ -191,6 +241,8 @@ extern int asyncRet;
 #define MT_Get_nnState() td.tld->pnnState
 #define MT_Get_aMoves() td.tld->aMoves
 #define MT_GetTLD() td.tld
+#define MT_STATIC_BUFFER(sz, cb) static char sz[cb]
+#define MT_SAFE_STATIC_BUFFERS 1
 
 #endif
 
@@ -38,11 +38,18 @@
 #define MAX_PROBS        32
 #define MAX_GAMMON_PROBS 15
 
-static unsigned long mt[MT_ARRAY_N];
-static int mti = MT_ARRAY_N + 1;
+unsigned int nOSRTrials = 5760;
+
+/* The random number generator of one call of raceProbs(), so that
+ * concurrent one sided rollouts don't share it */
+
+typedef struct {
+    unsigned long mt[MT_ARRAY_N];
+    int mti;
+} osrrng;
 
 static unsigned int
-OSRQuasiRandomDice(const unsigned int iTurn, const unsigned int iGame, const unsigned int cGames,
+OSRQuasiRandomDice(const unsigned int iTurn, const unsigned int iGame, const unsigned int cGames, osrrng * prng,
                    unsigned int anDice[2])
 {
     if (!iTurn && !(cGames % 36)) {
@@ -54,8 +61,8 @@ OSRQuasiRandomDice(const unsigned int iTurn, const unsigned int iGame, const uns
         anDice[1] = ((iGame / 216) % 6) + 1;
         return TRUE;
     } else {
-        anDice[0] = (genrand_int32(&mti, mt) % 6) + 1;
-        anDice[1] = (genrand_int32(&mti, mt) % 6) + 1;
+        anDice[0] = (genrand_int32(&prng->mti, prng->mt) % 6) + 1;
+        anDice[1] = (genrand_int32(&prng->mti, prng->mt) % 6) + 1;
         return (anDice[0] > 0 && anDice[1] > 0);
     }
 }
@@ -559,7 +566,7 @@ FindBestMoveOSR(unsigned int anBoard[25], const unsigned int anDice[2], unsigned
  */
 
 static unsigned int
-osr(unsigned int anBoard[25], const unsigned int iGame, const unsigned int nGames, unsigned int nOut)
+osr(unsigned int anBoard[25], const unsigned int iGame, const unsigned int nGames, unsigned int nOut, osrrng * prng)
 {
     unsigned int iTurn = 0;
     unsigned int anDice[2];
@@ -568,7 +575,7 @@ osr(unsigned int anBoard[25], const unsigned int iGame, const unsigned int nGame
 
     while (nOut) {
         /* roll dice */
-        if (OSRQuasiRandomDice(iTurn, iGame, nGames, anDice) == FALSE)
+        if (OSRQuasiRandomDice(iTurn, iGame, nGames, prng, anDice) == FALSE)
             g_warning("Error in function OSRQuasiRandomDice");
 
         if (anDice[0] < anDice[1])
@@ -600,7 +607,8 @@ osr(unsigned int anBoard[25], const unsigned int iGame, const unsigned int nGame
 
 static void
 rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigned int nOut,
-        float arProbs[], const unsigned int nMaxProbs, float arGammonProbs[], const unsigned int nMaxGammonProbs)
+        float arProbs[], const unsigned int nMaxProbs, float arGammonProbs[], const unsigned int nMaxGammonProbs,
+        osrrng * prng)
 {
 
     unsigned int an[25];
@@ -624,7 +632,7 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
 
         /* do actual rollout */
 
-        n = osr(an, iGame, nGames, nOut);
+        n = osr(an, iGame, nGames, nOut, prng);
 
         /* number of chequers in home quadrant */
 
@@ -681,7 +689,7 @@ rollOSR(const unsigned int nGames, const unsigned int anBoard[25], const unsigne
 
 static unsigned int
 osp(const unsigned int anBoard[25], const unsigned int nGames,
-    unsigned int an[25], float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS])
+    unsigned int an[25], float arProbs[MAX_PROBS], float arGammonProbs[MAX_GAMMON_PROBS], osrrng * prng)
 {
 
     int i, n;
@@ -705,7 +713,7 @@ osp(const unsigned int anBoard[25], const unsigned int nGames,
 
     if (nOut > 0)
         /* chequers outside home: do one sided rollout */
-        rollOSR(nGames, an, nOut, arProbs, MAX_PROBS, arGammonProbs, MAX_GAMMON_PROBS);
+        rollOSR(nGames, an, nOut, arProbs, MAX_PROBS, arGammonProbs, MAX_GAMMON_PROBS, prng);
     else {
         /* chequers inside home: use BEAROFF2 */
 
@@ -822,15 +830,17 @@ raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_
 
     float w, s;
 
+    osrrng rng;
+
     /* Seed set to ensure that OSR are reproducible */
 
-    init_genrand(0, &mti, mt);
+    init_genrand(0, &rng.mti, rng.mt);
 
     for (i = 0; i < 5; ++i)
         arOutput[i] = 0.0f;
 
     for (i = 0; i < 2; ++i)
-        anTotal[i] = osp(anBoard[i], nGames, an[i], aarProbs[i], aarGammonProbs[i]);
+        anTotal[i] = osp(anBoard[i], nGames, an[i], aarProbs[i], aarGammonProbs[i], &rng);
 
     /* calculate OUTPUT_WIN */
 
@@ -22,6 +22,9 @@
 #ifndef OSR_H
 #define OSR_H
 
+/* The number of games of one sided rollouts ("set osrtrials") */
+extern unsigned int nOSRTrials;
+
 extern void
  raceProbs(const TanBoard anBoard, const unsigned int nGames, float arOutput[NUM_OUTPUTS], float arMu[2]);
 
@@ -89,6 +89,7 @@ const char *aszLuckType[] = {
 const char *aszLuckTypeAbbr[] = { "--", "-", "", "+", "++" };
 
 listOLD lMatch, *plGame, *plLastMove;
+unsigned int nMatchGeneration;
 statcontext scMatch;
 static int fComputerDecision = FALSE;
 static int fEndGame = FALSE;
@@ -471,6 +472,7 @@ PopGame(listOLD * plDelete, int fInclusive)
         FreeGame(pl->plPrev->p);
         ListDelete(pl->plPrev);
     } while (pl->p);
+    nMatchGeneration++;
 
     pmr_hint_destroy();
     return 0;
@@ -503,6 +505,7 @@ PopMoveRecord(listOLD * plDelete)
         FreeMoveRecord(pl->plNext->p);
         ListDelete(pl->plNext);
     }
+    nMatchGeneration++;
     pmr_hint_destroy();
 
     return 0;
@@ -4240,6 +4243,7 @@ game_remove_pmr_hint(listOLD * pl_hint)
     g_return_if_fail(pl_hint);
     g_return_if_fail(pl_hint->p == pmr_hint);
     ListDelete(pl_hint);
+    nMatchGeneration++;
 }
 
 extern void
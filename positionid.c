@@ -42,6 +42,7 @@
 #include <errno.h>
 #include <string.h>
 #include "positionid.h"
+#include "multithread.h"
 
 extern void
 PositionKey(const TanBoard anBoard, positionkey * pkey)
@@ -200,7 +201,7 @@ oldPositionIDFromKey(const oldpositionkey * pkey)
 {
 
     unsigned char const *puch = pkey->auch;
-    static char szID[L_POSITIONID + 1];
+    MT_STATIC_BUFFER(szID, L_POSITIONID + 1);
     char *pch = szID;
     static char aszBase64[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
     int i;
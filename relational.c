@@ -71,31 +71,6 @@ GameOver(void)
     return FALSE;
 }
 
-static int
-GetNextId(DBProvider * pdb, const char *table)
-{
-    int next_id;
-    /* fetch next_id from control table */
-    char *buf = g_strdup_printf("next_id FROM control WHERE tablename = '%s'", table);
-    next_id = RunQueryValue(pdb, buf);
-    g_free(buf);
-
-    if (next_id != -1) {        /* update control data with new next id */
-        next_id++;
-        buf = g_strdup_printf("UPDATE control SET next_id = %d WHERE tablename = '%s'", next_id, table);
-        if (!pdb->UpdateCommand(buf))
-            next_id = -1;
-        g_free(buf);
-    } else {                    /* insert new id */
-        next_id = 1;
-        buf = g_strdup_printf("INSERT INTO control (tablename,next_id) VALUES ('%s',%d)", table, next_id);
-        if (!pdb->UpdateCommand(buf))
-            next_id = -1;
-        g_free(buf);
-    }
-    return next_id;
-}
-
 static int
 GetPlayerId(DBProvider * pdb, const char *player_name)
 {
@@ -105,22 +80,6 @@ GetPlayerId(DBProvider * pdb, const char *player_name)
     return id;
 }
 
-static int
-AddPlayer(DBProvider * pdb, const char *name)
-{
-    int id = GetPlayerId(pdb, name);
-    if (id == -1) {             /* Add new player to database */
-        id = GetNextId(pdb, "player");
-        if (id != -1) {
-            char *buf = g_strdup_printf("INSERT INTO player(player_id,name,notes) VALUES (%d, '%s', '')", id, name);
-            if (!pdb->UpdateCommand(buf))
-                id = -1;
-            g_free(buf);
-        }
-    }
-    return id;
-}
-
 static int
 MatchResult(int nMatchTo)
 {                               /* Work out the result (-1,0,1) - (p0 win, unfinished, p1 win) */
@@ -144,30 +103,174 @@ Ratio(float a, int b)
         return 0;
 }
 
-#define NS(x) (x == NULL) ? "NULL" : x
-#define APPENDF(x,y) {g_string_append_printf(column, "%s, ", x); \
-	g_string_append_printf(value, "'%s', ", g_ascii_dtostr(tmpf, G_ASCII_DTOSTR_BUF_SIZE, y));}
-#define APPENDI(x,y) {g_string_append_printf(column, "%s, ", x); \
-	g_string_append_printf(value, "'%i', ", y);}
-#define APPENDU(x,y) {g_string_append_printf(column, "%s, ", x); \
-        g_string_append_printf(value, "'%u', ", y);}
+/* The matches are added in transactions of this many */
+#define MATCHES_PER_TRANSACTION 100
+/* and the ids are taken from the control table in blocks of this size */
+#define ID_BLOCK 1024
+
+typedef enum _idtable {
+    ID_PLAYER, ID_SESSION, ID_GAME, ID_MATCHSTAT, ID_GAMESTAT, ID_POSITION, NUM_IDTABLES
+} idtable;
+
+static const char *aszIdTables[NUM_IDTABLES] = { "player", "session", "game", "matchstat", "gamestat", "position" };
+
+typedef struct _idblock {
+    int nLast;                  /* the last id handed out */
+    int nEnd;                   /* the last id reserved, -1 if none */
+} idblock;
+
+typedef enum _stmttype {
+    STMT_PLAYER, STMT_SESSION, STMT_GAME, STMT_MATCHSTAT, STMT_GAMESTAT,
+    STMT_DELETE_GAMESTAT, STMT_DELETE_GAME, STMT_DELETE_MATCHSTAT, STMT_DELETE_SESSION,
+    STMT_POSITION, STMT_UPDATE_POSITION,
+    NUM_STMTS
+} stmttype;
+
+/* the statistics statements are built by AddStats() */
+static const char *aszStatements[NUM_STMTS] = {
+    "INSERT INTO player(player_id,name,notes) VALUES (?, ?, '')",
+    "INSERT INTO session(session_id, checksum, player_id0, player_id1, "
+        "result, length, added, rating0, rating1, event, round, place, annotator, comment, date) "
+        "VALUES (?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP, ?, ?, ?, ?, ?, ?, ?, ?)",
+    "INSERT INTO game(game_id, session_id, player_id0, player_id1, "
+        "score_0, score_1, result, added, game_number, crawford) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP, ?, ?)",
+    NULL,
+    NULL,
+    "DELETE FROM gamestat WHERE game_id in (SELECT game_id FROM game WHERE session_id = ?)",
+    "DELETE FROM game WHERE session_id = ?",
+    "DELETE FROM matchstat WHERE session_id = ?",
+    "DELETE FROM session WHERE session_id = ?",
+    "INSERT INTO position(trials, dice_skip, stopped_on_jsd, "
+        "output_win, output_win_gammon, output_win_backgammon, output_lose_gammon, output_lose_backgammon, "
+        "output_equity, output_cubeful_equity, "
+        "stddev_win, stddev_win_gammon, stddev_win_backgammon, stddev_lose_gammon, stddev_lose_backgammon, "
+        "stddev_equity, stddev_cubeful_equity, added, position_id, gnubg_id, context, setup) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP, ?, ?, ?, ?)",
+    "UPDATE position SET trials = ?, dice_skip = ?, stopped_on_jsd = ?, "
+        "output_win = ?, output_win_gammon = ?, output_win_backgammon = ?, output_lose_gammon = ?, "
+        "output_lose_backgammon = ?, output_equity = ?, output_cubeful_equity = ?, "
+        "stddev_win = ?, stddev_win_gammon = ?, stddev_win_backgammon = ?, stddev_lose_gammon = ?, "
+        "stddev_lose_backgammon = ?, stddev_equity = ?, stddev_cubeful_equity = ?, "
+        "added = CURRENT_TIMESTAMP WHERE position_id = ?"
+};
+
+struct _relwriter {
+    DBProvider *pdb;
+    GHashTable *phPlayers;      /* player ids by name */
+    idblock aib[NUM_IDTABLES];
+    DBStatement *apst[NUM_STMTS];
+    int cPending;               /* matches added in this transaction */
+    int cRef;
+};
+
+/* the writer open, shared by anyone else wanting one meanwhile */
+static relwriter *prwOpen;
+
+static int
+NextId(relwriter * prw, idtable it)
+{
+    idblock *pib = &prw->aib[it];
+    int next_id;
+    char *buf;
+
+    if (pib->nLast < pib->nEnd)
+        return ++pib->nLast;
+
+    /* reserve another block in the control table */
+    buf = g_strdup_printf("next_id FROM control WHERE tablename = '%s'", aszIdTables[it]);
+    next_id = RunQueryValue(prw->pdb, buf);
+    g_free(buf);
+
+    if (next_id != -1)
+        buf = g_strdup_printf("UPDATE control SET next_id = %d WHERE tablename = '%s'",
+                              next_id + ID_BLOCK, aszIdTables[it]);
+    else {
+        next_id = 0;
+        buf = g_strdup_printf("INSERT INTO control (tablename,next_id) VALUES ('%s',%d)", aszIdTables[it], ID_BLOCK);
+    }
+    if (!prw->pdb->UpdateCommand(buf))
+        next_id = -1;
+    g_free(buf);
+
+    if (next_id == -1)
+        return -1;
+
+    pib->nLast = next_id + 1;
+    pib->nEnd = next_id + ID_BLOCK;
+    return pib->nLast;
+}
+
+static void
+ReleaseIds(relwriter * prw)
+{
+    int i;
+
+    /* give back what is left of the blocks, unless someone else has
+     * reserved ids after them */
+    for (i = 0; i < NUM_IDTABLES; i++) {
+        idblock *pib = &prw->aib[i];
+
+        if (pib->nEnd != -1 && pib->nLast < pib->nEnd) {
+            char *buf = g_strdup_printf("UPDATE control SET next_id = %d WHERE tablename = '%s' AND next_id = %d",
+                                        pib->nLast, aszIdTables[i], pib->nEnd);
+            prw->pdb->UpdateCommand(buf);
+            g_free(buf);
+        }
+        pib->nLast = pib->nEnd = -1;
+    }
+}
+
+static DBStatement *
+GetStatement(relwriter * prw, stmttype st)
+{
+    if (!prw->apst[st] && aszStatements[st])
+        prw->apst[st] = DBPrepare(prw->pdb, aszStatements[st]);
+    return prw->apst[st];
+}
+
+static int
+Execute(relwriter * prw, stmttype st, const DBValue * av, int c)
+{
+    DBStatement *pst = GetStatement(prw, st);
+    return pst && DBExecute(pst, av, c);
+}
+
+#define SETI(d,x) {(d).type = DB_INT; (d).v.n = (x);}
+#define SETS(d,x) {(d).type = (x) ? DB_TEXT : DB_NULL; (d).v.sz = (x);}
+#define SETF(d,x) {(d).type = DB_FLOAT; (d).v.r = (x);}
+
+/* The statistics columns are always all given (NULL where they don't
+ * apply), so that one statement serves every row */
+#define MAX_STAT_COLUMNS 80
+#define APPENDC(x) {g_assert(c < MAX_STAT_COLUMNS); \
+        if (column) g_string_append_printf(column, "%s, ", x);}
+#define APPENDF(x,y) {APPENDC(x); SETF(av[c], y); c++;}
+#define APPENDI(x,y) {APPENDC(x); SETI(av[c], y); c++;}
+#define APPENDU(x,y) APPENDI(x, (int) (y))
+#define APPENDF_IF(f,x,y) {APPENDC(x); \
+        if (f) SETF(av[c], y) else av[c].type = DB_NULL; c++;}
 
 static int
-AddStats(DBProvider * pdb, int gm_id, int player_id, int player, const char *table, int nMatchTo, statcontext * sc)
+AddStats(relwriter * prw, stmttype st, int gm_id, int player_id, int player, int nMatchTo, const statcontext * sc)
 {
-    gchar *buf;
-    GString *column, *value;
+    DBValue av[MAX_STAT_COLUMNS];
+    GString *column = NULL;
+    int c = 0;
     int totalmoves, unforced;
     float errorcost, errorskill;
     float aaaar[3][2][2][2];
     float r;
-    int ret;
-    char tmpf[G_ASCII_DTOSTR_BUF_SIZE];
+    int fRating;
+    idtable it = st == STMT_MATCHSTAT ? ID_MATCHSTAT : ID_GAMESTAT;
 
-    int gms_id = GetNextId(pdb, table);
+    int gms_id = NextId(prw, it);
     if (gms_id == -1)
         return FALSE;
 
+    if (!prw->apst[st])         /* first row; build the statement too */
+        column = g_string_new(NULL);
+
     totalmoves = sc->anTotalMoves[player];
     unforced = sc->anUnforcedMoves[player];
 
@@ -175,11 +278,7 @@ AddStats(DBProvider * pdb, int gm_id, int player_id, int player, const char *tab
     errorskill = aaaar[CUBEDECISION][PERMOVE][player][NORMALISED];
     errorcost = aaaar[CUBEDECISION][PERMOVE][player][UNNORMALISED];
 
-    column = g_string_new(NULL);
-    value = g_string_new(NULL);
-
-
-    if (strcmp("matchstat", table) == 0) {
+    if (st == STMT_MATCHSTAT) {
         APPENDI("matchstat_id", gms_id);
         APPENDI("session_id", gm_id);
     } else {
@@ -262,39 +361,39 @@ AddStats(DBProvider * pdb, int gm_id, int player_id, int player, const char *tab
     APPENDF("time_penalty_loss", 0.0);
     /* matches only */
     r = 0.5f + scMatch.arActualResult[player] - scMatch.arLuck[player][1] + scMatch.arLuck[!player][1];
-    if (nMatchTo && r > 0.0f && r < 1.0f)
-        APPENDF("luck_based_fibs_rating_diff", relativeFibsRating(r, nMatchTo));
-    if (nMatchTo && (scMatch.fCube || scMatch.fMoves)) {
-        APPENDF("error_based_fibs_rating", absoluteFibsRating(aaaar[CHEQUERPLAY][PERMOVE]
-                                                              [player][NORMALISED], aaaar[CUBEDECISION][PERMOVE]
-                                                              [player][NORMALISED], nMatchTo, rRatingOffset));
-        if (scMatch.anUnforcedMoves[player])
-            APPENDF("chequer_rating_loss", absoluteFibsRatingChequer(aaaar[CHEQUERPLAY]
-                                                                     [PERMOVE][player]
-                                                                     [NORMALISED], nMatchTo));
-        if (scMatch.anCloseCube[player])
-            APPENDF("cube_rating_loss", absoluteFibsRatingCube(aaaar[CUBEDECISION]
-                                                               [PERMOVE][player]
-                                                               [NORMALISED], nMatchTo));
-    }
+    APPENDF_IF(nMatchTo && r > 0.0f && r < 1.0f, "luck_based_fibs_rating_diff", relativeFibsRating(r, nMatchTo));
+    fRating = nMatchTo && (scMatch.fCube || scMatch.fMoves);
+    APPENDF_IF(fRating, "error_based_fibs_rating", absoluteFibsRating(aaaar[CHEQUERPLAY][PERMOVE]
+                                                                     [player][NORMALISED], aaaar[CUBEDECISION][PERMOVE]
+                                                                     [player][NORMALISED], nMatchTo, rRatingOffset));
+    APPENDF_IF(fRating && scMatch.anUnforcedMoves[player], "chequer_rating_loss",
+               absoluteFibsRatingChequer(aaaar[CHEQUERPLAY][PERMOVE][player][NORMALISED], nMatchTo));
+    APPENDF_IF(fRating && scMatch.anCloseCube[player], "cube_rating_loss",
+               absoluteFibsRatingCube(aaaar[CUBEDECISION][PERMOVE][player][NORMALISED], nMatchTo));
 
     /* for money sessions only */
-    if (scMatch.fDice && !nMatchTo && scMatch.nGames > 1) {
-
-        APPENDF("actual_advantage", scMatch.arActualResult[player] / scMatch.nGames);
-        APPENDF("actual_advantage_ci", 1.95996f * sqrtf(scMatch.arVarianceActual[player] / scMatch.nGames));
-        APPENDF("luck_adjusted_advantage", scMatch.arLuckAdj[player] / scMatch.nGames);
-        APPENDF("luck_adjusted_advantage_ci", 1.95996f * sqrtf(scMatch.arVarianceLuckAdj[player] / scMatch.nGames));
+    fRating = scMatch.fDice && !nMatchTo && scMatch.nGames > 1;
+    APPENDF_IF(fRating, "actual_advantage", scMatch.arActualResult[player] / scMatch.nGames);
+    APPENDF_IF(fRating, "actual_advantage_ci", 1.95996f * sqrtf(scMatch.arVarianceActual[player] / scMatch.nGames));
+    APPENDF_IF(fRating, "luck_adjusted_advantage", scMatch.arLuckAdj[player] / scMatch.nGames);
+    APPENDF_IF(fRating, "luck_adjusted_advantage_ci",
+               1.95996f * sqrtf(scMatch.arVarianceLuckAdj[player] / scMatch.nGames));
+
+    if (column) {
+        GString *buf = g_string_new(NULL);
+        int i;
+
+        g_string_truncate(column, column->len - 2);
+        g_string_printf(buf, "INSERT INTO %s (%s) VALUES(", aszIdTables[it], column->str);
+        for (i = 0; i < c; i++)
+            g_string_append(buf, i ? ", ?" : "?");
+        g_string_append_c(buf, ')');
+        prw->apst[st] = DBPrepare(prw->pdb, buf->str);
+        g_string_free(buf, TRUE);
+        g_string_free(column, TRUE);
     }
 
-    g_string_truncate(column, column->len - 2);
-    g_string_truncate(value, value->len - 2);
-    buf = g_strdup_printf("INSERT INTO %s (%s) VALUES(%s)", table, column->str, value->str);
-    ret = pdb->UpdateCommand(buf);
-    g_free(buf);
-    g_string_free(column, TRUE);
-    g_string_free(value, TRUE);
-    return ret;
+    return Execute(prw, st, av, c);
 }
 
 int
@@ -359,6 +458,43 @@ CreateDatabase(DBProvider * pdb)
     return TRUE;
 }
 
+/* The tables added since version 1 of the database (as in gnubg.sql) */
+static const char *aszUpgrade2[] = {
+    "CREATE TABLE position (position_id INTEGER NOT NULL, gnubg_id CHAR(14) NOT NULL, "
+        "context VARCHAR(128) NOT NULL, setup CHAR(32) NOT NULL, trials INTEGER NOT NULL, "
+        "dice_skip INTEGER NOT NULL, stopped_on_jsd FLOAT NOT NULL, "
+        "output_win FLOAT NOT NULL, output_win_gammon FLOAT NOT NULL, output_win_backgammon FLOAT NOT NULL, "
+        "output_lose_gammon FLOAT NOT NULL, output_lose_backgammon FLOAT NOT NULL, "
+        "output_equity FLOAT NOT NULL, output_cubeful_equity FLOAT NOT NULL, "
+        "stddev_win FLOAT NOT NULL, stddev_win_gammon FLOAT NOT NULL, stddev_win_backgammon FLOAT NOT NULL, "
+        "stddev_lose_gammon FLOAT NOT NULL, stddev_lose_backgammon FLOAT NOT NULL, "
+        "stddev_equity FLOAT NOT NULL, stddev_cubeful_equity FLOAT NOT NULL, "
+        "added TIMESTAMP NOT NULL, PRIMARY KEY (position_id))",
+    "CREATE INDEX iposition ON position (gnubg_id, context, setup)",
+    NULL
+};
+
+static void
+UpgradeDatabase(DBProvider * pdb)
+{
+    int version = RunQueryValue(pdb, "next_id FROM control WHERE tablename = 'version'");
+    char *buf;
+    int i;
+
+    if (version != 1)
+        return;
+
+    for (i = 0; aszUpgrade2[i]; i++)
+        if (!pdb->UpdateCommand(aszUpgrade2[i]))
+            return;
+
+    buf = g_strdup_printf("UPDATE control SET next_id = %d WHERE tablename = 'version'", DB_VERSION);
+    pdb->UpdateCommand(buf);
+    g_free(buf);
+
+    pdb->Commit();
+}
+
 DBProvider *
 ConnectToDB(DBProviderType dbType)
 {
@@ -368,44 +504,282 @@ ConnectToDB(DBProviderType dbType)
         if (con < 0)
             return NULL;
 
-        if (con > 0 || CreateDatabase(pdb))
+        if (con > 0) {
+            UpgradeDatabase(pdb);
+            return pdb;
+        }
+        if (CreateDatabase(pdb))
             return pdb;
     }
     return NULL;
 }
 
-static void
-AddGames(DBProvider * pdb, int session_id, int player_id0, int player_id1)
+static int
+PlayerId(relwriter * prw, const char *name)
+{
+    gpointer p;
+    DBValue av[2];
+    int id;
+
+    if (g_hash_table_lookup_extended(prw->phPlayers, name, NULL, &p))
+        return GPOINTER_TO_INT(p);
+
+    /* Add new player to database */
+    if ((id = NextId(prw, ID_PLAYER)) == -1)
+        return -1;
+
+    SETI(av[0], id);
+    SETS(av[1], name);
+    if (!Execute(prw, STMT_PLAYER, av, 2))
+        return -1;
+
+    g_hash_table_insert(prw->phPlayers, g_strdup(name), GINT_TO_POINTER(id));
+    return id;
+}
+
+static int
+AddGames(relwriter * prw, int session_id, int player_id0, int player_id1)
 {
     int gamenum = 0;
     listOLD *plGame, *pl = lMatch.plNext;
     while ((plGame = pl->p) != NULL) {
-        int game_id = GetNextId(pdb, "game");
+        int game_id = NextId(prw, ID_GAME);
         moverecord *pmr = plGame->plNext->p;
         xmovegameinfo *pmgi = &pmr->g;
+        DBValue av[9];
+
+        if (game_id == -1)
+            return FALSE;
+
+        SETI(av[0], game_id);
+        SETI(av[1], session_id);
+        SETI(av[2], player_id0);
+        SETI(av[3], player_id1);
+        SETI(av[4], pmgi->anScore[0]);
+        SETI(av[5], pmgi->anScore[1]);
+        SETI(av[6], pmgi->nPoints);
+        SETI(av[7], ++gamenum);
+        SETI(av[8], pmr->g.fCrawfordGame);
+
+        if (!Execute(prw, STMT_GAME, av, 9)
+            || !AddStats(prw, STMT_GAMESTAT, game_id, player_id0, 0, ms.nMatchTo, &(pmgi->sc))
+            || !AddStats(prw, STMT_GAMESTAT, game_id, player_id1, 1, ms.nMatchTo, &(pmgi->sc)))
+            return FALSE;
+        pl = pl->plNext;
+    }
+    return TRUE;
+}
+
+extern relwriter *
+RelationalWriterOpen(void)
+{
+    DBProvider *pdb;
+    relwriter *prw;
+    RowSet *rs;
+    size_t i;
 
-        char *buf = g_strdup_printf("INSERT INTO game(game_id, session_id, player_id0, player_id1, "
-                                    "score_0, score_1, result, added, game_number, crawford) "
-                                    "VALUES (%d, %d, %d, %d, %d, %d, %d, CURRENT_TIMESTAMP, %d, %d )",
-                                    game_id, session_id, player_id0, player_id1,
-                                    pmgi->anScore[0], pmgi->anScore[1], pmgi->nPoints, ++gamenum, pmr->g.fCrawfordGame);
+    if (prwOpen) {
+        prwOpen->cRef++;
+        return prwOpen;
+    }
 
-        if (pdb->UpdateCommand(buf)) {
-            AddStats(pdb, game_id, player_id0, 0, "gamestat", ms.nMatchTo, &(pmgi->sc));
-            AddStats(pdb, game_id, player_id1, 1, "gamestat", ms.nMatchTo, &(pmgi->sc));
-        }
-        g_free(buf);
-        pl = pl->plNext;
+    if ((pdb = ConnectToDB(dbProviderType)) == NULL)
+        return NULL;
+
+    prw = prwOpen = g_new0(relwriter, 1);
+    prw->pdb = pdb;
+    prw->cRef = 1;
+    for (i = 0; i < NUM_IDTABLES; i++)
+        prw->aib[i].nLast = prw->aib[i].nEnd = -1;
+
+    prw->phPlayers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    if ((rs = pdb->Select("player_id, name FROM player")) != NULL) {
+        for (i = 1; i < rs->rows; i++)
+            g_hash_table_insert(prw->phPlayers, g_strdup(rs->data[i][1]),
+                                GINT_TO_POINTER((int) strtol(rs->data[i][0], NULL, 0)));
+        FreeRowset(rs);
+    }
+
+    DBBegin(pdb);
+    return prw;
+}
+
+extern int
+RelationalWriterMatchExists(relwriter * prw)
+{
+    return RelationalMatchExists(prw->pdb);
+}
+
+extern int
+RelationalWriterAddMatch(relwriter * prw)
+{
+    DBValue av[15];
+    char *date;
+    int i, existing_id, session_id, player_id0, player_id1, ok;
+
+    existing_id = RelationalMatchExists(prw->pdb);
+    if (existing_id != -1) {
+        /* Remove any game stats and games, then any match stats and session */
+        SETI(av[0], existing_id);
+        for (i = STMT_DELETE_GAMESTAT; i <= STMT_DELETE_SESSION; i++)
+            Execute(prw, (stmttype) i, av, 1);
+    }
+
+    session_id = NextId(prw, ID_SESSION);
+    player_id0 = PlayerId(prw, ap[0].szName);
+    player_id1 = PlayerId(prw, ap[1].szName);
+    if (session_id == -1 || player_id0 == -1 || player_id1 == -1)
+        return FALSE;
+
+    if (mi.nYear)
+        date = g_strdup_printf("%04u-%02u-%02u", mi.nYear, mi.nMonth, mi.nDay);
+    else
+        date = NULL;
+
+    SETI(av[0], session_id);
+    SETS(av[1], GetMatchCheckSum());
+    SETI(av[2], player_id0);
+    SETI(av[3], player_id1);
+    SETI(av[4], MatchResult(ms.nMatchTo));
+    SETI(av[5], ms.nMatchTo);
+    SETS(av[6], mi.pchRating[0]);
+    SETS(av[7], mi.pchRating[1]);
+    SETS(av[8], mi.pchEvent);
+    SETS(av[9], mi.pchRound);
+    SETS(av[10], mi.pchPlace);
+    SETS(av[11], mi.pchAnnotator);
+    SETS(av[12], mi.pchComment);
+    SETS(av[13], date);
+
+    updateStatisticsMatch(&lMatch);
+
+    ok = Execute(prw, STMT_SESSION, av, 14)
+        && AddStats(prw, STMT_MATCHSTAT, session_id, player_id0, 0, ms.nMatchTo, &scMatch)
+        && AddStats(prw, STMT_MATCHSTAT, session_id, player_id1, 1, ms.nMatchTo, &scMatch)
+        && (!storeGameStats || AddGames(prw, session_id, player_id0, player_id1));
+    g_free(date);
+
+    if (++prw->cPending >= MATCHES_PER_TRANSACTION) {
+        prw->pdb->Commit();
+        DBBegin(prw->pdb);
+        prw->cPending = 0;
+    }
+
+    return ok;
+}
+
+extern void
+RelationalWriterClose(relwriter * prw)
+{
+    int i;
+
+    if (--prw->cRef)
+        return;
+
+    for (i = 0; i < NUM_STMTS; i++)
+        if (prw->apst[i])
+            DBFinalize(prw->apst[i]);
+
+    ReleaseIds(prw);
+    prw->pdb->Commit();
+    prw->pdb->Disconnect();
+
+    g_hash_table_destroy(prw->phPlayers);
+    g_free(prw);
+    prwOpen = NULL;
+}
+
+/* The id, trials, dice skip, stopped on jsd, outputs and std devs of
+ * the rollout with the most trials for the key */
+static RowSet *
+SelectRollout(relwriter * prw, const rolloutkey * prk)
+{
+    char *buf = g_strdup_printf("position_id, trials, dice_skip, stopped_on_jsd, "
+                                "output_win, output_win_gammon, output_win_backgammon, output_lose_gammon, "
+                                "output_lose_backgammon, output_equity, output_cubeful_equity, "
+                                "stddev_win, stddev_win_gammon, stddev_win_backgammon, stddev_lose_gammon, "
+                                "stddev_lose_backgammon, stddev_equity, stddev_cubeful_equity "
+                                "FROM position WHERE gnubg_id = '%s' AND context = '%s' AND setup = '%s' "
+                                "ORDER BY trials DESC",
+                                prk->szPosition, prk->szContext, prk->szSetup);
+    RowSet *rs = prw->pdb->Select(buf);
+    g_free(buf);
+
+    if (rs && (rs->rows < 2 || rs->cols < 4 + 2 * NUM_ROLLOUT_OUTPUTS)) {
+        FreeRowset(rs);
+        rs = NULL;
+    }
+    return rs;
+}
+
+extern int
+RelationalWriterGetRollout(relwriter * prw, const rolloutkey * prk, rolloutcontext * prc,
+                           float arOutput[NUM_ROLLOUT_OUTPUTS], float arStdDev[NUM_ROLLOUT_OUTPUTS])
+{
+    RowSet *rs = SelectRollout(prw, prk);
+    int i;
+
+    if (!rs)
+        return FALSE;
+
+    prc->nGamesDone = (unsigned int) strtol(rs->data[1][1], NULL, 0);
+    prc->nSkip = (int) strtol(rs->data[1][2], NULL, 0);
+    prc->rStoppedOnJSD = (float) g_ascii_strtod(rs->data[1][3], NULL);
+    for (i = 0; i < NUM_ROLLOUT_OUTPUTS; i++) {
+        arOutput[i] = (float) g_ascii_strtod(rs->data[1][4 + i], NULL);
+        arStdDev[i] = (float) g_ascii_strtod(rs->data[1][4 + NUM_ROLLOUT_OUTPUTS + i], NULL);
     }
+
+    FreeRowset(rs);
+    return prc->nGamesDone > 0;
+}
+
+extern int
+RelationalWriterAddRollout(relwriter * prw, const rolloutkey * prk, const rolloutcontext * prc,
+                           const float arOutput[NUM_ROLLOUT_OUTPUTS], const float arStdDev[NUM_ROLLOUT_OUTPUTS])
+{
+    DBValue av[3 + 2 * NUM_ROLLOUT_OUTPUTS + 4];
+    RowSet *rs = SelectRollout(prw, prk);
+    int i, c, position_id = -1;
+
+    if (rs) {
+        unsigned int nTrials = (unsigned int) strtol(rs->data[1][1], NULL, 0);
+
+        position_id = (int) strtol(rs->data[1][0], NULL, 0);
+        FreeRowset(rs);
+        if (nTrials >= prc->nGamesDone)
+            return TRUE;        /* nothing new */
+    }
+
+    SETI(av[0], (int) prc->nGamesDone);
+    SETI(av[1], prc->nSkip);
+    SETF(av[2], prc->rStoppedOnJSD);
+    for (i = 0; i < NUM_ROLLOUT_OUTPUTS; i++) {
+        SETF(av[3 + i], arOutput[i]);
+        SETF(av[3 + NUM_ROLLOUT_OUTPUTS + i], arStdDev[i]);
+    }
+    c = 3 + 2 * NUM_ROLLOUT_OUTPUTS;
+
+    if (position_id != -1) {
+        SETI(av[c], position_id);
+        return Execute(prw, STMT_UPDATE_POSITION, av, c + 1);
+    }
+
+    if ((position_id = NextId(prw, ID_POSITION)) == -1)
+        return FALSE;
+
+    SETI(av[c], position_id);
+    SETS(av[c + 1], prk->szPosition);
+    SETS(av[c + 2], prk->szContext);
+    SETS(av[c + 3], prk->szSetup);
+    return Execute(prw, STMT_POSITION, av, c + 4);
 }
 
 extern void
 CommandRelationalAddMatch(char *sz)
 {
-    DBProvider *pdb;
-    char *buf, *buf2, *date;
+    relwriter *prw;
     char warnings[1024] = "";
-    int session_id, existing_id, player_id0, player_id1;
     char *arg = NULL;
     gboolean quiet = FALSE;
 
@@ -430,68 +804,17 @@ CommandRelationalAddMatch(char *sz)
             return;
     }
 
-    if ((pdb = ConnectToDB(dbProviderType)) == NULL) {
+    if ((prw = RelationalWriterOpen()) == NULL) {
         outputerrf(_("Error opening database"));
         return;
     }
-    existing_id = RelationalMatchExists(pdb);
-    if (existing_id != -1) {
-        if (!quiet && !GetInputYN(_("Match exists, overwrite?")))
-            return;
 
-        /* Remove any game stats and games */
-        buf2 = g_strdup_printf("FROM game WHERE session_id = %d", existing_id);
-        buf = g_strdup_printf("DELETE FROM gamestat WHERE game_id in (SELECT game_id %s)", buf2);
-        pdb->UpdateCommand(buf);
-        g_free(buf);
-        buf = g_strdup_printf("DELETE %s", buf2);
-        pdb->UpdateCommand(buf);
-        g_free(buf);
-        g_free(buf2);
-
-        /* Remove any match stats and session */
-        buf = g_strdup_printf("DELETE FROM matchstat WHERE session_id = %d", existing_id);
-        pdb->UpdateCommand(buf);
-        g_free(buf);
-        buf = g_strdup_printf("DELETE FROM session WHERE session_id = %d", existing_id);
-        pdb->UpdateCommand(buf);
-        g_free(buf);
-    }
-
-    session_id = GetNextId(pdb, "session");
-    player_id0 = AddPlayer(pdb, ap[0].szName);
-    player_id1 = AddPlayer(pdb, ap[1].szName);
-    if (session_id == -1 || player_id0 == -1 || player_id1 == -1) {
-        outputl(_("Error adding match."));
-        return;
+    if (quiet || RelationalWriterMatchExists(prw) == -1 || GetInputYN(_("Match exists, overwrite?"))) {
+        if (!RelationalWriterAddMatch(prw))
+            outputl(_("Error adding match."));
     }
 
-    if (mi.nYear)
-        date = g_strdup_printf("%04u-%02u-%02u", mi.nYear, mi.nMonth, mi.nDay);
-    else
-        date = NULL;
-
-    buf = g_strdup_printf("INSERT INTO session(session_id, checksum, player_id0, player_id1, "
-                          "result, length, added, rating0, rating1, event, round, place, annotator, comment, date) "
-                          "VALUES (%d, '%s', %d, %d, %d, %d, CURRENT_TIMESTAMP, '%s', '%s', '%s', '%s', '%s', '%s', '%s', '%s')",
-                          session_id, GetMatchCheckSum(), player_id0, player_id1,
-                          MatchResult(ms.nMatchTo), ms.nMatchTo, NS(mi.pchRating[0]), NS(mi.pchRating[1]),
-                          NS(mi.pchEvent), NS(mi.pchRound), NS(mi.pchPlace), NS(mi.pchAnnotator), NS(mi.pchComment),
-                          NS(date));
-
-    updateStatisticsMatch(&lMatch);
-
-    if (pdb->UpdateCommand(buf)) {
-        if (AddStats(pdb, session_id, player_id0, 0, "matchstat", ms.nMatchTo, &scMatch) &&
-            AddStats(pdb, session_id, player_id1, 1, "matchstat", ms.nMatchTo, &scMatch)) {
-            if (storeGameStats)
-                AddGames(pdb, session_id, player_id0, player_id1);
-            pdb->Commit();
-        }
-    }
-    g_free(buf);
-    g_free(date);
-    pdb->Disconnect();
+    RelationalWriterClose(prw);
 }
 
 const char *
@@ -856,6 +1179,8 @@ CommandRelationalSetup(char *sz)
             SetDBType(apch[1]);
         if (!StrCaseCmp(apch[0], "storegamestats"))
             storeGameStats = !StrCaseCmp(apch[1], "yes");
+        else if (!StrCaseCmp(apch[0], "storepositions"))
+            storePositions = !StrCaseCmp(apch[1], "yes");
         else {
             char *pc = apch[0];
             char *db = NextTokenGeneral(&pc, "-");
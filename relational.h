@@ -26,12 +26,39 @@
 #include <sys/types.h>
 #include "analysis.h"
 #include "dbprovider.h"
+#include "eval.h"
+#include "rollout.h"
 
-#define DB_VERSION 1
+#define DB_VERSION 2
 
 
 extern int RelationalUpdatePlayerDetails(const char *oldName, const char *newName, const char *newNotes);
 extern float Ratio(float a, int b);
 extern statcontext *relational_player_stats_get(const char *player0, const char *player1);
 
+/* Adds matches to the database over one connection, with prepared
+ * statements, ids reserved in blocks and many matches to a transaction.
+ * RelationalWriterAddMatch() adds the current match, replacing it if it
+ * is already there; nothing is certain to be committed until
+ * RelationalWriterClose(). */
+typedef struct _relwriter relwriter;
+
+extern relwriter *RelationalWriterOpen(void);
+/* The session id of the current match if it is in the database, or -1 */
+extern int RelationalWriterMatchExists(relwriter * prw);
+extern int RelationalWriterAddMatch(relwriter * prw);
+extern void RelationalWriterClose(relwriter * prw);
+
+/* Rollouts of positions are kept in the database (when storePositions
+ * is set) so that the same rollout can be extended rather than done
+ * again.  They are found by their RolloutKey(). */
+/* Fill in the games done, outputs and std devs of the stored rollout
+ * with the most games; FALSE if there is none */
+extern int RelationalWriterGetRollout(relwriter * prw, const rolloutkey * prk, rolloutcontext * prc,
+                                      float arOutput[NUM_ROLLOUT_OUTPUTS], float arStdDev[NUM_ROLLOUT_OUTPUTS]);
+/* Store the rollout unless one with as many games is there already */
+extern int RelationalWriterAddRollout(relwriter * prw, const rolloutkey * prk, const rolloutcontext * prc,
+                                      const float arOutput[NUM_ROLLOUT_OUTPUTS],
+                                      const float arStdDev[NUM_ROLLOUT_OUTPUTS]);
+
 #endif                          /* RELATIONAL_H */
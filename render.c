@@ -40,6 +40,9 @@
 #include "boardpos.h"
 #include "backgammon.h"
 #include "util.h"
+#if defined(USE_AVX) || defined(USE_SSE2)
+#include "lib/blendsse.h"
+#endif
 
 #if defined(USE_GTK)
 #include <gtk/gtk.h>
@@ -229,17 +232,8 @@ ssqrt(float x)
 extern void
 CopyArea(unsigned char *puchDest, int nDestStride, unsigned char *puchSrc, int nSrcStride, int cx, int cy)
 {
-    int x;
-
-    nDestStride -= cx * 3;
-    nSrcStride -= cx * 3;
-
     for (; cy; cy--) {
-        for (x = cx; x; x--) {
-            *puchDest++ = *puchSrc++;
-            *puchDest++ = *puchSrc++;
-            *puchDest++ = *puchSrc++;
-        }
+        memcpy(puchDest, puchSrc, cx * 3);
         puchDest += nDestStride;
         puchSrc += nSrcStride;
     }
@@ -385,6 +379,9 @@ extern void
 AlphaBlendBase(unsigned char *puchDest, int nDestStride,
                unsigned char *puchBack, int nBackStride, unsigned char *puchFore, int nForeStride, int cx, int cy)
 {
+#if defined(USE_AVX) || defined(USE_SSE2)
+    AlphaBlendBaseSSE(puchDest, nDestStride, puchBack, nBackStride, puchFore, nForeStride, cx, cy);
+#else
     int x;
 
     nDestStride -= cx * 3;
@@ -404,6 +401,7 @@ AlphaBlendBase(unsigned char *puchDest, int nDestStride,
         puchBack += nBackStride;
         puchFore += nForeStride;
     }
+#endif
 }
 
 extern void
@@ -461,6 +459,9 @@ AlphaBlend2(unsigned char *puchDest, int nDestStride,
 {
     /* draw *puchFore on top of *puchBack using the alpha channel as mask into *puchDest */
 
+#if defined(USE_AVX) || defined(USE_SSE2)
+    AlphaBlend2SSE(puchDest, nDestStride, puchBack, nBackStride, puchFore, nForeStride, cx, cy);
+#else
     int x;
 
     nDestStride -= cx * 3;
@@ -480,6 +481,7 @@ AlphaBlend2(unsigned char *puchDest, int nDestStride,
         puchBack += nBackStride;
         puchFore += nForeStride;
     }
+#endif
 }
 
 extern void
@@ -537,6 +539,9 @@ RefractBlend(unsigned char *puchDest, int nDestStride,
              unsigned char *puchBack, int nBackStride,
              unsigned char *puchFore, int nForeStride, unsigned short *psRefract, int nRefractStride, int cx, int cy)
 {
+#if defined(USE_AVX) || defined(USE_SSE2)
+    RefractBlendSSE(puchDest, nDestStride, puchBack, nBackStride, puchFore, nForeStride, psRefract, nRefractStride, cx, cy);
+#else
     int x;
 
     nDestStride -= cx * 3;
@@ -558,6 +563,7 @@ RefractBlend(unsigned char *puchDest, int nDestStride,
         puchFore += nForeStride;
         psRefract += nRefractStride;
     }
+#endif
 }
 
 extern void
@@ -2261,6 +2267,9 @@ Copy_RGB_to_RGBA(unsigned char *puchDest, int nDestStride,
     /* copy an 24-bit RGB buffer into an 24+8-bit RGBA buffer, setting
      * the alpha channel to uchAlpha */
 
+#if defined(USE_AVX) || defined(USE_SSE2)
+    CopyRGBToRGBASSE(puchDest, nDestStride, puchSrc, nSrcStride, cx, cy, uchAlpha);
+#else
     int x;
 
     nDestStride -= cx * 4;      /* 8 bit alpha + 24 packed rgb bits */
@@ -2276,6 +2285,7 @@ Copy_RGB_to_RGBA(unsigned char *puchDest, int nDestStride,
         puchDest += nDestStride;
         puchSrc += nSrcStride;
     }
+#endif
 }
 
 #if defined(USE_GTK) && defined(HAVE_CAIRO)
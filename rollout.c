@@ -41,6 +41,11 @@
 #include "format.h"
 #include "multithread.h"
 #include "rollout.h"
+#include "relational.h"
+#include "gbf.h"
+#include "matchequity.h"
+#include "md5.h"
+#include "rolloutworker.h"
 #include "lib/simd.h"
 
 #define LogCubeClamped(n) (n < (1 << STAT_MAXCUBE) ? LogCube(n) : (STAT_MAXCUBE - 1))
@@ -364,14 +369,9 @@ BasicCubefulRollout(unsigned int aanBoard[][2][25],
     evalcontext aecVarRedn[2];
     evalcontext aecZero[2];
     float arMean[NUM_ROLLOUT_OUTPUTS];
-    unsigned int aaanBoard[6][6][2][25];
+    TanBoard aaanBoard[6][6];
     int aanMoves[6][6][8];
-#if defined(USE_SIMD_INSTRUCTIONS)
-#define NUM_ROLLOUT_OUTPUTS_PADDED (NUM_ROLLOUT_OUTPUTS + VEC_SIZE - (NUM_ROLLOUT_OUTPUTS % VEC_SIZE))
-    SSE_ALIGN(float aaar[6][6][NUM_ROLLOUT_OUTPUTS_PADDED]);
-#else
     float aaar[6][6][NUM_ROLLOUT_OUTPUTS];
-#endif
 
     evalcontext ecCubeless0ply = { FALSE, 0, FALSE, TRUE, 0.0 };
     evalcontext ecCubeful0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
@@ -586,32 +586,22 @@ BasicCubefulRollout(unsigned int aanBoard[][2][25],
                     for (i = 0; i < NUM_ROLLOUT_OUTPUTS; i++)
                         arMean[i] = 0.0f;
 
+                    /* Find the best move for each roll on ply 0 only and
+                     * re-evaluate the chosen move at ply n-1.  No doubles
+                     * are possible for the first roll when rolling out as
+                     * initial position. */
+
+                    if (EvaluateRollsVarRedn((ConstTanBoard) aanBoard[ici], pci, &aecZero[pci->fMove],
+                                             &aecVarRedn[!pci->fMove], prc->fInitial && !iTurn,
+                                             aanMoves, aaanBoard, aaar) < 0)
+                        return -1;
+
                     for (i = 0; i < 6; i++)
                         for (j = 0; j <= i; j++) {
 
                             if (prc->fInitial && !iTurn && j == i)
-                                /* no doubles possible for first roll when rolling
-                                 * out as initial position */
                                 continue;
 
-                            memcpy(&aaanBoard[i][j][0][0], &aanBoard[ici][0][0], 2 * 25 * sizeof(int));
-
-                            /* Find the best move for each roll on ply 0 only */
-
-                            if (FindBestMove(aanMoves[i][j], i + 1, j + 1,
-                                             aaanBoard[i][j], pci, &aecZero[pci->fMove], defaultFilters) < 0)
-                                return -1;
-
-                            SwapSides(aaanBoard[i][j]);
-
-                            /* re-evaluate the chosen move at ply n-1 */
-
-                            pci->fMove = !pci->fMove;
-                            if (GeneralEvaluationE(aaar[i][j],
-                                                   (ConstTanBoard) aaanBoard[i][j], pci, &aecVarRedn[pci->fMove]) < 0)
-                                return -1;
-                            pci->fMove = !pci->fMove;
-
                             if (!(iTurn & 1))
                                 InvertEvaluationR(aaar[i][j], pci);
 
@@ -912,6 +902,42 @@ comp_jsdinfo_order(const void *a, const void *b)
     return 0;
 }
 
+/* The key is the position, the cube, score and rules in a readable
+ * form, and an md5 checksum of the rollout settings */
+
+extern void
+RolloutKey(rolloutkey * prk, const TanBoard anBoard, const cubeinfo * pci,
+           int fInvert, int fCubeRollout, int fCubeDecTop, const rolloutcontext * prc)
+{
+    rolloutcontext rc;
+    GByteArray *pba;
+    unsigned char auch[16];
+    int i;
+
+    strcpy(prk->szPosition, PositionID(anBoard));
+
+    g_snprintf(prk->szContext, sizeof(prk->szContext), "%d %d %d %d %d-%d %d%d%d %d %d%d%d %s",
+               pci->nCube, pci->fCubeOwner, pci->fMove, pci->nMatchTo, pci->anScore[0], pci->anScore[1],
+               pci->fCrawford, pci->fJacoby, pci->fBeavers, pci->bgv, fInvert, fCubeRollout, fCubeDecTop,
+               pci->nMatchTo && miCurrent.szName ? miCurrent.szName : "");
+
+    /* only the settings that decide the result; how many games to
+     * play and when to stop don't make it a different rollout */
+    memcpy(&rc, prc, sizeof(rolloutcontext));
+    rc.fStopOnSTD = rc.fStopOnJsd = rc.fStopMoveOnJsd = 0;
+    rc.nTrials = rc.nMinimumGames = rc.nMinimumJsdGames = rc.nGamesDone = 0;
+    rc.rStdLimit = rc.rJsdLimit = rc.rStoppedOnJSD = 0.0f;
+    rc.nSkip = 0;
+
+    pba = g_byte_array_new();
+    GBFPutRolloutContext(pba, &rc);
+    md5_buffer((const char *) pba->data, pba->len, auch);
+    g_byte_array_free(pba, TRUE);
+
+    for (i = 0; i < 16; i++)
+        sprintf(prk->szSetup + (i * 2), "%02x", auch[i]);
+}
+
 /* Lots of shared variables - should probably not be globals... */
 static int cGames;
 static cubeinfo *aciLocal;
@@ -935,6 +961,7 @@ static int ro_fInvert;
 static int ro_NextTrial;
 static unsigned int *altGameCount;
 static int *altTrialCount;
+static GArray *ro_paPending;    /* rolloutresult of trials played out of turn */
 
 static void
 check_jsds(int *active)
@@ -1117,16 +1144,181 @@ check_sds(int *active)
 
 }
 
+/* Play game trial of a rollout of anBoard, which is played on.  The
+ * dice depend on the seed and the trial only, so the game is the same
+ * whichever thread or process plays it. */
+
 extern void
-RolloutLoopMT(void *UNUSED(unused))
+RolloutGame(TanBoard anBoard, float ar[NUM_ROLLOUT_OUTPUTS], int trial, const cubeinfo * pci, int *pfCubeDecTop,
+            rolloutcontext * prc, rolloutstat(*pars)[2], int nBasisCube, perArray * dicePerms,
+            rngcontext * rngctx, FILE * logfp)
+{
+    /* get the dice generator set up... */
+    if (prc->fRotate)
+        QuasiRandomSeed(dicePerms, (int) prc->nSeed);
+
+    nSkip = 0;                  /* not multi-thread safe do quasi random dice for initial positions */
+
+    /* ... and the RNG */
+    if (prc->rngRollout != RNG_MANUAL)
+        InitRNGSeedStream((unsigned int) prc->nSeed, (unsigned int) trial, prc->rngRollout, rngctx);
+
+    BasicCubefulRollout((unsigned int (*)[2][25]) anBoard, (float (*)[NUM_ROLLOUT_OUTPUTS]) ar, 0, trial, pci,
+                        pfCubeDecTop, 1, prc, pars, nBasisCube, dicePerms, rngctx, logfp);
+}
+
+static void
+ApplyGameResult(int alt, float aar[NUM_ROLLOUT_OUTPUTS])
+{
+    rolloutcontext *prc = &ro_apes[alt]->rc;
+    unsigned int j;
+
+    altGameCount[alt]++;
+
+    if (ro_fInvert)
+        InvertEvaluationR(aar, ro_apci[alt]);
+
+    /* apply the results */
+    for (j = 0; j < NUM_ROLLOUT_OUTPUTS; j++) {
+        float rMuNew, rDelta;
+
+        aarResult[alt][j] += aar[j];
+        rMuNew = aarResult[alt][j] / (altGameCount[alt]);
+
+        if (altGameCount[alt] > 1) {    /* for i == 0 aarVariance is not defined */
+
+            rDelta = rMuNew - aarMu[alt][j];
+
+            aarVariance[alt][j] =
+                aarVariance[alt][j] * (1.0f - 1.0f / (altGameCount[alt] - 1)) +
+                (altGameCount[alt]) * rDelta * rDelta;
+        }
+
+        aarMu[alt][j] = rMuNew;
+
+        if (j < OUTPUT_EQUITY) {
+            if (aarMu[alt][j] < 0.0f)
+                aarMu[alt][j] = 0.0f;
+            else if (aarMu[alt][j] > 1.0f)
+                aarMu[alt][j] = 1.0f;
+        }
+
+        aarSigma[alt][j] = sqrtf(aarVariance[alt][j] / (altGameCount[alt]));
+    }                           /* for (j = 0; j < NUM_ROLLOUT_OUTPUTS; j++ ) */
+
+    /* For normal alternatives nGamesDone and altGameCount will be equal. For cube decisions,
+     * however, the two may differ by the number of threads minus 1. So we cheat a little bit, but
+     * it would be better if the double and nodouble alternatives weren't linked */
+    if (prc->nGamesDone < altGameCount[alt])
+        prc->nGamesDone = altGameCount[alt];
+}
+
+/* Add the result of trial of alternative alt; must be called with the
+ * rollout state locked.  The results are applied in the order of the
+ * trials, so the games done are always trials 0 to altGameCount[alt] -
+ * 1, and a rollout stopped with games still being played goes on from
+ * the first one missing.  Games finished ahead of their turn wait in
+ * ro_paPending until then. */
+
+static void
+AddGameResult(int alt, int trial, float aar[NUM_ROLLOUT_OUTPUTS])
+{
+    guint i;
+
+    if (trial != (int) altGameCount[alt]) {
+        rolloutresult rr;
+
+        rr.alt = alt;
+        rr.trial = trial;
+        memcpy(rr.ar, aar, sizeof(rr.ar));
+        g_array_append_val(ro_paPending, rr);
+        return;
+    }
+
+    ApplyGameResult(alt, aar);
+
+    /* and those that were waiting for it */
+    for (i = 0; i < ro_paPending->len;) {
+        rolloutresult *prr = &g_array_index(ro_paPending, rolloutresult, i);
+
+        if (prr->alt == alt && prr->trial == (int) altGameCount[alt]) {
+            ApplyGameResult(alt, prr->ar);
+            g_array_remove_index_fast(ro_paPending, i);
+            i = 0;
+        } else
+            i++;
+    }
+}
+
+/* Play trial of alternative alt here and add the result; FALSE if
+ * interrupted */
+
+static int
+PlayTrial(int alt, int trial, rngcontext * rngctx, perArray * dicePerms)
 {
     TanBoard anBoardEval;
     float aar[NUM_ROLLOUT_OUTPUTS];
+    FILE *logfp = NULL;
+
+    memcpy(&anBoardEval, ro_apBoard[alt], sizeof(anBoardEval));
+
+    /* roll something out */
+    if (log_rollouts && log_file_name) {
+        char *log_name = g_strdup_printf("%s-%7.7d-%c.sgf", log_file_name, trial, alt + 'a');
+        logfp = log_game_start(log_name, ro_apci[alt], ro_apes[alt]->rc.fCubeful, anBoardEval);
+        g_free(log_name);
+    }
+    RolloutGame(anBoardEval, aar, trial, ro_apci[alt], ro_apCubeDecTop[alt], &ro_apes[alt]->rc,
+                ro_aarsStatistics ? ro_aarsStatistics + alt : NULL,
+                aciLocal[ro_fCubeRollout ? 0 : alt].nCube, dicePerms, rngctx, logfp);
+
+    if (logfp) {
+        log_game_over(logfp);
+    }
+
+    if (fInterrupt)
+        return FALSE;
+
+    multi_debug("exclusive lock: update result for alternative");
+    MT_Exclusive();
+    AddGameResult(alt, trial, aar);
+    MT_Release();
+    multi_debug("exclusive release: update result for alternative");
+
+    return TRUE;
+}
+
+/* We've rolled everything out for a trial; check the stopping
+ * conditions.  TRUE when the rollout is done. */
+
+static int
+RolloutDone(int *pactive)
+{
+    int fDone;
+
+    /* Stop rolling out moves whose Equity is more than a user selected multiple of the joint standard
+     * deviation of the equity difference with the best move in the list. */
+
+    multi_debug("exclusive lock: rollout cycle update");
+    MT_Exclusive();
+    if (show_jsds) {
+        check_jsds(pactive);
+    }
+    if (rcRollout.fStopOnSTD) {
+        check_sds(pactive);
+    }
+    fDone = (*pactive < 2 && rcRollout.fStopOnJsd) || *pactive < 1;
+    MT_Release();
+    multi_debug("exclusive release: rollout cycle update");
+
+    return fDone;
+}
+
+extern void
+RolloutLoopMT(void *UNUSED(unused))
+{
     int active_alternatives;
-    unsigned int j;
     int alt;
-    FILE *logfp = NULL;
-    rolloutcontext *prc = NULL;
     /* Each thread gets a copy of the rngctxRollout */
     rngcontext *rngctxMTRollout = CopyRNGContext(rngctxRollout);
     perArray dicePerms;
@@ -1145,113 +1337,177 @@ RolloutLoopMT(void *UNUSED(unused))
                 continue;
             }
 
+            if (!PlayTrial(alt, trial, rngctxMTRollout, &dicePerms))
+                break;
+        }                       /* for (alt = 0; alt < ro_alternatives; ++alt) */
 
-            prc = &ro_apes[alt]->rc;
+        if (fInterrupt)
+            break;
 
-            /* get the dice generator set up... */
-            if (prc->fRotate)
-                QuasiRandomSeed(&dicePerms, (int) prc->nSeed);
+#if !defined(USE_MULTITHREAD)
+        ProcessEvents();
+#endif
 
-            nSkip = 0;          /* not multi-thread safe do quasi random dice for initial positions */
+        if (RolloutDone(&active_alternatives))
+            break;
+    }
+    free(rngctxMTRollout);
+}
 
-            /* ... and the RNG */
-            if (prc->rngRollout != RNG_MANUAL)
-                InitRNGSeed((unsigned int) (prc->nSeed + (trial << 8)), prc->rngRollout, rngctxMTRollout);
+/* The task that hands trials to the rollout workers.  It takes them
+ * from the same counters as RolloutLoopMT() and adds the results the
+ * same way, so threads and workers share the rollout, and the
+ * stopping rules see every game.  The trials of a worker that goes
+ * away are played here. */
 
-            memcpy(&anBoardEval, ro_apBoard[alt], sizeof(anBoardEval));
+static int ro_cWorkers;
 
-            /* roll something out */
-            if (log_rollouts && log_file_name) {
-                char *log_name = g_strdup_printf("%s-%7.7d-%c.sgf", log_file_name, trial, alt + 'a');
-                logfp = log_game_start(log_name, ro_apci[alt], prc->fCubeful, anBoardEval);
-                g_free(log_name);
-            }
-            BasicCubefulRollout(&anBoardEval, &aar, 0, trial, ro_apci[alt],
-                                ro_apCubeDecTop[alt], 1, prc,
-                                ro_aarsStatistics ? ro_aarsStatistics + alt : NULL,
-                                aciLocal[ro_fCubeRollout ? 0 : alt].nCube, &dicePerms, rngctxMTRollout, logfp);
+static void
+AddStatistics(rolloutstat ars[2], const rolloutstat arsAdd[2])
+{
+    /* rolloutstat is all counts */
+    int *pi = (int *) ars;
+    const int *piAdd = (const int *) arsAdd;
+    unsigned int i;
 
-            if (logfp) {
-                log_game_over(logfp);
-            }
+    for (i = 0; i < 2 * sizeof(rolloutstat) / sizeof(int); i++)
+        pi[i] += piAdd[i];
+}
 
-            if (fInterrupt)
-                break;
+static void
+RolloutWorkersMT(void *UNUSED(unused))
+{
+    rngcontext *rngctxMTRollout = CopyRNGContext(rngctxRollout);
+    perArray dicePerms;
+    rollouttrial *aart = g_new(rollouttrial, ro_cWorkers * ro_alternatives);
+    rolloutresult *arr = g_new(rolloutresult, ro_alternatives);
+    rolloutstat(*aars)[2] = ro_aarsStatistics ? g_malloc(ro_alternatives * sizeof(*aars)) : NULL;
+    int *ac = g_new0(int, ro_cWorkers);
+    int cAlive = ro_cWorkers;
+    int active_alternatives;
+    int fDone = FALSE;
+    int i, k, c, alt;
 
-            multi_debug("exclusive lock: update result for alternative");
-            MT_Exclusive();
-            altGameCount[alt]++;
+    dicePerms.nPermutationSeed = -1;
 
-            if (ro_fInvert)
-                InvertEvaluationR(aar, ro_apci[alt]);
+    for (;;) {
+        /* a trial for every idle worker */
+        for (i = 0; i < ro_cWorkers && !fDone && !fInterrupt; i++) {
+            rollouttrial *art = aart + i * ro_alternatives;
 
-            /* apply the results */
-            for (j = 0; j < NUM_ROLLOUT_OUTPUTS; j++) {
-                float rMuNew, rDelta;
+            if (ac[i])          /* busy or gone */
+                continue;
 
-                aarResult[alt][j] += aar[j];
-                rMuNew = aarResult[alt][j] / (altGameCount[alt]);
+            if (MT_SafeIncValue(&ro_NextTrial) > cGames) {
+                fDone = TRUE;
+                break;
+            }
 
-                if (altGameCount[alt] > 1) {    /* for i == 0 aarVariance is not defined */
+            for (alt = 0, c = 0; alt < ro_alternatives; ++alt) {
+                int trial = MT_SafeIncValue(&altTrialCount[alt]) - 1;
+                if (fNoMore[alt] || (trial > cGames)) {
+                    MT_SafeDec(&altTrialCount[alt]);
+                    continue;
+                }
+                art[c].alt = alt;
+                art[c++].trial = trial;
+            }
 
-                    rDelta = rMuNew - aarMu[alt][j];
+            if (!c)
+                continue;
 
-                    aarVariance[alt][j] =
-                        aarVariance[alt][j] * (1.0f - 1.0f / (altGameCount[alt] - 1)) +
-                        (altGameCount[alt]) * rDelta * rDelta;
-                }
+            if (RolloutWorkerSend(i, art, c) < 0) {
+                ac[i] = -1;
+                cAlive--;
+                for (k = 0; k < c; k++)
+                    if (!PlayTrial(art[k].alt, art[k].trial, rngctxMTRollout, &dicePerms))
+                        break;
+            } else
+                ac[i] = c;
+        }
 
-                aarMu[alt][j] = rMuNew;
+        i = RolloutWorkerWait(UI_UPDATETIME);
 
-                if (j < OUTPUT_EQUITY) {
-                    if (aarMu[alt][j] < 0.0f)
-                        aarMu[alt][j] = 0.0f;
-                    else if (aarMu[alt][j] > 1.0f)
-                        aarMu[alt][j] = 1.0f;
-                }
+        if (i == -2) {
+            /* none busy */
+            if (fDone || fInterrupt)
+                break;
+            if (!cAlive) {
+                /* carry on here */
+                RolloutLoopMT(NULL);
+                break;
+            }
+            continue;
+        }
 
-                aarSigma[alt][j] = sqrtf(aarVariance[alt][j] / (altGameCount[alt]));
-            }                   /* for (j = 0; j < NUM_ROLLOUT_OUTPUTS; j++ ) */
+        if (i == -1) {
+#if !defined(USE_MULTITHREAD)
+            ProcessEvents();
+#endif
+            continue;
+        }
 
-            /* For normal alternatives nGamesDone and altGameCount will be equal. For cube decisions,
-             * however, the two may differ by the number of threads minus 1. So we cheat a little bit, but
-             * it would be better if the double and nodouble alternatives weren't linked */
-            if (prc->nGamesDone < altGameCount[alt])
-                prc->nGamesDone = altGameCount[alt];
+        c = ac[i];
+        ac[i] = 0;
 
+        if (RolloutWorkerReceive(i, arr, &k, aars) < 0) {
+            rollouttrial *art = aart + i * ro_alternatives;
+
+            outputerrf(_("Rollout worker %d has stopped; its games are played here."), i + 1);
+            ac[i] = -1;
+            cAlive--;
+            for (k = 0; k < c && !fInterrupt; k++)
+                if (!PlayTrial(art[k].alt, art[k].trial, rngctxMTRollout, &dicePerms))
+                    break;
+        } else if (!fInterrupt) {
+            multi_debug("exclusive lock: update result for alternative");
+            MT_Exclusive();
+            for (c = 0; c < k; c++)
+                AddGameResult(arr[c].alt, arr[c].trial, arr[c].ar);
+            if (aars)
+                for (alt = 0; alt < ro_alternatives; alt++)
+                    AddStatistics(ro_aarsStatistics[alt], aars[alt]);
             MT_Release();
             multi_debug("exclusive release: update result for alternative");
+        }
 
-        }                       /* for (alt = 0; alt < ro_alternatives; ++alt) */
+        if (!fDone && !fInterrupt) {
+            /* counted down again by every check, as in RolloutLoopMT() */
+            active_alternatives = ro_alternatives;
+            fDone = RolloutDone(&active_alternatives);
+        }
+    }
 
-        if (fInterrupt)
-            break;
+    g_free(ac);
+    g_free(aars);
+    g_free(arr);
+    g_free(aart);
+    free(rngctxMTRollout);
+}
 
-        /* we've rolled everything out for this trial, check stopping conditions */
-        /* Stop rolling out moves whose Equity is more than a user selected multiple of the joint standard
-         * deviation of the equity difference with the best move in the list. */
+/* Whether the games can be left to the workers: they must get their
+ * dice from the seed and trial alone */
 
-#if !defined(USE_MULTITHREAD)
-        ProcessEvents();
-#endif
+static int
+UseWorkers(evalsetup * apes[], int alternatives)
+{
+    int alt;
 
-        multi_debug("exclusive lock: rollout cycle update");
-        MT_Exclusive();
-        if (show_jsds) {
-            check_jsds(&active_alternatives);
-        }
-        if (rcRollout.fStopOnSTD) {
-            check_sds(&active_alternatives);
-        }
-        if ((active_alternatives < 2 && rcRollout.fStopOnJsd) || active_alternatives < 1) {
-            multi_debug("exclusive release: rollout done early");
-            MT_Release();
+    if (log_rollouts && log_file_name)
+        return FALSE;
+
+    for (alt = 0; alt < alternatives; alt++)
+        switch (apes[alt]->rc.rngRollout) {
+        case RNG_ISAAC:
+        case RNG_MD5:
+        case RNG_MERSENNE:
+        case RNG_PHILOX:
             break;
+        default:
+            return FALSE;
         }
-        multi_debug("exclusive release: rollout cycle update");
-        MT_Release();
-    }
-    free(rngctxMTRollout);
+
+    return TRUE;
 }
 
 static rolloutprogressfunc *ro_pfProgress;
@@ -1280,6 +1536,216 @@ UpdateProgress(gpointer UNUSED(unused))
     return TRUE;
 }
 
+/* Checkpoints.  With "set autosave rollout on" the state of the
+ * rollout is written every nAutoSaveTime minutes to a file in the
+ * backup directory named after the alternatives rolled out, so a
+ * rollout lost with gnubg or the machine it ran on carries on from
+ * there when it is started again.  Each game is seeded by its trial
+ * number and the games done are always the first ones
+ * (AddGameResult()), so their number with the means and standard
+ * deviations is all it takes to go on as if it had never stopped.
+ *
+ * The file is little endian: CKPT_MAGIC, the version, the number of
+ * alternatives and whether statistics follow, then for each
+ * alternative the games done, nSkip, rStoppedOnJSD and the means and
+ * standard deviations, then the statistics of each side as ints.  It
+ * is written with the primitives of the binary match files (gbf.h). */
+
+#define CKPT_MAGIC "GNUBGROL"
+#define CKPT_VERSION 1
+
+typedef struct _altcheckpoint {
+    unsigned int nGames;
+    int nSkip;
+    float rStoppedOnJSD;
+    float arMu[NUM_ROLLOUT_OUTPUTS];
+    float arSigma[NUM_ROLLOUT_OUTPUTS];
+    rolloutstat ars[2];
+} altcheckpoint;
+
+static char *ro_szCheckpoint;
+static time_t ro_tCheckpoint;
+
+/* The statistics of one side, field by field so the file doesn't
+ * depend on the layout of rolloutstat */
+
+#define CKPT_STAT_INTS (5 * STAT_MAXCUBE + 6)
+
+static void
+PutRolloutStat(GByteArray * pba, const rolloutstat * prs)
+{
+    GBFPutInts(pba, prs->acWin, STAT_MAXCUBE);
+    GBFPutInts(pba, prs->acWinGammon, STAT_MAXCUBE);
+    GBFPutInts(pba, prs->acWinBackgammon, STAT_MAXCUBE);
+    GBFPutInts(pba, prs->acDoubleDrop, STAT_MAXCUBE);
+    GBFPutInts(pba, prs->acDoubleTake, STAT_MAXCUBE);
+    GBFPutI32(pba, prs->nOpponentHit);
+    GBFPutI32(pba, prs->rOpponentHitMove);
+    GBFPutI32(pba, prs->nBearoffMoves);
+    GBFPutI32(pba, prs->nBearoffPipsLost);
+    GBFPutI32(pba, prs->nOpponentClosedOut);
+    GBFPutI32(pba, prs->rOpponentClosedOutMove);
+}
+
+static void
+GetRolloutStat(gbfreader * pr, rolloutstat * prs)
+{
+    GBFGetInts(pr, prs->acWin, STAT_MAXCUBE);
+    GBFGetInts(pr, prs->acWinGammon, STAT_MAXCUBE);
+    GBFGetInts(pr, prs->acWinBackgammon, STAT_MAXCUBE);
+    GBFGetInts(pr, prs->acDoubleDrop, STAT_MAXCUBE);
+    GBFGetInts(pr, prs->acDoubleTake, STAT_MAXCUBE);
+    prs->nOpponentHit = GBFGetI32(pr);
+    prs->rOpponentHitMove = GBFGetI32(pr);
+    prs->nBearoffMoves = GBFGetI32(pr);
+    prs->nBearoffPipsLost = GBFGetI32(pr);
+    prs->nOpponentClosedOut = GBFGetI32(pr);
+    prs->rOpponentClosedOutMove = GBFGetI32(pr);
+}
+
+static char *
+CheckpointFile(ConstTanBoard * apBoard, const cubeinfo(*apci[]), int (*apCubeDecTop[]),
+               evalsetup(*apes[]), int alternatives, int fInvert, int fCubeRollout)
+{
+    GString *pstr = g_string_new(NULL);
+    unsigned char auch[16];
+    char szName[sizeof("rollout-.ckpt") + 32];
+    rolloutkey rk;
+    int alt, i;
+
+    for (alt = 0; alt < alternatives; alt++) {
+        const rolloutcontext *prc = (apes[alt]->et == EVAL_ROLLOUT && apes[alt]->rc.nGamesDone) ?
+            &apes[alt]->rc : &rcRollout;
+
+        RolloutKey(&rk, apBoard[alt], apci[alt], fInvert, fCubeRollout, *apCubeDecTop[alt], prc);
+        g_string_append_printf(pstr, "%s %s %s\n", rk.szPosition, rk.szContext, rk.szSetup);
+    }
+
+    md5_buffer(pstr->str, pstr->len, auch);
+    g_string_free(pstr, TRUE);
+
+    strcpy(szName, "rollout-");
+    for (i = 0; i < 16; i++)
+        sprintf(szName + 8 + (i * 2), "%02x", auch[i]);
+    strcat(szName, ".ckpt");
+
+    return g_build_filename(szHomeDirectory, "backup", szName, NULL);
+}
+
+/* Must be called with the rollout state locked */
+
+static void
+SaveCheckpoint(void)
+{
+    GByteArray *pba;
+    int alt;
+
+    if (!ro_szCheckpoint || ro_alternatives < 1)
+        return;
+
+    pba = g_byte_array_new();
+    g_byte_array_append(pba, (const guint8 *) CKPT_MAGIC, 8);
+    GBFPutU32(pba, CKPT_VERSION);
+    GBFPutU32(pba, ro_alternatives);
+    GBFPutU32(pba, ro_aarsStatistics != NULL);
+
+    for (alt = 0; alt < ro_alternatives; alt++) {
+        const rolloutcontext *prc = &ro_apes[alt]->rc;
+
+        GBFPutU32(pba, altGameCount[alt]);
+        GBFPutI32(pba, prc->nSkip);
+        GBFPutFloat(pba, prc->rStoppedOnJSD);
+        GBFPutFloats(pba, aarMu[alt], NUM_ROLLOUT_OUTPUTS);
+        GBFPutFloats(pba, aarSigma[alt], NUM_ROLLOUT_OUTPUTS);
+    }
+
+    if (ro_aarsStatistics)
+        for (alt = 0; alt < ro_alternatives; alt++) {
+            PutRolloutStat(pba, &ro_aarsStatistics[alt][0]);
+            PutRolloutStat(pba, &ro_aarsStatistics[alt][1]);
+        }
+
+    /* written to a temporary file and renamed, so a crash while saving
+     * leaves the last checkpoint */
+    if (!g_file_set_contents(ro_szCheckpoint, (const gchar *) pba->data, pba->len, NULL))
+        outputerrf(_("Could not save the rollout checkpoint %s"), ro_szCheckpoint);
+
+    g_byte_array_free(pba, TRUE);
+}
+
+/* Read the checkpoint into pac; FALSE if there isn't one for this
+ * rollout */
+
+static int
+LoadCheckpoint(const char *szFile, altcheckpoint * pac, int alternatives, int fStatistics)
+{
+    gchar *pch;
+    gsize cb, cbAlt, cbStat;
+    gbfreader r;
+    int alt, fHasStatistics;
+
+    if (!g_file_get_contents(szFile, &pch, &cb, NULL))
+        return FALSE;
+
+    cbAlt = 4 * (3 + 2 * NUM_ROLLOUT_OUTPUTS);
+    cbStat = 2 * 4 * CKPT_STAT_INTS;
+
+    if (cb < 20 || memcmp(pch, CKPT_MAGIC, 8)) {
+        g_free(pch);
+        return FALSE;
+    }
+
+    r.puch = (const guchar *) pch + 8;
+    r.puchEnd = (const guchar *) pch + cb;
+    r.fError = FALSE;
+
+    if (GBFGetU32(&r) != CKPT_VERSION || GBFGetU32(&r) != (guint32) alternatives) {
+        g_free(pch);
+        return FALSE;
+    }
+
+    fHasStatistics = GBFGetU32(&r);
+    if ((fStatistics && !fHasStatistics) ||
+        cb != 20 + alternatives * cbAlt + (fHasStatistics ? alternatives * cbStat : 0)) {
+        g_free(pch);
+        return FALSE;
+    }
+
+    for (alt = 0; alt < alternatives; alt++) {
+        pac[alt].nGames = GBFGetU32(&r);
+        pac[alt].nSkip = GBFGetI32(&r);
+        pac[alt].rStoppedOnJSD = GBFGetFloat(&r);
+        GBFGetFloats(&r, pac[alt].arMu, NUM_ROLLOUT_OUTPUTS);
+        GBFGetFloats(&r, pac[alt].arSigma, NUM_ROLLOUT_OUTPUTS);
+    }
+
+    if (fHasStatistics)
+        for (alt = 0; alt < alternatives; alt++) {
+            GetRolloutStat(&r, &pac[alt].ars[0]);
+            GetRolloutStat(&r, &pac[alt].ars[1]);
+        }
+
+    g_free(pch);
+    return !r.fError;
+}
+
+static gboolean
+RolloutCallback(gpointer p)
+{
+    UpdateProgress(p);
+
+    if (ro_szCheckpoint && time(NULL) - ro_tCheckpoint >= nAutoSaveTime * 60) {
+        multi_debug("exclusive lock: rollout checkpoint");
+        MT_Exclusive();
+        SaveCheckpoint();
+        MT_Release();
+        multi_debug("exclusive release: rollout checkpoint");
+        ro_tCheckpoint = time(NULL);
+    }
+
+    return TRUE;
+}
+
 extern int
 RolloutGeneral(ConstTanBoard * apBoard,
                float (*apOutput[])[NUM_ROLLOUT_OUTPUTS],
@@ -1302,6 +1768,9 @@ RolloutGeneral(ConstTanBoard * apBoard,
     int fOutputMWCSave = fOutputMWC;
     int active_alternatives;
     int previous_rollouts = 0;
+    relwriter *prw = NULL;
+    rolloutkey rk;
+    altcheckpoint *pac = NULL;
 
     show_jsds = 1;
 
@@ -1342,6 +1811,21 @@ RolloutGeneral(ConstTanBoard * apBoard,
     if (rcRollout.fInitial)
         rcRollout.fRotate = FALSE;
 
+    /* earlier rollouts of the alternatives may be in the database */
+    if (storePositions)
+        prw = RelationalWriterOpen();
+
+    /* or a checkpoint of this rollout stopped before it was done */
+    g_free(ro_szCheckpoint);
+    ro_szCheckpoint = NULL;
+    if (fAutoSaveRollout) {
+        ro_szCheckpoint = CheckpointFile(apBoard, apci, apCubeDecTop, apes, alternatives, fInvert, fCubeRollout);
+        ro_tCheckpoint = time(NULL);
+        pac = g_alloca(alternatives * sizeof(altcheckpoint));
+        if (!LoadCheckpoint(ro_szCheckpoint, pac, alternatives, aarsStatistics != NULL))
+            pac = NULL;
+    }
+
     /* nFirstTrial will be the smallest number of trials done for an alternative */
     nFirstTrial = cGames = rcRollout.nTrials;
     initial_game_count = 0;
@@ -1362,6 +1846,28 @@ RolloutGeneral(ConstTanBoard * apBoard,
         if (fInvert)
             aciLocal[alt].fMove = !aciLocal[alt].fMove;
 
+        if (prw && ((pes->et != EVAL_ROLLOUT) || (prc->nGamesDone == 0)) && apOutput[alt] && apStdDev[alt]) {
+            RolloutKey(&rk, apBoard[alt], apci[alt], fInvert, fCubeRollout, *apCubeDecTop[alt], &rcRollout);
+            memcpy(prc, &rcRollout, sizeof(rolloutcontext));
+            if (RelationalWriterGetRollout(prw, &rk, prc, *apOutput[alt], *apStdDev[alt]))
+                pes->et = EVAL_ROLLOUT; /* extend it below */
+        }
+
+        if (pac && apOutput[alt] && apStdDev[alt] &&
+            pac[alt].nGames > (pes->et == EVAL_ROLLOUT ? prc->nGamesDone : 0)) {
+            if (pes->et != EVAL_ROLLOUT || prc->nGamesDone == 0)
+                memcpy(prc, &rcRollout, sizeof(rolloutcontext));
+            prc->nGamesDone = pac[alt].nGames;
+            prc->nSkip = pac[alt].nSkip;
+            prc->rStoppedOnJSD = pac[alt].rStoppedOnJSD;
+            memcpy(*apOutput[alt], pac[alt].arMu, sizeof(pac[alt].arMu));
+            memcpy(*apStdDev[alt], pac[alt].arSigma, sizeof(pac[alt].arSigma));
+            if (aarsStatistics)
+                memcpy(aarsStatistics[alt], pac[alt].ars, sizeof(pac[alt].ars));
+            pes->et = EVAL_ROLLOUT;
+            outputf(_("Resuming the rollout of alternative %d after %u games.\n"), alt + 1, pac[alt].nGames);
+        }
+
         if ((pes->et != EVAL_ROLLOUT) || (prc->nGamesDone == 0)) {
             /* later the saved context may to be stored with the move, so cubeful/cubeless must be made
              * consistent */
@@ -1450,6 +1956,7 @@ RolloutGeneral(ConstTanBoard * apBoard,
     ro_fCubeRollout = fCubeRollout;
     ro_fInvert = fInvert;
     ro_NextTrial = nFirstTrial;
+    ro_paPending = g_array_new(FALSE, FALSE, sizeof(rolloutresult));
     ro_pfProgress = pfProgress;
     ro_pUserData = pUserData;
 
@@ -1469,14 +1976,55 @@ RolloutGeneral(ConstTanBoard * apBoard,
     UpdateProgress(NULL);
 
     if (active_alternatives > 1 || (!rcRollout.fStopOnJsd && active_alternatives > 0)) {
+        ro_cWorkers = 0;
+        if (cRolloutWorkers) {
+            if (!UseWorkers(apes, alternatives))
+                outputl(_("The rollout workers are not used: they need a seeded random number generator "
+                          "and no logging of the games."));
+            else if ((ro_cWorkers = RolloutWorkersStart()) > 0) {
+                rolloutjob rj;
+                int *anBasisCube = g_alloca(alternatives * sizeof(int));
+
+                for (alt = 0; alt < alternatives; alt++)
+                    anBasisCube[alt] = aciLocal[fCubeRollout ? 0 : alt].nCube;
+
+                rj.alternatives = alternatives;
+                rj.fStatistics = aarsStatistics != NULL;
+                rj.apBoard = apBoard;
+                rj.apci = apci;
+                rj.apCubeDecTop = apCubeDecTop;
+                rj.apes = apes;
+                rj.anBasisCube = anBasisCube;
+
+                if (!RolloutWorkersSendJob(&rj))
+                    ro_cWorkers = 0;
+            }
+        }
+
         multi_debug("rollout adding tasks");
-        mt_add_tasks(MT_GetNumThreads(), RolloutLoopMT, NULL, NULL);
+        if (ro_cWorkers) {
+            /* the task feeding the workers takes the place of a thread */
+            mt_add_tasks(1, RolloutWorkersMT, NULL, NULL);
+            mt_add_tasks(MT_GetNumThreads() - 1, RolloutLoopMT, NULL, NULL);
+        } else
+            mt_add_tasks(MT_GetNumThreads(), RolloutLoopMT, NULL, NULL);
 
         multi_debug("rollout waiting for tasks to complete");
-        MT_WaitForTasks(UpdateProgress, 2000, fAutoSaveRollout);
+        MT_WaitForTasks(RolloutCallback, 2000, fAutoSaveRollout);
         multi_debug("rollout finished waiting for tasks to complete");
     }
 
+    /* keep the checkpoint if the rollout was interrupted, so it can go
+     * on from there; it's done with otherwise */
+    if (ro_szCheckpoint) {
+        if (fInterrupt)
+            SaveCheckpoint();
+        else
+            g_unlink(ro_szCheckpoint);
+        g_free(ro_szCheckpoint);
+        ro_szCheckpoint = NULL;
+    }
+
     /* Make sure final output is up to date */
 #if defined(USE_GTK)
     if (!fX)
@@ -1492,6 +2040,10 @@ RolloutGeneral(ConstTanBoard * apBoard,
      */
     ro_alternatives = -1;
 
+    /* the games after one that wasn't finished are played again */
+    g_array_free(ro_paPending, TRUE);
+    ro_paPending = NULL;
+
     for (alt = 0, trialsDone = 0; alt < alternatives; ++alt) {
         if (apes[alt]->rc.nGamesDone > trialsDone)
             trialsDone = apes[alt]->rc.nGamesDone;
@@ -1500,6 +2052,17 @@ RolloutGeneral(ConstTanBoard * apBoard,
     memcpy(&rcRollout, &rcRolloutSave, sizeof(rcRollout));
     fOutputMWC = fOutputMWCSave;
 
+    if (prw) {
+        for (alt = 0; alt < alternatives; alt++) {
+            if (!apOutput[alt] || !apStdDev[alt] || !apes[alt]->rc.nGamesDone)
+                continue;
+            RolloutKey(&rk, apBoard[alt], apci[alt], fInvert, fCubeRollout, *apCubeDecTop[alt],
+                       &apes[alt]->rc);
+            RelationalWriterAddRollout(prw, &rk, &apes[alt]->rc, aarMu[alt], aarSigma[alt]);
+        }
+        RelationalWriterClose(prw);
+    }
+
     /* return -1 if no games rolled out */
     if (trialsDone == 0)
         return -1;
@@ -22,6 +22,8 @@
 #ifndef ROLLOUT_H
 #define ROLLOUT_H
 
+#include "positionid.h"
+
 #define MAXHIT 50               /* for statistics */
 #define STAT_MAXCUBE 10
 
@@ -70,6 +72,18 @@ typedef void
                         const int nRank,
                         const float rJsd, const int fStopped, const int fShowRanks, int fCubeRollout, void *pUserData);
 
+/* What identifies a rollout: the position, the cube, score and rules it
+ * is rolled out with, and a checksum of the settings that decide the
+ * result */
+typedef struct _rolloutkey {
+    char szPosition[L_POSITIONID + 1];
+    char szContext[128];
+    char szSetup[33];
+} rolloutkey;
+
+extern void RolloutKey(rolloutkey * prk, const TanBoard anBoard, const cubeinfo * pci,
+                       int fInvert, int fCubeRollout, int fCubeDecTop, const rolloutcontext * prc);
+
 extern int
 RolloutGeneral(ConstTanBoard * apBoard,
                float (*apOutput[])[NUM_ROLLOUT_OUTPUTS],
@@ -145,6 +159,9 @@ EXP_LOCK_FUN(int, BasicCubefulRollout, unsigned int aanBoard[][2][25], float aar
              rolloutstat aarsStatistics[][2], int nBasisCube, perArray * dicePerms, rngcontext * rngctxRollout,
              FILE * logfp);
 
+extern void RolloutGame(TanBoard anBoard, float ar[NUM_ROLLOUT_OUTPUTS], int trial, const cubeinfo * pci,
+                        int *pfCubeDecTop, rolloutcontext * prc, rolloutstat(*pars)[2], int nBasisCube,
+                        perArray * dicePerms, rngcontext * rngctx, FILE * logfp);
 
 extern void log_cube(FILE * logfp, const char *action, int side);
 extern void log_move(FILE * logfp, const int *anMove, int side, int die0, int die1);
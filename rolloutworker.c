@@ -0,0 +1,635 @@
+/*
+ * rolloutworker.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+
+#include "backgammon.h"
+#include "dice.h"
+#include "gbf.h"
+#include "matchequity.h"
+#include "rolloutworker.h"
+#include "util.h"
+
+unsigned int cRolloutWorkers = 0;
+
+#if !defined(WIN32)
+
+/* Every message starts with its type and the length of the rest */
+
+#define RW_JOB 1
+#define RW_TRIALS 2
+#define RW_RESULTS 3
+
+typedef struct _worker {
+    int fdIn, fdOut;            /* our ends of its standard input and output; -1 when gone */
+    int fBusy;
+} worker;
+
+static worker aw[MAX_ROLLOUT_WORKERS];
+static int cStarted;
+static int cJobAlternatives, fJobStatistics;
+
+static char *szProgram;
+static int fProgramNoBearoff;
+
+static int
+WriteAll(int fd, const void *p, size_t cb)
+{
+    const char *pch = p;
+    ssize_t n;
+
+    while (cb) {
+        if ((n = write(fd, pch, cb)) < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        pch += n;
+        cb -= n;
+    }
+
+    return 0;
+}
+
+static int
+ReadAll(int fd, void *p, size_t cb)
+{
+    char *pch = p;
+    ssize_t n;
+
+    while (cb) {
+        if ((n = read(fd, pch, cb)) < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        } else if (!n)
+            return -1;
+        pch += n;
+        cb -= n;
+    }
+
+    return 0;
+}
+
+static GByteArray *
+NewMessage(guint32 nType)
+{
+    GByteArray *pba = g_byte_array_new();
+    guint32 an[2];
+
+    an[0] = nType;
+    an[1] = 0;
+    g_byte_array_append(pba, (const guint8 *) an, sizeof(an));
+
+    return pba;
+}
+
+/* Append a structure as it is in memory */
+
+static void
+PutRaw(GByteArray * pba, const void *p, size_t cb)
+{
+    g_byte_array_append(pba, p, (guint) cb);
+}
+
+/* Send the message and free it */
+
+static int
+SendMessage(int fd, GByteArray * pba)
+{
+    guint32 cb = pba->len - 2 * sizeof(guint32);
+    int n;
+
+    memcpy(pba->data + sizeof(guint32), &cb, sizeof(cb));
+    n = WriteAll(fd, pba->data, pba->len);
+    g_byte_array_free(pba, TRUE);
+
+    return n;
+}
+
+static GByteArray *
+ReceiveMessage(int fd, guint32 * pnType)
+{
+    GByteArray *pba;
+    guint32 an[2];
+
+    if (ReadAll(fd, an, sizeof(an)))
+        return NULL;
+
+    pba = g_byte_array_sized_new(an[1]);
+    g_byte_array_set_size(pba, an[1]);
+    if (ReadAll(fd, pba->data, an[1])) {
+        g_byte_array_free(pba, TRUE);
+        return NULL;
+    }
+
+    *pnType = an[0];
+    return pba;
+}
+
+static void
+InitReader(gbfreader * pr, const GByteArray * pba)
+{
+    pr->puch = pba->data;
+    pr->puchEnd = pba->data + pba->len;
+    pr->fError = FALSE;
+}
+
+/* Take a structure written by PutRaw() from the message */
+
+static int
+GetRaw(gbfreader * pr, void *p, size_t cb)
+{
+    const guchar *puch = GBFTake(pr, cb);
+
+    if (!puch)
+        return -1;
+
+    memcpy(p, puch, cb);
+    return 0;
+}
+
+static void
+CloseWorker(worker * pw)
+{
+    if (pw->fdIn >= 0)
+        close(pw->fdIn);
+    if (pw->fdOut >= 0)
+        close(pw->fdOut);
+    pw->fdIn = pw->fdOut = -1;
+    pw->fBusy = FALSE;
+}
+
+extern void
+RolloutWorkerSetProgram(const char *szArgv0, int fNoBearoff)
+{
+    char *pch;
+
+    g_free(szProgram);
+
+    /* the working directory may change before the workers are started */
+    if ((pch = g_find_program_in_path(szArgv0)) && !g_path_is_absolute(pch)) {
+        char *szDir = g_get_current_dir();
+
+        szProgram = g_build_filename(szDir, pch, NULL);
+        g_free(szDir);
+        g_free(pch);
+    } else
+        szProgram = pch;
+
+    fProgramNoBearoff = fNoBearoff;
+}
+
+static int
+StartWorker(worker * pw)
+{
+    const char *argv[12];
+    int i = 0;
+    GError *error = NULL;
+
+    argv[i++] = szProgram;
+    argv[i++] = "--tty";
+    argv[i++] = "--quiet";
+    argv[i++] = "--no-rc";
+    argv[i++] = "--rollout-worker";
+    if (fProgramNoBearoff)
+        argv[i++] = "--no-bearoff";
+    if (datadir) {
+        argv[i++] = "--datadir";
+        argv[i++] = datadir;
+    }
+    if (pkg_datadir) {
+        argv[i++] = "--pkgdatadir";
+        argv[i++] = pkg_datadir;
+    }
+    argv[i] = NULL;
+
+    if (!g_spawn_async_with_pipes(NULL, (gchar **) argv, NULL, 0, NULL, NULL, NULL,
+                                  &pw->fdIn, &pw->fdOut, NULL, &error)) {
+        outputerrf(_("Could not start a rollout worker: %s"), error->message);
+        g_error_free(error);
+        pw->fdIn = pw->fdOut = -1;
+        return -1;
+    }
+
+    pw->fBusy = FALSE;
+    return 0;
+}
+
+extern int
+RolloutWorkersStart(void)
+{
+    int i, c = 0;
+
+    if (!szProgram) {
+        outputl(_("Rollout workers cannot be started: the gnubg program was not found."));
+        return 0;
+    }
+
+    if (!cStarted)
+        /* a worker that goes away is noticed by the writes failing */
+        PortableSignal(SIGPIPE, SIG_IGN, NULL, FALSE);
+
+    /* workers that went away are started again */
+    for (i = 0; i < MAX_ROLLOUT_WORKERS; i++) {
+        if (i >= (int) cRolloutWorkers) {
+            if (i < cStarted)
+                CloseWorker(aw + i);
+            continue;
+        }
+
+        if ((i >= cStarted || aw[i].fdIn < 0) && StartWorker(aw + i) < 0)
+            continue;
+
+        c++;
+    }
+    cStarted = MIN((int) cRolloutWorkers, MAX_ROLLOUT_WORKERS);
+
+    return c ? cStarted : 0;
+}
+
+extern void
+RolloutWorkersStop(void)
+{
+    int i;
+
+    for (i = 0; i < cStarted; i++)
+        CloseWorker(aw + i);
+    cStarted = 0;
+}
+
+extern int
+RolloutWorkersSendJob(const rolloutjob * prj)
+{
+    GByteArray *pba;
+    int i, alt, c = 0;
+
+    for (i = 0; i < cStarted; i++) {
+        if (aw[i].fdIn < 0)
+            continue;
+
+        pba = NewMessage(RW_JOB);
+        GBFPutString(pba, VERSION);
+        GBFPutI32(pba, sizeof(TanBoard));
+        GBFPutI32(pba, sizeof(cubeinfo));
+        GBFPutI32(pba, sizeof(rolloutcontext));
+        GBFPutI32(pba, sizeof(rolloutstat));
+        GBFPutString(pba, miCurrent.szFileName);
+        GBFPutI32(pba, fInvertMET);
+        GBFPutI32(pba, prj->alternatives);
+        GBFPutI32(pba, prj->fStatistics);
+
+        for (alt = 0; alt < prj->alternatives; alt++) {
+            PutRaw(pba, prj->apBoard[alt], sizeof(TanBoard));
+            PutRaw(pba, prj->apci[alt], sizeof(cubeinfo));
+            GBFPutI32(pba, *prj->apCubeDecTop[alt]);
+            GBFPutI32(pba, prj->anBasisCube[alt]);
+            PutRaw(pba, &prj->apes[alt]->rc, sizeof(rolloutcontext));
+        }
+
+        if (SendMessage(aw[i].fdIn, pba))
+            CloseWorker(aw + i);
+        else
+            c++;
+    }
+
+    cJobAlternatives = prj->alternatives;
+    fJobStatistics = prj->fStatistics;
+
+    return c;
+}
+
+extern int
+RolloutWorkerSend(int i, const rollouttrial * art, int c)
+{
+    GByteArray *pba;
+    int k;
+
+    if (aw[i].fdIn < 0)
+        return -1;
+
+    pba = NewMessage(RW_TRIALS);
+    GBFPutI32(pba, c);
+    for (k = 0; k < c; k++) {
+        GBFPutI32(pba, art[k].alt);
+        GBFPutI32(pba, art[k].trial);
+    }
+
+    if (SendMessage(aw[i].fdIn, pba)) {
+        CloseWorker(aw + i);
+        return -1;
+    }
+
+    aw[i].fBusy = TRUE;
+    return 0;
+}
+
+extern int
+RolloutWorkerWait(int msTimeout)
+{
+    GPollFD apfd[MAX_ROLLOUT_WORKERS];
+    int ai[MAX_ROLLOUT_WORKERS];
+    int i, c = 0;
+
+    for (i = 0; i < cStarted; i++)
+        if (aw[i].fBusy) {
+            apfd[c].fd = aw[i].fdOut;
+            apfd[c].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+            apfd[c].revents = 0;
+            ai[c++] = i;
+        }
+
+    if (!c)
+        return -2;
+
+    if (g_poll(apfd, c, msTimeout) <= 0)
+        return -1;
+
+    for (i = 0; i < c; i++)
+        if (apfd[i].revents)
+            return ai[i];
+
+    return -1;
+}
+
+extern int
+RolloutWorkerReceive(int i, rolloutresult * arr, int *pc, rolloutstat(*aars)[2])
+{
+    GByteArray *pba;
+    gbfreader r;
+    guint32 nType;
+    int c, k;
+
+    aw[i].fBusy = FALSE;
+
+    if (!(pba = ReceiveMessage(aw[i].fdOut, &nType)))
+        goto error;
+
+    InitReader(&r, pba);
+
+    c = GBFGetI32(&r);
+    if (nType != RW_RESULTS || c < 0 || c > cJobAlternatives) {
+        g_byte_array_free(pba, TRUE);
+        goto error;
+    }
+
+    for (k = 0; k < c; k++) {
+        arr[k].alt = GBFGetI32(&r);
+        arr[k].trial = GBFGetI32(&r);
+        GBFGetFloats(&r, arr[k].ar, NUM_ROLLOUT_OUTPUTS);
+    }
+
+    if ((fJobStatistics && GetRaw(&r, aars, cJobAlternatives * sizeof(rolloutstat[2]))) || r.fError) {
+        g_byte_array_free(pba, TRUE);
+        goto error;
+    }
+
+    g_byte_array_free(pba, TRUE);
+    *pc = c;
+    return 0;
+
+  error:
+    CloseWorker(aw + i);
+    return -1;
+}
+
+/* The worker's side */
+
+static struct {
+    int alternatives;
+    int fStatistics;
+    TanBoard *aanBoard;
+    cubeinfo *aci;
+    int *afCubeDecTop;
+    int *anBasisCube;
+    rolloutcontext *arc;
+    rolloutstat(*aars)[2];
+} wj;
+
+static int
+ReadJob(const GByteArray * pba)
+{
+    gbfreader r;
+    char *sz, *szMET;
+    int an[4], f, alt, i;
+
+    InitReader(&r, pba);
+
+    /* the same build of gnubg */
+    sz = GBFGetString(&r);
+    f = sz && !strcmp(sz, VERSION);
+    g_free(sz);
+    if (!f)
+        return -1;
+
+    for (i = 0; i < 4; i++)
+        an[i] = GBFGetI32(&r);
+    if (r.fError || an[0] != sizeof(TanBoard) || an[1] != sizeof(cubeinfo) || an[2] != sizeof(rolloutcontext) ||
+        an[3] != sizeof(rolloutstat))
+        return -1;
+
+    /* the match equity table of the coordinator */
+    szMET = GBFGetString(&r);
+    f = GBFGetI32(&r);
+    if (r.fError) {
+        g_free(szMET);
+        return -1;
+    }
+
+    if (szMET && *szMET && (!miCurrent.szFileName || strcmp(szMET, miCurrent.szFileName) || f != fInvertMET)) {
+        InitMatchEquity(szMET);
+        fInvertMET = f;
+        if (fInvertMET)
+            invertMET();
+        EvalCacheFlush();
+    }
+    g_free(szMET);
+
+    wj.alternatives = GBFGetI32(&r);
+    wj.fStatistics = GBFGetI32(&r);
+    if (r.fError || wj.alternatives < 1)
+        return -1;
+
+    wj.aanBoard = g_renew(TanBoard, wj.aanBoard, wj.alternatives);
+    wj.aci = g_renew(cubeinfo, wj.aci, wj.alternatives);
+    wj.afCubeDecTop = g_renew(int, wj.afCubeDecTop, wj.alternatives);
+    wj.anBasisCube = g_renew(int, wj.anBasisCube, wj.alternatives);
+    wj.arc = g_renew(rolloutcontext, wj.arc, wj.alternatives);
+    wj.aars = g_realloc(wj.aars, wj.alternatives * sizeof(*wj.aars));
+    memset(wj.aars, 0, wj.alternatives * sizeof(rolloutstat[2]));
+
+    for (alt = 0; alt < wj.alternatives; alt++) {
+        if (GetRaw(&r, wj.aanBoard[alt], sizeof(TanBoard)) || GetRaw(&r, wj.aci + alt, sizeof(cubeinfo)))
+            return -1;
+        wj.afCubeDecTop[alt] = GBFGetI32(&r);
+        wj.anBasisCube[alt] = GBFGetI32(&r);
+        if (GetRaw(&r, wj.arc + alt, sizeof(rolloutcontext)))
+            return -1;
+    }
+
+    return r.fError ? -1 : 0;
+}
+
+static int
+PlayTrials(const GByteArray * pba, int fd, rngcontext * rngctx, perArray * dicePerms)
+{
+    gbfreader r;
+    rollouttrial rt;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    GByteArray *pbaResults;
+    int i, c;
+
+    InitReader(&r, pba);
+
+    c = GBFGetI32(&r);
+    if (r.fError || c < 0 || c > wj.alternatives)
+        return -1;
+
+    pbaResults = NewMessage(RW_RESULTS);
+    GBFPutI32(pbaResults, c);
+
+    for (i = 0; i < c; i++) {
+        TanBoard anBoard;
+
+        rt.alt = GBFGetI32(&r);
+        rt.trial = GBFGetI32(&r);
+        if (r.fError || rt.alt < 0 || rt.alt >= wj.alternatives) {
+            g_byte_array_free(pbaResults, TRUE);
+            return -1;
+        }
+
+        memcpy(anBoard, wj.aanBoard[rt.alt], sizeof(TanBoard));
+        RolloutGame(anBoard, ar, rt.trial, wj.aci + rt.alt, wj.afCubeDecTop + rt.alt, wj.arc + rt.alt,
+                    wj.fStatistics ? wj.aars + rt.alt : NULL, wj.anBasisCube[rt.alt], dicePerms, rngctx, NULL);
+        GBFPutI32(pbaResults, rt.alt);
+        GBFPutI32(pbaResults, rt.trial);
+        GBFPutFloats(pbaResults, ar, NUM_ROLLOUT_OUTPUTS);
+    }
+
+    /* the statistics since the last answer */
+    if (wj.fStatistics) {
+        PutRaw(pbaResults, wj.aars, wj.alternatives * sizeof(rolloutstat[2]));
+        memset(wj.aars, 0, wj.alternatives * sizeof(rolloutstat[2]));
+    }
+
+    return SendMessage(fd, pbaResults);
+}
+
+extern int
+RolloutWorkerMain(void)
+{
+    rngcontext *rngctx = CopyRNGContext(rngctxRollout);
+    perArray *pdicePerms = g_new(perArray, 1);
+    GByteArray *pba;
+    guint32 nType;
+    int fd, n = 0;
+
+    pdicePerms->nPermutationSeed = -1;
+
+    /* the messages go to the real standard output; anything gnubg
+     * prints goes to standard error */
+    fd = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    /* an interrupt is for the coordinator, which stops sending trials */
+    PortableSignal(SIGINT, SIG_IGN, NULL, FALSE);
+
+    while (!n && (pba = ReceiveMessage(STDIN_FILENO, &nType))) {
+        switch (nType) {
+        case RW_JOB:
+            n = ReadJob(pba);
+            break;
+        case RW_TRIALS:
+            n = wj.alternatives ? PlayTrials(pba, fd, rngctx, pdicePerms) : -1;
+            break;
+        default:
+            n = -1;
+            break;
+        }
+        g_byte_array_free(pba, TRUE);
+    }
+
+    g_free(pdicePerms);
+    free(rngctx);
+
+    return n ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#else                           /* WIN32 */
+
+/* Workers need pipes that can be polled */
+
+extern void
+RolloutWorkerSetProgram(const char *UNUSED(szArgv0), int UNUSED(fNoBearoff))
+{
+}
+
+extern int
+RolloutWorkersStart(void)
+{
+    outputl(_("Rollout workers are not supported on this platform."));
+    return 0;
+}
+
+extern void
+RolloutWorkersStop(void)
+{
+}
+
+extern int
+RolloutWorkersSendJob(const rolloutjob * UNUSED(prj))
+{
+    return 0;
+}
+
+extern int
+RolloutWorkerSend(int UNUSED(i), const rollouttrial * UNUSED(art), int UNUSED(c))
+{
+    return -1;
+}
+
+extern int
+RolloutWorkerWait(int UNUSED(msTimeout))
+{
+    return -2;
+}
+
+extern int
+RolloutWorkerReceive(int UNUSED(i), rolloutresult * UNUSED(arr), int *UNUSED(pc), rolloutstat(*UNUSED(aars))[2])
+{
+    return -1;
+}
+
+extern int
+RolloutWorkerMain(void)
+{
+    return EXIT_FAILURE;
+}
+
+#endif
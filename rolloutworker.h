@@ -0,0 +1,92 @@
+/*
+ * rolloutworker.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef ROLLOUTWORKER_H
+#define ROLLOUTWORKER_H
+
+#include "eval.h"
+#include "rollout.h"
+
+/* Rollout workers are gnubg processes started with --rollout-worker
+ * that play the games of a rollout for another one.  They are given
+ * the alternatives rolled out once (a job), then single trials, and
+ * answer each trial with the result of every game and the statistics
+ * gathered since the last answer.  The messages go over the standard
+ * input and output of the worker.  Numbers and strings are written with
+ * the primitives of the binary match files (gbf.h), but the boards,
+ * cube information, rollout contexts and statistics are sent as they
+ * are in memory, so both ends must be the same build; a worker that
+ * doesn't recognise the job exits.
+ *
+ * Each game is seeded by its trial number, so it doesn't matter which
+ * process plays it. */
+
+#define MAX_ROLLOUT_WORKERS 64
+
+typedef struct _rollouttrial {
+    int alt;
+    int trial;
+} rollouttrial;
+
+typedef struct _rolloutresult {
+    int alt;
+    int trial;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+} rolloutresult;
+
+typedef struct _rolloutjob {
+    int alternatives;
+    int fStatistics;
+    ConstTanBoard *apBoard;
+    const cubeinfo **apci;
+    int **apCubeDecTop;
+    evalsetup **apes;
+    const int *anBasisCube;
+} rolloutjob;
+
+/* The number of worker processes to use ("set rollout workers") */
+extern unsigned int cRolloutWorkers;
+
+/* Remember how this gnubg was started, for starting the workers */
+extern void RolloutWorkerSetProgram(const char *szArgv0, int fNoBearoff);
+
+/* Start or stop workers until cRolloutWorkers are running; returns
+ * how many are */
+extern int RolloutWorkersStart(void);
+extern void RolloutWorkersStop(void);
+
+/* Give the job to all running workers; returns how many took it */
+extern int RolloutWorkersSendJob(const rolloutjob * prj);
+
+/* Hand worker i the trials; -1 if it is gone */
+extern int RolloutWorkerSend(int i, const rollouttrial * art, int c);
+
+/* A worker with an answer to read, or -1 after msTimeout ms.  -2 if
+ * none is busy. */
+extern int RolloutWorkerWait(int msTimeout);
+
+/* Read the answer of worker i: *pc results into arr and, if the job
+ * has statistics, those of its games since the last answer into aars.
+ * -1 if the worker is gone, and with it its trials. */
+extern int RolloutWorkerReceive(int i, rolloutresult * arr, int *pc, rolloutstat(*aars)[2]);
+
+/* The worker's side; returns the exit status */
+extern int RolloutWorkerMain(void);
+
+#endif                          /* ROLLOUTWORKER_H */
@@ -0,0 +1,276 @@
+/*
+ * rolls.c
+ *
+ * by Joern Thyssen <jth@gnubg.org>, 2002
+ *
+ * Distribution of rolls, moved out of gtkrolls.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "backgammon.h"
+#include "multithread.h"
+#include "positionid.h"
+#include "rolls.h"
+#include "lib/simd.h"
+
+/* The tree is expanded one level at a time.  Every node of the
+ * deepest level gets its 21 replies filled in by a task of its own, so
+ * the threads share the work, and asking for one level more than last
+ * time only costs the new level. */
+
+typedef struct _rollstask {
+    Task task;
+    rollstree *prt;
+    rollsnode *prnParent;
+    unsigned int nLevel;        /* level of the parent, 0 for the root */
+    unsigned int iFirst, iLast;
+} rollstask;
+
+const int aanRollsDice[21][2] = {
+    {1, 1},
+    {2, 1}, {2, 2},
+    {3, 1}, {3, 2}, {3, 3},
+    {4, 1}, {4, 2}, {4, 3}, {4, 4},
+    {5, 1}, {5, 2}, {5, 3}, {5, 4}, {5, 5},
+    {6, 1}, {6, 2}, {6, 3}, {6, 4}, {6, 5}, {6, 6}
+};
+
+static rollstree *prtCache = NULL;
+
+static void
+FreeNodes(rollsnode * arn)
+{
+    unsigned int i;
+
+    if (!arn)
+        return;
+
+    for (i = 0; i < 21; ++i)
+        FreeNodes(arn[i].arnChild);
+
+    g_free(arn);
+}
+
+static void
+RollsTreeFree(rollstree * prt)
+{
+    if (!prt)
+        return;
+
+    FreeNodes(prt->rnRoot.arnChild);
+    g_free(prt);
+}
+
+extern rollstree *
+RollsTreeGet(const TanBoard anBoard, const cubeinfo * pci, const evalcontext * pec)
+{
+    positionkey key;
+
+    PositionKey(anBoard, &key);
+
+    /* a noisy evaluation must not be reused */
+
+    if (prtCache && EqualKeys(key, prtCache->rnRoot.key)
+        && !memcmp(pci, &prtCache->aci[0], sizeof(cubeinfo))
+        && !cmp_evalcontext(pec, &prtCache->ec) && (pec->rNoise == 0.0f || pec->fDeterministic))
+        return prtCache;
+
+    RollsTreeFree(prtCache);
+
+    prtCache = g_new0(rollstree, 1);
+    prtCache->rnRoot.key = key;
+    memcpy(&prtCache->aci[0], pci, sizeof(cubeinfo));
+    memcpy(&prtCache->aci[1], pci, sizeof(cubeinfo));
+    prtCache->aci[1].fMove = !pci->fMove;
+    memcpy(&prtCache->ec, pec, sizeof(evalcontext));
+    prtCache->nDepth = 0;
+
+    return prtCache;
+}
+
+static void
+RollsNodeMT(rollstask * prtt)
+{
+    rollstree *prt = prtt->prt;
+    cubeinfo *pciMove = &prt->aci[prtt->nLevel & 1];
+    cubeinfo *pciOpp = &prt->aci[!(prtt->nLevel & 1)];
+    TanBoard anBoard, an;
+    SSE_ALIGN(float ar[NUM_ROLLOUT_OUTPUTS]);
+    unsigned int i;
+
+    PositionFromKey(anBoard, &prtt->prnParent->key);
+
+    for (i = prtt->iFirst; i < prtt->iLast; ++i) {
+        rollsnode *prn = &prtt->prnParent->arnChild[i];
+
+        memcpy(an, anBoard, sizeof(an));
+
+        if (FindBestMove(prn->anMove, aanRollsDice[i][0], aanRollsDice[i][1], an, pciMove, &prt->ec, defaultFilters) < 0) {
+            MT_AbortTasks();
+            return;
+        }
+
+        SwapSides(an);
+        PositionKey((ConstTanBoard) an, &prn->key);
+
+        if (GeneralEvaluationE(ar, (ConstTanBoard) an, pciOpp, &prt->ec) < 0) {
+            MT_AbortTasks();
+            return;
+        }
+
+        memcpy(prn->arOutput, ar, sizeof(ar));
+    }
+}
+
+static void
+AddLeaves(rollstree * prt, rollsnode * prn, const unsigned int nLevel, GPtrArray * pa)
+{
+    unsigned int i;
+
+    if (nLevel == prt->nDepth) {
+        g_ptr_array_add(pa, prn);
+        return;
+    }
+
+    for (i = 0; i < 21; ++i)
+        AddLeaves(prt, &prn->arnChild[i], nLevel + 1, pa);
+}
+
+static gboolean
+UpdateProgressBar(gpointer UNUSED(unused))
+{
+    ProgressValue(MT_GetDoneTasks());
+    return TRUE;
+}
+
+extern int
+RollsTreeExpand(rollstree * prt, const unsigned int nDepth)
+{
+    while (prt->nDepth < nDepth) {
+
+        GPtrArray *pa = g_ptr_array_new();
+        unsigned int i, cTasks;
+        int result;
+
+        AddLeaves(prt, &prt->rnRoot, 0, pa);
+
+        /* a single leaf (the root) is split by roll, otherwise each
+         * leaf is a task */
+
+        cTasks = (pa->len == 1) ? 21 : pa->len;
+
+        for (i = 0; i < cTasks; ++i) {
+            rollstask *prtt = (rollstask *) malloc(sizeof(rollstask));
+
+            prtt->task.fun = (AsyncFun) RollsNodeMT;
+            prtt->task.data = prtt;
+            prtt->task.pLinkedTask = NULL;
+            prtt->prt = prt;
+            prtt->nLevel = prt->nDepth;
+
+            if (pa->len == 1) {
+                prtt->prnParent = g_ptr_array_index(pa, 0);
+                prtt->iFirst = i;
+                prtt->iLast = i + 1;
+            } else {
+                prtt->prnParent = g_ptr_array_index(pa, i);
+                prtt->iFirst = 0;
+                prtt->iLast = 21;
+            }
+
+            if (prtt->iFirst == 0)
+                prtt->prnParent->arnChild = g_new0(rollsnode, 21);
+
+            MT_AddTask((Task *) prtt, TRUE);
+        }
+
+        ProgressStartValue(_("Calculating equities"), cTasks);
+        result = MT_WaitForTasks(UpdateProgressBar, 250, FALSE);
+        ProgressEnd();
+
+        if (result == -1 || fInterrupt) {
+
+            /* discard the partial level, keep the ones above */
+
+            for (i = 0; i < pa->len; ++i) {
+                rollsnode *prn = g_ptr_array_index(pa, i);
+                g_free(prn->arnChild);
+                prn->arnChild = NULL;
+            }
+            g_ptr_array_free(pa, TRUE);
+            return -1;
+        }
+
+        g_ptr_array_free(pa, TRUE);
+        prt->nDepth++;
+    }
+
+    return 0;
+}
+
+/* Equity of prn looking n levels further, seen from the player on roll
+ * at prn */
+
+static void
+NodeValue(const rollstree * prt, const rollsnode * prn, const unsigned int n, float arOutput[NUM_ROLLOUT_OUTPUTS])
+{
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    unsigned int i, j;
+
+    if (!n) {
+        memcpy(arOutput, prn->arOutput, sizeof(ar));
+        return;
+    }
+
+    g_assert(prn->arnChild);
+
+    for (j = 0; j < NUM_ROLLOUT_OUTPUTS; ++j)
+        arOutput[j] = 0.0f;
+
+    for (i = 0; i < 21; ++i) {
+        NodeValue(prt, &prn->arnChild[i], n - 1, ar);
+        InvertEvaluationR(ar, &prt->aci[0]);
+
+        for (j = 0; j < NUM_ROLLOUT_OUTPUTS; ++j)
+            arOutput[j] += (aanRollsDice[i][0] == aanRollsDice[i][1]) ? ar[j] : 2.0f * ar[j];
+    }
+
+    for (j = 0; j < NUM_ROLLOUT_OUTPUTS; ++j)
+        arOutput[j] /= 36.0f;
+}
+
+/* Equity of the node prn at level nLevel (0 for the root) of a tree
+ * evaluated to depth nDepth, seen from the player on roll at the root.
+ * For the root and other inner nodes this is the average over the
+ * rolls. */
+
+extern void
+RollsNodeValue(const rollstree * prt, const rollsnode * prn,
+               const unsigned int nLevel, const unsigned int nDepth, float arOutput[NUM_ROLLOUT_OUTPUTS])
+{
+    g_assert(nLevel <= nDepth && nDepth <= prt->nDepth);
+
+    NodeValue(prt, prn, nDepth - nLevel, arOutput);
+
+    if (nLevel & 1)
+        InvertEvaluationR(arOutput, &prt->aci[0]);
+}
@@ -0,0 +1,58 @@
+/*
+ * rolls.h
+ *
+ * by Joern Thyssen <jth@gnubg.org>, 2002
+ *
+ * Distribution of rolls, moved out of gtkrolls.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef ROLLS_H
+#define ROLLS_H
+
+#include "eval.h"
+
+/* One roll in the distribution tree: the best move for the roll and
+ * the evaluation of the resulting position, seen from the opponent
+ * who is on roll there. */
+
+typedef struct _rollsnode {
+    positionkey key;            /* position after the move, opponent on roll */
+    int anMove[8];
+    float arOutput[NUM_ROLLOUT_OUTPUTS];
+    struct _rollsnode *arnChild;        /* the 21 replies, NULL until expanded */
+} rollsnode;
+
+typedef struct _rollstree {
+    rollsnode rnRoot;           /* only key and arnChild are used */
+    cubeinfo aci[2];            /* player on roll at the root and opponent */
+    evalcontext ec;
+    unsigned int nDepth;        /* number of levels expanded */
+} rollstree;
+
+extern const int aanRollsDice[21][2];
+
+extern rollstree *RollsTreeGet(const TanBoard anBoard, const cubeinfo * pci, const evalcontext * pec);
+
+extern int
+ RollsTreeExpand(rollstree * prt, const unsigned int nDepth);
+
+extern void
+ RollsNodeValue(const rollstree * prt, const rollsnode * prn,
+                const unsigned int nLevel, const unsigned int nDepth, float arOutput[NUM_ROLLOUT_OUTPUTS]);
+
+#endif                          /* ROLLS_H */
@@ -79,11 +79,13 @@
 #include "boarddim.h"
 #include "sound.h"
 #include "openurl.h"
+#include "osr.h"
 
 #if defined(USE_BOARD3D)
 #include "fun3d.h"
 #endif
 #include "multithread.h"
+#include "rolloutworker.h"
 
 static int iPlayerSet, iPlayerLateSet;
 
@@ -651,14 +653,36 @@ CommandSetCache(char *sz)
         outputerr("EvalCacheResize");
 }
 
+extern void
+CommandSetOSRTrials(char *sz)
+{
+    int n;
+
+    if ((n = ParseNumber(&sz)) < 1 || n > 1296 * 1296) {
+        outputl(_("You must specify the number of games of one sided rollouts (see `help set osrtrials')."));
+        return;
+    }
+
+    nOSRTrials = (unsigned int) n;
+    outputf(ngettext("One sided rollouts will play %u game.\n",
+                     "One sided rollouts will play %u games.\n", nOSRTrials), nOSRTrials);
+}
+
 #if defined(USE_MULTITHREAD)
 extern void
 CommandSetThreads(char *sz)
 {
     int n;
 
+    if (sz && *sz && !StrNCaseCmp(sz, "auto", strlen(sz))) {
+        MT_SetAutoThreads();
+        outputf(_("The number of threads has been set to %d, the number of processors available.\n"),
+                MT_GetNumThreads());
+        return;
+    }
+
     if ((n = ParseNumber(&sz)) <= 0) {
-        outputl(_("You must specify the number of threads to use."));
+        outputl(_("You must specify the number of threads to use (or `auto')."));
 
         return;
     }
@@ -672,6 +696,41 @@ CommandSetThreads(char *sz)
     MT_SetNumThreads(n);
     outputf(_("The number of threads has been set to %d.\n"), n);
 }
+
+static void
+SetNUMA(numamode nm)
+{
+    MT_SetNUMA(nm);
+
+    if (nm != NUMA_OFF && MT_GetNUMANodes() < 2)
+        outputl(_("Only one NUMA node was found; the threads are placed by the system."));
+    else if (nm == NUMA_SHARDED)
+        outputf(_("The threads are placed on %u NUMA nodes, which have copies of the nets "
+                  "and split the evaluation cache between them.\n"), MT_GetNUMANodes());
+    else if (nm == NUMA_ON)
+        outputf(_("The threads are placed on %u NUMA nodes, which have copies of the nets.\n"),
+                MT_GetNUMANodes());
+    else
+        outputl(_("The threads are placed by the system."));
+}
+
+extern void
+CommandSetNUMAOff(char *UNUSED(sz))
+{
+    SetNUMA(NUMA_OFF);
+}
+
+extern void
+CommandSetNUMAOn(char *UNUSED(sz))
+{
+    SetNUMA(NUMA_ON);
+}
+
+extern void
+CommandSetNUMASharded(char *UNUSED(sz))
+{
+    SetNUMA(NUMA_SHARDED);
+}
 #endif
 
 extern void
@@ -1729,6 +1788,12 @@ CommandSetRNGMersenne(char *sz)
     SetRNG(rngSet, rngctxSet, RNG_MERSENNE, sz);
 }
 
+extern void
+CommandSetRNGPhilox(char *sz)
+{
+    SetRNG(rngSet, rngctxSet, RNG_PHILOX, sz);
+}
+
 extern void
 CommandSetRNGRandomDotOrg(char *sz)
 {
@@ -2228,6 +2293,36 @@ CommandSetRolloutTrials(char *sz)
 
 }
 
+extern void
+CommandSetRolloutWorkers(char *sz)
+{
+
+    int n = ParseNumber(&sz);
+
+    if (n < 0) {
+        outputl(_("You must specify the number of worker processes (see `help set rollout workers')."));
+
+        return;
+    }
+
+    if (n > MAX_ROLLOUT_WORKERS) {
+        outputf(_("%d is the maximum number of rollout workers supported"), MAX_ROLLOUT_WORKERS);
+        output(".\n");
+        n = MAX_ROLLOUT_WORKERS;
+    }
+
+    cRolloutWorkers = n;
+    if (!n)
+        RolloutWorkersStop();
+
+    if (n)
+        outputf(ngettext("The games of rollouts will be played by %d worker process.\n",
+                         "The games of rollouts will be played by %d worker processes.\n", n), n);
+    else
+        outputl(_("The games of rollouts will be played by this process."));
+
+}
+
 extern void
 CommandSetRolloutTruncationEnable(char *sz)
 {
@@ -40,6 +40,7 @@
 #include "analysis.h"
 #include "positionid.h"
 #include "sgf.h"
+#include "sgfreader.h"
 
 static const char *szFile;
 static int fError;
@@ -55,106 +56,79 @@ ErrorHandler(const char *sz, int UNUSED(fParseError))
     }
 }
 
-static void
-FreeList(listOLD * pl, int nLevel)
-{
-    /* Levels are:
-     *  0 - GameTreeSeq
-     *  1 - GameTree
-     *  2 - Sequence
-     *  3 - Node
-     *  4 - Property
-     */
+static int
+IsBackgammon(listOLD * plRoot)
+{
 
-    if (nLevel == 1) {
-        FreeList(pl->plNext->p, 2);     /* initial sequence */
-        ListDelete(pl->plNext);
-        nLevel = 0;             /* remainder of list is more GameTreeSeqs */
-    }
+    listOLD *plProp;
+    property *pp;
 
-    while (pl->plNext != pl) {
-        if (nLevel == 3) {
-            FreeList(((property *) pl->plNext->p)->pl, 4);
-            free(pl->plNext->p);
-        } else if (nLevel == 4)
-            free(pl->plNext->p);
-        else
-            FreeList(pl->plNext->p, nLevel + 1);
+    for (plProp = plRoot->plNext; plProp != plRoot; plProp = plProp->plNext) {
+        pp = plProp->p;
 
-        ListDelete(pl->plNext);
+        if (pp->ach[0] == 'G' && pp->ach[1] == 'M' && pp->pl->plNext->p && atoi((char *) pp->pl->plNext->p) == 6)
+            return TRUE;
     }
 
-    free(pl);
+    return FALSE;
 }
 
-static void
-FreeGameTreeSeq(listOLD * pl)
+/* Move to the next backgammon game of the collection, and return its
+ * root node (NULL if there are no more) */
+
+static listOLD *
+NextBackgammonGame(sgfreader * psr)
 {
 
-    FreeList(pl, 0);
+    listOLD *plRoot;
+
+    while (SGFReaderNextGame(psr))
+        if ((plRoot = SGFReaderNextNode(psr)) && IsBackgammon(plRoot))
+            return plRoot;
+
+    return NULL;
 }
 
-static listOLD *
-LoadCollection(char *sz)
+/* Open the collection in sz and read up to the root node of its first
+ * backgammon game, which is returned in *pplRoot.  The games are then
+ * read one at a time with RestoreGame(), without ever holding the
+ * whole file in memory as a tree. */
+
+static sgfreader *
+OpenCollection(char *sz, listOLD ** pplRoot)
 {
 
-    listOLD *plCollection, *pl, *plRoot, *plProp;
-    FILE *pf;
-    int fBackgammon;
-    property *pp;
+    sgfreader *psr;
+    GError *error = NULL;
 
     fError = FALSE;
-    SGFErrorHandler = ErrorHandler;
+    szFile = strcmp(sz, "-") ? sz : "(stdin)";
 
-    if (strcmp(sz, "-")) {
-        if (!(pf = gnubg_g_fopen(sz, "r"))) {
-            outputerr(sz);
-            return NULL;
-        }
-        szFile = sz;
-    } else {
-        /* FIXME does it really make sense to try to load from stdin? */
-        pf = stdin;
-        szFile = "(stdin)";
+    if (!(psr = SGFReaderOpen(sz, &error))) {
+        outputerrf("%s: %s", sz, error->message);
+        g_error_free(error);
+        return NULL;
     }
 
-    plCollection = SGFParse(pf);
-
-    if (pf != stdin)
-        fclose(pf);
-
-    /* Traverse collection, looking for backgammon games. */
-    if (plCollection) {
-        pl = plCollection->plNext;
-        while (pl != plCollection) {
-            plRoot = ((listOLD *) ((listOLD *) pl->p)->plNext->p)->plNext->p;
-            fBackgammon = FALSE;
-            for (plProp = plRoot->plNext; plProp != plRoot; plProp = plProp->plNext) {
-                pp = plProp->p;
-
-                if (pp->ach[0] == 'G' && pp->ach[1] == 'M' && pp->pl->plNext->p && atoi((char *)
-                                                                                        pp->pl->plNext->p) == 6) {
-                    fBackgammon = TRUE;
-                    break;
-                }
-            }
+    if (!(*pplRoot = NextBackgammonGame(psr))) {
+        if (SGFReaderError(psr))
+            ErrorHandler(SGFReaderError(psr), TRUE);
+        ErrorHandler(_("warning: no backgammon games in SGF file"), TRUE);
+        SGFReaderFree(psr);
+        return NULL;
+    }
 
-            pl = pl->plNext;
+    return psr;
+}
 
-            if (!fBackgammon) {
-                FreeList(pl->plPrev->p, 1);
-                ListDelete(pl->plPrev);
-            }
-        }
+static void
+CloseCollection(sgfreader * psr)
+{
 
-        if (ListEmpty(plCollection)) {
-            ErrorHandler(_("warning: no backgammon games in SGF file"), TRUE);
-            free(plCollection);
-            plCollection = NULL;
-        }
-    }
+    if (SGFReaderError(psr))
+        ErrorHandler(SGFReaderError(psr), TRUE);
 
-    return plCollection;
+    SGFReaderFree(psr);
 }
 
 static void
@@ -1332,40 +1306,12 @@ RestoreNode(listOLD * pl)
     }
 }
 
-static void
-RestoreSequence(listOLD * pl, int fRoot)
-{
-
-    pl = pl->plNext;
-    if (fRoot)
-        RestoreRootNode(pl->p);
-    else
-        RestoreNode(pl->p);
-
-    while (pl = pl->plNext, pl->p)
-        RestoreNode(pl->p);
-}
-
-static void
-RestoreTree(listOLD * pl, int fRoot)
-{
-
-    pl = pl->plNext;
-    RestoreSequence(pl->p, fRoot);
-
-    pl = pl->plNext;
-    if (pl->p)
-        RestoreTree(pl->p, FALSE);
-
-    /* FIXME restore other variations, once we can handle them */
-}
+/* Start a new game in the match from its root node */
 
 static void
-RestoreGame(listOLD * pl)
+RestoreGameStart(listOLD * plRoot)
 {
 
-    moverecord *pmr, *pmrResign;
-
     InitBoard(ms.anBoard, ms.bgv);
 
     /* FIXME should anything be done with the current game? */
@@ -1380,7 +1326,18 @@ RestoreGame(listOLD * pl)
     ms.fTurn = ms.fMove = ms.fCubeOwner = -1;
     ms.gs = GAME_NONE;
 
-    RestoreTree(pl, TRUE);
+    RestoreRootNode(plRoot);
+}
+
+/* Finish the game once all of its nodes have been restored */
+
+static void
+RestoreGameEnd(void)
+{
+
+    moverecord *pmr, *pmrResign;
+
+    /* FIXME restore other variations, once we can handle them */
 
     pmr = plGame->plNext->p;
     g_assert(pmr->mt == MOVE_GAMEINFO);
@@ -1409,11 +1366,175 @@ RestoreGame(listOLD * pl)
 
 }
 
+/* Restore the game whose root node has just been read from psr */
+
+static void
+RestoreGame(sgfreader * psr, listOLD * plRoot)
+{
+
+    listOLD *pl;
+
+    RestoreGameStart(plRoot);
+
+    while ((pl = SGFReaderNextNode(psr)))
+        RestoreNode(pl);
+
+    RestoreGameEnd();
+}
+
+/* A collection read by SGFReadCollection(): the nodes of the main line
+ * of each backgammon game, copied out of the reader */
+
+struct _sgfcollection {
+    GPtrArray *paGames;         /* a GPtrArray of nodes for each game */
+    char *szError;              /* the first syntax error, or NULL */
+};
+
+static listOLD *
+CopyNode(const listOLD * plNode)
+{
+
+    listOLD *plCopy, *plProp, *plValue;
+
+    plCopy = g_new(listOLD, 1);
+    ListCreate(plCopy);
+
+    for (plProp = plNode->plNext; plProp != plNode; plProp = plProp->plNext) {
+        const property *ppOld = plProp->p;
+        property *pp = g_new(property, 1);
+
+        pp->ach[0] = ppOld->ach[0];
+        pp->ach[1] = ppOld->ach[1];
+        pp->pl = g_new(listOLD, 1);
+        ListCreate(pp->pl);
+
+        for (plValue = ppOld->pl->plNext; plValue != ppOld->pl; plValue = plValue->plNext)
+            ListInsert(pp->pl, g_strdup(plValue->p));
+
+        ListInsert(plCopy, pp);
+    }
+
+    return plCopy;
+}
+
+static void
+FreeNode(listOLD * plNode)
+{
+
+    while (plNode->plNext != plNode) {
+        property *pp = plNode->plNext->p;
+
+        while (pp->pl->plNext != pp->pl) {
+            g_free(pp->pl->plNext->p);
+            ListDelete(pp->pl->plNext);
+        }
+
+        g_free(pp->pl);
+        g_free(pp);
+        ListDelete(plNode->plNext);
+    }
+
+    g_free(plNode);
+}
+
+/* This only reads the file, so unlike the commands below it can be
+ * called from any thread */
+
+extern sgfcollection *
+SGFReadCollection(const char *sz, GError ** ppError)
+{
+
+    sgfreader *psr;
+    sgfcollection *psc;
+    listOLD *pl;
+
+    if (!(psr = SGFReaderOpen(sz, ppError)))
+        return NULL;
+
+    psc = g_new(sgfcollection, 1);
+    psc->paGames = g_ptr_array_new();
+
+    while ((pl = NextBackgammonGame(psr))) {
+        GPtrArray *paNodes = g_ptr_array_new();
+
+        do
+            g_ptr_array_add(paNodes, CopyNode(pl));
+        while ((pl = SGFReaderNextNode(psr)));
+
+        g_ptr_array_add(psc->paGames, paNodes);
+    }
+
+    psc->szError = g_strdup(SGFReaderError(psr));
+
+    SGFReaderFree(psr);
+
+    return psc;
+}
+
+extern int
+SGFRestoreCollection(const sgfcollection * psc, const char *sz)
+{
+
+    guint i, j;
+
+    fError = FALSE;
+    szFile = sz;
+
+    if (!psc->paGames->len) {
+        if (psc->szError)
+            ErrorHandler(psc->szError, TRUE);
+        ErrorHandler(_("warning: no backgammon games in SGF file"), TRUE);
+        return FALSE;
+    }
+
+    FreeMatch();
+    ClearMatch();
+
+    for (i = 0; i < psc->paGames->len; i++) {
+        GPtrArray *paNodes = g_ptr_array_index(psc->paGames, i);
+
+        RestoreGameStart(g_ptr_array_index(paNodes, 0));
+
+        for (j = 1; j < paNodes->len; j++)
+            RestoreNode(g_ptr_array_index(paNodes, j));
+
+        RestoreGameEnd();
+    }
+
+    if (psc->szError)
+        ErrorHandler(psc->szError, TRUE);
+
+    return TRUE;
+}
+
+extern void
+SGFFreeCollection(sgfcollection * psc)
+{
+
+    guint i, j;
+
+    if (!psc)
+        return;
+
+    for (i = 0; i < psc->paGames->len; i++) {
+        GPtrArray *paNodes = g_ptr_array_index(psc->paGames, i);
+
+        for (j = 0; j < paNodes->len; j++)
+            FreeNode(g_ptr_array_index(paNodes, j));
+        g_ptr_array_free(paNodes, TRUE);
+    }
+
+    g_ptr_array_free(psc->paGames, TRUE);
+    g_free(psc->szError);
+    g_free(psc);
+}
+
 extern void
 CommandLoadGame(char *sz)
 {
 
-    listOLD *pl;
+    sgfreader *psr;
+    listOLD *plRoot;
 
     sz = NextToken(&sz);
 
@@ -1422,9 +1543,11 @@ CommandLoadGame(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
-        if (!get_input_discard())
+    if ((psr = OpenCollection(sz, &plRoot))) {
+        if (!get_input_discard()) {
+            SGFReaderFree(psr);
             return;
+        }
 #if USE_GTK
         if (fX) {               /* Clear record to avoid ugly updates */
             GTKClearMoveRecord();
@@ -1435,11 +1558,11 @@ CommandLoadGame(char *sz)
         FreeMatch();
         ClearMatch();
 
-        /* FIXME if pl contains multiple games, ask which one to load */
+        /* FIXME if the file contains multiple games, ask which one to load */
 
-        RestoreGame(pl->plNext->p);
+        RestoreGame(psr, plRoot);
 
-        FreeGameTreeSeq(pl);
+        CloseCollection(psr);
 
         UpdateSettings();
 
@@ -1465,7 +1588,8 @@ extern void
 CommandLoadPosition(char *sz)
 {
 
-    listOLD *pl;
+    sgfreader *psr;
+    listOLD *plRoot;
 
     sz = NextToken(&sz);
 
@@ -1474,9 +1598,11 @@ CommandLoadPosition(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
-        if (!get_input_discard())
+    if ((psr = OpenCollection(sz, &plRoot))) {
+        if (!get_input_discard()) {
+            SGFReaderFree(psr);
             return;
+        }
 #if USE_GTK
         if (fX) {               /* Clear record to avoid ugly updates */
             GTKClearMoveRecord();
@@ -1487,11 +1613,11 @@ CommandLoadPosition(char *sz)
         FreeMatch();
         ClearMatch();
 
-        /* FIXME if pl contains multiple games, ask which one to load */
+        /* FIXME if the file contains multiple games, ask which one to load */
 
-        RestoreGame(pl->plNext->p);
+        RestoreGame(psr, plRoot);
 
-        FreeGameTreeSeq(pl);
+        CloseCollection(psr);
 
         UpdateSettings();
 
@@ -1513,7 +1639,8 @@ extern void
 CommandLoadMatch(char *sz)
 {
 
-    listOLD *pl;
+    sgfreader *psr;
+    listOLD *plRoot;
 
     sz = NextToken(&sz);
 
@@ -1522,11 +1649,13 @@ CommandLoadMatch(char *sz)
         return;
     }
 
-    if ((pl = LoadCollection(sz))) {
+    if ((psr = OpenCollection(sz, &plRoot))) {
         /* FIXME make sure the root nodes have MI properties; if not,
          * we're loading a session. */
-        if (!get_input_discard())
+        if (!get_input_discard()) {
+            SGFReaderFree(psr);
             return;
+        }
 #if USE_GTK
         if (fX) {               /* Clear record to avoid ugly updates */
             GTKClearMoveRecord();
@@ -1537,11 +1666,11 @@ CommandLoadMatch(char *sz)
         FreeMatch();
         ClearMatch();
 
-        for (pl = pl->plNext; pl->p; pl = pl->plNext) {
-            RestoreGame(pl->p);
-        }
+        do
+            RestoreGame(psr, plRoot);
+        while ((plRoot = NextBackgammonGame(psr)));
 
-        FreeGameTreeSeq(pl);
+        CloseCollection(psr);
 
         UpdateSettings();
 
@@ -23,6 +23,7 @@
 #define SGF_H
 
 #include "list.h"
+#include <glib.h>
 #include <stdio.h>
 
 typedef struct _property {
@@ -44,6 +45,16 @@ extern void (*SGFErrorHandler) (const char *szMessage, int fParseError);
  * (if set), or complains to stderr (otherwise). */
 extern listOLD *SGFParse(FILE * pf);
 
+/* The backgammon games of an SGF file, read without touching the match
+ * (so from any thread), to be restored later as the match on the main
+ * thread.  SGFRestoreCollection() returns FALSE, leaving the match as it
+ * was, if there are no games; sz names the file in error messages. */
+typedef struct _sgfcollection sgfcollection;
+
+extern sgfcollection *SGFReadCollection(const char *sz, GError ** ppError);
+extern int SGFRestoreCollection(const sgfcollection * psc, const char *sz);
+extern void SGFFreeCollection(sgfcollection * psc);
+
 /* The following properties are defined for GNU Backgammon SGF files:
  * 
  * A  (M)  - analysis (gnubg private)
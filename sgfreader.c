@@ -0,0 +1,464 @@
+/*
+ * sgfreader.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+#include "common.h"
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "glib-ext.h"
+
+#include "sgfreader.h"
+
+/* The lexical rules are those of sgf_l.l, so a file reads the same as
+ * with SGFParse().  Values can't be terminated in place (the file is
+ * mapped read only), so the values of a node are copied into one
+ * scratch buffer, and the properties and list cells pointing into it
+ * are kept in arrays; all three are reused from node to node, so
+ * reading a node normally allocates nothing. */
+
+typedef struct _propinfo {
+    char ach[2];
+    guint iValue;               /* index of the first value in paValues */
+    guint cValues;
+} propinfo;
+
+struct _sgfreader {
+    const char *pch, *pchEnd;   /* unread input */
+    GMappedFile *pmf;           /* the mapping, if we made it */
+    char *pchOwn;               /* or the buffer, if we read it */
+    int fInGame;                /* inside the main line of a game tree */
+    int nDepth;                 /* open game trees at pch */
+    const char *szError;
+
+    GString *pstrValues;        /* the values of the node, NUL separated */
+    GArray *paValues;           /* offsets of the values in pstrValues */
+    GArray *paProps;            /* propinfo for each property */
+
+    property *ap;               /* the node returned */
+    listOLD *apl;
+    guint cpAlloc, cplAlloc;
+    listOLD lNode;
+};
+
+static void
+Error(sgfreader * psr, const char *sz)
+{
+
+    if (!psr->szError)
+        psr->szError = sz;
+}
+
+extern sgfreader *
+SGFReaderNew(const char *pch, gsize cch)
+{
+
+    sgfreader *psr = g_new0(sgfreader, 1);
+
+    psr->pch = pch;
+    psr->pchEnd = pch + cch;
+
+    psr->pstrValues = g_string_sized_new(1024);
+    psr->paValues = g_array_new(FALSE, FALSE, sizeof(gsize));
+    psr->paProps = g_array_new(FALSE, FALSE, sizeof(propinfo));
+
+    return psr;
+}
+
+extern sgfreader *
+SGFReaderOpen(const char *szFile, GError ** ppError)
+{
+
+    sgfreader *psr;
+    GMappedFile *pmf;
+    GString *pstr;
+    char ach[4096];
+    size_t cch;
+
+    if (!strcmp(szFile, "-")) {
+        pstr = g_string_new(NULL);
+        while ((cch = fread(ach, 1, sizeof(ach), stdin)) > 0)
+            g_string_append_len(pstr, ach, cch);
+        psr = SGFReaderNew(pstr->str, pstr->len);
+        psr->pchOwn = g_string_free(pstr, FALSE);
+        return psr;
+    }
+
+    if (!(pmf = g_mapped_file_new(szFile, FALSE, ppError)))
+        return NULL;
+
+    psr = SGFReaderNew(g_mapped_file_get_contents(pmf), g_mapped_file_get_length(pmf));
+    psr->pmf = pmf;
+
+    return psr;
+}
+
+extern void
+SGFReaderFree(sgfreader * psr)
+{
+
+    if (psr->pmf)
+        g_mapped_file_unref(psr->pmf);
+    g_free(psr->pchOwn);
+
+    g_string_free(psr->pstrValues, TRUE);
+    g_array_free(psr->paValues, TRUE);
+    g_array_free(psr->paProps, TRUE);
+    g_free(psr->ap);
+    g_free(psr->apl);
+
+    g_free(psr);
+}
+
+extern const char *
+SGFReaderError(const sgfreader * psr)
+{
+
+    return psr->szError;
+}
+
+static void
+SkipSpace(sgfreader * psr)
+{
+
+    while (psr->pch < psr->pchEnd && isspace((unsigned char) *psr->pch))
+        psr->pch++;
+}
+
+/* Read the value starting after the '['; if pstr is NULL the value is
+ * only skipped */
+
+static void
+ReadValue(sgfreader * psr, GString * pstr)
+{
+
+    const char *pch = psr->pch, *pchEnd = psr->pchEnd;
+
+    while (pch < pchEnd) {
+        switch (*pch) {
+        case ']':
+            psr->pch = pch + 1;
+            return;
+
+        case '\0':
+            pch++;
+            break;
+
+        case '\\':
+            if (pch + 1 == pchEnd) {
+                if (pstr)
+                    g_string_append_c(pstr, '\\');
+                pch++;
+            } else if (pch[1] == ']') {
+                if (pstr)
+                    g_string_append_c(pstr, ']');
+                pch += 2;
+            } else if (pch[1] == '\n')
+                pch += 2;
+            else {
+                if (pstr)
+                    g_string_append_len(pstr, pch, 2);
+                pch += 2;
+            }
+            break;
+
+        default:
+            {
+                const char *pchRun = pch;
+
+                while (pch < pchEnd && *pch != ']' && *pch != '\\' && *pch)
+                    pch++;
+
+                if (pstr)
+                    g_string_append_len(pstr, pchRun, pch - pchRun);
+            }
+            break;
+        }
+    }
+
+    Error(psr, _("unterminated property value in SGF file"));
+    psr->pch = pchEnd;
+}
+
+/* Skip input until the game tree open at pch is closed */
+
+static void
+SkipTrees(sgfreader * psr)
+{
+
+    while (psr->nDepth && psr->pch < psr->pchEnd) {
+        switch (*psr->pch++) {
+        case '[':
+            ReadValue(psr, NULL);
+            break;
+        case '(':
+            psr->nDepth++;
+            break;
+        case ')':
+            psr->nDepth--;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (psr->nDepth) {
+        Error(psr, _("unexpected end of SGF file"));
+        psr->nDepth = 0;
+    }
+
+    psr->fInGame = FALSE;
+}
+
+extern int
+SGFReaderNextGame(sgfreader * psr)
+{
+
+    if (psr->fInGame || psr->nDepth)
+        SkipTrees(psr);
+
+    for (;;) {
+        SkipSpace(psr);
+
+        if (psr->pch == psr->pchEnd)
+            return FALSE;
+
+        switch (*psr->pch++) {
+        case '(':
+            psr->nDepth = 1;
+            psr->fInGame = TRUE;
+            return TRUE;
+
+        case '[':
+            Error(psr, _("illegal character in SGF file"));
+            ReadValue(psr, NULL);
+            break;
+
+        default:
+            Error(psr, _("illegal character in SGF file"));
+            break;
+        }
+    }
+}
+
+/* Read a property identifier as sgf_l.l does: any lowercase letters
+ * are ignored and there are at most two uppercase ones.  Returns FALSE
+ * for a run of lowercase letters only. */
+
+static int
+ReadIdent(sgfreader * psr, char ach[2])
+{
+
+    const char *pch = psr->pch, *pchEnd = psr->pchEnd;
+
+    while (pch < pchEnd && islower((unsigned char) *pch))
+        pch++;
+
+    if (pch == pchEnd || !isupper((unsigned char) *pch)) {
+        psr->pch = pch;
+        return FALSE;
+    }
+
+    ach[0] = *pch++;
+    ach[1] = 0;
+
+    while (pch < pchEnd && islower((unsigned char) *pch))
+        pch++;
+
+    if (pch < pchEnd && isupper((unsigned char) *pch)) {
+        ach[1] = *pch++;
+
+        while (pch < pchEnd && islower((unsigned char) *pch))
+            pch++;
+    }
+
+    psr->pch = pch;
+    return TRUE;
+}
+
+static void
+Append(listOLD * plHead, listOLD * pl, void *p)
+{
+
+    pl->p = p;
+    pl->plNext = plHead;
+    pl->plPrev = plHead->plPrev;
+    plHead->plPrev->plNext = pl;
+    plHead->plPrev = pl;
+}
+
+/* Build the lists of the node once all of it has been read, when the
+ * scratch buffer can no longer move */
+
+static listOLD *
+LinkNode(sgfreader * psr)
+{
+
+    guint cp = psr->paProps->len;
+    guint cpl = 2 * cp + psr->paValues->len;
+    listOLD *pl;
+    guint i, j;
+
+    if (cp > psr->cpAlloc) {
+        psr->cpAlloc = MAX(cp, 2 * psr->cpAlloc);
+        psr->ap = g_renew(property, psr->ap, psr->cpAlloc);
+    }
+
+    if (cpl > psr->cplAlloc) {
+        psr->cplAlloc = MAX(cpl, 2 * psr->cplAlloc);
+        psr->apl = g_renew(listOLD, psr->apl, psr->cplAlloc);
+    }
+
+    psr->lNode.plNext = psr->lNode.plPrev = &psr->lNode;
+    psr->lNode.p = NULL;
+
+    for (i = 0, pl = psr->apl; i < cp; i++) {
+        propinfo *ppi = &g_array_index(psr->paProps, propinfo, i);
+        property *pp = psr->ap + i;
+
+        pp->ach[0] = ppi->ach[0];
+        pp->ach[1] = ppi->ach[1];
+        pp->pl = pl++;
+        pp->pl->plNext = pp->pl->plPrev = pp->pl;
+        pp->pl->p = NULL;
+
+        for (j = 0; j < ppi->cValues; j++)
+            Append(pp->pl, pl++, psr->pstrValues->str + g_array_index(psr->paValues, gsize, ppi->iValue + j));
+
+        Append(&psr->lNode, pl++, pp);
+    }
+
+    return &psr->lNode;
+}
+
+/* Read the node starting after the ';' */
+
+static listOLD *
+ReadNode(sgfreader * psr)
+{
+
+    propinfo pi;
+
+    g_string_truncate(psr->pstrValues, 0);
+    g_array_set_size(psr->paValues, 0);
+    g_array_set_size(psr->paProps, 0);
+
+    for (;;) {
+        SkipSpace(psr);
+
+        if (psr->pch == psr->pchEnd)
+            break;
+
+        switch (*psr->pch) {
+        case ';':
+        case '(':
+        case ')':
+            return LinkNode(psr);
+
+        case '[':
+            /* a value with no identifier */
+            Error(psr, _("illegal character in SGF file"));
+            psr->pch++;
+            ReadValue(psr, NULL);
+            continue;
+
+        default:
+            break;
+        }
+
+        if (!isalpha((unsigned char) *psr->pch)) {
+            Error(psr, _("illegal character in SGF file"));
+            psr->pch++;
+            continue;
+        }
+
+        if (!ReadIdent(psr, pi.ach))
+            continue;
+
+        pi.iValue = psr->paValues->len;
+        pi.cValues = 0;
+
+        for (;;) {
+            gsize iOffset;
+
+            SkipSpace(psr);
+            if (psr->pch == psr->pchEnd || *psr->pch != '[')
+                break;
+
+            psr->pch++;
+            iOffset = psr->pstrValues->len;
+            ReadValue(psr, psr->pstrValues);
+            g_string_append_c(psr->pstrValues, 0);
+            g_array_append_val(psr->paValues, iOffset);
+            pi.cValues++;
+        }
+
+        if (pi.cValues)
+            g_array_append_val(psr->paProps, pi);
+        else
+            Error(psr, _("property without a value in SGF file"));
+    }
+
+    return LinkNode(psr);
+}
+
+extern listOLD *
+SGFReaderNextNode(sgfreader * psr)
+{
+
+    if (!psr->fInGame)
+        return NULL;
+
+    for (;;) {
+        SkipSpace(psr);
+
+        if (psr->pch == psr->pchEnd) {
+            SkipTrees(psr);
+            return NULL;
+        }
+
+        switch (*psr->pch++) {
+        case ';':
+            return ReadNode(psr);
+
+        case '(':
+            /* the main line continues in the first variation */
+            psr->nDepth++;
+            break;
+
+        case ')':
+            /* end of the main line; skip the other variations */
+            psr->nDepth--;
+            SkipTrees(psr);
+            return NULL;
+
+        case '[':
+            Error(psr, _("illegal character in SGF file"));
+            ReadValue(psr, NULL);
+            break;
+
+        default:
+            Error(psr, _("illegal character in SGF file"));
+            break;
+        }
+    }
+}
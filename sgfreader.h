@@ -0,0 +1,63 @@
+/*
+ * sgfreader.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef SGFREADER_H
+#define SGFREADER_H
+
+#include <glib.h>
+#include "list.h"
+#include "sgf.h"
+
+/* A streaming reader for SGF collections.  Instead of building the
+ * complete tree of SGFParse() it walks the file (normally mapped into
+ * memory) one game and one node at a time, and only keeps the node
+ * being read.  Variations other than the main line are skipped, as
+ * RestoreGame() does.
+ *
+ *   psr = SGFReaderOpen(szFile, &error);
+ *   while (SGFReaderNextGame(psr))
+ *       while ((plNode = SGFReaderNextNode(psr)))
+ *           ...
+ *   SGFReaderFree(psr);
+ *
+ * The nodes are lists of properties in the same form as SGFParse()
+ * produces them.  They are owned by the reader and valid until the
+ * next call; the values may be modified. */
+
+typedef struct _sgfreader sgfreader;
+
+/* Read the collection in the buffer, which must outlive the reader */
+extern sgfreader *SGFReaderNew(const char *pch, gsize cch);
+
+/* Read the collection in szFile ("-" for standard input) */
+extern sgfreader *SGFReaderOpen(const char *szFile, GError ** ppError);
+
+extern void SGFReaderFree(sgfreader * psr);
+
+/* Move to the next game tree of the collection; FALSE at the end */
+extern int SGFReaderNextGame(sgfreader * psr);
+
+/* The next node on the main line of the current game, or NULL at the
+ * end of it */
+extern listOLD *SGFReaderNextNode(sgfreader * psr);
+
+/* The first syntax error met, or NULL */
+extern const char *SGFReaderError(const sgfreader * psr);
+
+#endif                          /* SGFREADER_H */
@@ -41,12 +41,15 @@
 #include "matchid.h"
 #include "sound.h"
 #include "osr.h"
+#include "rolls.h"
+#include "tempmap.h"
 #include "positionid.h"
 #include "boarddim.h"
 #include "credits.h"
 #include "util.h"
 #include "openurl.h"
 #include "multithread.h"
+#include "rolloutworker.h"
 
 #if USE_GTK
 #include "gtkboard.h"
@@ -885,6 +888,10 @@ CommandShowRollout(char *UNUSED(sz))
     outputl(_("`rollout' will use:"));
     ShowRollout(&rcRollout);
 
+    if (cRolloutWorkers)
+        outputf(ngettext("The games will be played by %u worker process.\n",
+                         "The games will be played by %u worker processes.\n", cRolloutWorkers), cRolloutWorkers);
+
 }
 
 extern void
@@ -1136,6 +1143,12 @@ CommandShowThreads(char *UNUSED(sz))
 {
     int c = MT_GetNumThreads();
     outputf(ngettext("%d calculation thread.\n", "%d calculation threads.\n", c), c);
+
+    if (MT_GetAutoThreads())
+        outputf(_("(The number of processors available, %u.)\n"), MT_GetDefaultThreads());
+
+    if (MT_GetNUMA() != NUMA_OFF)
+        outputf(_("NUMA placement: %s (%u nodes).\n"), aszNUMAMode[MT_GetNUMA()], MT_GetNUMANodes());
 }
 #endif
 
@@ -1419,7 +1432,6 @@ CommandShowOneSidedRollout(char *sz)
 {
 
     TanBoard anBoard;
-    int nTrials = 5760;
     float arMu[2];
     float ar[5];
     unsigned int anPips[2];
@@ -1440,9 +1452,9 @@ CommandShowOneSidedRollout(char *sz)
     }
 #endif
 
-    outputf(_("One sided rollout with %d trials (%s on roll):\n"), nTrials, ap[ms.fMove].szName);
+    outputf(_("One sided rollout with %u trials (%s on roll):\n"), nOSRTrials, ap[ms.fMove].szName);
 
-    raceProbs((ConstTanBoard) anBoard, nTrials, ar, arMu);
+    raceProbs((ConstTanBoard) anBoard, nOSRTrials, ar, arMu);
     outputl(OutputPercents(ar, TRUE));
 
     PipCount((ConstTanBoard) anBoard, anPips);
@@ -2015,15 +2027,43 @@ CommandShowSound(char *UNUSED(sz))
 
 
 
+static void
+ShowRollsLevel(const rollstree * prt, const rollsnode * prn, const unsigned int nLevel, const unsigned int nDepth)
+{
+    TanBoard anBoard;
+    float ar[NUM_ROLLOUT_OUTPUTS];
+    char szMove[100];
+    unsigned int i;
+
+    PositionFromKey(anBoard, &prn->key);
+
+    for (i = 0; i < 21; ++i) {
+        const rollsnode *prnChild = &prn->arnChild[i];
+
+        RollsNodeValue(prt, prnChild, nLevel + 1, nDepth, ar);
+        FormatMove(szMove, (ConstTanBoard) anBoard, (int *) prnChild->anMove);
+
+        outputf("%*s%d%d  %-*s %s\n", 2 * nLevel, "", aanRollsDice[i][0], aanRollsDice[i][1],
+                30 - 2 * nLevel, szMove, OutputMWC(ar[OUTPUT_CUBEFUL_EQUITY], &prt->aci[0], TRUE));
+
+        if (nLevel + 1 < nDepth)
+            ShowRollsLevel(prt, prnChild, nLevel + 1, nDepth);
+    }
+
+    RollsNodeValue(prt, prn, nLevel, nDepth, ar);
+
+    outputf("%*s%-*s %s\n", 2 * nLevel, "", 34 - 2 * nLevel, _("Average equity"),
+            OutputMWC(ar[OUTPUT_CUBEFUL_EQUITY], &prt->aci[0], TRUE));
+}
+
 extern void
 CommandShowRolls(char *sz)
 {
 
-#if USE_GTK
+    static evalcontext ec0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
     int nDepth = ParseNumber(&sz);
-#else
-    (void) sz;                  /* suppress unused parameter compiler warning */
-#endif
+    cubeinfo ci;
+    rollstree *prt;
 
     if (ms.gs != GAME_PLAYING) {
         outputl(_("No game in progress (type `new game' to start one)."));
@@ -2033,18 +2073,74 @@ CommandShowRolls(char *sz)
 #if USE_GTK
 
     if (fX) {
-        static evalcontext ec0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
         GTKShowRolls(nDepth, &ec0ply, &ms);
         return;
     }
 #endif
 
-    CommandNotImplemented(NULL);
+    if (nDepth < 1)
+        nDepth = 1;
+
+    GetMatchStateCubeInfo(&ci, &ms);
+
+    prt = RollsTreeGet((ConstTanBoard) ms.anBoard, &ci, &ec0ply);
+
+    if (RollsTreeExpand(prt, (unsigned int) nDepth) < 0 || fInterrupt)
+        return;
+
+    outputf(_("Distribution of rolls (depth %d):\n\n"), nDepth);
+    ShowRollsLevel(prt, &prt->rnRoot, 0, (unsigned int) nDepth);
 
 }
 
 
 
+static void
+ShowTempMap(const matchstate ams[], const int n, gchar * aszTitle[])
+{
+    static evalcontext ec0ply = { TRUE, 0, FALSE, TRUE, 0.0 };
+    tempmapdata *atmd = g_new(tempmapdata, n);
+    int i, j, m;
+
+    for (m = 0; m < n; ++m) {
+        memcpy(atmd[m].anBoard, ams[m].anBoard, sizeof(TanBoard));
+        GetMatchStateCubeInfo(&atmd[m].ci, &ams[m]);
+    }
+
+    if (CalcTempMap(atmd, (unsigned int) n, &ec0ply) < 0 || fInterrupt) {
+        g_free(atmd);
+        return;
+    }
+
+    for (m = 0; m < n; ++m) {
+
+        /* money equities relative to the first cube value */
+        const float rFac = atmd[m].ci.nMatchTo ? 1.0f : (float) (ams[m].nCube / ams[0].nCube);
+        float rAverage = 0.0f;
+
+        if (aszTitle && aszTitle[m])
+            outputf("%s\n", aszTitle[m]);
+
+        output("   ");
+        for (j = 0; j < 6; ++j)
+            outputf(" %9d", j + 1);
+        outputc('\n');
+
+        for (i = 0; i < 6; ++i) {
+            outputf("%2d ", i + 1);
+            for (j = 0; j < 6; ++j) {
+                outputf(" %9s", OutputMWC(rFac * atmd[m].aarEquity[i][j], &atmd[m].ci, TRUE));
+                rAverage += rFac * atmd[m].aarEquity[i][j];
+            }
+            outputc('\n');
+        }
+
+        outputf(_("Average equity: %s\n\n"), OutputMWC(rAverage / 36.0f, &atmd[m].ci, TRUE));
+    }
+
+    g_free(atmd);
+}
+
 extern void
 CommandShowTemperatureMap(char *sz)
 {
@@ -2054,52 +2150,55 @@ CommandShowTemperatureMap(char *sz)
 
         return;
     }
-#if USE_GTK
-
-    if (fX) {
 
-        if (sz && *sz && !strncmp(sz, "=cube", 5)) {
+    if (sz && *sz && !strncmp(sz, "=cube", 5)) {
 
-            cubeinfo ci;
-            GetMatchStateCubeInfo(&ci, &ms);
-            if (GetDPEq(NULL, NULL, &ci)) {
+        cubeinfo ci;
+        GetMatchStateCubeInfo(&ci, &ms);
+        if (GetDPEq(NULL, NULL, &ci)) {
 
-                /* cube is available */
+            /* cube is available */
 
-                matchstate ams[2];
-                int i;
-                gchar *asz[2];
+            matchstate ams[2];
+            int i;
+            gchar *asz[2];
 
-                for (i = 0; i < 2; ++i)
-                    memcpy(&ams[i], &ms, sizeof(matchstate));
+            for (i = 0; i < 2; ++i)
+                memcpy(&ams[i], &ms, sizeof(matchstate));
 
-                ams[1].nCube *= 2;
-                ams[1].fCubeOwner = !ams[1].fMove;
+            ams[1].nCube *= 2;
+            ams[1].fCubeOwner = !ams[1].fMove;
 
-                for (i = 0; i < 2; ++i) {
-                    asz[i] = g_malloc(200);
-                    GetMatchStateCubeInfo(&ci, &ams[i]);
-                    FormatCubePosition(asz[i], &ci);
-                }
+            for (i = 0; i < 2; ++i) {
+                asz[i] = g_malloc(200);
+                GetMatchStateCubeInfo(&ci, &ams[i]);
+                FormatCubePosition(asz[i], &ci);
+            }
 
+#if USE_GTK
+            if (fX)
                 GTKShowTempMap(ams, 2, asz, FALSE);
+            else
+#endif
+                ShowTempMap(ams, 2, asz);
 
-                for (i = 0; i < 2; ++i)
-                    g_free(asz[i]);
-
-            } else
-                outputl(_("Cube is not available."));
+            for (i = 0; i < 2; ++i)
+                g_free(asz[i]);
 
         } else
-            GTKShowTempMap(&ms, 1, NULL, FALSE);
+            outputl(_("Cube is not available."));
 
         return;
     }
-#else
-    (void) sz;                  /* suppress unused parameter compiler warning */
+#if USE_GTK
+
+    if (fX) {
+        GTKShowTempMap(&ms, 1, NULL, FALSE);
+        return;
+    }
 #endif
 
-    CommandNotImplemented(NULL);
+    ShowTempMap(&ms, 1, NULL);
 
 }
 
@@ -41,17 +41,25 @@
 static randctx rc;
 static double timeTaken;
 
+#if defined(USE_MULTITHREAD)
+/* The number of iterations timed with one thread alone before the
+ * others are started */
+#define ALONE_ITERATIONS 8
+
+/* The time the threads of each NUMA node spent evaluating, and how many
+ * iterations they did, for the scaling figures; and the same for one
+ * thread running alone */
+static double arNodeTime[MAX_NUMA_NODES];
+static unsigned int acNodeIter[MAX_NUMA_NODES];
+static double rAloneTime;
+static unsigned int cAloneIter;
+#endif
+
 static void
-RunEvals(void *UNUSED(notused))
+RandomBoards(int aanBoard[EVALS_PER_ITERATION][2][25])
 {
-    int aanBoard[EVALS_PER_ITERATION][2][25];
     int i, j, k;
-    double t;
-    SSE_ALIGN(float ar[NUM_OUTPUTS]);
 
-#if defined(USE_MULTITHREAD)
-    MT_Exclusive();
-#endif
     for (i = 0; i < EVALS_PER_ITERATION; i++) {
         /* Generate a random board.  Don't allow chequers on the bar
          * or borne off, so we can trivially guarantee the position
@@ -71,19 +79,39 @@ RunEvals(void *UNUSED(notused))
             aanBoard[i][1][k]++;
         }
     }
+}
+
+static void
+RunEvals(void *UNUSED(notused))
+{
+    int aanBoard[EVALS_PER_ITERATION][2][25];
+    int i;
+    double t;
+    SSE_ALIGN(float ar[NUM_OUTPUTS]);
+
+#if defined(USE_MULTITHREAD)
+    MT_Exclusive();
+#endif
+    RandomBoards(aanBoard);
 
 #if defined(USE_MULTITHREAD)
     MT_Release();
     MT_SyncStart();
-#else
-    t = get_time();
 #endif
+    t = get_time();
 
     for (i = 0; i < EVALS_PER_ITERATION; i++) {
         (void) EvaluatePosition(NULL, (ConstTanBoard) aanBoard[i], ar, &ciCubeless, NULL);
     }
 
 #if defined(USE_MULTITHREAD)
+    t = get_time() - t;
+    i = MAX(MT_GetTLD()->iNode, 0);
+    MT_Exclusive();
+    arNodeTime[i] += t;
+    acNodeIter[i]++;
+    MT_Release();
+
     if ((t = MT_SyncEnd()) > 0)
         timeTaken += t;
 #else
@@ -91,6 +119,62 @@ RunEvals(void *UNUSED(notused))
 #endif
 }
 
+#if defined(USE_MULTITHREAD)
+/* The same as RunEvals() for a task running on its own, so without
+ * waiting for the other threads */
+static void
+RunEvalsAlone(void *UNUSED(notused))
+{
+    int aanBoard[EVALS_PER_ITERATION][2][25];
+    int i;
+    double t;
+    SSE_ALIGN(float ar[NUM_OUTPUTS]);
+
+    RandomBoards(aanBoard);
+
+    t = get_time();
+
+    for (i = 0; i < EVALS_PER_ITERATION; i++) {
+        (void) EvaluatePosition(NULL, (ConstTanBoard) aanBoard[i], ar, &ciCubeless, NULL);
+    }
+
+    rAloneTime += get_time() - t;
+    cAloneIter++;
+}
+
+/* How fast each thread was with all of them running, and all of them
+ * together, compared with one thread running alone */
+static void
+ShowScaling(void)
+{
+    unsigned int c = MT_GetNumThreads(), cIter = 0, i;
+    double rTime = 0.0, rAlone, rThread;
+
+    for (i = 0; i < MAX_NUMA_NODES; i++) {
+        rTime += arNodeTime[i];
+        cIter += acNodeIter[i];
+    }
+
+    if (c < 2 || rTime <= 0.0 || rAloneTime <= 0.0)
+        return;
+
+    rAlone = cAloneIter * (EVALS_PER_ITERATION * 1000 / rAloneTime);
+    rThread = cIter * (EVALS_PER_ITERATION * 1000 / rTime);
+    outputf(_("1 thread alone: %.0f static evaluations/second.\n"), rAlone);
+    outputf(_("%u threads: %.0f static evaluations/second per thread (%.0f%% of one alone), "
+              "%.0f%% of %u times one alone together.\n"),
+            c, rThread, 100.0 * rThread / rAlone, 100.0 * rEvalsPerSec / (c * rAlone), c);
+
+    if (MT_GetNUMA() != NUMA_OFF && MT_GetNUMANodes() > 1)
+        for (i = 0; i < MT_GetNUMANodes(); i++)
+            if (arNodeTime[i] > 0.0) {
+                rThread = acNodeIter[i] * (EVALS_PER_ITERATION * 1000 / arNodeTime[i]);
+                outputf(_("NUMA node %u: %.0f static evaluations/second per thread (%.0f%% of one alone).\n"),
+                        i, rThread, 100.0 * rThread / rAlone);
+            }
+}
+#endif
+
 extern void
 CommandCalibrate(char *sz)
 {
@@ -105,6 +189,10 @@ CommandCalibrate(char *sz)
 
 #if defined(USE_MULTITHREAD)
     MT_SyncInit();
+    for (i = 0; i < MAX_NUMA_NODES; i++) {
+        arNodeTime[i] = 0.0;
+        acNodeIter[i] = 0;
+    }
 #endif
 
     if (sz && *sz) {
@@ -131,6 +219,18 @@ CommandCalibrate(char *sz)
         pcc = GTKCalibrationStart();
 #endif
 
+#if defined(USE_MULTITHREAD)
+    /* the baseline for the scaling figures, before the threads compete
+     * for memory and caches */
+    rAloneTime = 0.0;
+    cAloneIter = 0;
+    if (MT_GetNumThreads() > 1)
+        for (i = 0; i < ALONE_ITERATIONS && !fInterrupt; i++) {
+            mt_add_tasks(1, RunEvalsAlone, NULL, NULL);
+            (void) MT_WaitForTasks(NULL, 0, FALSE);
+        }
+#endif
+
     timeTaken = 0.0;
     for (iIter = 0; n < 0 || iIter < (unsigned int) n;) {
         double spd;
@@ -171,6 +271,9 @@ CommandCalibrate(char *sz)
     if (timeTaken > 0.0) {
         rEvalsPerSec = iIter * (float) (EVALS_PER_ITERATION * 1000 / timeTaken);
         outputf("\rCalibration result: %.0f static evaluations/second.\n", rEvalsPerSec);
+#if defined(USE_MULTITHREAD)
+        ShowScaling();
+#endif
     } else
         outputl(_("Calibration incomplete."));
 }
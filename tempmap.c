@@ -0,0 +1,124 @@
+/*
+ * tempmap.c
+ *
+ * by Joern Thyssen <jth@gnubg.org>, 2003
+ *
+ * Temperature map equities, moved out of gtktempmap.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "backgammon.h"
+#include "multithread.h"
+#include "tempmap.h"
+#include "lib/simd.h"
+
+/* Every (position, roll) pair is a task of its own; the two orders of
+ * a non-double share one move search. */
+
+typedef struct _tempmaptask {
+    Task task;
+    tempmapdata *ptmd;
+    evalcontext *pec;
+    int i, j;
+} tempmaptask;
+
+static void
+TempMapRollMT(tempmaptask * ptmt)
+{
+    tempmapdata *ptmd = ptmt->ptmd;
+    int i = ptmt->i, j = ptmt->j;
+    SSE_ALIGN(float arOutput[NUM_ROLLOUT_OUTPUTS]);
+    TanBoard anBoard;
+    cubeinfo ci;
+
+    memcpy(&ci, &ptmd->ci, sizeof ci);
+
+    /* find best move */
+
+    memcpy(anBoard, ptmd->anBoard, sizeof(anBoard));
+
+    if (FindBestMove(ptmd->aaanMove[i][j], i + 1, j + 1, anBoard, &ci, ptmt->pec, defaultFilters) < 0) {
+        MT_AbortTasks();
+        return;
+    }
+
+    /* evaluate resulting position */
+
+    SwapSides(anBoard);
+    ci.fMove = !ci.fMove;
+
+    if (GeneralEvaluationE(arOutput, (ConstTanBoard) anBoard, &ci, ptmt->pec) < 0) {
+        MT_AbortTasks();
+        return;
+    }
+
+    InvertEvaluationR(arOutput, &ptmd->ci);
+
+    ptmd->aarEquity[i][j] = arOutput[OUTPUT_CUBEFUL_EQUITY];
+}
+
+static gboolean
+UpdateProgressBar(gpointer UNUSED(unused))
+{
+    ProgressValue(MT_GetDoneTasks());
+    return TRUE;
+}
+
+extern int
+CalcTempMap(tempmapdata atmd[], const unsigned int n, evalcontext * pec)
+{
+    unsigned int m;
+    int i, j;
+    int result;
+
+    for (m = 0; m < n; ++m)
+        for (i = 0; i < 6; ++i)
+            for (j = 0; j <= i; ++j) {
+                tempmaptask *ptmt = (tempmaptask *) malloc(sizeof(tempmaptask));
+
+                ptmt->task.fun = (AsyncFun) TempMapRollMT;
+                ptmt->task.data = ptmt;
+                ptmt->task.pLinkedTask = NULL;
+                ptmt->ptmd = &atmd[m];
+                ptmt->pec = pec;
+                ptmt->i = i;
+                ptmt->j = j;
+
+                MT_AddTask((Task *) ptmt, TRUE);
+            }
+
+    ProgressStartValue(_("Calculating equities"), (int) (21 * n));
+    result = MT_WaitForTasks(UpdateProgressBar, 250, FALSE);
+    ProgressEnd();
+
+    if (result == -1 || fInterrupt)
+        return -1;
+
+    for (m = 0; m < n; ++m)
+        for (i = 0; i < 6; ++i)
+            for (j = 0; j < i; ++j) {
+                atmd[m].aarEquity[j][i] = atmd[m].aarEquity[i][j];
+                memcpy(atmd[m].aaanMove[j][i], atmd[m].aaanMove[i][j], sizeof atmd[m].aaanMove[0][0]);
+            }
+
+    return 0;
+}
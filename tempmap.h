@@ -0,0 +1,39 @@
+/*
+ * tempmap.h
+ *
+ * by Joern Thyssen <jth@gnubg.org>, 2003
+ *
+ * Temperature map equities, moved out of gtktempmap.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of version 3 or later of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * $Id$
+ */
+
+#ifndef TEMPMAP_H
+#define TEMPMAP_H
+
+#include "eval.h"
+
+typedef struct _tempmapdata {
+    TanBoard anBoard;           /* player on roll */
+    cubeinfo ci;
+    float aarEquity[6][6];      /* after the best move, for the player on roll */
+    int aaanMove[6][6][8];
+} tempmapdata;
+
+extern int
+ CalcTempMap(tempmapdata atmd[], const unsigned int n, evalcontext * pec);
+
+#endif                          /* TEMPMAP_H */
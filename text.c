@@ -314,9 +314,6 @@ TextPrintCubeAnalysis(GString * gsz, const matchstate * pms, moverecord * pmr)
 {
 
     cubeinfo ci;
-    /* we need to remember the double type to be able to do the right
-     * thing for beavers and racoons */
-    static doubletype dt = DT_NORMAL;
 
     GetMatchStateCubeInfo(&ci, pms);
 
@@ -331,14 +328,12 @@ TextPrintCubeAnalysis(GString * gsz, const matchstate * pms, moverecord * pmr)
                                    pmr->CubeDecPtr->aarOutput,
                                    pmr->CubeDecPtr->aarStdDev,
                                    pmr->fPlayer, &pmr->CubeDecPtr->esDouble, &ci, FALSE, -1, pmr->stCube, SKILL_NONE);
-        dt = DT_NORMAL;
 
         break;
 
     case MOVE_DOUBLE:
 
-        dt = DoubleType(pms->fDoubled, pms->fMove, pms->fTurn);
-        if (dt != DT_NORMAL) {
+        if (DoubleType(pms->fDoubled, pms->fMove, pms->fTurn) != DT_NORMAL) {
             g_string_append(gsz, _("Cannot analyse beaver nor raccoons!\n"));
             break;
         }
@@ -352,10 +347,10 @@ TextPrintCubeAnalysis(GString * gsz, const matchstate * pms, moverecord * pmr)
     case MOVE_TAKE:
     case MOVE_DROP:
 
-        /* cube analysis from double, {take, drop, beaver} */
+        /* cube analysis from double, {take, drop, beaver}; the match
+         * state counts the beavers of the double being answered */
 
-        if (dt != DT_NORMAL) {
-            dt = DT_NORMAL;
+        if (pms->cBeavers) {
             g_string_append(gsz, _("Cannot analyse beaver nor raccoons!\n"));
             break;
         }